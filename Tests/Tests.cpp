@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
 #include <interactivity.h>
+#include <internal/interactive_session.h>
 #include <iostream>
 #include <fstream>
 #include <thread>
@@ -9,6 +10,19 @@
 #include <map>
 #if _WIN32
 #include <Windows.h>
+#elif __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include <internal/posix_http_client.h>
 #endif
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
@@ -285,7 +299,12 @@ void handle_input(void* context, interactive_session session, const interactive_
 {
 	int err = 0;
 
-	Logger::WriteMessage((std::string("Input detected, raw JSON: ") + std::string(input->jsonData, input->jsonDataLength)).c_str());
+	char inputJson[1024];
+	size_t inputJsonLength = sizeof(inputJson);
+	if (MIXER_OK == interactive_input_get_json(session, input, inputJson, &inputJsonLength))
+	{
+		Logger::WriteMessage((std::string("Input detected, raw JSON: ") + inputJson).c_str());
+	}
 
 	switch (input->type)
 	{
@@ -443,7 +462,11 @@ int do_short_code_auth(const std::string& clientId, const std::string& clientSec
 	ASSERT_RETERR(interactive_auth_get_short_code(clientId.c_str(), clientSecret.c_str(), shortCode, &shortCodeLength, shortCodeHandle, &shortCodeHandleLength));
 
 	std::string authUrl = std::string("https://www.mixer.com/go?code=") + shortCode;
+#if _WIN32
 	ShellExecuteA(0, 0, authUrl.c_str(), nullptr, nullptr, SW_SHOW);
+#else
+	Logger::WriteMessage(("Visit " + authUrl + " to authorize.").c_str());
+#endif
 
 	// Wait for OAuth token response.
 	char refreshTokenBuffer[1024];
@@ -520,7 +543,7 @@ static std::chrono::time_point<std::chrono::steady_clock> g_start;
 void handle_debug_message(interactive_debug_level level, const char* dbgMsg, size_t dbgMsgSize)
 {
 	std::stringstream s;
-	std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - g_start;
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - g_start;
 	std::string type;
 	switch (level)
 	{
@@ -544,537 +567,3709 @@ void handle_debug_message(interactive_debug_level level, const char* dbgMsg, siz
 	Logger::WriteMessage(s.str().c_str());
 }
 
-TEST_CLASS(Tests)
+// Offline tests and benchmarks drive the session internals directly, without a connection to the service.
+mixer_internal::interactive_session_internal* get_internal_session(interactive_session session)
 {
-public:
-	TEST_METHOD(ConnectTest)
-	{
-		g_start = std::chrono::high_resolution_clock::now();
-		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+	return reinterpret_cast<mixer_internal::interactive_session_internal*>(session);
+}
 
-		std::string clientId = CLIENT_ID;
-		std::string versionId = VERSION_ID;
-		std::string shareCode = SHARE_CODE;
-		std::string auth;
+int seed_scenes(interactive_session session, const char* scenesJson)
+{
+	mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+	sessionInternal->scenesRoot.Parse(scenesJson);
+	return mixer_internal::cache_controls(*sessionInternal);
+}
 
-		ASSERT_NOERR(do_auth(clientId, "", auth));
+void inject_message(interactive_session session, const std::string& message)
+{
+	mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+	std::vector<char> buffer(message.begin(), message.end());
+	buffer.push_back('\0');
+	sessionInternal->handle_ws_message(*sessionInternal->ws, buffer.data(), message.length());
+}
 
-		interactive_session session;
-		Logger::WriteMessage("Connecting...");
-		ASSERT_NOERR(interactive_open_session(&session));
-		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
-		ASSERT_NOERR(interactive_set_state_changed_handler(session, handle_state_changed));
-		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), false));
+// Pops the next queued method off the outgoing queue and returns its packet.
+std::string pop_outgoing_packet(mixer_internal::interactive_session_internal* sessionInternal)
+{
+	auto ev = std::static_pointer_cast<mixer_internal::rpc_method_event>(sessionInternal->outgoingEvents.front());
+	sessionInternal->outgoingEvents.pop();
+	return ev->packet;
+}
 
-		interactive_state state;
-		ASSERT_NOERR(interactive_get_state(session, &state));
-		Assert::IsTrue(interactive_connecting == state);
+#define BENCHMARK_SCENES "{\"scenes\":[{\"sceneID\":\"default\",\"controls\":[{\"controlID\":\"GiveHealth\",\"kind\":\"button\",\"text\":\"Give Health\",\"cost\":0}]}]}"
 
-		// Run until the session is connected.
-		while (g_activeSessionState < interactive_connected)
-		{
-			ASSERT_NOERR(interactive_run(session, 1));
-			if (g_activeSessionState < interactive_connected)
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(16));
-			}
-		}
+#if __linux__
+// The Sec-WebSocket-Accept value for a client's Sec-WebSocket-Key.
+std::string websocket_accept(const std::string& key)
+{
+	std::string keyed = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+	unsigned char digest[SHA_DIGEST_LENGTH];
+	SHA1((const unsigned char*)keyed.data(), keyed.length(), digest);
+	char accept[64];
+	EVP_EncodeBlock((unsigned char*)accept, digest, SHA_DIGEST_LENGTH);
+	return accept;
+}
 
-		Logger::WriteMessage("Disconnecting...");
-		interactive_close_session(session);
-	}
+// Returns the interactive hosts without going to the service.
+class stand_in_hosts : public mixer_internal::http_client, public mixer_internal::polled_http_client
+{
+public:
+	stand_in_hosts(const std::string& host) : hostsJson("[{\"address\":\"" + host + "\"}]") {}
 
-	TEST_METHOD(ConnectWithSecretTest)
+	int make_request(const std::string& uri, const std::string& requestType, const mixer_internal::http_headers* headers, const std::string& body, _Out_ mixer_internal::http_response& response, unsigned long timeoutMs = 5000) const
 	{
-		g_start = std::chrono::high_resolution_clock::now();
-		interactive_config_debug(interactive_debug_trace, handle_debug_message);
-
-		std::string clientId = DO_NOT_APPROVE_CLIENT_ID;
-		std::string clientSecret = DO_NOT_APPROVE_CLIENT_SECRET;
-		std::string versionId = VERSION_ID;
-		std::string shareCode = SHARE_CODE;
-		std::string auth;
-
-		ASSERT_NOERR(do_auth(clientId, clientSecret, auth));
+		response.statusCode = 200;
+		response.body = hostsJson;
+		return 0;
+	}
 
-		interactive_session session;
-		Logger::WriteMessage("Connecting...");
-		ASSERT_NOERR(interactive_open_session(&session));
-		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
-		ASSERT_NOERR(interactive_set_state_changed_handler(session, handle_state_changed));
-		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), true));
+	mixer_internal::polled_http_client* polled()
+	{
+		return this;
+	}
 
-		interactive_state state;
-		ASSERT_NOERR(interactive_get_state(session, &state));
-		Assert::IsTrue(interactive_connecting == state);
+	int make_request_async(const std::string& uri, const std::string& requestType, const mixer_internal::http_headers* headers, const std::string& body, const mixer_internal::on_http_complete onComplete, unsigned long timeoutMs = 5000)
+	{
+		pending.push_back(onComplete);
+		return 0;
+	}
 
-		// Run until the session is connected.
-		while (g_activeSessionState < interactive_connected)
+	size_t poll()
+	{
+		std::vector<mixer_internal::on_http_complete> completing;
+		completing.swap(pending);
+		for (auto& onComplete : completing)
 		{
-			ASSERT_NOERR(interactive_run(session, 1));
-			if (g_activeSessionState < interactive_connected)
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(16));
-			}
+			mixer_internal::http_response response;
+			make_request("", "GET", nullptr, "", response);
+			onComplete(0, response);
 		}
 
-		Logger::WriteMessage("Disconnecting...");
-		interactive_close_session(session);
+		return pending.size();
 	}
 
-	TEST_METHOD(InputTest)
+	// Pending requests complete on the next poll, there is no descriptor to wait on.
+	int poll_fd(int& timeoutMs) const
 	{
-		g_start = std::chrono::high_resolution_clock::now();
-		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+		timeoutMs = pending.empty() ? -1 : 0;
+		return -1;
+	}
 
-		std::string clientId = CLIENT_ID;
-		std::string versionId = VERSION_ID;
-		std::string shareCode = SHARE_CODE;
-		std::string auth;
+private:
+	std::string hostsJson;
+	std::vector<mixer_internal::on_http_complete> pending;
+};
 
-		ASSERT_NOERR(do_auth(clientId, "", auth));
+// Answers the hosts lookup at once, holds requests to http://slow/ for a second and fails requests to http://fail/. Polled
+// requests to http://slow/ are held without blocking.
+class slow_stand_in_hosts : public stand_in_hosts
+{
+public:
+	slow_stand_in_hosts(const std::string& host) : stand_in_hosts(host), polls(0) {}
 
-		interactive_session session;
-		ASSERT_NOERR(interactive_open_session(&session));
-		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
-		ASSERT_NOERR(interactive_set_input_handler(session, handle_input));
-		ASSERT_NOERR(interactive_set_participants_changed_handler(session, handle_participants_changed));
-		ASSERT_NOERR(interactive_set_unhandled_method_handler(session, handle_unhandled_method));
-		ASSERT_NOERR(interactive_set_transaction_complete_handler(session, handle_transaction_complete));
-		ASSERT_NOERR(interactive_set_state_changed_handler(session, handle_state_changed));
-		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), true));
-		ASSERT_ERR(MIXER_ERROR_INVALID_POINTER, interactive_capture_transaction(session, ""));
+	std::atomic<size_t> polls;
 
-		auto start = std::chrono::steady_clock::now();
-		while (std::chrono::steady_clock::now() < start + std::chrono::seconds(15))
+	int make_request_async(const std::string& uri, const std::string& requestType, const mixer_internal::http_headers* headers, const std::string& body, const mixer_internal::on_http_complete onComplete, unsigned long timeoutMs = 5000)
+	{
+		if (0 == uri.find("http://fail/"))
 		{
-			ASSERT_NOERR(interactive_run(session, 1));
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			return ECONNREFUSED;
 		}
 
-		Logger::WriteMessage("Disconnecting...");
-		interactive_close_session(session);
+		if (0 == uri.find("http://slow/"))
+		{
+			held.emplace_back(std::chrono::steady_clock::now() + std::chrono::seconds(1), onComplete);
+			return 0;
+		}
+
+		return stand_in_hosts::make_request_async(uri, requestType, headers, body, onComplete, timeoutMs);
 	}
 
-	TEST_METHOD(ManualReadyTest)
+	size_t poll()
 	{
-		g_start = std::chrono::high_resolution_clock::now();
-		interactive_config_debug(interactive_debug_trace, handle_debug_message);
-
-		std::string clientId = CLIENT_ID;
-		std::string versionId = VERSION_ID;
-		std::string shareCode = SHARE_CODE;
-		std::string auth;
-
-		ASSERT_NOERR(do_auth(clientId, "", auth));
-
-		interactive_session session;
-		ASSERT_NOERR(interactive_open_session(&session));
-		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
-		interactive_set_state_changed_handler(session, [](void* context, interactive_session session, interactive_state prevState, interactive_state newState)
+		++polls;
+		std::vector<mixer_internal::on_http_complete> completing;
+		auto now = std::chrono::steady_clock::now();
+		for (auto request = held.begin(); request != held.end();)
 		{
-			Logger::WriteMessage(("Interactive state changed: " + std::to_string(prevState) + " -> " + std::to_string(newState)).c_str());
-			static int order = 0;
-			if (interactive_disconnected == prevState)
+			if (request->first <= now)
 			{
-				Assert::IsTrue(0 == order++ && interactive_connecting == newState);
-			}
-			else if (interactive_connecting == prevState)
-			{
-				Assert::IsTrue(1 == order++ && interactive_connected == newState);
-				ASSERT_NOERR(interactive_set_ready(session, true));
-			}
-			else if (interactive_connected == prevState)
-			{
-				Assert::IsTrue(2 == order++ && interactive_ready == newState);
-				ASSERT_NOERR(interactive_set_ready(session, false));
+				completing.push_back(std::move(request->second));
+				request = held.erase(request);
 			}
-			else if (interactive_ready == prevState)
+			else
 			{
-				Assert::IsTrue(3 == order++ && interactive_connected == newState);
-				g_runInteractive = false;
+				++request;
 			}
-		});
+		}
 
-		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), false));
+		for (auto& onComplete : completing)
+		{
+			mixer_internal::http_response response;
+			response.statusCode = 200;
+			onComplete(0, response);
+		}
 
-		while (g_runInteractive)
+		return stand_in_hosts::poll() + held.size();
+	}
+
+	int poll_fd(int& timeoutMs) const
+	{
+		stand_in_hosts::poll_fd(timeoutMs);
+		auto now = std::chrono::steady_clock::now();
+		for (auto& request : held)
 		{
-			ASSERT_NOERR(interactive_run(session, 1));
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			int heldMs = request.first <= now ? 0 : (int)std::chrono::duration_cast<std::chrono::milliseconds>(request.first - now).count() + 1;
+			timeoutMs = timeoutMs < 0 ? heldMs : (std::min)(timeoutMs, heldMs);
 		}
 
-		Logger::WriteMessage("Disconnecting...");
-		interactive_close_session(session);
+		return -1;
 	}
 
-	TEST_METHOD(GroupTest)
+	int make_request(const std::string& uri, const std::string& requestType, const mixer_internal::http_headers* headers, const std::string& body, _Out_ mixer_internal::http_response& response, unsigned long timeoutMs = 5000) const
 	{
-		g_start = std::chrono::high_resolution_clock::now();
-		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+		if (0 == uri.find("http://fail/"))
+		{
+			return ECONNREFUSED;
+		}
 
-		std::string clientId = CLIENT_ID;
-		std::string versionId = VERSION_ID;
-		std::string shareCode = SHARE_CODE;
-		std::string auth;
+		if (0 == uri.find("http://slow/"))
+		{
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+			response.statusCode = 200;
+			return 0;
+		}
 
-		ASSERT_NOERR(do_auth(clientId, "", auth));
+		return stand_in_hosts::make_request(uri, requestType, headers, body, response, timeoutMs);
+	}
 
-		interactive_session session;
-		Logger::WriteMessage("Connecting...");
-		ASSERT_NOERR(interactive_open_session(&session));
-		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
-		ASSERT_NOERR(interactive_set_participants_changed_handler(session, handle_participants_changed));
+private:
+	std::vector<std::pair<std::chrono::steady_clock::time_point, mixer_internal::on_http_complete>> held;
+};
 
-		auto onStateChange = [](void* context, interactive_session session, interactive_state prevState, interactive_state currentState)
-		{
-			if (interactive_connected != currentState)
-			{
-				return;
-			}
+// A hosts lookup that takes five seconds when made blocking and never completes when polled.
+class held_hosts : public stand_in_hosts
+{
+public:
+	held_hosts() : stand_in_hosts(""), held(0) {}
 
-			Logger::WriteMessage("Enumerating groups.");
-			ASSERT_NOERR(interactive_get_groups(session, [](void* context, interactive_session session, const interactive_group* group)
-			{
-				std::stringstream s;
-				s << "[Group] '" << std::string(group->id, group->idLength) << "' Scene: '" << std::string(group->sceneId, group->sceneIdLength) << "'";
-				Logger::WriteMessage(s.str().c_str());
-			}));
+	int make_request(const std::string& uri, const std::string& requestType, const mixer_internal::http_headers* headers, const std::string& body, _Out_ mixer_internal::http_response& response, unsigned long timeoutMs = 5000) const
+	{
+		std::this_thread::sleep_for(std::chrono::seconds(5));
+		return ETIMEDOUT;
+	}
 
-			Logger::WriteMessage("Creating group.");
-			ASSERT_NOERR(interactive_create_group(session, "Test group", nullptr));
-			Logger::WriteMessage("Moving all participants to new group");
-			ASSERT_NOERR(interactive_get_participants(session, [](void* context, interactive_session session, const interactive_participant* participant)
-			{
-				ASSERT_NOERR(interactive_participant_set_group(session, participant->id, "Test group"));
-			}));
-			ASSERT_NOERR(interactive_group_set_scene(session, "Test group", "Scene1"));
+	int make_request_async(const std::string& uri, const std::string& requestType, const mixer_internal::http_headers* headers, const std::string& body, const mixer_internal::on_http_complete onComplete, unsigned long timeoutMs = 5000)
+	{
+		++held;
+		return 0;
+	}
 
-			ASSERT_NOERR(interactive_get_groups(session, [](void* context, interactive_session session, const interactive_group* group)
-			{
-				if (0 == strcmp("Test group", group->id))
-				{
-					Logger::WriteMessage("Test group found.");
-					Assert::IsTrue(0 == strcmp("Scene1", group->sceneId));
-				}
-			}));
+	size_t poll()
+	{
+		return held;
+	}
 
-			g_runInteractive = false;
-		};
+private:
+	size_t held;
+};
 
-		ASSERT_NOERR(interactive_set_state_changed_handler(session, onStateChange));
-		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), true));
+// A local stand-in for the interactive service. It accepts websockets on a single thread, says hello, answers the methods
+// a session bootstraps with and records how long each giveInput took to be captured.
+class stand_in_server
+{
+public:
+	stand_in_server() : listenFd(-1), epollFd(-1), wakeFd(-1), stopping(false), captures(0), captureMs(0)
+	{
+		listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		sockaddr_in address = {};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t addressLength = sizeof(address);
+		bind(listenFd, (sockaddr*)&address, addressLength);
+		listen(listenFd, SOMAXCONN);
+		getsockname(listenFd, (sockaddr*)&address, &addressLength);
+		port = ntohs(address.sin_port);
+
+		epollFd = epoll_create1(EPOLL_CLOEXEC);
+		wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		watch(listenFd);
+		watch(wakeFd);
+		thread = std::thread([this]() { run(); });
+	}
 
-		while (g_runInteractive)
+	~stand_in_server()
+	{
+		stopping = true;
+		uint64_t one = 1;
+		Assert::IsTrue(sizeof(one) == write(wakeFd, &one, sizeof(one)));
+		thread.join();
+		for (auto& connection : connections)
 		{
-			ASSERT_NOERR(interactive_run(session, 1));
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			close(connection.first);
 		}
+		close(listenFd);
+		close(wakeFd);
+		close(epollFd);
+	}
 
-		Logger::WriteMessage("Disconnecting...");
-		interactive_close_session(session);
+	std::string uri() const
+	{
+		return "ws://127.0.0.1:" + std::to_string(port) + "/";
 	}
 
-	TEST_METHOD(ScenesTest)
+	// Send every open websocket an input carrying a transaction to capture.
+	void send_inputs()
 	{
-		g_start = std::chrono::high_resolution_clock::now();
-		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto& connection : connections)
+		{
+			if (connection.second.open)
+			{
+				connection.second.inputSent = std::chrono::steady_clock::now();
+				send_message(connection.first, "{\"type\":\"method\",\"id\":0,\"method\":\"giveInput\",\"params\":{\"control\":{\"controlID\":\"GiveHealth\",\"kind\":\"button\"},"
+					"\"input\":{\"controlID\":\"GiveHealth\",\"event\":\"mousedown\",\"button\":0},\"participantID\":\"0d3b9a2c-7f55-4d45-9a52-61f8d6a5c1e0\",\"transactionID\":\"" + std::to_string(connection.first) + "\"},\"discard\":true}");
+			}
+		}
+	}
 
-		std::string clientId = CLIENT_ID;
-		std::string versionId = VERSION_ID;
-		std::string shareCode = SHARE_CODE;
-		std::string auth;
+	size_t captured(double* totalMs)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		*totalMs = captureMs;
+		return captures;
+	}
 
-		ASSERT_NOERR(do_auth(clientId, "", auth));
+	void reset_captures()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		captures = 0;
+		captureMs = 0;
+	}
 
-		interactive_session session;
-		Logger::WriteMessage("Connecting...");
-		ASSERT_NOERR(interactive_open_session(&session));
-		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
-		ASSERT_NOERR(interactive_set_participants_changed_handler(session, handle_participants_changed));
+private:
+	struct connection
+	{
+		std::string received;
+		bool open;
+		std::chrono::steady_clock::time_point inputSent;
+	};
 
-		interactive_set_state_changed_handler(session, [](void* context, interactive_session session, interactive_state prevState, interactive_state currentState)
+	int listenFd;
+	int epollFd;
+	int wakeFd;
+	unsigned short port;
+	std::atomic<bool> stopping;
+	std::thread thread;
+	std::mutex mutex;
+	std::map<int, connection> connections;
+	size_t captures;
+	double captureMs;
+
+	void watch(int fd)
+	{
+		epoll_event ev = {};
+		ev.events = EPOLLIN;
+		ev.data.fd = fd;
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+	}
+
+	void send_all(int fd, const std::string& data)
+	{
+		size_t sent = 0;
+		while (sent < data.length())
 		{
-			if (interactive_connected != currentState)
+			ssize_t written = ::send(fd, data.data() + sent, data.length() - sent, MSG_NOSIGNAL);
+			if (written > 0)
 			{
+				sent += written;
+			}
+			else if (written < 0 && EAGAIN == errno)
+			{
+				pollfd pfd = { fd, POLLOUT, 0 };
+				::poll(&pfd, 1, 100);
+			}
+			else
+			{
+				return;
+			}
+		}
+	}
+
+	void send_message(int fd, const std::string& message)
+	{
+		std::string frame(1, (char)0x81);
+		if (message.length() < 126)
+		{
+			frame += (char)message.length();
+		}
+		else
+		{
+			frame += (char)126;
+			frame += (char)(message.length() >> 8);
+			frame += (char)(message.length() & 0xff);
+		}
+		send_all(fd, frame + message);
+	}
+
+	void reply(int fd, unsigned int id, const std::string& result)
+	{
+		send_message(fd, "{\"type\":\"reply\",\"id\":" + std::to_string(id) + ",\"error\":null,\"result\":" + result + "}");
+	}
+
+	void handle_message(int fd, connection& client, const std::string& message)
+	{
+		rapidjson::Document doc;
+		if (doc.Parse(message.c_str()).HasParseError() || !doc.HasMember("method"))
+		{
+			return;
+		}
+
+		std::string method = doc["method"].GetString();
+		unsigned int id = doc["id"].GetUint();
+		if ("getTime" == method)
+		{
+			reply(fd, id, "{\"time\":" + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()) + "}");
+		}
+		else if ("getScenes" == method)
+		{
+			reply(fd, id, BENCHMARK_SCENES);
+		}
+		else if ("getGroups" == method)
+		{
+			reply(fd, id, "{\"groups\":[{\"groupID\":\"default\",\"sceneID\":\"default\"}]}");
+		}
+		else if ("getAllParticipants" == method)
+		{
+			reply(fd, id, "{\"participants\":[],\"total\":0,\"hasMore\":false}");
+		}
+		else if ("capture" == method)
+		{
+			++captures;
+			captureMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - client.inputSent).count();
+			reply(fd, id, "null");
+		}
+		else if (!doc.HasMember("discard") || !doc["discard"].GetBool())
+		{
+			reply(fd, id, "null");
+		}
+	}
+
+	void handle_data(int fd, connection& client)
+	{
+		if (!client.open)
+		{
+			size_t headerEnd = client.received.find("\r\n\r\n");
+			if (std::string::npos == headerEnd)
+			{
+				return;
+			}
+
+			static const char keyHeader[] = "Sec-WebSocket-Key: ";
+			size_t keyStart = client.received.find(keyHeader) + sizeof(keyHeader) - 1;
+			std::string accept = websocket_accept(client.received.substr(keyStart, client.received.find("\r\n", keyStart) - keyStart));
+			send_all(fd, "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: " + accept + "\r\n\r\n");
+			client.received.erase(0, headerEnd + 4);
+			client.open = true;
+			send_message(fd, "{\"type\":\"method\",\"id\":0,\"method\":\"hello\",\"params\":{},\"discard\":true}");
+		}
+
+		// Client frames are always masked.
+		for (;;)
+		{
+			const unsigned char* bytes = (const unsigned char*)client.received.data();
+			if (client.received.length() < 2)
+			{
+				return;
+			}
+
+			size_t headerLength = 6;
+			size_t length = bytes[1] & 0x7f;
+			if (126 == length)
+			{
+				if (client.received.length() < 8)
+				{
+					return;
+				}
+				length = (bytes[2] << 8) | bytes[3];
+				headerLength = 8;
+			}
+			else if (127 == length)
+			{
+				if (client.received.length() < 14)
+				{
+					return;
+				}
+				length = 0;
+				for (int i = 2; i < 10; ++i)
+				{
+					length = (length << 8) | bytes[i];
+				}
+				headerLength = 14;
+			}
+
+			if (client.received.length() < headerLength + length)
+			{
+				return;
+			}
+
+			std::string payload(length, '\0');
+			for (size_t i = 0; i < length; ++i)
+			{
+				payload[i] = bytes[headerLength + i] ^ bytes[headerLength - 4 + (i % 4)];
+			}
+
+			unsigned char opcode = bytes[0] & 0x0f;
+			client.received.erase(0, headerLength + length);
+			if (0x1 == opcode)
+			{
+				handle_message(fd, client, payload);
+			}
+		}
+	}
+
+	void run()
+	{
+		epoll_event events[64];
+		char buffer[16384];
+		while (!stopping)
+		{
+			int count = epoll_wait(epollFd, events, 64, -1);
+			std::lock_guard<std::mutex> lock(mutex);
+			for (int i = 0; i < count; ++i)
+			{
+				int fd = events[i].data.fd;
+				if (fd == listenFd)
+				{
+					int client;
+					while ((client = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+					{
+						int noDelay = 1;
+						setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+						connections[client].open = false;
+						watch(client);
+					}
+					continue;
+				}
+				else if (fd == wakeFd)
+				{
+					continue;
+				}
+
+				auto connectionItr = connections.find(fd);
+				ssize_t readBytes;
+				while ((readBytes = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+				{
+					connectionItr->second.received.append(buffer, readBytes);
+				}
+
+				if (0 == readBytes || (readBytes < 0 && EAGAIN != errno))
+				{
+					close(fd);
+					connections.erase(connectionItr);
+					continue;
+				}
+
+				handle_data(fd, connectionItr->second);
+			}
+		}
+	}
+};
+
+// Accepts one websocket, greets it with a message fragmented around a ping, then echoes every text message until the
+// client closes.
+class echo_websocket_server
+{
+public:
+	// "hello" split across a text frame and a continuation, with a ping between them.
+	echo_websocket_server() : echo_websocket_server(frame(0x01, "hel") + frame(0x89, "ping") + frame(0x80, "lo")) {}
+
+	// Sends the greeting's raw bytes once the handshake is done.
+	echo_websocket_server(const std::string& greeting) : pongs(0), closed(false), closeCode(0), greeting(greeting), listenFd(-1)
+	{
+		listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		sockaddr_in address = {};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t addressLength = sizeof(address);
+		bind(listenFd, (sockaddr*)&address, addressLength);
+		listen(listenFd, 1);
+		getsockname(listenFd, (sockaddr*)&address, &addressLength);
+		port = ntohs(address.sin_port);
+		thread = std::thread([this]() { run(); });
+	}
+
+	~echo_websocket_server()
+	{
+		shutdown(listenFd, SHUT_RDWR);
+		thread.join();
+		close(listenFd);
+	}
+
+	std::string uri() const
+	{
+		return "ws://127.0.0.1:" + std::to_string(port) + "/";
+	}
+
+	std::atomic<size_t> pongs;
+	std::atomic<bool> closed;
+	std::atomic<unsigned short> closeCode;
+
+	static std::string frame(unsigned char firstByte, const std::string& payload)
+	{
+		std::string frame(1, (char)firstByte);
+		if (payload.length() < 126)
+		{
+			frame += (char)payload.length();
+		}
+		else if (payload.length() < 65536)
+		{
+			frame += (char)126;
+			frame += (char)(payload.length() >> 8);
+			frame += (char)(payload.length() & 0xff);
+		}
+		else
+		{
+			frame += (char)127;
+			for (int shift = 56; shift >= 0; shift -= 8)
+			{
+				frame += (char)((uint64_t)payload.length() >> shift);
+			}
+		}
+
+		return frame + payload;
+	}
+
+private:
+	std::string greeting;
+	int listenFd;
+	unsigned short port;
+	std::thread thread;
+
+	static bool read_exactly(int fd, std::string& buffer, size_t length)
+	{
+		char chunk[65536];
+		while (buffer.length() < length)
+		{
+			ssize_t bytesRead = recv(fd, chunk, sizeof(chunk), 0);
+			if (bytesRead <= 0)
+			{
+				return false;
+			}
+			buffer.append(chunk, bytesRead);
+		}
+
+		return true;
+	}
+
+	static void send_frame(int fd, unsigned char firstByte, const std::string& payload)
+	{
+		std::string bytes = frame(firstByte, payload);
+		send(fd, bytes.data(), bytes.length(), MSG_NOSIGNAL);
+	}
+
+	void run()
+	{
+		int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+		if (fd < 0)
+		{
+			return;
+		}
+
+		std::string received;
+		size_t headerEnd;
+		while (std::string::npos == (headerEnd = received.find("\r\n\r\n")))
+		{
+			if (!read_exactly(fd, received, received.length() + 1))
+			{
+				close(fd);
+				return;
+			}
+		}
+
+		static const char keyHeader[] = "Sec-WebSocket-Key: ";
+		size_t keyStart = received.find(keyHeader) + sizeof(keyHeader) - 1;
+		std::string response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: " +
+			websocket_accept(received.substr(keyStart, received.find("\r\n", keyStart) - keyStart)) + "\r\n\r\n";
+		send(fd, response.data(), response.length(), MSG_NOSIGNAL);
+		received.erase(0, headerEnd + 4);
+
+		send(fd, greeting.data(), greeting.length(), MSG_NOSIGNAL);
+
+		// Client frames are always masked.
+		for (;;)
+		{
+			if (!read_exactly(fd, received, 2))
+			{
+				break;
+			}
+
+			size_t headerLength = 6;
+			uint64_t length = (unsigned char)received[1] & 0x7f;
+			if (126 == length)
+			{
+				headerLength = 8;
+			}
+			else if (127 == length)
+			{
+				headerLength = 14;
+			}
+
+			if (!read_exactly(fd, received, headerLength))
+			{
+				break;
+			}
+
+			if (126 == length)
+			{
+				length = ((unsigned char)received[2] << 8) | (unsigned char)received[3];
+			}
+			else if (127 == length)
+			{
+				length = 0;
+				for (int i = 2; i < 10; ++i)
+				{
+					length = (length << 8) | (unsigned char)received[i];
+				}
+			}
+
+			if (!read_exactly(fd, received, headerLength + length))
+			{
+				break;
+			}
+
+			std::string payload(length, '\0');
+			for (size_t i = 0; i < length; ++i)
+			{
+				payload[i] = received[headerLength + i] ^ received[headerLength - 4 + (i % 4)];
+			}
+
+			unsigned char opcode = received[0] & 0x0f;
+			received.erase(0, headerLength + length);
+			if (0x1 == opcode)
+			{
+				send_frame(fd, 0x81, payload);
+			}
+			else if (0xA == opcode)
+			{
+				++pongs;
+			}
+			else if (0x8 == opcode)
+			{
+				if (payload.length() >= 2)
+				{
+					closeCode = (unsigned short)(((unsigned char)payload[0] << 8) | (unsigned char)payload[1]);
+				}
+
+				send_frame(fd, 0x88, payload.substr(0, 2));
+				closed = true;
+				break;
+			}
+		}
+
+		close(fd);
+	}
+};
+
+size_t process_thread_count()
+{
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line))
+	{
+		if (0 == line.compare(0, 8, "Threads:"))
+		{
+			return std::stoul(line.substr(8));
+		}
+	}
+
+	return 0;
+}
+
+// A local http server with a thread per connection. Every request is answered with a small json body, connections are
+// kept alive unless closeAfterResponse is set, in which case the server closes them without saying so.
+class stand_in_http_server
+{
+public:
+	stand_in_http_server() : closeAfterResponse(false), accepted(0), requests(0), listenFd(-1), stopping(false)
+	{
+		listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		sockaddr_in address = {};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t addressLength = sizeof(address);
+		bind(listenFd, (sockaddr*)&address, addressLength);
+		listen(listenFd, SOMAXCONN);
+		getsockname(listenFd, (sockaddr*)&address, &addressLength);
+		port = ntohs(address.sin_port);
+		acceptThread = std::thread([this]() { run(); });
+	}
+
+	~stand_in_http_server()
+	{
+		stopping = true;
+		shutdown(listenFd, SHUT_RDWR);
+		acceptThread.join();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (int fd : fds)
+			{
+				shutdown(fd, SHUT_RDWR);
+			}
+		}
+		for (auto& thread : connectionThreads)
+		{
+			thread.join();
+		}
+		close(listenFd);
+	}
+
+	std::string uri() const
+	{
+		return "http://127.0.0.1:" + std::to_string(port) + "/";
+	}
+
+	std::atomic<bool> closeAfterResponse;
+	std::atomic<size_t> accepted;
+	std::atomic<size_t> requests;
+
+private:
+	void run()
+	{
+		for (;;)
+		{
+			int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+			if (fd < 0 || stopping)
+			{
+				if (fd >= 0)
+				{
+					close(fd);
+				}
 				return;
 			}
 
-			Logger::WriteMessage("Enumerating scenes.");
-			ASSERT_NOERR(interactive_get_scenes(session, [](void* context, interactive_session session, const interactive_scene* scene)
+			int noDelay = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+			++accepted;
+			std::lock_guard<std::mutex> lock(mutex);
+			fds.push_back(fd);
+			connectionThreads.emplace_back([this, fd]() { serve(fd); });
+		}
+	}
+
+	// Answers /nobody with a 204, /continue with an interim response before the final one and /chunked with a chunked
+	// body and a trailer. Every other request gets a small json body, without it for HEAD.
+	std::string respond(const std::string& requestLine)
+	{
+		std::string body = "{\"ok\":true}";
+		std::string headers = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.length()) + "\r\n\r\n";
+		if (std::string::npos != requestLine.find(" /nobody "))
+		{
+			return "HTTP/1.1 204 No Content\r\n\r\n";
+		}
+		else if (std::string::npos != requestLine.find(" /continue "))
+		{
+			return "HTTP/1.1 100 Continue\r\n\r\n" + headers + body;
+		}
+		else if (std::string::npos != requestLine.find(" /chunked "))
+		{
+			return "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\n{\"ok\"\r\n6\r\n:true}\r\n0\r\nX-Checksum: 1\r\n\r\n";
+		}
+		else if (0 == requestLine.compare(0, 5, "HEAD "))
+		{
+			return headers;
+		}
+
+		return headers + body;
+	}
+
+	void serve(int fd)
+	{
+		std::string received;
+		char buffer[4096];
+		for (;;)
+		{
+			size_t headerEnd = received.find("\r\n\r\n");
+			if (std::string::npos == headerEnd)
+			{
+				ssize_t bytesRead = recv(fd, buffer, sizeof(buffer), 0);
+				if (bytesRead <= 0)
+				{
+					break;
+				}
+				received.append(buffer, bytesRead);
+				continue;
+			}
+
+			size_t contentLength = 0;
+			size_t lengthHeader = received.find("Content-Length: ");
+			if (std::string::npos != lengthHeader && lengthHeader < headerEnd)
+			{
+				contentLength = strtoul(received.c_str() + lengthHeader + 16, nullptr, 10);
+			}
+			if (received.length() < headerEnd + 4 + contentLength)
+			{
+				ssize_t bytesRead = recv(fd, buffer, sizeof(buffer), 0);
+				if (bytesRead <= 0)
+				{
+					break;
+				}
+				received.append(buffer, bytesRead);
+				continue;
+			}
+
+			bool closing = closeAfterResponse || std::string::npos != received.substr(0, headerEnd).find("Connection: close");
+			std::string response = respond(received.substr(0, received.find("\r\n")));
+			received.erase(0, headerEnd + 4 + contentLength);
+			++requests;
+			if (send(fd, response.c_str(), response.length(), MSG_NOSIGNAL) != (ssize_t)response.length() || closing)
+			{
+				break;
+			}
+		}
+
+		// Critical Section: Forget the connection before closing it.
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			fds.erase(std::find(fds.begin(), fds.end(), fd));
+		}
+		close(fd);
+	}
+
+	int listenFd;
+	unsigned short port;
+	std::atomic<bool> stopping;
+	std::thread acceptThread;
+	std::mutex mutex;
+	std::vector<int> fds;
+	std::vector<std::thread> connectionThreads;
+};
+#endif
+
+TEST_CLASS(Tests)
+{
+public:
+	TEST_METHOD(ConnectTest)
+	{
+		g_start = std::chrono::steady_clock::now();
+		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+
+		std::string clientId = CLIENT_ID;
+		std::string versionId = VERSION_ID;
+		std::string shareCode = SHARE_CODE;
+		std::string auth;
+
+		ASSERT_NOERR(do_auth(clientId, "", auth));
+
+		interactive_session session;
+		Logger::WriteMessage("Connecting...");
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
+		ASSERT_NOERR(interactive_set_state_changed_handler(session, handle_state_changed));
+		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), false));
+
+		interactive_state state;
+		ASSERT_NOERR(interactive_get_state(session, &state));
+		Assert::IsTrue(interactive_connecting == state);
+
+		// Run until the session is connected.
+		while (g_activeSessionState < interactive_connected)
+		{
+			ASSERT_NOERR(interactive_run(session, 1));
+			if (g_activeSessionState < interactive_connected)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(16));
+			}
+		}
+
+		Logger::WriteMessage("Disconnecting...");
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(ConnectWithSecretTest)
+	{
+		g_start = std::chrono::steady_clock::now();
+		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+
+		std::string clientId = DO_NOT_APPROVE_CLIENT_ID;
+		std::string clientSecret = DO_NOT_APPROVE_CLIENT_SECRET;
+		std::string versionId = VERSION_ID;
+		std::string shareCode = SHARE_CODE;
+		std::string auth;
+
+		ASSERT_NOERR(do_auth(clientId, clientSecret, auth));
+
+		interactive_session session;
+		Logger::WriteMessage("Connecting...");
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
+		ASSERT_NOERR(interactive_set_state_changed_handler(session, handle_state_changed));
+		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), true));
+
+		interactive_state state;
+		ASSERT_NOERR(interactive_get_state(session, &state));
+		Assert::IsTrue(interactive_connecting == state);
+
+		// Run until the session is connected.
+		while (g_activeSessionState < interactive_connected)
+		{
+			ASSERT_NOERR(interactive_run(session, 1));
+			if (g_activeSessionState < interactive_connected)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(16));
+			}
+		}
+
+		Logger::WriteMessage("Disconnecting...");
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(InputTest)
+	{
+		g_start = std::chrono::steady_clock::now();
+		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+
+		std::string clientId = CLIENT_ID;
+		std::string versionId = VERSION_ID;
+		std::string shareCode = SHARE_CODE;
+		std::string auth;
+
+		ASSERT_NOERR(do_auth(clientId, "", auth));
+
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
+		ASSERT_NOERR(interactive_set_input_handler(session, handle_input));
+		ASSERT_NOERR(interactive_set_participants_changed_handler(session, handle_participants_changed));
+		ASSERT_NOERR(interactive_set_unhandled_method_handler(session, handle_unhandled_method));
+		ASSERT_NOERR(interactive_set_transaction_complete_handler(session, handle_transaction_complete));
+		ASSERT_NOERR(interactive_set_state_changed_handler(session, handle_state_changed));
+		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), true));
+		ASSERT_ERR(MIXER_ERROR_INVALID_POINTER, interactive_capture_transaction(session, ""));
+
+		auto start = std::chrono::steady_clock::now();
+		while (std::chrono::steady_clock::now() < start + std::chrono::seconds(15))
+		{
+			ASSERT_NOERR(interactive_run(session, 1));
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		Logger::WriteMessage("Disconnecting...");
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(ManualReadyTest)
+	{
+		g_start = std::chrono::steady_clock::now();
+		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+
+		std::string clientId = CLIENT_ID;
+		std::string versionId = VERSION_ID;
+		std::string shareCode = SHARE_CODE;
+		std::string auth;
+
+		ASSERT_NOERR(do_auth(clientId, "", auth));
+
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
+		interactive_set_state_changed_handler(session, [](void* context, interactive_session session, interactive_state prevState, interactive_state newState)
+		{
+			Logger::WriteMessage(("Interactive state changed: " + std::to_string(prevState) + " -> " + std::to_string(newState)).c_str());
+			static int order = 0;
+			if (interactive_disconnected == prevState)
+			{
+				Assert::IsTrue(0 == order++ && interactive_connecting == newState);
+			}
+			else if (interactive_connecting == prevState)
+			{
+				Assert::IsTrue(1 == order++ && interactive_connected == newState);
+				ASSERT_NOERR(interactive_set_ready(session, true));
+			}
+			else if (interactive_connected == prevState)
+			{
+				Assert::IsTrue(2 == order++ && interactive_ready == newState);
+				ASSERT_NOERR(interactive_set_ready(session, false));
+			}
+			else if (interactive_ready == prevState)
+			{
+				Assert::IsTrue(3 == order++ && interactive_connected == newState);
+				g_runInteractive = false;
+			}
+		});
+
+		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), false));
+
+		while (g_runInteractive)
+		{
+			ASSERT_NOERR(interactive_run(session, 1));
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		Logger::WriteMessage("Disconnecting...");
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(GroupTest)
+	{
+		g_start = std::chrono::steady_clock::now();
+		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+
+		std::string clientId = CLIENT_ID;
+		std::string versionId = VERSION_ID;
+		std::string shareCode = SHARE_CODE;
+		std::string auth;
+
+		ASSERT_NOERR(do_auth(clientId, "", auth));
+
+		interactive_session session;
+		Logger::WriteMessage("Connecting...");
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
+		ASSERT_NOERR(interactive_set_participants_changed_handler(session, handle_participants_changed));
+
+		auto onStateChange = [](void* context, interactive_session session, interactive_state prevState, interactive_state currentState)
+		{
+			if (interactive_connected != currentState)
+			{
+				return;
+			}
+
+			Logger::WriteMessage("Enumerating groups.");
+			ASSERT_NOERR(interactive_get_groups(session, [](void* context, interactive_session session, const interactive_group* group)
+			{
+				std::stringstream s;
+				s << "[Group] '" << std::string(group->id, group->idLength) << "' Scene: '" << std::string(group->sceneId, group->sceneIdLength) << "'";
+				Logger::WriteMessage(s.str().c_str());
+			}));
+
+			Logger::WriteMessage("Creating group.");
+			ASSERT_NOERR(interactive_create_group(session, "Test group", nullptr));
+			Logger::WriteMessage("Moving all participants to new group");
+			ASSERT_NOERR(interactive_get_participants(session, [](void* context, interactive_session session, const interactive_participant* participant)
+			{
+				ASSERT_NOERR(interactive_participant_set_group(session, participant->id, "Test group"));
+			}));
+			ASSERT_NOERR(interactive_group_set_scene(session, "Test group", "Scene1"));
+
+			ASSERT_NOERR(interactive_get_groups(session, [](void* context, interactive_session session, const interactive_group* group)
+			{
+				if (0 == strcmp("Test group", group->id))
+				{
+					Logger::WriteMessage("Test group found.");
+					Assert::IsTrue(0 == strcmp("Scene1", group->sceneId));
+				}
+			}));
+
+			g_runInteractive = false;
+		};
+
+		ASSERT_NOERR(interactive_set_state_changed_handler(session, onStateChange));
+		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), true));
+
+		while (g_runInteractive)
+		{
+			ASSERT_NOERR(interactive_run(session, 1));
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		Logger::WriteMessage("Disconnecting...");
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(ScenesTest)
+	{
+		g_start = std::chrono::steady_clock::now();
+		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+
+		std::string clientId = CLIENT_ID;
+		std::string versionId = VERSION_ID;
+		std::string shareCode = SHARE_CODE;
+		std::string auth;
+
+		ASSERT_NOERR(do_auth(clientId, "", auth));
+
+		interactive_session session;
+		Logger::WriteMessage("Connecting...");
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
+		ASSERT_NOERR(interactive_set_participants_changed_handler(session, handle_participants_changed));
+
+		interactive_set_state_changed_handler(session, [](void* context, interactive_session session, interactive_state prevState, interactive_state currentState)
+		{
+			if (interactive_connected != currentState)
+			{
+				return;
+			}
+
+			Logger::WriteMessage("Enumerating scenes.");
+			ASSERT_NOERR(interactive_get_scenes(session, [](void* context, interactive_session session, const interactive_scene* scene)
+			{
+				std::stringstream s;
+				s << "[Scene] '" << std::string(scene->id, scene->idLength) << "'";
+				Logger::WriteMessage(s.str().c_str());
+
+				Logger::WriteMessage("Groups:");
+				interactive_scene_get_groups(session, scene->id, [](void* context, interactive_session session, const interactive_group* group)
+				{
+					std::stringstream s;
+					s << std::setw(10) << group->id;
+					Logger::WriteMessage(s.str().c_str());
+				});
+
+				Logger::WriteMessage("Controls:");
+				interactive_scene_get_controls(session, scene->id, [](void* context, interactive_session session, const interactive_control* control)
+				{
+					print_control_properties(session, control->id);
+				});
+			}));
+
+			g_runInteractive = false;
+		});
+
+		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), true));
+
+		while (g_runInteractive)
+		{
+			ASSERT_NOERR(interactive_run(session, 1));
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		Logger::WriteMessage("Disconnecting...");
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(NotConnectedTest)
+	{
+		g_start = std::chrono::steady_clock::now();
+		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+
+		std::string clientId = CLIENT_ID;
+		std::string versionId = VERSION_ID;
+		std::string shareCode = SHARE_CODE;
+		std::string auth;
+
+		ASSERT_NOERR(do_auth(clientId, "", auth));
+
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+
+		std::string controlId = "GiveHealth";
+		size_t size;
+		interactive_property_type type;
+		char prop[8];
+		size = 8;
+		int intProp;
+		long long int64Prop;
+		bool boolProp;
+		float floatProp;
+		unsigned int uInt;
+		unsigned long long ulong64;
+
+
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_get_scenes(session, [](void* context, interactive_session session, const interactive_scene* scene) {}));
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_get_groups(session, [](void* context, interactive_session session, const interactive_group* group) {}));
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_get_participants(session, [](void* context, interactive_session session, const interactive_participant* participant) {}));
+
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_participant_get_user_id(session, "participant", &uInt));
+		size = 8;
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_participant_get_user_name(session, "participant", prop, &size));
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_participant_get_level(session, "participant", &uInt));
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_participant_get_last_input_at(session, "participant", &ulong64));
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_participant_get_connected_at(session, "participant", &ulong64));
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_participant_is_disabled(session, "participant", &boolProp));
+		size = 8;
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_participant_get_group(session, controlId.c_str(), prop, &size));
+
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_property_count(session, controlId.c_str(), &size));
+		size = 8;
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_property_data(session, controlId.c_str(), 0, "id", &size, &type));
+		size = 8;
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_meta_property_count(session, controlId.c_str(), &size));
+		size = 8;
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_meta_property_data(session, controlId.c_str(), 0, "id", &size, &type));
+
+
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_property_int(session, controlId.c_str(), "key", &intProp));
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_property_int64(session, controlId.c_str(), "key", &int64Prop));
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_property_bool(session, controlId.c_str(), "key", &boolProp));
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_property_float(session, controlId.c_str(), "key", &floatProp));
+		size = 8;
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_property_string(session, controlId.c_str(), "key", prop, &size));
+
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_meta_property_int(session, controlId.c_str(), "key", &intProp));
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_meta_property_int64(session, controlId.c_str(), "key", &int64Prop));
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_meta_property_bool(session, controlId.c_str(), "key", &boolProp));
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_meta_property_float(session, controlId.c_str(), "key", &floatProp));
+		size = 8;
+		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_meta_property_string(session, controlId.c_str(), "key", prop, &size));
+
+		Logger::WriteMessage("Disconnecting...");
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(ControlModificationTest)
+	{
+		g_start = std::chrono::steady_clock::now();
+		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+
+		std::string clientId = CLIENT_ID;
+		std::string versionId = VERSION_ID;
+		std::string shareCode = SHARE_CODE;
+		std::string auth;
+
+		ASSERT_NOERR(do_auth(clientId, "", auth));
+
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
+		ASSERT_NOERR(interactive_set_input_handler(session, handle_input));
+		ASSERT_NOERR(interactive_set_participants_changed_handler(session, handle_participants_changed));
+		ASSERT_NOERR(interactive_set_unhandled_method_handler(session, handle_unhandled_method));
+		ASSERT_NOERR(interactive_set_transaction_complete_handler(session, handle_transaction_complete));
+
+		auto onControlModUpdate = [](void* context, interactive_session session, interactive_control_event eventType, const interactive_control* control)
+		{
+			int err = 0;
+			Assert::IsTrue(interactive_control_updated == eventType);
+			bool disabled = false;
+			ASSERT_NOERR(interactive_control_get_property_bool(session, control->id, "disabled", &disabled));
+			Assert::IsTrue(disabled);
+			g_runInteractive = false;
+		};
+
+		ASSERT_NOERR(interactive_set_control_changed_handler(session, onControlModUpdate));
+
+		auto onStateChanged = [](void* context, interactive_session session, interactive_state prev, interactive_state curr)
+		{
+			if (interactive_connected == curr && interactive_connecting == prev)
+			{
+				int err = 0;
+				ASSERT_NOERR(interactive_control_set_property_bool(session, "GiveHealth", "disabled", true));
+			}
+		};
+
+		ASSERT_NOERR(interactive_set_state_changed_handler(session, onStateChanged));
+		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), true));
+
+		while (g_runInteractive)
+		{
+			ASSERT_NOERR(interactive_run(session, 1));
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		Logger::WriteMessage("Disconnecting...");
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(UserDataTest)
+	{
+		g_start = std::chrono::steady_clock::now();
+		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+
+		std::string clientId = CLIENT_ID;
+		std::string versionId = VERSION_ID;
+		std::string shareCode = SHARE_CODE;
+		std::string auth;
+
+		ASSERT_NOERR(do_auth(clientId, "", auth));
+
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
+		interactive_set_state_changed_handler(session, [](void* context, interactive_session session, interactive_state prevState, interactive_state currentState)
+		{
+			ASSERT_NOERR(interactive_get_user(session, [](void* context, interactive_session session, const interactive_user* user)
+			{
+				Assert::IsTrue(nullptr != user);
+				std::stringstream logStream;
+				logStream << "Connecting as: " << user->userName << std::endl;
+				logStream << "Id: " << user->id << std::endl;
+				logStream << "Avatar: " << (nullptr == user->avatarUrl ? "" : user->avatarUrl) << std::endl;
+				logStream << "Experience: " << user->experience << std::endl;
+				logStream << "Level: " << user->level << std::endl;
+				logStream << "Sparks: " << user->sparks << std::endl;
+				logStream << "Broadcasting: " << (user->isBroadcasting ? "true" : "false") << std::endl;
+				Logger::WriteMessage(logStream.str().c_str());
+			}));
+		});
+		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), true));
+
+		Logger::WriteMessage("Disconnecting...");
+		interactive_close_session(session);
+	}
+
+	struct ChangeControlContext {
+		std::string controlId;
+		std::string propKey;
+		std::string newPropVal;
+		unsigned int iterations;
+		unsigned int currentIteration;
+	};
+
+	TEST_METHOD(ManyControlModificationsTest)
+	{
+		g_start = std::chrono::steady_clock::now();
+		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+
+		std::string clientId = CLIENT_ID;
+		std::string versionId = VERSION_ID;
+		std::string shareCode = SHARE_CODE;
+		std::string auth;
+
+		ASSERT_NOERR(do_auth(clientId, "", auth));
+
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
+
+		ChangeControlContext context;
+		context.controlId = "GiveHealth";
+		context.propKey = "text";
+		context.newPropVal = "0";
+		context.iterations = 10;
+		context.currentIteration = 0;
+		interactive_set_session_context(session, &context);
+
+		interactive_set_control_changed_handler(session, [](void* context, interactive_session session, interactive_control_event eventType, const interactive_control* control) {
+			std::stringstream logStream;
+
+			// Verify the control updated with the correct string.
+			ChangeControlContext* ctx = static_cast<ChangeControlContext*>(context);
+			size_t bufferSize = 4096;
+			char buffer[4096];
+			ASSERT_NOERR(interactive_control_get_property_string(session, ctx->controlId.c_str(), ctx->propKey.c_str(), buffer, &bufferSize));
+			Assert::IsTrue(0 == ctx->newPropVal.compare(buffer));
+
+			++ctx->currentIteration;
+			if (ctx->currentIteration >= ctx->iterations)
+			{
+				g_runInteractive = false;
+			}
+			else {
+				// Generate some random data to put into the string
+				ctx->newPropVal = std::to_string(rand());
+				ASSERT_NOERR(interactive_control_set_property_string(session, ctx->controlId.c_str(), ctx->propKey.c_str(), ctx->newPropVal.c_str()));
+			}
+		});
+
+		g_runInteractive = true;
+
+		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), true));
+
+		interactive_set_state_changed_handler(session, [](void* context, interactive_session session, interactive_state previousState, interactive_state newState)
+		{
+			if (interactive_state::interactive_ready == newState) {
+				ChangeControlContext* ctx = static_cast<ChangeControlContext*>(context);
+				Assert::IsTrue(0 == ctx->currentIteration);
+				ASSERT_NOERR(interactive_control_set_property_string(session, ctx->controlId.c_str(), ctx->propKey.c_str(), ctx->newPropVal.c_str()));
+			}
+		});
+
+		while (g_runInteractive)
+		{
+			ASSERT_NOERR(interactive_run(session, 10));
+			// Wait one second between processing changes so it can be seen on the page.
+			std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+		}
+
+		Assert::IsTrue(context.currentIteration == context.iterations);
+
+		Logger::WriteMessage("Disconnecting...");
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(InputThroughputBenchmark)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(seed_scenes(session, BENCHMARK_SCENES));
+
+		static size_t inputCount = 0;
+		ASSERT_NOERR(interactive_set_input_handler(session, [](void* context, interactive_session session, const interactive_input* input)
+		{
+			if (input_type_click == input->type && 0 == strcmp(input->control.id, "GiveHealth"))
+			{
+				++inputCount;
+			}
+		}));
+
+		std::string message = "{\"type\":\"method\",\"id\":1234,\"method\":\"giveInput\",\"params\":{\"control\":{\"controlID\":\"GiveHealth\",\"kind\":\"button\"},"
+			"\"input\":{\"controlID\":\"GiveHealth\",\"event\":\"mousedown\",\"button\":0,\"x\":0.5,\"y\":0.25},"
+			"\"participantID\":\"0d3b9a2c-7f55-4d45-9a52-61f8d6a5c1e0\",\"transactionID\":\"e3a2c3b8-2b8c-4f0e-8d7e-1f6b2f1c9d3a\"},\"discard\":true}";
+		std::vector<char> buffer(message.begin(), message.end());
+		buffer.push_back('\0');
+
+		// Feed inputs through the websocket message handler and dispatch them in batches, as a title calling interactive_run each frame would.
+		const size_t totalInputs = 500000;
+		const unsigned int batchSize = 100;
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < totalInputs; i += batchSize)
+		{
+			for (unsigned int j = 0; j < batchSize; ++j)
+			{
+				sessionInternal->handle_ws_message(*sessionInternal->ws, buffer.data(), message.length());
+			}
+
+			ASSERT_NOERR(interactive_run(session, batchSize));
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		Assert::IsTrue(totalInputs == inputCount);
+		std::stringstream s;
+		s << "Processed " << totalInputs << " inputs in " << elapsed.count() << "s, " << (size_t)(totalInputs / elapsed.count()) << " inputs/sec on one core.";
+		Logger::WriteMessage(s.str().c_str());
+
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(InputJsonTest)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(seed_scenes(session, BENCHMARK_SCENES));
+
+		static std::string inputJson;
+		static const interactive_input* lastInput = nullptr;
+		ASSERT_NOERR(interactive_set_input_handler(session, [](void* context, interactive_session session, const interactive_input* input)
+		{
+			size_t inputJsonLength = 0;
+			if (MIXER_ERROR_BUFFER_SIZE == interactive_input_get_json(session, input, nullptr, &inputJsonLength))
+			{
+				inputJson.resize(inputJsonLength);
+				if (MIXER_OK == interactive_input_get_json(session, input, (char*)inputJson.data(), &inputJsonLength))
+				{
+					inputJson.erase(inputJsonLength - 1);
+				}
+			}
+
+			lastInput = input;
+		}));
+
+		std::string params = "{\"control\":{\"controlID\":\"GiveHealth\",\"kind\":\"button\"},\"input\":{\"controlID\":\"GiveHealth\",\"event\":\"mousedown\",\"button\":0},\"participantID\":\"abc\"}";
+		inject_message(session, "{\"type\":\"method\",\"id\":1,\"method\":\"giveInput\",\"params\":" + params + ",\"discard\":true}");
+		ASSERT_NOERR(interactive_run(session, 1));
+		Assert::IsTrue(params == inputJson);
+
+		// The json may only be requested while the input is being handled.
+		size_t inputJsonLength = 0;
+		ASSERT_ERR(MIXER_ERROR_INVALID_OPERATION, interactive_input_get_json(session, lastInput, nullptr, &inputJsonLength));
+
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(MethodSerializationTest)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+		sessionInternal->sequenceId = 42;
+
+		// Methods are written straight into the session's buffer, check that the packets are complete and independent.
+		for (int i = 0; i < 2; ++i)
+		{
+			ASSERT_NOERR(mixer_internal::queue_method(*sessionInternal, RPC_METHOD_UPDATE_CONTROLS, [&](mixer_internal::method_writer& writer)
+			{
+				writer.StartObject();
+				writer.Key(RPC_SCENE_ID);
+				writer.String("default");
+				writer.Key(RPC_PARAM_CONTROLS);
+				writer.StartArray();
+				writer.StartObject();
+				writer.Key(RPC_CONTROL_ID);
+				writer.String("Give \"Health\"");
+				writer.Key("progress");
+				writer.Double(0.5);
+				writer.EndObject();
+				writer.EndArray();
+				writer.EndObject();
+			}, nullptr));
+		}
+
+		ASSERT_NOERR(mixer_internal::queue_method(*sessionInternal, RPC_METHOD_GET_SCENES, nullptr, [](mixer_internal::interactive_session_internal&, rapidjson::Document&) { return 0; }));
+
+		Assert::IsTrue(3 == sessionInternal->outgoingEvents.size());
+		for (unsigned int id = 0; id < 3; ++id)
+		{
+			auto ev = sessionInternal->outgoingEvents.front();
+			sessionInternal->outgoingEvents.pop();
+			Assert::IsTrue(mixer_internal::interactive_event_type_rpc_method == ev->type);
+			const std::string& packet = reinterpret_cast<std::shared_ptr<mixer_internal::rpc_method_event>&>(ev)->packet;
+			Logger::WriteMessage(packet.c_str());
+
+			rapidjson::Document doc;
+			Assert::IsFalse(doc.Parse(packet.c_str()).HasParseError());
+			Assert::IsTrue(id == doc[RPC_ID].GetUint());
+			Assert::IsTrue(42 == doc[RPC_SEQUENCE].GetInt());
+			Assert::IsTrue(doc[RPC_PARAMS].IsObject());
+			if (id < 2)
+			{
+				Assert::IsTrue(0 == strcmp(RPC_METHOD_UPDATE_CONTROLS, doc[RPC_METHOD].GetString()));
+				Assert::IsTrue(doc[RPC_DISCARD].GetBool());
+				Assert::IsTrue(0 == strcmp("Give \"Health\"", doc[RPC_PARAMS][RPC_PARAM_CONTROLS][0][RPC_CONTROL_ID].GetString()));
+			}
+			else
+			{
+				Assert::IsTrue(0 == strcmp(RPC_METHOD_GET_SCENES, doc[RPC_METHOD].GetString()));
+				Assert::IsFalse(doc[RPC_DISCARD].GetBool());
+				Assert::IsTrue(0 == doc[RPC_PARAMS].MemberCount());
+			}
+		}
+
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(ControlUpdateBatchingTest)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(seed_scenes(session, "{\"scenes\":[{\"sceneID\":\"default\",\"controls\":[{\"controlID\":\"Health\",\"kind\":\"button\"},{\"controlID\":\"Mana\",\"kind\":\"button\"}]},"
+			"{\"sceneID\":\"Shop\",\"controls\":[{\"controlID\":\"Buy\",\"kind\":\"button\"}]}]}"));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+		sessionInternal->state = interactive_connected;
+
+		// A frame's worth of HUD updates, several of them overwriting earlier values.
+		for (int i = 0; i <= 10; ++i)
+		{
+			ASSERT_NOERR(interactive_control_set_property_float(session, "Health", "progress", i / 10.0f));
+			ASSERT_NOERR(interactive_control_set_property_float(session, "Mana", "progress", i / 20.0f));
+		}
+		ASSERT_NOERR(interactive_control_set_property_string(session, "Health", "text", "Full"));
+		ASSERT_NOERR(interactive_control_set_property_bool(session, "Mana", "disabled", true));
+		ASSERT_NOERR(interactive_control_set_property_int(session, "Buy", "cost", 10));
+		ASSERT_NOERR(interactive_control_set_property_int(session, "Buy", "cost", 20));
+		ASSERT_NOERR(interactive_control_set_property_null(session, "Buy", "tooltip"));
+		Assert::IsTrue(sessionInternal->outgoingEvents.empty());
+
+		ASSERT_NOERR(interactive_run(session, 1));
+		Assert::IsTrue(2 == sessionInternal->outgoingEvents.size());
+
+		rapidjson::Document updates[2];
+		for (int i = 0; i < 2; ++i)
+		{
+			std::string packet = pop_outgoing_packet(sessionInternal);
+			Logger::WriteMessage(packet.c_str());
+			Assert::IsFalse(updates[i].Parse(packet.c_str()).HasParseError());
+			Assert::IsTrue(0 == strcmp(RPC_METHOD_UPDATE_CONTROLS, updates[i][RPC_METHOD].GetString()));
+		}
+
+		rapidjson::Value& defaultScene = updates[0][RPC_PARAMS];
+		Assert::IsTrue(0 == strcmp("default", defaultScene[RPC_SCENE_ID].GetString()));
+		Assert::IsTrue(2 == defaultScene[RPC_PARAM_CONTROLS].Size());
+		Assert::IsTrue(0 == strcmp("Health", defaultScene[RPC_PARAM_CONTROLS][0][RPC_CONTROL_ID].GetString()));
+		Assert::IsTrue(1.0 == defaultScene[RPC_PARAM_CONTROLS][0]["progress"].GetDouble());
+		Assert::IsTrue(0 == strcmp("Full", defaultScene[RPC_PARAM_CONTROLS][0]["text"].GetString()));
+		Assert::IsTrue(0.5 == defaultScene[RPC_PARAM_CONTROLS][1]["progress"].GetDouble());
+		Assert::IsTrue(defaultScene[RPC_PARAM_CONTROLS][1]["disabled"].GetBool());
+
+		rapidjson::Value& shopScene = updates[1][RPC_PARAMS];
+		Assert::IsTrue(0 == strcmp("Shop", shopScene[RPC_SCENE_ID].GetString()));
+		Assert::IsTrue(1 == shopScene[RPC_PARAM_CONTROLS].Size());
+		Assert::IsTrue(20 == shopScene[RPC_PARAM_CONTROLS][0]["cost"].GetInt());
+		Assert::IsTrue(shopScene[RPC_PARAM_CONTROLS][0]["tooltip"].IsNull());
+
+		interactive_control_update_stats stats;
+		ASSERT_NOERR(interactive_control_get_update_stats(session, &stats));
+		Assert::IsTrue(27 == stats.propertyWrites);
+		Assert::IsTrue(2 == stats.methodsSent);
+		Assert::IsTrue(25 == stats.framesSaved);
+
+		// Nothing is sent when there is nothing pending.
+		ASSERT_NOERR(interactive_control_flush_updates(session));
+		Assert::IsTrue(sessionInternal->outgoingEvents.empty());
+
+		// A cooldown is sent after any updates batched before it.
+		ASSERT_NOERR(interactive_control_set_property_string(session, "Health", "text", "Cooling"));
+		ASSERT_NOERR(interactive_control_trigger_cooldown(session, "Health", 1000));
+		Assert::IsTrue(2 == sessionInternal->outgoingEvents.size());
+		rapidjson::Document batched, cooldown;
+		Assert::IsFalse(batched.Parse(pop_outgoing_packet(sessionInternal).c_str()).HasParseError());
+		Assert::IsFalse(cooldown.Parse(pop_outgoing_packet(sessionInternal).c_str()).HasParseError());
+		Assert::IsTrue(0 == strcmp("Cooling", batched[RPC_PARAMS][RPC_PARAM_CONTROLS][0]["text"].GetString()));
+		Assert::IsFalse(batched[RPC_PARAMS].HasMember("priority"));
+		Assert::IsTrue(1 == cooldown[RPC_PARAMS]["priority"].GetInt());
+		Assert::IsTrue(cooldown[RPC_PARAMS][RPC_PARAM_CONTROLS][0].HasMember(RPC_CONTROL_BUTTON_COOLDOWN));
+
+		sessionInternal->state = interactive_disconnected;
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(PropertyHandleTest)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(seed_scenes(session, "{\"scenes\":[{\"sceneID\":\"default\",\"controls\":[{\"controlID\":\"Health\",\"kind\":\"button\",\"progress\":0.25,\"text\":\"Heal\"},{\"controlID\":\"Mana\",\"kind\":\"button\",\"progress\":0.75}]}]}"));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+		sessionInternal->state = interactive_connected;
+
+		interactive_property_handle progress, text, cooldown, sameProgress;
+		ASSERT_NOERR(interactive_control_get_property_handle(session, "Health", "progress", &progress));
+		ASSERT_NOERR(interactive_control_get_property_handle(session, "Health", "text", &text));
+		ASSERT_NOERR(interactive_control_get_property_handle(session, "Health", "cooldown", &cooldown));
+		ASSERT_NOERR(interactive_control_get_property_handle(session, "Health", "progress", &sameProgress));
+		Assert::IsTrue(progress == sameProgress);
+		ASSERT_ERR(MIXER_ERROR_OBJECT_NOT_FOUND, interactive_control_get_property_handle(session, "Missing", "progress", &progress));
+
+		float progressVal = 0;
+		ASSERT_NOERR(interactive_property_get_float(session, progress, &progressVal));
+		Assert::IsTrue(0.25f == progressVal);
+		char textVal[16];
+		size_t textValLength = sizeof(textVal);
+		ASSERT_NOERR(interactive_property_get_string(session, text, textVal, &textValLength));
+		Assert::IsTrue(0 == strcmp("Heal", textVal));
+		long long cooldownVal = 0;
+		ASSERT_ERR(MIXER_ERROR_PROPERTY_NOT_FOUND, interactive_property_get_int64(session, cooldown, &cooldownVal));
+		ASSERT_ERR(MIXER_ERROR_INVALID_PROPERTY_TYPE, interactive_property_get_int64(session, text, &cooldownVal));
+
+		// Writes through a handle join the same batch as writes by name.
+		ASSERT_NOERR(interactive_property_set_float(session, progress, 0.5f));
+		ASSERT_NOERR(interactive_control_set_property_string(session, "Health", "text", "Healing"));
+		ASSERT_NOERR(interactive_control_flush_updates(session));
+		Assert::IsTrue(1 == sessionInternal->outgoingEvents.size());
+		sessionInternal->outgoingEvents.pop();
+
+		// Handles follow the control when the cache replaces it.
+		inject_message(session, "{\"type\":\"method\",\"id\":5,\"method\":\"onControlUpdate\",\"params\":{\"sceneID\":\"default\",\"controls\":[{\"controlID\":\"Health\",\"kind\":\"button\",\"progress\":0.5,\"cooldown\":1234,\"text\":\"Healing\"}]},\"discard\":true}");
+		ASSERT_NOERR(interactive_run(session, 1));
+		ASSERT_NOERR(interactive_property_get_float(session, progress, &progressVal));
+		Assert::IsTrue(0.5f == progressVal);
+		ASSERT_NOERR(interactive_property_get_int64(session, cooldown, &cooldownVal));
+		Assert::IsTrue(1234 == cooldownVal);
+
+		// And when the scenes are cached again.
+		ASSERT_NOERR(seed_scenes(session, "{\"scenes\":[{\"sceneID\":\"default\",\"controls\":[{\"controlID\":\"Health\",\"kind\":\"button\",\"progress\":1.0,\"text\":\"Heal\"},{\"controlID\":\"Mana\",\"kind\":\"button\",\"progress\":0.75}]}]}"));
+		ASSERT_NOERR(interactive_property_get_float(session, progress, &progressVal));
+		Assert::IsTrue(1.0f == progressVal);
+		ASSERT_ERR(MIXER_ERROR_PROPERTY_NOT_FOUND, interactive_property_get_int64(session, cooldown, &cooldownVal));
+
+		// Compare polling by handle against polling by name.
+		const int iterations = 100000;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; ++i)
+		{
+			ASSERT_NOERR(interactive_control_get_property_float(session, "Health", "progress", &progressVal));
+		}
+		std::chrono::duration<double> byName = std::chrono::steady_clock::now() - start;
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; ++i)
+		{
+			ASSERT_NOERR(interactive_property_get_float(session, progress, &progressVal));
+		}
+		std::chrono::duration<double> byHandle = std::chrono::steady_clock::now() - start;
+		std::stringstream s;
+		s << iterations << " reads by name: " << byName.count() << "s, by handle: " << byHandle.count() << "s.";
+		Logger::WriteMessage(s.str().c_str());
+
+		sessionInternal->state = interactive_disconnected;
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(ControlStoreTest)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(seed_scenes(session, "{\"scenes\":[{\"sceneID\":\"default\",\"groups\":[{\"groupID\":\"default\"}],\"controls\":[{\"controlID\":\"Health\",\"kind\":\"button\",\"cost\":10,\"text\":\"Heal\",\"meta\":{\"color\":{\"value\":\"red\"}}},{\"controlID\":\"Mana\",\"kind\":\"button\",\"cost\":\"free\",\"tooltip\":\"Restore\",\"progress\":0.5}]},{\"sceneID\":\"Shop\",\"controls\":[{\"controlID\":\"Buy\",\"kind\":\"joystick\",\"progress\":1}]}]}"));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+		sessionInternal->state = interactive_connected;
+
+		static std::vector<std::string> names;
+		auto on_control = [](void*, interactive_session, const interactive_control* control) { names.push_back(std::string(control->id, control->idLength) + ":" + std::string(control->kind, control->kindLength)); };
+		auto on_scene = [](void*, interactive_session, const interactive_scene* scene) { names.push_back(std::string(scene->id, scene->idLength)); };
+		auto on_group = [](void*, interactive_session, const interactive_group* group) { names.push_back(std::string(group->id, group->idLength)); };
+		ASSERT_NOERR(interactive_get_scenes(session, on_scene));
+		ASSERT_NOERR(interactive_scene_get_groups(session, "default", on_group));
+		ASSERT_NOERR(interactive_scene_get_controls(session, "default", on_control));
+		Assert::IsTrue(std::vector<std::string>({ "default", "Shop", "default", "Health:button", "Mana:button" }) == names);
+
+		// Typed columns and the other properties are both readable by name.
+		int cost = 0;
+		ASSERT_NOERR(interactive_control_get_property_int(session, "Health", "cost", &cost));
+		Assert::IsTrue(10 == cost);
+		char text[16];
+		size_t textLength = sizeof(text);
+		ASSERT_NOERR(interactive_control_get_property_string(session, "Mana", "cost", text, &textLength));
+		Assert::IsTrue(0 == strcmp("free", text));
+		textLength = sizeof(text);
+		ASSERT_NOERR(interactive_control_get_property_string(session, "Mana", "tooltip", text, &textLength));
+		Assert::IsTrue(0 == strcmp("Restore", text));
+		textLength = sizeof(text);
+		ASSERT_NOERR(interactive_control_get_meta_property_string(session, "Health", "color", text, &textLength));
+		Assert::IsTrue(0 == strcmp("red", text));
+
+		// Values keep the type they were sent with, whole number progress still reads back as an integer.
+		float progress = 0;
+		ASSERT_NOERR(interactive_control_get_property_float(session, "Mana", "progress", &progress));
+		Assert::IsTrue(0.5f == progress);
+		int wholeProgress = 0;
+		ASSERT_NOERR(interactive_control_get_property_int(session, "Buy", "progress", &wholeProgress));
+		Assert::IsTrue(1 == wholeProgress);
+		ASSERT_ERR(MIXER_ERROR_INVALID_PROPERTY_TYPE, interactive_control_get_property_int(session, "Mana", "progress", &wholeProgress));
+
+		size_t count = 0;
+		ASSERT_NOERR(interactive_control_get_property_count(session, "Health", &count));
+		Assert::IsTrue(5 == count);
+		interactive_property_type type = interactive_unknown_t;
+		size_t nameLength = 0;
+		ASSERT_ERR(MIXER_ERROR_BUFFER_SIZE, interactive_control_get_property_data(session, "Health", 4, nullptr, &nameLength, &type));
+		Assert::IsTrue(sizeof("meta") == nameLength);
+		ASSERT_NOERR(interactive_control_get_property_data(session, "Health", 4, text, &nameLength, &type));
+		Assert::IsTrue(0 == strcmp("meta", text) && interactive_object_t == type);
+		ASSERT_NOERR(interactive_control_get_meta_property_count(session, "Health", &count));
+		Assert::IsTrue(1 == count);
+		nameLength = sizeof(text);
+		ASSERT_NOERR(interactive_control_get_meta_property_data(session, "Health", 0, text, &nameLength, &type));
+		Assert::IsTrue(0 == strcmp("color", text) && interactive_string_t == type);
+
+		// Deleting a control moves another into its slot, handles and lookups follow it.
+		interactive_property_handle buyKind;
+		ASSERT_NOERR(interactive_control_get_property_handle(session, "Buy", "kind", &buyKind));
+		inject_message(session, "{\"type\":\"method\",\"id\":5,\"method\":\"onControlDelete\",\"params\":{\"sceneID\":\"default\",\"controls\":[{\"controlID\":\"Health\"}]},\"discard\":true}");
+		inject_message(session, "{\"type\":\"method\",\"id\":6,\"method\":\"onControlCreate\",\"params\":{\"sceneID\":\"Shop\",\"controls\":[{\"controlID\":\"Sell\",\"kind\":\"button\",\"cost\":5}]},\"discard\":true}");
+		ASSERT_NOERR(interactive_run(session, 2));
+		ASSERT_ERR(MIXER_ERROR_OBJECT_NOT_FOUND, interactive_control_get_property_int(session, "Health", "cost", &cost));
+		textLength = sizeof(text);
+		ASSERT_NOERR(interactive_property_get_string(session, buyKind, text, &textLength));
+		Assert::IsTrue(0 == strcmp("joystick", text));
+		ASSERT_NOERR(interactive_control_get_property_int(session, "Sell", "cost", &cost));
+		Assert::IsTrue(5 == cost);
+
+		names.clear();
+		ASSERT_NOERR(interactive_scene_get_controls(session, "Shop", on_control));
+		ASSERT_NOERR(interactive_scene_get_controls(session, "default", on_control));
+		Assert::IsTrue(std::vector<std::string>({ "Buy:joystick", "Sell:button", "Mana:button" }) == names);
+
+		// A getScenes reply replaces the scenes and the control store together.
+		sessionInternal->scenesCached = true;
+		ASSERT_NOERR(mixer_internal::cache_scenes(*sessionInternal));
+		rapidjson::Document request;
+		Assert::IsFalse(request.Parse(pop_outgoing_packet(sessionInternal).c_str()).HasParseError());
+		inject_message(session, "{\"type\":\"reply\",\"id\":" + std::to_string(request[RPC_ID].GetUint()) + ",\"error\":null,\"result\":{\"scenes\":[{\"sceneID\":\"default\",\"controls\":[{\"controlID\":\"Shield\",\"kind\":\"button\"}]}]}}");
+		ASSERT_NOERR(interactive_run(session, 1));
+		names.clear();
+		ASSERT_NOERR(interactive_get_scenes(session, on_scene));
+		ASSERT_NOERR(interactive_scene_get_controls(session, "default", on_control));
+		Assert::IsTrue(std::vector<std::string>({ "default", "Shield:button" }) == names);
+		ASSERT_ERR(MIXER_ERROR_OBJECT_NOT_FOUND, interactive_control_get_property_int(session, "Sell", "cost", &cost));
+		textLength = sizeof(text);
+		ASSERT_ERR(MIXER_ERROR_OBJECT_NOT_FOUND, interactive_property_get_string(session, buyKind, text, &textLength));
+
+		sessionInternal->state = interactive_disconnected;
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(ControlIndexStressTest)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(seed_scenes(session, "{\"scenes\":[{\"sceneID\":\"default\",\"controls\":[]}]}"));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+		sessionInternal->state = interactive_connected;
+
+		const int controlCount = 10000;
+		auto control_id = [](int i) { return "control" + std::to_string(i); };
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < controlCount; ++i)
+		{
+			inject_message(session, "{\"type\":\"method\",\"id\":" + std::to_string(i) + ",\"method\":\"onControlCreate\",\"params\":{\"sceneID\":\"default\",\"controls\":[{\"controlID\":\"" + control_id(i) + "\",\"kind\":\"button\",\"cost\":" + std::to_string(i) + "}]},\"discard\":true}");
+			ASSERT_NOERR(interactive_run(session, 1));
+		}
+		std::chrono::duration<double> createTime = std::chrono::steady_clock::now() - start;
+
+		interactive_property_handle lastCost;
+		ASSERT_NOERR(interactive_control_get_property_handle(session, control_id(controlCount - 1).c_str(), "cost", &lastCost));
+
+		// Delete every even control, front to back, so most deletions move another control.
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < controlCount; i += 2)
+		{
+			inject_message(session, "{\"type\":\"method\",\"id\":" + std::to_string(i) + ",\"method\":\"onControlDelete\",\"params\":{\"sceneID\":\"default\",\"controls\":[{\"controlID\":\"" + control_id(i) + "\"}]},\"discard\":true}");
+			ASSERT_NOERR(interactive_run(session, 1));
+		}
+		std::chrono::duration<double> deleteTime = std::chrono::steady_clock::now() - start;
+
+		for (int i = 0; i < controlCount; ++i)
+		{
+			int cost = -1;
+			int err = interactive_control_get_property_int(session, control_id(i).c_str(), "cost", &cost);
+			if (0 == i % 2)
+			{
+				ASSERT_ERR(MIXER_ERROR_OBJECT_NOT_FOUND, err);
+			}
+			else
+			{
+				ASSERT_NOERR(err);
+				Assert::IsTrue(i == cost);
+				const mixer_internal::interactive_control_store& controls = sessionInternal->controls;
+				size_t slot = controls.find(control_id(i));
+				Assert::IsTrue(0 == controls.sceneIds[controls.sceneIndices[slot]].compare("default"));
+				Assert::IsTrue(slot == controls.sceneSlots[controls.sceneIndices[slot]][controls.sceneOffsets[slot]]);
+			}
+		}
+
+		int cost = 0;
+		ASSERT_NOERR(interactive_property_get_int(session, lastCost, &cost));
+		Assert::IsTrue(controlCount - 1 == cost);
+
+		static int enumerated = 0;
+		ASSERT_NOERR(interactive_scene_get_controls(session, "default", [](void*, interactive_session, const interactive_control* control) { Assert::IsTrue(0 == strncmp("control", control->id, 7)); ++enumerated; }));
+		Assert::IsTrue(controlCount / 2 == enumerated);
+
+		std::stringstream s;
+		s << controlCount << " creates: " << 1000000 * createTime.count() / controlCount << "us each, " << controlCount / 2 << " deletes: " << 1000000 * deleteTime.count() / (controlCount / 2) << "us each.";
+		Logger::WriteMessage(s.str().c_str());
+
+		sessionInternal->state = interactive_disconnected;
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(ParticipantTableBenchmark)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+		sessionInternal->state = interactive_connected;
+
+		auto participant_json = [](int i)
+		{
+			return "{\"sessionID\":\"" + std::to_string(i) + "-7a3c2f10-5b8e-4d6a-9c1f-2e4b6d8f0a1c\",\"userID\":" + std::to_string(i) + ",\"username\":\"viewer" + std::to_string(i) + "\",\"level\":" + std::to_string(i % 100) + ",\"lastInputAt\":1500000000000,\"connectedAt\":" + std::to_string(1500000000000LL + i) + ",\"disabled\":" + (i % 10 ? "false" : "true") + ",\"groupID\":\"" + (i % 4 ? "default" : "red") + "\"}";
+		};
+
+		// Join 100k participants, 100 per message like the service does.
+		const int participantCount = 100000;
+		const int blockSize = 100;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < participantCount; i += blockSize)
+		{
+			std::string message = "{\"type\":\"method\",\"id\":" + std::to_string(i) + ",\"method\":\"onParticipantJoin\",\"params\":{\"participants\":[";
+			for (int j = i; j < i + blockSize; ++j)
+			{
+				message += (j == i ? "" : ",") + participant_json(j);
+			}
+			message += "]},\"discard\":true}";
+			inject_message(session, message);
+			ASSERT_NOERR(interactive_run(session, 1));
+		}
+		std::chrono::duration<double> joinTime = std::chrono::steady_clock::now() - start;
+		Assert::IsTrue(participantCount == sessionInternal->participants.read()->size());
+		size_t tableBytes = sessionInternal->participants.read()->memory_usage();
+
+		// Spot check the getters.
+		std::string participantId = std::to_string(12340) + "-7a3c2f10-5b8e-4d6a-9c1f-2e4b6d8f0a1c";
+		unsigned int userId = 0, level = 0;
+		bool isDisabled = false;
+		char buffer[64];
+		size_t bufferLength = sizeof(buffer);
+		ASSERT_NOERR(interactive_participant_get_user_id(session, participantId.c_str(), &userId));
+		ASSERT_NOERR(interactive_participant_get_level(session, participantId.c_str(), &level));
+		ASSERT_NOERR(interactive_participant_is_disabled(session, participantId.c_str(), &isDisabled));
+		Assert::IsTrue(12340 == userId && 40 == level && isDisabled);
+		ASSERT_NOERR(interactive_participant_get_user_name(session, participantId.c_str(), buffer, &bufferLength));
+		Assert::IsTrue(0 == strcmp("viewer12340", buffer));
+		bufferLength = sizeof(buffer);
+		ASSERT_NOERR(interactive_participant_get_group(session, participantId.c_str(), buffer, &bufferLength));
+		Assert::IsTrue(0 == strcmp("red", buffer));
+
+		// Every other participant leaves, the rest move group.
+		for (int i = 0; i < participantCount; i += blockSize)
+		{
+			std::string leave = "{\"type\":\"method\",\"id\":1,\"method\":\"onParticipantLeave\",\"params\":{\"participants\":[";
+			std::string update = "{\"type\":\"method\",\"id\":2,\"method\":\"onParticipantUpdate\",\"params\":{\"participants\":[";
+			for (int j = i; j < i + blockSize; j += 2)
+			{
+				leave += (j == i ? "" : ",") + participant_json(j);
+				std::string moved = participant_json(j + 1);
+				moved.replace(moved.rfind(":\"") + 2, std::string::npos, "blue\"}");
+				update += (j == i ? "" : ",") + moved;
+			}
+			inject_message(session, leave + "]},\"discard\":true}");
+			inject_message(session, update + "]},\"discard\":true}");
+			ASSERT_NOERR(interactive_run(session, 2));
+		}
+		Assert::IsTrue(participantCount / 2 == sessionInternal->participants.read()->size());
+		ASSERT_ERR(MIXER_ERROR_OBJECT_NOT_FOUND, interactive_participant_get_user_id(session, participantId.c_str(), &userId));
+		participantId = std::to_string(12341) + "-7a3c2f10-5b8e-4d6a-9c1f-2e4b6d8f0a1c";
+		bufferLength = sizeof(buffer);
+		ASSERT_NOERR(interactive_participant_get_group(session, participantId.c_str(), buffer, &bufferLength));
+		Assert::IsTrue(0 == strcmp("blue", buffer));
+		static int enumerated = 0;
+		ASSERT_NOERR(interactive_get_participants(session, [](void*, interactive_session, const interactive_participant* participant) { Assert::IsTrue(0 == strncmp("blue", participant->groupId, participant->groupIdLength)); ++enumerated; }));
+		Assert::IsTrue(participantCount / 2 == enumerated);
+
+		// For comparison, the bytes held by one participant copied into its own document.
+		rapidjson::Document participantJson;
+		participantJson.Parse(participant_json(0).c_str());
+		rapidjson::Document participantDoc;
+		participantDoc.CopyFrom(participantJson, participantDoc.GetAllocator());
+
+		std::stringstream s;
+		s << participantCount << " joins: " << joinTime.count() << "s, table " << tableBytes / participantCount << " bytes per participant, "
+			<< sessionInternal->participants.read()->memory_usage() / sessionInternal->participants.read()->size() << " after churn. A document per participant holds "
+			<< sizeof(rapidjson::Document) + participantDoc.GetAllocator().Capacity() << " bytes.";
+		Logger::WriteMessage(s.str().c_str());
+
+		sessionInternal->state = interactive_disconnected;
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(ParticipantReadersTest)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+		sessionInternal->state = interactive_connected;
+
+		auto participant_json = [](int i, const char* group)
+		{
+			return "{\"sessionID\":\"session" + std::to_string(i) + "\",\"userID\":" + std::to_string(i) + ",\"username\":\"viewer" + std::to_string(i) + "\",\"level\":1,\"lastInputAt\":0,\"connectedAt\":0,\"disabled\":false,\"groupID\":\"" + group + "\"}";
+		};
+
+		// Readers query and enumerate participants while the dispatch thread changes them.
+		const int participantCount = 20000;
+		std::atomic<bool> done(false);
+		std::atomic<int> failures(0);
+		std::atomic<long long> reads(0);
+		std::vector<std::thread> readers;
+
+		// The enumeration callback reports failures through the session context.
+		sessionInternal->callerContext = &failures;
+		for (int r = 0; r < 3; ++r)
+		{
+			readers.emplace_back([&, r]()
+			{
+				int i = r;
+				while (!done)
+				{
+					i = (i * 7919 + 1) % participantCount;
+					std::string participantId = "session" + std::to_string(i);
+					unsigned int userId = 0;
+					char userName[32];
+					size_t userNameLength = sizeof(userName);
+					if (MIXER_OK == interactive_participant_get_user_id(session, participantId.c_str(), &userId))
+					{
+						if (userId != (unsigned int)i)
+						{
+							++failures;
+						}
+					}
+					int err = interactive_participant_get_user_name(session, participantId.c_str(), userName, &userNameLength);
+					if (MIXER_OK == err && 0 != ("viewer" + std::to_string(i)).compare(userName))
+					{
+						++failures;
+					}
+					else if (MIXER_OK != err && MIXER_ERROR_OBJECT_NOT_FOUND != err)
+					{
+						++failures;
+					}
+					++reads;
+
+					if (0 == i % 64)
+					{
+						interactive_get_participants(session, [](void* context, interactive_session, const interactive_participant* participant)
+						{
+							std::string expected = "viewer" + std::to_string(participant->userId);
+							if (0 != expected.compare(0, std::string::npos, participant->userName, participant->usernameLength))
+							{
+								++*reinterpret_cast<std::atomic<int>*>(context);
+							}
+						});
+					}
+				}
+			});
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		for (int round = 0; round < 4; ++round)
+		{
+			for (int i = 0; i < participantCount; i += 100)
+			{
+				std::string join = "{\"type\":\"method\",\"id\":1,\"method\":\"onParticipantJoin\",\"params\":{\"participants\":[";
+				for (int j = i; j < i + 100; ++j)
+				{
+					join += (j == i ? "" : ",") + participant_json(j, "default");
+				}
+				inject_message(session, join + "]},\"discard\":true}");
+				ASSERT_NOERR(interactive_run(session, 1));
+			}
+
+			for (int i = 0; i < participantCount; i += 100)
+			{
+				std::string leave = "{\"type\":\"method\",\"id\":2,\"method\":\"onParticipantLeave\",\"params\":{\"participants\":[";
+				std::string update = "{\"type\":\"method\",\"id\":3,\"method\":\"onParticipantUpdate\",\"params\":{\"participants\":[";
+				for (int j = i; j < i + 100; j += 2)
+				{
+					leave += (j == i ? "" : ",") + participant_json(j, "default");
+					update += (j == i ? "" : ",") + participant_json(j + 1, "blue");
+				}
+				inject_message(session, leave + "]},\"discard\":true}");
+				inject_message(session, update + "]},\"discard\":true}");
+				ASSERT_NOERR(interactive_run(session, 2));
+			}
+		}
+		std::chrono::duration<double> writeTime = std::chrono::steady_clock::now() - start;
+
+		done = true;
+		for (std::thread& reader : readers)
+		{
+			reader.join();
+		}
+
+		Assert::IsTrue(0 == failures);
+		Assert::IsTrue(participantCount / 2 == sessionInternal->participants.read()->size());
+		std::stringstream s;
+		s << "Dispatch applied " << 4 * participantCount * 2 << " participant changes in " << writeTime.count() << "s while 3 readers made " << reads << " lookups.";
+		Logger::WriteMessage(s.str().c_str());
+
+		sessionInternal->callerContext = nullptr;
+		sessionInternal->state = interactive_disconnected;
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(ParticipantSyncTest)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+		sessionInternal->state = interactive_connected;
+
+		// A simulated service holding 100k participants, three connecting each millisecond.
+		const int participantCount = 100000;
+		const unsigned long long firstConnectedAt = 1500000000000ULL;
+		auto connected_at = [&](int i) { return firstConnectedAt + i / 3; };
+		auto participant_json = [&](int i, const char* group)
+		{
+			return "{\"sessionID\":\"session" + std::to_string(i) + "\",\"userID\":" + std::to_string(i) + ",\"username\":\"viewer" + std::to_string(i) + "\",\"level\":1,\"lastInputAt\":0,\"connectedAt\":" + std::to_string(connected_at(i)) + ",\"disabled\":false,\"groupID\":\"" + group + "\"}";
+		};
+
+		long long steadyNowMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		sessionInternal->serverTimeOffsetMs = steadyNowMs - (long long)(connected_at(participantCount) + 1000);
+
+		auto start = std::chrono::steady_clock::now();
+		ASSERT_NOERR(mixer_internal::sync_participants(*sessionInternal));
+
+		// Changes arriving during the sync are newer than the synced pages.
+		inject_message(session, "{\"type\":\"method\",\"id\":1,\"method\":\"onParticipantLeave\",\"params\":{\"participants\":[" + participant_json(90000, "default") + "]},\"discard\":true}");
+		inject_message(session, "{\"type\":\"method\",\"id\":2,\"method\":\"onParticipantUpdate\",\"params\":{\"participants\":[" + participant_json(90001, "live") + "]},\"discard\":true}");
+		ASSERT_NOERR(interactive_run(session, 2));
+
+		// Answer every request in flight each round trip.
+		int roundTrips = 0;
+		int pages = 0;
+		while (!sessionInternal->outgoingEvents.empty())
+		{
+			++roundTrips;
+			std::queue<std::shared_ptr<mixer_internal::interactive_event_internal>> inFlight;
+			inFlight.swap(sessionInternal->outgoingEvents);
+			while (!inFlight.empty())
+			{
+				auto ev = inFlight.front();
+				inFlight.pop();
+				rapidjson::Document request;
+				request.Parse(std::static_pointer_cast<mixer_internal::rpc_method_event>(ev)->packet.c_str());
+				Assert::IsTrue(0 == strcmp(RPC_GET_PARTICIPANTS, request[RPC_METHOD].GetString()));
+				unsigned long long from = request[RPC_PARAMS][RPC_PARAM_FROM].GetUint64();
+				int i = from <= firstConnectedAt ? 0 : (int)(std::min)((from - firstConnectedAt) * 3, (unsigned long long)participantCount);
+
+				std::string reply = "{\"type\":\"reply\",\"id\":" + std::to_string(request[RPC_ID].GetUint()) + ",\"error\":null,\"result\":{\"participants\":[";
+				int end = (std::min)(i + RPC_GET_PARTICIPANTS_BLOCK_SIZE, participantCount);
+				for (int j = i; j < end; ++j)
+				{
+					reply += (j == i ? "" : ",") + participant_json(j, "default");
+				}
+				reply += "],\"total\":" + std::to_string(participantCount) + ",\"hasMore\":" + (end < participantCount ? "true" : "false") + "}}";
+				inject_message(session, reply);
+				++pages;
+			}
+		}
+		std::chrono::duration<double> syncTime = std::chrono::steady_clock::now() - start;
+
+		Assert::IsTrue(participantCount - 1 == sessionInternal->participants.read()->size());
+		unsigned int userId = 0;
+		ASSERT_ERR(MIXER_ERROR_OBJECT_NOT_FOUND, interactive_participant_get_user_id(session, "session90000", &userId));
+		ASSERT_NOERR(interactive_participant_get_user_id(session, "session99999", &userId));
+		Assert::IsTrue(99999 == userId);
+		char group[16];
+		size_t groupLength = sizeof(group);
+		ASSERT_NOERR(interactive_participant_get_group(session, "session90001", group, &groupLength));
+		Assert::IsTrue(0 == strcmp("live", group));
+		Assert::IsTrue(0 == sessionInternal->participantSyncWalkers);
+		size_t groupCount = 0;
+		ASSERT_NOERR(interactive_group_get_participant_count(session, "default", &groupCount));
+		Assert::IsTrue(participantCount - 2 == groupCount);
+
+		// A page that shares one timestamp is asked for again while it brings new participants.
+		ASSERT_NOERR(mixer_internal::sync_participants(*sessionInternal));
+		const unsigned long long sharedAt = connected_at(participantCount) + 1;
+		auto shared_page = [&](int first)
+		{
+			std::string page;
+			for (int j = first; j < first + RPC_GET_PARTICIPANTS_BLOCK_SIZE; ++j)
+			{
+				page += std::string(j == first ? "" : ",") + "{\"sessionID\":\"shared" + std::to_string(j) + "\",\"userID\":" + std::to_string(j) + ",\"username\":\"shared" + std::to_string(j) + "\",\"level\":1,\"lastInputAt\":0,\"connectedAt\":" + std::to_string(sharedAt) + ",\"disabled\":false,\"groupID\":\"default\"}";
+			}
+			return page;
+		};
+		std::pair<unsigned long long, std::string> exchanges[] = { { 0, shared_page(0) }, { sharedAt, shared_page(RPC_GET_PARTICIPANTS_BLOCK_SIZE) }, { sharedAt, shared_page(RPC_GET_PARTICIPANTS_BLOCK_SIZE) }, { sharedAt + 1, "" } };
+		for (auto& exchange : exchanges)
+		{
+			// Readers keep the previous participants until the sync completes.
+			Assert::IsTrue(participantCount - 1 == sessionInternal->participants.read()->size());
+			ASSERT_NOERR(interactive_group_get_participant_count(session, "default", &groupCount));
+			Assert::IsTrue(participantCount - 2 == groupCount);
+			Assert::IsTrue(1 == sessionInternal->outgoingEvents.size());
+			rapidjson::Document request;
+			request.Parse(pop_outgoing_packet(sessionInternal).c_str());
+			Assert::IsTrue(exchange.first == request[RPC_PARAMS][RPC_PARAM_FROM].GetUint64());
+			inject_message(session, "{\"type\":\"reply\",\"id\":" + std::to_string(request[RPC_ID].GetUint()) + ",\"error\":null,\"result\":{\"participants\":[" + exchange.second + "],\"hasMore\":" + (exchange.second.empty() ? "false" : "true") + "}}");
+		}
+		ASSERT_NOERR(interactive_participant_get_user_id(session, "shared199", &userId));
+		Assert::IsTrue(2 * RPC_GET_PARTICIPANTS_BLOCK_SIZE == sessionInternal->participants.read()->size());
+		ASSERT_NOERR(interactive_group_get_participant_count(session, "default", &groupCount));
+		Assert::IsTrue(2 * RPC_GET_PARTICIPANTS_BLOCK_SIZE == groupCount);
+		Assert::IsTrue(sessionInternal->outgoingEvents.empty());
+		Assert::IsTrue(0 == sessionInternal->participantSyncWalkers);
+
+		std::stringstream s;
+		s << "Synced " << participantCount << " participants from " << pages << " pages in " << roundTrips << " round trips, " << syncTime.count() << "s.";
+		Logger::WriteMessage(s.str().c_str());
+
+		sessionInternal->state = interactive_disconnected;
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(ActiveParticipantsTest)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+		sessionInternal->state = interactive_connected;
+
+		const int participantCount = 20000;
+		const unsigned long long base = 1500000000000ULL;
+		auto participant_json = [&](int i)
+		{
+			unsigned long long lastInputAt = i < 100 ? base + i : 0;
+			return "{\"sessionID\":\"session" + std::to_string(i) + "\",\"userID\":" + std::to_string(i) + ",\"username\":\"viewer" + std::to_string(i) + "\",\"level\":1,\"lastInputAt\":" + std::to_string(lastInputAt) + ",\"connectedAt\":0,\"disabled\":false,\"groupID\":\"default\"}";
+		};
+
+		for (int i = 0; i < participantCount; i += 100)
+		{
+			std::string join = "{\"type\":\"method\",\"id\":1,\"method\":\"onParticipantJoin\",\"params\":{\"participants\":[";
+			for (int j = i; j < i + 100; ++j)
+			{
+				join += (j == i ? "" : ",") + participant_json(j);
+			}
+			inject_message(session, join + "]},\"discard\":true}");
+			ASSERT_NOERR(interactive_run(session, 1));
+		}
+
+		// Fifty participants give input now, long after the first hundred last did.
+		long long steadyNowMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		sessionInternal->serverTimeOffsetMs = steadyNowMs - (long long)(base + 1000000);
+		for (int i = 100; i < 150; ++i)
+		{
+			inject_message(session, "{\"type\":\"method\",\"id\":2,\"method\":\"giveInput\",\"params\":{\"input\":{\"controlID\":\"GiveHealth\",\"event\":\"mousedown\",\"button\":0},"
+				"\"participantID\":\"session" + std::to_string(i) + "\"},\"discard\":true}");
+		}
+		ASSERT_NOERR(interactive_run(session, 50));
+
+		static std::vector<interactive_participant> active;
+		auto collect = [](void* context, interactive_session session, const interactive_participant* participant)
+		{
+			active.push_back(*participant);
+		};
+
+		ASSERT_NOERR(interactive_get_active_participants(session, base + 500000, collect));
+		Assert::IsTrue(50 == active.size());
+		for (size_t i = 1; i < active.size(); ++i)
+		{
+			Assert::IsTrue(active[i - 1].lastInputAtMs >= active[i].lastInputAtMs);
+			Assert::IsTrue(active[i].userId >= 100 && active[i].userId < 150);
+		}
+
+		unsigned long long lastInputAt = 0;
+		ASSERT_NOERR(interactive_participant_get_last_input_at(session, "session120", &lastInputAt));
+		Assert::IsTrue(lastInputAt >= base + 1000000);
+
+		active.clear();
+		ASSERT_NOERR(interactive_get_active_participants(session, base, collect));
+		Assert::IsTrue(150 == active.size());
+		Assert::IsTrue(base == active.back().lastInputAtMs);
+
+		// Participants that leave are no longer active.
+		inject_message(session, "{\"type\":\"method\",\"id\":3,\"method\":\"onParticipantLeave\",\"params\":{\"participants\":[" + participant_json(120) + "]},\"discard\":true}");
+		ASSERT_NOERR(interactive_run(session, 1));
+		active.clear();
+		ASSERT_NOERR(interactive_get_active_participants(session, base + 500000, collect));
+		Assert::IsTrue(49 == active.size());
+
+		// The service's active participants are merged into the index.
+		ASSERT_NOERR(interactive_refresh_active_participants(session, base + 500000));
+		Assert::IsTrue(1 == sessionInternal->outgoingEvents.size());
+		rapidjson::Document request;
+		request.Parse(reinterpret_cast<std::shared_ptr<mixer_internal::rpc_method_event>&>(sessionInternal->outgoingEvents.front())->packet.c_str());
+		sessionInternal->outgoingEvents.pop();
+		Assert::IsTrue(0 == strcmp(RPC_METHOD_PARTICIPANTS_ACTIVE, request[RPC_METHOD].GetString()));
+		Assert::IsTrue(base + 500000 == request[RPC_PARAMS][RPC_PARAM_PARTICIPANTS_ACTIVE_THRESHOLD].GetUint64());
+		inject_message(session, "{\"type\":\"reply\",\"id\":" + std::to_string(request[RPC_ID].GetUint()) + ",\"error\":null,\"result\":{\"participants\":["
+			"{\"sessionID\":\"session5\",\"userID\":5,\"username\":\"viewer5\",\"level\":1,\"lastInputAt\":" + std::to_string(base + 900000) + ",\"connectedAt\":0,\"disabled\":false,\"groupID\":\"default\"}]}}");
+		active.clear();
+		ASSERT_NOERR(interactive_get_active_participants(session, base + 500000, collect));
+		Assert::IsTrue(50 == active.size());
+		Assert::IsTrue(5 == active.back().userId);
+
+		// Compare against scanning every participant each query.
+		const int queries = 100;
+		auto start = std::chrono::steady_clock::now();
+		for (int q = 0; q < queries; ++q)
+		{
+			active.clear();
+			ASSERT_NOERR(interactive_get_active_participants(session, base + 500000, collect));
+		}
+		std::chrono::duration<double> indexTime = std::chrono::steady_clock::now() - start;
+
+		start = std::chrono::steady_clock::now();
+		for (int q = 0; q < queries; ++q)
+		{
+			active.clear();
+			ASSERT_NOERR(interactive_get_participants(session, [](void* context, interactive_session session, const interactive_participant* participant)
+			{
+				if (participant->lastInputAtMs >= 1500000500000ULL)
+				{
+					active.push_back(*participant);
+				}
+			}));
+		}
+		std::chrono::duration<double> scanTime = std::chrono::steady_clock::now() - start;
+
+		std::stringstream s;
+		s << "Found 50 of " << participantCount << " participants active in " << indexTime.count() * 1000000 / queries << "us from the index, " << scanTime.count() * 1000000 / queries << "us by scanning.";
+		Logger::WriteMessage(s.str().c_str());
+
+		active.clear();
+		sessionInternal->state = interactive_disconnected;
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(GroupMembershipTest)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+		sessionInternal->state = interactive_connected;
+
+		const int participantCount = 30000;
+		const char* groups[] = { "default", "red", "blue" };
+		auto participant_json = [](int i, const char* group)
+		{
+			return "{\"sessionID\":\"session" + std::to_string(i) + "\",\"userID\":" + std::to_string(i) + ",\"username\":\"viewer" + std::to_string(i) + "\",\"level\":1,\"lastInputAt\":0,\"connectedAt\":0,\"disabled\":false,\"groupID\":\"" + group + "\"}";
+		};
+
+		for (int i = 0; i < participantCount; i += 100)
+		{
+			std::string join = "{\"type\":\"method\",\"id\":1,\"method\":\"onParticipantJoin\",\"params\":{\"participants\":[";
+			for (int j = i; j < i + 100; ++j)
+			{
+				join += (j == i ? "" : ",") + participant_json(j, groups[j % 3]);
+			}
+			inject_message(session, join + "]},\"discard\":true}");
+			ASSERT_NOERR(interactive_run(session, 1));
+		}
+
+		size_t count = 0;
+		for (const char* group : groups)
+		{
+			ASSERT_NOERR(interactive_group_get_participant_count(session, group, &count));
+			Assert::IsTrue(participantCount / 3 == count);
+		}
+		ASSERT_NOERR(interactive_group_get_participant_count(session, "green", &count));
+		Assert::IsTrue(0 == count);
+
+		// Leaves and updates move participants between the lists.
+		inject_message(session, "{\"type\":\"method\",\"id\":2,\"method\":\"onParticipantLeave\",\"params\":{\"participants\":[" + participant_json(1, "red") + "]},\"discard\":true}");
+		inject_message(session, "{\"type\":\"method\",\"id\":3,\"method\":\"onParticipantUpdate\",\"params\":{\"participants\":[" + participant_json(2, "green") + "," + participant_json(4, "green") + "]},\"discard\":true}");
+		ASSERT_NOERR(interactive_run(session, 2));
+		ASSERT_NOERR(interactive_group_get_participant_count(session, "red", &count));
+		Assert::IsTrue(participantCount / 3 - 2 == count);
+		ASSERT_NOERR(interactive_group_get_participant_count(session, "blue", &count));
+		Assert::IsTrue(participantCount / 3 - 1 == count);
+		ASSERT_NOERR(interactive_group_get_participant_count(session, "green", &count));
+		Assert::IsTrue(2 == count);
+
+		static std::vector<std::string> members;
+		auto collect = [](void* context, interactive_session session, const interactive_participant* participant)
+		{
+			members.emplace_back(participant->groupId, participant->groupIdLength);
+		};
+		ASSERT_NOERR(interactive_group_get_participants(session, "green", collect));
+		Assert::IsTrue(2 == members.size() && "green" == members[0] && "green" == members[1]);
+
+		// A group change is applied once the service acknowledges it.
+		ASSERT_NOERR(interactive_participant_set_group(session, "session0", "green"));
+		rapidjson::Document request;
+		request.Parse(reinterpret_cast<std::shared_ptr<mixer_internal::rpc_method_event>&>(sessionInternal->outgoingEvents.front())->packet.c_str());
+		sessionInternal->outgoingEvents.pop();
+		ASSERT_NOERR(interactive_group_get_participant_count(session, "green", &count));
+		Assert::IsTrue(2 == count);
+		inject_message(session, "{\"type\":\"reply\",\"id\":" + std::to_string(request[RPC_ID].GetUint()) + ",\"error\":null,\"result\":{}}");
+		ASSERT_NOERR(interactive_group_get_participant_count(session, "green", &count));
+		Assert::IsTrue(3 == count);
+		char group[16];
+		size_t groupLength = sizeof(group);
+		ASSERT_NOERR(interactive_participant_get_group(session, "session0", group, &groupLength));
+		Assert::IsTrue(0 == strcmp("green", group));
+
+		// Compare enumerating one group against scanning everyone for it.
+		const int queries = 100;
+		auto start = std::chrono::steady_clock::now();
+		for (int q = 0; q < queries; ++q)
+		{
+			members.clear();
+			ASSERT_NOERR(interactive_group_get_participants(session, "green", collect));
+		}
+		std::chrono::duration<double> indexTime = std::chrono::steady_clock::now() - start;
+		Assert::IsTrue(3 == members.size());
+
+		start = std::chrono::steady_clock::now();
+		for (int q = 0; q < queries; ++q)
+		{
+			members.clear();
+			ASSERT_NOERR(interactive_get_participants(session, [](void* context, interactive_session session, const interactive_participant* participant)
+			{
+				if (0 == std::string("green").compare(0, std::string::npos, participant->groupId, participant->groupIdLength))
+				{
+					members.emplace_back(participant->groupId, participant->groupIdLength);
+				}
+			}));
+		}
+		std::chrono::duration<double> scanTime = std::chrono::steady_clock::now() - start;
+		Assert::IsTrue(3 == members.size());
+
+		std::stringstream s;
+		s << "Enumerated a group of 3 among " << participantCount << " participants in " << indexTime.count() * 1000000 / queries << "us, " << scanTime.count() * 1000000 / queries << "us by scanning.";
+		Logger::WriteMessage(s.str().c_str());
+
+		members.clear();
+		sessionInternal->state = interactive_disconnected;
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(ParticipantsSetGroupBenchmark)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+		sessionInternal->state = interactive_connected;
+
+		const int participantCount = 20000;
+		std::vector<std::string> ids;
+		for (int i = 0; i < participantCount; i += 100)
+		{
+			std::string join = "{\"type\":\"method\",\"id\":1,\"method\":\"onParticipantJoin\",\"params\":{\"participants\":[";
+			for (int j = i; j < i + 100; ++j)
+			{
+				ids.push_back("7d1e2a3b-0000-4000-8000-" + std::to_string(100000000000ULL + j));
+				join += (j == i ? "" : ",") + std::string("{\"sessionID\":\"") + ids.back() + "\",\"userID\":" + std::to_string(j) + ",\"username\":\"viewer\",\"level\":1,\"lastInputAt\":0,\"connectedAt\":0,\"disabled\":false,\"groupID\":\"default\"}";
+			}
+			inject_message(session, join + "]},\"discard\":true}");
+			ASSERT_NOERR(interactive_run(session, 1));
+		}
+
+		auto drain = [&](std::vector<std::string>& packets)
+		{
+			while (!sessionInternal->outgoingEvents.empty())
+			{
+				packets.push_back(pop_outgoing_packet(sessionInternal));
+			}
+		};
+		auto total_bytes = [](const std::vector<std::string>& packets)
+		{
+			size_t bytes = 0;
+			for (auto& packet : packets)
+			{
+				bytes += packet.length();
+			}
+			return bytes;
+		};
+
+		std::vector<std::string> singlePackets;
+		for (auto& id : ids)
+		{
+			ASSERT_NOERR(interactive_participant_set_group(session, id.c_str(), "stage"));
+		}
+		drain(singlePackets);
+		sessionInternal->replyHandlersById.clear();
+
+		static int completions = 0;
+		static std::vector<std::string> failed;
+		auto on_complete = [](void* context, interactive_session session, const char* groupId, const char** failedParticipantIds, size_t failedCount)
+		{
+			++completions;
+			failed.assign(failedParticipantIds, failedParticipantIds + failedCount);
+		};
+
+		std::vector<const char*> idPointers;
+		for (auto& id : ids)
+		{
+			idPointers.push_back(id.c_str());
+		}
+
+		std::vector<std::string> batchPackets;
+		ASSERT_NOERR(interactive_participants_set_group(session, idPointers.data(), idPointers.size(), "stage", on_complete));
+		drain(batchPackets);
+		Assert::IsTrue(batchPackets.size() > 1);
+
+		// Reply to every message, the service does not move three participants that have left.
+		size_t moved = 0;
+		for (auto& packet : batchPackets)
+		{
+			Assert::IsTrue(packet.length() <= RPC_PARTICIPANTS_BATCH_BYTES);
+			rapidjson::Document request;
+			request.Parse(packet.c_str());
+			std::string reply = "{\"type\":\"reply\",\"id\":" + std::to_string(request[RPC_ID].GetUint()) + ",\"error\":null,\"result\":{\"participants\":[";
+			bool first = true;
+			for (auto& participant : request[RPC_PARAMS][RPC_PARAM_PARTICIPANTS].GetArray())
+			{
+				std::string id = participant[RPC_SESSION_ID].GetString();
+				if (id == ids[5] || id == ids[6] || id == ids[7])
+				{
+					continue;
+				}
+				reply += (first ? "" : ",") + std::string("{\"sessionID\":\"") + id + "\",\"groupID\":\"stage\"}";
+				first = false;
+				++moved;
+			}
+			inject_message(session, reply + "]}}");
+		}
+		Assert::IsTrue(0 == completions);
+		ASSERT_NOERR(interactive_run(session, (unsigned int)batchPackets.size()));
+		Assert::IsTrue(1 == completions);
+		Assert::IsTrue(3 == failed.size() && ids[5] == failed[0]);
+		size_t count = 0;
+		ASSERT_NOERR(interactive_group_get_participant_count(session, "stage", &count));
+		Assert::IsTrue(participantCount - 3 == count && moved == count);
+
+		// Ids and groups that need escaping still fit the limit.
+		const size_t smallBatchBytes = 1024;
+		ASSERT_NOERR(interactive_set_participants_batch_size(session, smallBatchBytes));
+		std::vector<std::string> escapedIds;
+		std::vector<const char*> escapedIdPointers;
+		for (int i = 0; i < 100; ++i)
+		{
+			escapedIds.push_back("\"quoted\\" + std::to_string(i) + "\n\x01\"");
+		}
+		for (auto& id : escapedIds)
+		{
+			escapedIdPointers.push_back(id.c_str());
+		}
+		std::vector<std::string> escapedPackets;
+		ASSERT_NOERR(interactive_participants_set_group(session, escapedIdPointers.data(), escapedIdPointers.size(), "\"stage\"", nullptr));
+		drain(escapedPackets);
+		sessionInternal->replyHandlersById.clear();
+		Assert::IsTrue(escapedPackets.size() > 1);
+		for (auto& packet : escapedPackets)
+		{
+			Assert::IsTrue(packet.length() <= smallBatchBytes);
+		}
+
+		// A message the service rejects fails all of its participants.
+		completions = 0;
+		ASSERT_NOERR(interactive_set_participants_batch_size(session, 1));
+		ASSERT_NOERR(interactive_participants_set_group(session, idPointers.data(), 2, "default", on_complete));
+		std::vector<std::string> smallPackets;
+		drain(smallPackets);
+		Assert::IsTrue(2 == smallPackets.size());
+		for (auto& packet : smallPackets)
+		{
+			rapidjson::Document request;
+			request.Parse(packet.c_str());
+			inject_message(session, "{\"type\":\"reply\",\"id\":" + std::to_string(request[RPC_ID].GetUint()) + ",\"error\":{\"code\":4000,\"message\":\"bad request\"},\"result\":null}");
+		}
+		ASSERT_NOERR(interactive_run(session, 2));
+		Assert::IsTrue(1 == completions && 2 == failed.size());
+
+		std::stringstream s;
+		s << "Moving " << participantCount << " participants sent " << singlePackets.size() << " frames, " << total_bytes(singlePackets) << " bytes one at a time and "
+			<< batchPackets.size() << " frames, " << total_bytes(batchPackets) << " bytes batched.";
+		Logger::WriteMessage(s.str().c_str());
+
+		failed.clear();
+		sessionInternal->state = interactive_disconnected;
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(EventQueueBenchmark)
+	{
+		using namespace mixer_internal;
+		typedef std::shared_ptr<interactive_event_internal> event_ptr;
+
+		// Three producers, as the websocket, outgoing and http threads, feed one consumer calling interactive_run.
+		const int producerCount = 3;
+		const int eventsPerProducer = 200000;
+		std::vector<std::vector<event_ptr>> produced(producerCount);
+		std::unordered_map<const interactive_event_internal*, std::pair<int, int>> origins;
+		for (int p = 0; p < producerCount; ++p)
+		{
+			for (int i = 0; i < eventsPerProducer; ++i)
+			{
+				event_ptr ev;
+				if (0 == i % 64)
+				{
+					ev = std::make_shared<error_event>(interactive_error(MIXER_ERROR_WS_CLOSED, std::string()));
+				}
+				else if (0 == i % 16)
+				{
+					ev = std::make_shared<state_change_event>(interactive_connected);
+				}
+				else
+				{
+					ev = std::make_shared<rpc_method_event>(std::string());
+				}
+				origins.emplace(ev.get(), std::make_pair(p, i));
+				produced[p].push_back(ev);
+			}
+		}
+
+		auto run = [&](std::function<void(event_ptr&&)> push, std::function<bool(event_ptr&)> pop, std::vector<const interactive_event_internal*>& consumed)
+		{
+			std::vector<std::vector<event_ptr>> events = produced;
+			std::vector<std::thread> producers;
+			auto start = std::chrono::steady_clock::now();
+			for (int p = 0; p < producerCount; ++p)
 			{
-				std::stringstream s;
-				s << "[Scene] '" << std::string(scene->id, scene->idLength) << "'";
-				Logger::WriteMessage(s.str().c_str());
-
-				Logger::WriteMessage("Groups:");
-				interactive_scene_get_groups(session, scene->id, [](void* context, interactive_session session, const interactive_group* group)
+				producers.emplace_back([&, p]()
 				{
-					std::stringstream s;
-					s << std::setw(10) << group->id;
-					Logger::WriteMessage(s.str().c_str());
+					for (event_ptr& ev : events[p])
+					{
+						push(std::move(ev));
+					}
 				});
+			}
 
-				Logger::WriteMessage("Controls:");
-				interactive_scene_get_controls(session, scene->id, [](void* context, interactive_session session, const interactive_control* control)
+			event_ptr ev;
+			while (consumed.size() < (size_t)producerCount * eventsPerProducer)
+			{
+				if (pop(ev))
 				{
-					print_control_properties(session, control->id);
-				});
-			}));
+					consumed.push_back(ev.get());
+					ev.reset();
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
 
-			g_runInteractive = false;
-		});
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			for (std::thread& producer : producers)
+			{
+				producer.join();
+			}
+			return elapsed.count();
+		};
 
-		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), true));
+		// The previous queue, a priority queue behind a mutex.
+		struct compare_event_priority
+		{
+			bool operator()(const event_ptr& left, const event_ptr& right) const
+			{
+				return left->type > right->type;
+			}
+		};
+		std::mutex lockedMutex;
+		std::priority_queue<event_ptr, std::vector<event_ptr>, compare_event_priority> locked;
+		std::vector<const interactive_event_internal*> lockedConsumed;
+		lockedConsumed.reserve(producerCount * eventsPerProducer);
+		double lockedTime = run([&](event_ptr&& ev)
+		{
+			std::lock_guard<std::mutex> lock(lockedMutex);
+			locked.emplace(std::move(ev));
+		}, [&](event_ptr& ev)
+		{
+			std::lock_guard<std::mutex> lock(lockedMutex);
+			if (locked.empty())
+			{
+				return false;
+			}
+			ev = locked.top();
+			locked.pop();
+			return true;
+		}, lockedConsumed);
+
+		interactive_event_queue rings;
+		std::vector<const interactive_event_internal*> ringConsumed;
+		ringConsumed.reserve(producerCount * eventsPerProducer);
+		double ringTime = run([&](event_ptr&& ev)
+		{
+			while (!rings.try_push(std::move(ev)))
+			{
+				std::this_thread::yield();
+			}
+		}, [&](event_ptr& ev)
+		{
+			return rings.try_pop(ev);
+		}, ringConsumed);
 
-		while (g_runInteractive)
+		// Events of one type from one producer are consumed in the order they were produced.
+		std::vector<std::vector<int>> last(producerCount, std::vector<int>(interactive_event_type_count, -1));
+		for (const interactive_event_internal* ev : ringConsumed)
+		{
+			const std::pair<int, int>& origin = origins[ev];
+			Assert::IsTrue(last[origin.first][ev->type] < origin.second);
+			last[origin.first][ev->type] = origin.second;
+		}
+
+		std::stringstream s;
+		s << std::fixed << std::setprecision(0) << producerCount << " producers, " << producerCount * eventsPerProducer << " events: "
+			<< producerCount * eventsPerProducer / lockedTime << " events/sec through the locked priority queue, "
+			<< producerCount * eventsPerProducer / ringTime << " events/sec through the rings.";
+		Logger::WriteMessage(s.str().c_str());
+	}
+
+	TEST_METHOD(IncomingBackpressureTest)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+
+		static std::atomic<int> errorsHandled(0);
+		errorsHandled = 0;
+		ASSERT_NOERR(interactive_set_error_handler(session, [](void*, interactive_session, int, const char*, size_t) { ++errorsHandled; }));
+
+		// A producer that outruns the title waits for room on the ring rather than spinning or dropping events.
+		const int eventCount = 1000;
+		std::atomic<int> queued(0);
+		std::thread producer([&]()
+		{
+			for (int i = 0; i < eventCount; ++i)
+			{
+				sessionInternal->enqueue_incoming_event(std::make_shared<mixer_internal::error_event>(mixer_internal::interactive_error(MIXER_ERROR_WS_CLOSED, std::string())));
+				++queued;
+			}
+		});
+
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		while (0 == sessionInternal->incomingSpaceWaiters && std::chrono::steady_clock::now() < deadline)
 		{
-			ASSERT_NOERR(interactive_run(session, 1));
 			std::this_thread::sleep_for(std::chrono::milliseconds(1));
 		}
+		Assert::IsTrue(1 == sessionInternal->incomingSpaceWaiters);
+		Assert::IsTrue(queued < eventCount);
+
+		while (errorsHandled < eventCount && std::chrono::steady_clock::now() < deadline)
+		{
+			ASSERT_NOERR(interactive_run(session, 100));
+		}
+		producer.join();
+		Assert::IsTrue(eventCount == errorsHandled);
+		Assert::IsTrue(0 == sessionInternal->incomingSpaceWaiters);
 
-		Logger::WriteMessage("Disconnecting...");
 		interactive_close_session(session);
 	}
 
-	TEST_METHOD(NotConnectedTest)
+	TEST_METHOD(PooledEventsTest)
 	{
-		g_start = std::chrono::high_resolution_clock::now();
-		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(seed_scenes(session, BENCHMARK_SCENES));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
 
-		std::string clientId = CLIENT_ID;
-		std::string versionId = VERSION_ID;
-		std::string shareCode = SHARE_CODE;
-		std::string auth;
+		static size_t inputCount = 0;
+		static size_t replyCount = 0;
+		ASSERT_NOERR(interactive_set_input_handler(session, [](void* context, interactive_session session, const interactive_input* input)
+		{
+			++inputCount;
+		}));
 
-		ASSERT_NOERR(do_auth(clientId, "", auth));
+		std::string input = "{\"type\":\"method\",\"id\":1234,\"method\":\"giveInput\",\"params\":{\"control\":{\"controlID\":\"GiveHealth\",\"kind\":\"button\"},"
+			"\"input\":{\"controlID\":\"GiveHealth\",\"event\":\"mousedown\",\"button\":0},\"participantID\":\"0d3b9a2c-7f55-4d45-9a52-61f8d6a5c1e0\"},\"discard\":true}";
+		auto run_batch = [&]()
+		{
+			// A reply with a handler, then a batch of input.
+			ASSERT_NOERR(mixer_internal::queue_method(*sessionInternal, RPC_METHOD_GET_TIME, nullptr, [](mixer_internal::interactive_session_internal& session, rapidjson::Document& reply)
+			{
+				++replyCount;
+				return (int)MIXER_OK;
+			}));
+			unsigned int id = sessionInternal->packetId - 1;
+			sessionInternal->outgoingEvents.pop();
+			inject_message(session, "{\"type\":\"reply\",\"id\":" + std::to_string(id) + ",\"error\":null,\"result\":{\"time\":0}}");
+			for (int i = 0; i < 100; ++i)
+			{
+				inject_message(session, input);
+			}
+			ASSERT_NOERR(interactive_run(session, 101));
+		};
+
+		// Warm the pool, after that handling messages allocates no events.
+		run_batch();
+		unsigned long long allocations = sessionInternal->incomingAllocations;
+		Assert::IsTrue(0 < allocations);
+		for (int batch = 0; batch < 1000; ++batch)
+		{
+			run_batch();
+		}
+
+		Assert::IsTrue(1001 * 100 == inputCount && 1001 == replyCount);
+		Assert::IsTrue(allocations == sessionInternal->incomingAllocations);
+
+		std::stringstream s;
+		s << "Handled " << inputCount + replyCount << " messages with " << allocations << " event allocations.";
+		Logger::WriteMessage(s.str().c_str());
+
+		interactive_close_session(session);
+	}
 
+	TEST_METHOD(PollEventsTest)
+	{
 		interactive_session session;
 		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(seed_scenes(session, BENCHMARK_SCENES));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
 
-		std::string controlId = "GiveHealth";
-		size_t size;
-		interactive_property_type type;
-		char prop[8];
-		size = 8;
-		int intProp;
-		long long int64Prop;
-		bool boolProp;
-		float floatProp;
-		unsigned int uInt;
-		unsigned long long ulong64;
+		// Registered handlers are left alone while polling.
+		static size_t handlerCalls = 0;
+		ASSERT_NOERR(interactive_set_input_handler(session, [](void* context, interactive_session session, const interactive_input* input)
+		{
+			++handlerCalls;
+		}));
+		ASSERT_NOERR(interactive_set_error_handler(session, [](void* context, interactive_session session, int errorCode, const char* errorMessage, size_t errorMessageLength)
+		{
+			++handlerCalls;
+		}));
+		ASSERT_NOERR(interactive_set_participants_changed_handler(session, [](void* context, interactive_session session, interactive_participant_action action, const interactive_participant* participant)
+		{
+			++handlerCalls;
+		}));
+
+		const int inputCount = 10;
+		std::string message = "{\"type\":\"method\",\"id\":1,\"method\":\"onParticipantJoin\",\"params\":{\"participants\":[";
+		for (int i = 0; i < 3; ++i)
+		{
+			message += (0 == i ? "" : ",") + std::string("{\"sessionID\":\"participant-") + std::to_string(i) + "\",\"userID\":" + std::to_string(i) + ",\"username\":\"user" + std::to_string(i) + "\",\"level\":1,\"lastInputAt\":0,\"connectedAt\":0,\"disabled\":false,\"groupID\":\"default\"}";
+		}
+		inject_message(session, message + "]},\"discard\":true}");
+		for (int i = 0; i < inputCount; ++i)
+		{
+			inject_message(session, "{\"type\":\"method\",\"id\":" + std::to_string(i + 2) + ",\"method\":\"giveInput\",\"params\":{\"control\":{\"controlID\":\"GiveHealth\",\"kind\":\"button\"},"
+				"\"input\":{\"controlID\":\"GiveHealth\",\"event\":\"mousedown\",\"button\":" + std::to_string(i) + "},\"participantID\":\"participant-" + std::to_string(i % 3) + "\"},\"discard\":true}");
+		}
+		sessionInternal->enqueue_incoming_event(std::make_shared<mixer_internal::error_event>(mixer_internal::interactive_error(MIXER_ERROR_WS_READ_FAILED, "Read failed")));
+
+		// Poll in batches smaller than the events a message raises, the overflow is returned by the following calls.
+		interactive_event events[2];
+		size_t count = 0;
+		size_t errors = 0, inputs = 0, joins = 0;
+		do
+		{
+			ASSERT_NOERR(interactive_poll_events(session, events, 2, &count));
+			Assert::IsTrue(count <= 2);
+			for (size_t i = 0; i < count; ++i)
+			{
+				switch (events[i].kind)
+				{
+				case interactive_event_error:
+					Assert::IsTrue(MIXER_ERROR_WS_READ_FAILED == events[i].error.errorCode && 0 == strcmp("Read failed", events[i].error.errorMessage));
+					++errors;
+					break;
+				case interactive_event_participants_changed:
+				{
+					const interactive_participant& participant = events[i].participantsChanged.participant;
+					Assert::IsTrue(participant_join == events[i].participantsChanged.action);
+					Assert::IsTrue(std::string("participant-") + std::to_string(participant.userId) == participant.id && strlen(participant.id) == participant.idLength);
+					Assert::IsTrue(std::string("user") + std::to_string(participant.userId) == participant.userName && 0 == strcmp("default", participant.groupId));
+					++joins;
+					break;
+				}
+				case interactive_event_input:
+				{
+					const interactive_input& input = events[i].input;
+					Assert::IsTrue(0 == strcmp("GiveHealth", input.control.id) && input_type_click == input.type && 0 == strncmp("participant-", input.participantId, 12));
+					std::string json(input.jsonData, input.jsonDataLength);
+					Assert::IsTrue(std::string::npos != json.find("\"button\":" + std::to_string(inputs)));
+					++inputs;
+					break;
+				}
+				default:
+					Assert::Fail(L"Unexpected event.");
+				}
+			}
+		} while (0 < count);
+
+		Assert::IsTrue(1 == errors && 3 == joins && inputCount == inputs);
+		Assert::IsTrue(0 == handlerCalls);
+
+		// The handlers are back in place for interactive_run.
+		inject_message(session, "{\"type\":\"method\",\"id\":20,\"method\":\"giveInput\",\"params\":{\"control\":{\"controlID\":\"GiveHealth\",\"kind\":\"button\"},"
+			"\"input\":{\"controlID\":\"GiveHealth\",\"event\":\"mousedown\",\"button\":0},\"participantID\":\"participant-0\"},\"discard\":true}");
+		ASSERT_NOERR(interactive_run(session, 1));
+		Assert::IsTrue(1 == handlerCalls);
+
+		// While the title polls, other threads still raise events with the title's handlers.
+		sessionInternal->poll.thread = std::this_thread::get_id();
+		Assert::IsTrue(sessionInternal->onError != mixer_internal::error_handler(*sessionInternal));
+		on_error otherThreadHandler = nullptr;
+		std::thread([&]() { otherThreadHandler = mixer_internal::error_handler(*sessionInternal); }).join();
+		Assert::IsTrue(sessionInternal->onError == otherThreadHandler);
+		sessionInternal->poll.thread = std::thread::id();
+
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(RunForBudgetTest)
+	{
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(seed_scenes(session, BENCHMARK_SCENES));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+		sessionInternal->scenesCached = true;
+		sessionInternal->groupsCached = true;
+
+		// Each input costs about 20us.
+		static size_t inputCount = 0;
+		ASSERT_NOERR(interactive_set_input_handler(session, [](void* context, interactive_session session, const interactive_input* input)
+		{
+			auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(20);
+			while (std::chrono::steady_clock::now() < until);
+			++inputCount;
+		}));
+
+		const size_t queuedInputs = 500;
+		std::string input = "{\"type\":\"method\",\"id\":1234,\"method\":\"giveInput\",\"params\":{\"control\":{\"controlID\":\"GiveHealth\",\"kind\":\"button\"},"
+			"\"input\":{\"controlID\":\"GiveHealth\",\"event\":\"mousedown\",\"button\":0},\"participantID\":\"0d3b9a2c-7f55-4d45-9a52-61f8d6a5c1e0\"},\"discard\":true}";
+		for (size_t i = 0; i < queuedInputs; ++i)
+		{
+			inject_message(session, input);
+		}
+
+		// A 1ms budget handles a slice of the queue and reports the rest.
+		size_t pending = 0;
+		size_t calls = 0;
+		double longestCall = 0;
+		do
+		{
+			auto start = std::chrono::steady_clock::now();
+			ASSERT_NOERR(interactive_run_for(session, 1000, &pending));
+			longestCall = (std::max)(longestCall, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+			++calls;
+			Assert::IsTrue(queuedInputs == inputCount + pending);
+		} while (0 < pending);
+		Assert::IsTrue(queuedInputs == inputCount && 1 < calls);
+
+		// Re-caching a large project inside interactive_run stalls the frame, in the background it does not.
+		std::string scenes = "{\"scenes\":[{\"sceneID\":\"default\",\"controls\":[{\"controlID\":\"GiveHealth\",\"kind\":\"button\"}";
+		for (int i = 0; i < 5000; ++i)
+		{
+			scenes += ",{\"controlID\":\"Control" + std::to_string(i) + "\",\"kind\":\"button\",\"text\":\"Control " + std::to_string(i) + "\",\"cost\":" + std::to_string(i) + "}";
+		}
+		scenes += "]}]}";
+		auto recache = [&]()
+		{
+			inject_message(session, "{\"type\":\"method\",\"id\":1,\"method\":\"updateScenes\",\"params\":{},\"discard\":true}");
+			Assert::IsTrue(MIXER_OK == interactive_run(session, 1));
+			unsigned int id = sessionInternal->packetId - 1;
+			sessionInternal->outgoingEvents.pop();
+			inject_message(session, "{\"type\":\"reply\",\"id\":" + std::to_string(id) + ",\"error\":null,\"result\":" + scenes + "}");
+			auto start = std::chrono::steady_clock::now();
+			Assert::IsTrue(MIXER_OK == interactive_run(session, 1));
+			return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+		};
+
+		double foregroundRun = recache();
+		Assert::IsTrue(5001 == sessionInternal->controls.size());
+		ASSERT_NOERR(interactive_set_background_caching(session, true));
+		ASSERT_NOERR(seed_scenes(session, BENCHMARK_SCENES));
+
+		// A reader on the title's side sees either the old controls or the new ones while the background thread replaces them.
+		sessionInternal->state = interactive_connected;
+		std::atomic<bool> recached(false);
+		std::atomic<int> failures(0);
+		std::atomic<int> reads(0);
+		std::thread reader([&]()
+		{
+			static thread_local size_t enumerated;
+			while (!recached)
+			{
+				enumerated = 0;
+				int err = interactive_scene_get_controls(session, "default", [](void*, interactive_session, const interactive_control*) { ++enumerated; });
+				int cost = 0;
+				int costErr = interactive_control_get_property_int(session, "Control4999", "cost", &cost);
+				if (MIXER_OK != err || (1 != enumerated && 5001 != enumerated) || !((MIXER_OK == costErr && 4999 == cost) || MIXER_ERROR_OBJECT_NOT_FOUND == costErr))
+				{
+					++failures;
+				}
+				++reads;
+			}
+		});
+		while (0 == reads)
+		{
+			std::this_thread::yield();
+		}
+
+		double backgroundRun = recache();
+		recached = true;
+		reader.join();
+		Assert::IsTrue(0 == failures);
+		Assert::IsTrue(5001 == sessionInternal->controls.size());
+		sessionInternal->state = interactive_disconnected;
+
+		std::stringstream s;
+		s << queuedInputs << " inputs in " << calls << " calls of 1000us, longest call " << longestCall << "us. Re-caching 5001 controls took "
+			<< foregroundRun << "us of interactive_run, " << backgroundRun << "us in the background mode.";
+		Logger::WriteMessage(s.str().c_str());
+
+		interactive_close_session(session);
+	}
+
+	TEST_METHOD(CooperativeModeTest)
+	{
+		// Inbound events queue on the title's thread without waiting, even beyond the capacity of their ring.
+		interactive_session session;
+		ASSERT_NOERR(interactive_open_session(&session));
+		ASSERT_NOERR(interactive_set_cooperative_mode(session, true));
+		ASSERT_NOERR(seed_scenes(session, BENCHMARK_SCENES));
+		static size_t inputCount = 0;
+		ASSERT_NOERR(interactive_set_input_handler(session, [](void* context, interactive_session session, const interactive_input* input)
+		{
+			++inputCount;
+		}));
+
+		const size_t queuedInputs = 10000;
+		for (size_t i = 0; i < queuedInputs; ++i)
+		{
+			inject_message(session, "{\"type\":\"method\",\"id\":" + std::to_string(i) + ",\"method\":\"giveInput\",\"params\":{\"control\":{\"controlID\":\"GiveHealth\",\"kind\":\"button\"},"
+				"\"input\":{\"controlID\":\"GiveHealth\",\"event\":\"mousedown\",\"button\":0},\"participantID\":\"0d3b9a2c-7f55-4d45-9a52-61f8d6a5c1e0\"},\"discard\":true}");
+		}
+		size_t pending = 0;
+		ASSERT_NOERR(interactive_run_for(session, 0, &pending));
+		Assert::IsTrue(queuedInputs == inputCount + pending);
+		ASSERT_NOERR(interactive_run(session, UINT_MAX));
+		Assert::IsTrue(queuedInputs == inputCount);
+		interactive_close_session(session);
+
+#if __linux__
+		// Connect and round trip input with every step taken by this thread.
+		stand_in_server server;
+		static std::atomic<size_t> connectedCount;
+		std::stringstream s;
+		for (size_t sessionCount : { 1, 100 })
+		{
+			size_t baseThreads = process_thread_count();
+			std::vector<interactive_session> sessions(sessionCount);
+			for (interactive_session& session : sessions)
+			{
+				ASSERT_NOERR(interactive_open_session(&session));
+				get_internal_session(session)->http = std::make_unique<stand_in_hosts>(server.uri());
+				ASSERT_NOERR(interactive_set_cooperative_mode(session, true));
+				ASSERT_NOERR(interactive_set_state_changed_handler(session, [](void* context, interactive_session session, interactive_state previousState, interactive_state newState)
+				{
+					if (interactive_connected == newState)
+					{
+						++connectedCount;
+					}
+				}));
+				ASSERT_NOERR(interactive_set_input_handler(session, [](void* context, interactive_session session, const interactive_input* input)
+				{
+					Assert::IsTrue(MIXER_OK == interactive_capture_transaction(session, input->transactionId));
+				}));
+			}
+
+			connectedCount = 0;
+			size_t runs = 0;
+			auto start = std::chrono::steady_clock::now();
+			for (interactive_session session : sessions)
+			{
+				ASSERT_NOERR(interactive_connect(session, "Bearer stand-in", VERSION_ID, "", false));
+			}
+
+			auto deadline = start + std::chrono::seconds(30);
+			while (connectedCount < sessionCount && std::chrono::steady_clock::now() < deadline)
+			{
+				for (interactive_session session : sessions)
+				{
+					ASSERT_NOERR(interactive_run(session, 100));
+				}
+				++runs;
+			}
+			Assert::IsTrue(sessionCount == connectedCount);
+			Assert::IsTrue(baseThreads == process_thread_count());
+			double connectMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			server.reset_captures();
+			start = std::chrono::steady_clock::now();
+			server.send_inputs();
+			double captureMs = 0;
+			while (server.captured(&captureMs) < sessionCount && std::chrono::steady_clock::now() < deadline)
+			{
+				for (interactive_session session : sessions)
+				{
+					ASSERT_NOERR(interactive_run(session, 100));
+				}
+			}
+			Assert::IsTrue(sessionCount == server.captured(&captureMs));
+			Assert::IsTrue(baseThreads == process_thread_count());
+			double roundTripMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 
+			for (interactive_session session : sessions)
+			{
+				interactive_close_session(session);
+			}
+
+			s << sessionCount << " cooperative sessions on one thread: connected in " << connectMs << "ms over " << runs << " passes, inputs captured in "
+				<< roundTripMs << "ms, " << captureMs / sessionCount << "ms per round trip." << std::endl;
+		}
+
+		// Http requests have a lane of their own, they do not wait behind a method held until the websocket opens.
+		ASSERT_NOERR(interactive_open_session(&session));
+		mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+		sessionInternal->http = std::make_unique<slow_stand_in_hosts>("ws://127.0.0.1:1/");
+		ASSERT_NOERR(interactive_set_cooperative_mode(session, true));
+		ASSERT_NOERR(interactive_connect(session, "Bearer stand-in", VERSION_ID, "", false));
+		ASSERT_NOERR(mixer_internal::queue_method(*sessionInternal, RPC_METHOD_GET_TIME, nullptr, nullptr));
+		static size_t responses;
+		responses = 0;
+		ASSERT_NOERR(mixer_internal::queue_request(*sessionInternal, "http://fast/", "GET", nullptr, nullptr, [](const mixer_internal::http_response& response)
+		{
+			++responses;
+			return (int)MIXER_OK;
+		}));
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		while (0 == responses && std::chrono::steady_clock::now() < deadline)
+		{
+			ASSERT_NOERR(interactive_run(session, 100));
+		}
+		Assert::IsTrue(1 == responses);
+		Assert::IsTrue(!sessionInternal->wsOpen && 1 == sessionInternal->processingEvents.size());
+		interactive_close_session(session);
+
+		Logger::WriteMessage(s.str().c_str());
+#endif
+	}
+
+#if __linux__
+	TEST_METHOD(WebsocketLoopbackTest)
+	{
+		echo_websocket_server server;
+		std::unique_ptr<mixer_internal::websocket> ws = mixer_internal::websocket_factory::make_websocket();
+		std::mutex mutex;
+		std::condition_variable received;
+		std::vector<std::string> messages;
+		bool connected = false;
+		bool closed = false;
+		int openErr = -1;
+		std::thread socketThread([&]()
+		{
+			openErr = ws->open(server.uri(), [&](const mixer_internal::websocket& socket, const std::string& connectMessage)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				connected = true;
+			},
+			[&](const mixer_internal::websocket& socket, char* message, const size_t messageSize)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				messages.emplace_back(message, messageSize);
+				received.notify_all();
+			},
+			nullptr,
+			[&](const mixer_internal::websocket& socket, const unsigned short code, const std::string& reason)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				closed = true;
+			});
+		});
+
+		auto wait_for_messages = [&](size_t count)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			return received.wait_for(lock, std::chrono::seconds(10), [&]() { return messages.size() >= count; });
+		};
+
+		// The fragmented greeting arrives whole and the ping interleaved with it is answered.
+		Assert::IsTrue(wait_for_messages(1));
+		Assert::IsTrue(connected);
+		Assert::IsTrue(0 == messages[0].compare("hello"));
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		while (0 == server.pongs && std::chrono::steady_clock::now() < deadline)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		Assert::IsTrue(1 == server.pongs);
+
+		// A message with a 64 bit length.
+		std::string large(200 * 1024, '\0');
+		for (size_t i = 0; i < large.length(); ++i)
+		{
+			large[i] = 'a' + (i % 26);
+		}
+		ASSERT_NOERR(ws->send(large));
+		Assert::IsTrue(wait_for_messages(2));
+		Assert::IsTrue(messages[1] == large);
+
+		// Many small messages are echoed in order.
+		const size_t smallCount = 20000;
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < smallCount; ++i)
+		{
+			ASSERT_NOERR(ws->send(std::to_string(i)));
+		}
+		Assert::IsTrue(wait_for_messages(2 + smallCount));
+		double echoMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		for (size_t i = 0; i < smallCount; ++i)
+		{
+			Assert::IsTrue(messages[2 + i] == std::to_string(i));
+		}
+
+		// Closing returns from open once the close frame is written, the server sees it shortly after.
+		ws->close();
+		socketThread.join();
+		Assert::IsTrue(closed);
+		deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		while (!server.closed && std::chrono::steady_clock::now() < deadline)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		Assert::IsTrue(server.closed);
+
+		std::stringstream s;
+		s << smallCount << " small messages echoed in " << echoMs << "ms, open returned " << openErr << "." << std::endl;
+		Logger::WriteMessage(s.str().c_str());
+	}
+
+	TEST_METHOD(WebsocketLimitsTest)
+	{
+		// Frames the client must refuse, and the close code it answers each with.
+		std::string hugeLength(1, (char)0x81);
+		hugeLength += (char)127;
+		for (int shift = 56; shift >= 0; shift -= 8)
+		{
+			hugeLength += (char)((1ull << 40) >> shift);
+		}
+
+		std::string longPing = echo_websocket_server::frame(0x89, std::string(126, 'p'));
+		std::string fragmentedPing = echo_websocket_server::frame(0x09, "ping");
+		std::string oversizedFragments = echo_websocket_server::frame(0x01, std::string(10 * 1024 * 1024, 'a')) + echo_websocket_server::frame(0x80, std::string(10 * 1024 * 1024, 'b'));
+		std::pair<std::string, unsigned short> cases[] = { { hugeLength, 1009 }, { longPing, 1002 }, { fragmentedPing, 1002 }, { oversizedFragments, 1009 } };
+		for (auto& refused : cases)
+		{
+			echo_websocket_server server(refused.first);
+			std::unique_ptr<mixer_internal::websocket> ws = mixer_internal::websocket_factory::make_websocket();
+			size_t messages = 0;
+			int err = ws->open(server.uri(), nullptr, [&](const mixer_internal::websocket& socket, char* message, const size_t messageSize)
+			{
+				++messages;
+			}, nullptr, nullptr);
+			Assert::IsTrue(EPROTO == err);
+			Assert::IsTrue(0 == messages);
+
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+			while (!server.closed && std::chrono::steady_clock::now() < deadline)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			Assert::IsTrue(refused.second == server.closeCode);
+		}
+	}
+
+	TEST_METHOD(HostLookupTest)
+	{
+		// A host name is looked up on a thread of its own while its owner waits on the descriptor it is given.
+		echo_websocket_server server;
+		std::unique_ptr<mixer_internal::websocket> ws = mixer_internal::websocket_factory::make_websocket();
+		mixer_internal::polled_websocket* polled = ws->polled();
+		std::string uri = server.uri();
+		uri.replace(uri.find("127.0.0.1"), strlen("127.0.0.1"), "localhost");
+		std::vector<std::string> messages;
+		ASSERT_NOERR(polled->open_async(uri, nullptr, [&](const mixer_internal::websocket& socket, char* message, const size_t messageSize)
+		{
+			messages.emplace_back(message, messageSize);
+		}, nullptr, nullptr));
+
+		// Opening returns before the lookup has been picked up, leaving the lookup's eventfd to wait on.
+		bool lookupWantWrite = true;
+		int lookupTimeoutMs = -1;
+		char target[64] = {};
+		std::string lookupFd = "/proc/self/fd/" + std::to_string(polled->poll_fd(lookupWantWrite, lookupTimeoutMs));
+		Assert::IsTrue(0 < readlink(lookupFd.c_str(), target, sizeof(target) - 1) && nullptr != strstr(target, "eventfd"));
+		Assert::IsTrue(!lookupWantWrite);
+
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		while (messages.empty() && std::chrono::steady_clock::now() < deadline)
+		{
+			bool wantWrite = false;
+			int timeoutMs = -1;
+			pollfd pfd = {};
+			pfd.fd = polled->poll_fd(wantWrite, timeoutMs);
+			pfd.events = POLLIN | (wantWrite ? POLLOUT : 0);
+			Assert::IsTrue(pfd.fd >= 0);
+			::poll(&pfd, 1, 100);
+			Assert::IsTrue(EAGAIN == polled->poll());
+		}
+
+		Assert::IsTrue(1 == messages.size() && "hello" == messages[0]);
+		ws->close();
+	}
+
+	TEST_METHOD(SessionGroupScalingBenchmark)
+	{
+		// Every session holds a socket on each end and, without a group, an eventfd of its own.
+		rlimit files;
+		getrlimit(RLIMIT_NOFILE, &files);
+		files.rlim_cur = files.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &files);
+
+		stand_in_server server;
+		static std::atomic<size_t> connectedCount;
+		std::stringstream s;
+		for (size_t sessionCount : { 1, 10, 100, 1000 })
+		{
+			if (files.rlim_cur < sessionCount * 4 + 64)
+			{
+				s << "Skipped " << sessionCount << " sessions, too few file descriptors." << std::endl;
+				continue;
+			}
 
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_get_scenes(session, [](void* context, interactive_session session, const interactive_scene* scene) {}));
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_get_groups(session, [](void* context, interactive_session session, const interactive_group* group) {}));
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_get_participants(session, [](void* context, interactive_session session, const interactive_participant* participant) {}));
+			for (bool grouped : { false, true })
+			{
+				size_t baseThreads = process_thread_count();
+				interactive_session_group group = nullptr;
+				if (grouped)
+				{
+					ASSERT_NOERR(interactive_open_session_group(2, &group));
+				}
 
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_participant_get_user_id(session, "participant", &uInt));
-		size = 8;
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_participant_get_user_name(session, "participant", prop, &size));
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_participant_get_level(session, "participant", &uInt));
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_participant_get_last_input_at(session, "participant", &ulong64));
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_participant_get_connected_at(session, "participant", &ulong64));
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_participant_is_disabled(session, "participant", &boolProp));
-		size = 8;
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_participant_get_group(session, controlId.c_str(), prop, &size));
+				std::vector<interactive_session> sessions(sessionCount);
+				for (interactive_session& session : sessions)
+				{
+					ASSERT_NOERR(interactive_open_session(&session));
+					get_internal_session(session)->http = std::make_unique<stand_in_hosts>(server.uri());
+					ASSERT_NOERR(interactive_set_state_changed_handler(session, [](void* context, interactive_session session, interactive_state previousState, interactive_state newState)
+					{
+						if (interactive_connected == newState)
+						{
+							++connectedCount;
+						}
+					}));
+					ASSERT_NOERR(interactive_set_input_handler(session, [](void* context, interactive_session session, const interactive_input* input)
+					{
+						Assert::IsTrue(MIXER_OK == interactive_capture_transaction(session, input->transactionId));
+					}));
+					if (grouped)
+					{
+						ASSERT_NOERR(interactive_session_group_add(group, session));
+					}
+				}
 
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_property_count(session, controlId.c_str(), &size));
-		size = 8;
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_property_data(session, controlId.c_str(), 0, "id", &size, &type));
-		size = 8;
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_meta_property_count(session, controlId.c_str(), &size));
-		size = 8;
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_meta_property_data(session, controlId.c_str(), 0, "id", &size, &type));
+				// Connect every session and run them all from this thread until they have bootstrapped.
+				connectedCount = 0;
+				auto start = std::chrono::steady_clock::now();
+				for (interactive_session session : sessions)
+				{
+					ASSERT_NOERR(interactive_connect(session, "Bearer stand-in", VERSION_ID, "", false));
+				}
 
+				auto deadline = start + std::chrono::seconds(60);
+				while (connectedCount < sessionCount && std::chrono::steady_clock::now() < deadline)
+				{
+					for (interactive_session session : sessions)
+					{
+						ASSERT_NOERR(interactive_run(session, 100));
+					}
+				}
+				Assert::IsTrue(sessionCount == connectedCount);
+				double connectMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				size_t threads = process_thread_count() - baseThreads;
+
+				// Round trip an input to every session and back as a capture.
+				server.reset_captures();
+				start = std::chrono::steady_clock::now();
+				server.send_inputs();
+				double captureMs = 0;
+				while (server.captured(&captureMs) < sessionCount && std::chrono::steady_clock::now() < deadline)
+				{
+					for (interactive_session session : sessions)
+					{
+						ASSERT_NOERR(interactive_run(session, 100));
+					}
+				}
+				Assert::IsTrue(sessionCount == server.captured(&captureMs));
+				double roundTripMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_property_int(session, controlId.c_str(), "key", &intProp));
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_property_int64(session, controlId.c_str(), "key", &int64Prop));
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_property_bool(session, controlId.c_str(), "key", &boolProp));
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_property_float(session, controlId.c_str(), "key", &floatProp));
-		size = 8;
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_property_string(session, controlId.c_str(), "key", prop, &size));
+				for (interactive_session session : sessions)
+				{
+					interactive_close_session(session);
+				}
+				interactive_close_session_group(group);
 
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_meta_property_int(session, controlId.c_str(), "key", &intProp));
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_meta_property_int64(session, controlId.c_str(), "key", &int64Prop));
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_meta_property_bool(session, controlId.c_str(), "key", &boolProp));
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_meta_property_float(session, controlId.c_str(), "key", &floatProp));
-		size = 8;
-		ASSERT_ERR(MIXER_ERROR_NOT_CONNECTED, interactive_control_get_meta_property_string(session, controlId.c_str(), "key", prop, &size));
+				s << sessionCount << " sessions " << (grouped ? "in a group of 2 threads" : "with their own threads") << ": " << threads << " threads, connected in "
+					<< connectMs << "ms, inputs captured in " << roundTripMs << "ms, " << captureMs / sessionCount << "ms per round trip." << std::endl;
+			}
+		}
 
-		Logger::WriteMessage("Disconnecting...");
-		interactive_close_session(session);
+		Logger::WriteMessage(s.str().c_str());
 	}
 
-	TEST_METHOD(ControlModificationTest)
+	TEST_METHOD(GroupedHostsLookupTest)
 	{
-		g_start = std::chrono::high_resolution_clock::now();
-		interactive_config_debug(interactive_debug_trace, handle_debug_message);
-
-		std::string clientId = CLIENT_ID;
-		std::string versionId = VERSION_ID;
-		std::string shareCode = SHARE_CODE;
-		std::string auth;
+		// A hosts lookup that does not answer must not hold up the other sessions on the group's only thread.
+		stand_in_server server;
+		static std::atomic<size_t> connectedCount;
+		interactive_session_group group = nullptr;
+		ASSERT_NOERR(interactive_open_session_group(1, &group));
 
-		ASSERT_NOERR(do_auth(clientId, "", auth));
+		interactive_session heldSession;
+		ASSERT_NOERR(interactive_open_session(&heldSession));
+		get_internal_session(heldSession)->http = std::make_unique<held_hosts>();
+		ASSERT_NOERR(interactive_session_group_add(group, heldSession));
 
 		interactive_session session;
 		ASSERT_NOERR(interactive_open_session(&session));
-		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
-		ASSERT_NOERR(interactive_set_input_handler(session, handle_input));
-		ASSERT_NOERR(interactive_set_participants_changed_handler(session, handle_participants_changed));
-		ASSERT_NOERR(interactive_set_unhandled_method_handler(session, handle_unhandled_method));
-		ASSERT_NOERR(interactive_set_transaction_complete_handler(session, handle_transaction_complete));
-
-		auto onControlModUpdate = [](void* context, interactive_session session, interactive_control_event eventType, const interactive_control* control)
-		{
-			int err = 0;
-			Assert::IsTrue(interactive_control_updated == eventType);
-			bool disabled = false;
-			ASSERT_NOERR(interactive_control_get_property_bool(session, control->id, "disabled", &disabled));
-			Assert::IsTrue(disabled);
-			g_runInteractive = false;
-		};
-
-		ASSERT_NOERR(interactive_set_control_changed_handler(session, onControlModUpdate));
-
-		auto onStateChanged = [](void* context, interactive_session session, interactive_state prev, interactive_state curr)
+		get_internal_session(session)->http = std::make_unique<stand_in_hosts>(server.uri());
+		ASSERT_NOERR(interactive_set_state_changed_handler(session, [](void* context, interactive_session session, interactive_state previousState, interactive_state newState)
 		{
-			if (interactive_connected == curr && interactive_connecting == prev)
+			if (interactive_connected == newState)
 			{
-				int err = 0;
-				ASSERT_NOERR(interactive_control_set_property_bool(session, "GiveHealth", "disabled", true));
+				++connectedCount;
 			}
-		};
-
-		ASSERT_NOERR(interactive_set_state_changed_handler(session, onStateChanged));
-		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), true));
+		}));
+		ASSERT_NOERR(interactive_session_group_add(group, session));
 
-		while (g_runInteractive)
+		connectedCount = 0;
+		auto start = std::chrono::steady_clock::now();
+		ASSERT_NOERR(interactive_connect(heldSession, "Bearer stand-in", VERSION_ID, "", false));
+		ASSERT_NOERR(interactive_connect(session, "Bearer stand-in", VERSION_ID, "", false));
+		auto deadline = start + std::chrono::seconds(30);
+		while (0 == connectedCount && std::chrono::steady_clock::now() < deadline)
 		{
-			ASSERT_NOERR(interactive_run(session, 1));
+			ASSERT_NOERR(interactive_run(session, 100));
+			ASSERT_NOERR(interactive_run(heldSession, 100));
 			std::this_thread::sleep_for(std::chrono::milliseconds(1));
 		}
+		double connectMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		Assert::IsTrue(1 == connectedCount);
+		Assert::IsTrue(connectMs < 2000);
 
-		Logger::WriteMessage("Disconnecting...");
 		interactive_close_session(session);
+		interactive_close_session(heldSession);
+		interactive_close_session_group(group);
+
+		std::stringstream s;
+		s << "Connected in " << connectMs << "ms beside a session whose hosts lookup never answered." << std::endl;
+		Logger::WriteMessage(s.str().c_str());
 	}
 
-	TEST_METHOD(UserDataTest)
+	TEST_METHOD(WakeFdTest)
 	{
-		g_start = std::chrono::high_resolution_clock::now();
-		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+		// The title waits on the session's descriptor and only runs it when it has been woken.
+		stand_in_server server;
+		static std::atomic<size_t> connectedCount;
+		std::stringstream s;
+		for (bool grouped : { false, true })
+		{
+			interactive_session_group group = nullptr;
+			if (grouped)
+			{
+				ASSERT_NOERR(interactive_open_session_group(1, &group));
+			}
 
-		std::string clientId = CLIENT_ID;
-		std::string versionId = VERSION_ID;
-		std::string shareCode = SHARE_CODE;
-		std::string auth;
+			interactive_session session;
+			ASSERT_NOERR(interactive_open_session(&session));
+			get_internal_session(session)->http = std::make_unique<stand_in_hosts>(server.uri());
+			ASSERT_NOERR(interactive_set_state_changed_handler(session, [](void* context, interactive_session session, interactive_state previousState, interactive_state newState)
+			{
+				if (interactive_connected == newState)
+				{
+					++connectedCount;
+				}
+			}));
+			ASSERT_NOERR(interactive_set_input_handler(session, [](void* context, interactive_session session, const interactive_input* input)
+			{
+				Assert::IsTrue(MIXER_OK == interactive_capture_transaction(session, input->transactionId));
+			}));
+			if (grouped)
+			{
+				ASSERT_NOERR(interactive_session_group_add(group, session));
+			}
 
-		ASSERT_NOERR(do_auth(clientId, "", auth));
+			int wakeFd = -1;
+			ASSERT_NOERR(interactive_get_wake_fd(session, &wakeFd));
+			int epollFd = epoll_create1(EPOLL_CLOEXEC);
+			epoll_event watch = {};
+			watch.events = EPOLLIN;
+			Assert::IsTrue(0 == epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &watch));
 
-		interactive_session session;
-		ASSERT_NOERR(interactive_open_session(&session));
-		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
-		interactive_set_state_changed_handler(session, [](void* context, interactive_session session, interactive_state prevState, interactive_state currentState)
-		{
-			ASSERT_NOERR(interactive_get_user(session, [](void* context, interactive_session session, const interactive_user* user)
+			size_t wakeups = 0;
+			auto runWhenWoken = [&](int timeoutMs)
 			{
-				Assert::IsTrue(nullptr != user);
-				std::stringstream logStream;
-				logStream << "Connecting as: " << user->userName << std::endl;
-				logStream << "Id: " << user->id << std::endl;
-				logStream << "Avatar: " << (nullptr == user->avatarUrl ? "" : user->avatarUrl) << std::endl;
-				logStream << "Experience: " << user->experience << std::endl;
-				logStream << "Level: " << user->level << std::endl;
-				logStream << "Sparks: " << user->sparks << std::endl;
-				logStream << "Broadcasting: " << (user->isBroadcasting ? "true" : "false") << std::endl;
-				Logger::WriteMessage(logStream.str().c_str());
-			}));
-		});
-		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), true));
+				epoll_event ready;
+				if (0 < epoll_wait(epollFd, &ready, 1, timeoutMs))
+				{
+					++wakeups;
+					Assert::IsTrue(MIXER_OK == interactive_run(session, UINT_MAX));
+				}
+			};
 
-		Logger::WriteMessage("Disconnecting...");
-		interactive_close_session(session);
-	}
+			connectedCount = 0;
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+			ASSERT_NOERR(interactive_connect(session, "Bearer stand-in", VERSION_ID, "", false));
+			while (0 == connectedCount && std::chrono::steady_clock::now() < deadline)
+			{
+				runWhenWoken(1000);
+			}
+			Assert::IsTrue(1 == connectedCount);
+			size_t connectWakeups = wakeups;
 
-	struct ChangeControlContext {
-		std::string controlId;
-		std::string propKey;
-		std::string newPropVal;
-		unsigned int iterations;
-		unsigned int currentIteration;
-	};
+			// Let the replies to the bootstrap settle, after which an idle session never wakes the title.
+			wakeups = 1;
+			while (0 < wakeups)
+			{
+				wakeups = 0;
+				runWhenWoken(200);
+			}
+			auto idleEnd = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+			while (std::chrono::steady_clock::now() < idleEnd)
+			{
+				runWhenWoken((int)std::chrono::duration_cast<std::chrono::milliseconds>(idleEnd - std::chrono::steady_clock::now()).count() + 1);
+			}
+			Assert::IsTrue(0 == wakeups);
 
-	TEST_METHOD(ManyControlModificationsTest)
-	{
-		g_start = std::chrono::high_resolution_clock::now();
-		interactive_config_debug(interactive_debug_trace, handle_debug_message);
+			// Input wakes the title, which captures it.
+			server.reset_captures();
+			server.send_inputs();
+			double captureMs = 0;
+			while (0 == server.captured(&captureMs) && std::chrono::steady_clock::now() < deadline)
+			{
+				runWhenWoken(1000);
+			}
+			Assert::IsTrue(1 == server.captured(&captureMs));
+			Assert::IsTrue(0 < wakeups);
 
-		std::string clientId = CLIENT_ID;
-		std::string versionId = VERSION_ID;
-		std::string shareCode = SHARE_CODE;
-		std::string auth;
+			close(epollFd);
+			interactive_close_session(session);
+			interactive_close_session_group(group);
+			s << (grouped ? "Grouped" : "Threaded") << " session: " << connectWakeups << " wakeups to connect, none while idle, " << wakeups << " to capture input." << std::endl;
+		}
 
-		ASSERT_NOERR(do_auth(clientId, "", auth));
+		Logger::WriteMessage(s.str().c_str());
+	}
 
-		interactive_session session;
-		ASSERT_NOERR(interactive_open_session(&session));
-		ASSERT_NOERR(interactive_set_error_handler(session, handle_error_assert));
+	TEST_METHOD(OutgoingLanesTest)
+	{
+		// A slow http request must not hold up the capture sent for an input queued behind it, whether the session runs
+		// its own lanes or a group's reactor runs them.
+		stand_in_server server;
+		static std::atomic<size_t> connectedCount;
+		static std::atomic<size_t> httpErrors;
+		std::stringstream s;
+		for (bool grouped : { false, true })
+		{
+			interactive_session_group group = nullptr;
+			if (grouped)
+			{
+				ASSERT_NOERR(interactive_open_session_group(1, &group));
+			}
 
-		ChangeControlContext context;
-		context.controlId = "GiveHealth";
-		context.propKey = "text";
-		context.newPropVal = "0";
-		context.iterations = 10;
-		context.currentIteration = 0;
-		interactive_set_session_context(session, &context);
+			interactive_session session;
+			ASSERT_NOERR(interactive_open_session(&session));
+			mixer_internal::interactive_session_internal* sessionInternal = get_internal_session(session);
+			slow_stand_in_hosts* hosts = new slow_stand_in_hosts(server.uri());
+			sessionInternal->http.reset(hosts);
+			ASSERT_NOERR(interactive_set_state_changed_handler(session, [](void* context, interactive_session session, interactive_state previousState, interactive_state newState)
+			{
+				if (interactive_connected == newState)
+				{
+					++connectedCount;
+				}
+			}));
+			ASSERT_NOERR(interactive_set_error_handler(session, [](void* context, interactive_session session, int errorCode, const char* errorMessage, size_t errorMessageLength)
+			{
+				if (MIXER_ERROR_HTTP == errorCode)
+				{
+					++httpErrors;
+				}
+			}));
+			ASSERT_NOERR(interactive_set_input_handler(session, [](void* context, interactive_session session, const interactive_input* input)
+			{
+				Assert::IsTrue(MIXER_OK == interactive_capture_transaction(session, input->transactionId));
+			}));
+			if (grouped)
+			{
+				ASSERT_NOERR(interactive_session_group_add(group, session));
+			}
 
-		interactive_set_control_changed_handler(session, [](void* context, interactive_session session, interactive_control_event eventType, const interactive_control* control) {
-			std::stringstream logStream;
+			connectedCount = 0;
+			httpErrors = 0;
+			ASSERT_NOERR(interactive_connect(session, "Bearer stand-in", VERSION_ID, "", false));
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+			while (0 == connectedCount && std::chrono::steady_clock::now() < deadline)
+			{
+				ASSERT_NOERR(interactive_run(session, 100));
+			}
+			Assert::IsTrue(1 == connectedCount);
+
+			static std::atomic<size_t> responses;
+			responses = 0;
+			server.reset_captures();
+			size_t basePolls = hosts->polls;
+			auto start = std::chrono::steady_clock::now();
+			ASSERT_NOERR(mixer_internal::queue_request(*sessionInternal, "http://slow/", "GET", nullptr, nullptr, [](const mixer_internal::http_response& response)
+			{
+				++responses;
+				return (int)MIXER_OK;
+			}));
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			server.send_inputs();
+			double captureMs = 0;
+			while (0 == server.captured(&captureMs) && std::chrono::steady_clock::now() < deadline)
+			{
+				ASSERT_NOERR(interactive_run(session, 100));
+			}
+			double roundTripMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			Assert::IsTrue(1 == server.captured(&captureMs));
+			Assert::IsTrue(0 == responses);
+			Assert::IsTrue(roundTripMs < 1000);
 
-			// Verify the control updated with the correct string.
-			ChangeControlContext* ctx = static_cast<ChangeControlContext*>(context);
-			size_t bufferSize = 4096;
-			char buffer[4096];
-			ASSERT_NOERR(interactive_control_get_property_string(session, ctx->controlId.c_str(), ctx->propKey.c_str(), buffer, &bufferSize));
-			Assert::IsTrue(0 == ctx->newPropVal.compare(buffer));
+			while (0 == responses && std::chrono::steady_clock::now() < deadline)
+			{
+				ASSERT_NOERR(interactive_run(session, 100));
+			}
+			Assert::IsTrue(1 == responses);
 
-			++ctx->currentIteration;
-			if (ctx->currentIteration >= ctx->iterations)
+			// The reactor steps the session for the request when it is due rather than polling it in the meantime.
+			Assert::IsTrue(hosts->polls - basePolls < 20);
+
+			// A failed request is reported once, without holding up either lane.
+			ASSERT_NOERR(mixer_internal::queue_request(*sessionInternal, "http://fail/", "GET", nullptr, nullptr, nullptr));
+			auto settle = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+			while (std::chrono::steady_clock::now() < settle)
 			{
-				g_runInteractive = false;
+				ASSERT_NOERR(interactive_run(session, 100));
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
 			}
-			else {
-				// Generate some random data to put into the string
-				ctx->newPropVal = std::to_string(rand());
-				ASSERT_NOERR(interactive_control_set_property_string(session, ctx->controlId.c_str(), ctx->propKey.c_str(), ctx->newPropVal.c_str()));
+			Assert::IsTrue(1 == httpErrors);
+
+			// Only a session outside a group starts a thread for its http lane.
+			Assert::IsTrue(grouped != sessionInternal->httpThread.joinable());
+
+			interactive_outgoing_stats stats;
+			ASSERT_NOERR(interactive_get_outgoing_stats(session, &stats));
+			Assert::IsTrue(2 == stats.http.count);
+			Assert::IsTrue(0 < stats.websocket.count);
+			Assert::IsTrue(stats.websocket.maxMicroseconds < 1000000);
+			unsigned long long bucketed = 0;
+			for (unsigned long long bucket : stats.websocket.buckets)
+			{
+				bucketed += bucket;
 			}
-		});
+			Assert::IsTrue(stats.websocket.count == bucketed);
+			interactive_close_session(session);
+			interactive_close_session_group(group);
 
-		g_runInteractive = true;
+			s << (grouped ? "Grouped" : "Threaded") << " session: input captured " << roundTripMs << "ms after a 1s http request was queued. Websocket methods: "
+				<< stats.websocket.count << " sent, mean wait " << (double)stats.websocket.totalMicroseconds / stats.websocket.count << "us, max "
+				<< stats.websocket.maxMicroseconds << "us." << std::endl;
+		}
 
-		ASSERT_NOERR(interactive_connect(session, auth.c_str(), versionId.c_str(), shareCode.c_str(), true));
+		Logger::WriteMessage(s.str().c_str());
+	}
 
-		interactive_set_state_changed_handler(session, [](void* context, interactive_session session, interactive_state previousState, interactive_state newState)
+	TEST_METHOD(HttpKeepAliveBenchmark)
+	{
+		stand_in_http_server server;
+		const size_t requestCount = 500;
+		std::stringstream s;
+
+		// Sequential requests, each on a new connection and then on one kept alive.
+		for (bool keepAlive : { false, true })
 		{
-			if (interactive_state::interactive_ready == newState) {
-				ChangeControlContext* ctx = static_cast<ChangeControlContext*>(context);
-				Assert::IsTrue(0 == ctx->currentIteration);
-				ASSERT_NOERR(interactive_control_set_property_string(session, ctx->controlId.c_str(), ctx->propKey.c_str(), ctx->newPropVal.c_str()));
+			mixer_internal::posix_http_client client(keepAlive);
+			size_t baseAccepted = server.accepted;
+			auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < requestCount; ++i)
+			{
+				mixer_internal::http_response response;
+				ASSERT_NOERR(client.make_request(server.uri(), "GET", nullptr, "", response));
+				Assert::IsTrue(200 == response.statusCode);
+				Assert::IsTrue(0 == response.body.compare("{\"ok\":true}"));
 			}
-		});
+			double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			size_t connections = server.accepted - baseAccepted;
+			Assert::IsTrue((keepAlive ? 1 : requestCount) == connections);
+			s << requestCount << " sequential requests " << (keepAlive ? "reusing a kept alive connection" : "on new connections") << ": " << connections << " connections, "
+				<< 1000 * elapsedMs / requestCount << "us per request." << std::endl;
+		}
 
-		while (g_runInteractive)
+		// Requests in flight together each take a connection, which the next batch reuses.
+		mixer_internal::posix_http_client client;
+		for (size_t batch = 0; batch < 2; ++batch)
 		{
-			ASSERT_NOERR(interactive_run(session, 10));
-			// Wait one second between processing changes so it can be seen on the page.
-			std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+			size_t baseAccepted = server.accepted;
+			size_t completed = 0;
+			for (size_t i = 0; i < 4; ++i)
+			{
+				ASSERT_NOERR(client.make_request_async(server.uri(), "POST", nullptr, "{}", [&completed](int err, mixer_internal::http_response& response)
+				{
+					Assert::IsTrue(0 == err && 200 == response.statusCode);
+					++completed;
+				}));
+			}
+
+			// Wait on the client's descriptor between polls, it is readable as soon as any request can make progress.
+			auto start = std::chrono::steady_clock::now();
+			auto deadline = start + std::chrono::seconds(5);
+			while (0 < client.poll() && std::chrono::steady_clock::now() < deadline)
+			{
+				int timeoutMs = -1;
+				pollfd pfd = {};
+				pfd.fd = client.poll_fd(timeoutMs);
+				pfd.events = POLLIN;
+				Assert::IsTrue(pfd.fd >= 0 && timeoutMs > 0);
+				::poll(&pfd, 1, (std::min)(timeoutMs, 1000));
+			}
+			Assert::IsTrue(4 == completed);
+			Assert::IsTrue(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(1000));
+			if (0 < batch)
+			{
+				Assert::IsTrue(baseAccepted == server.accepted);
+			}
 		}
 
-		Assert::IsTrue(context.currentIteration == context.iterations);
+		// Responses without a body and chunked bodies with trailers end where their framing says, leaving the connection
+		// to be reused. Clients do not share their connections.
+		{
+			mixer_internal::posix_http_client framingClient;
+			size_t baseAccepted = server.accepted;
+			auto start = std::chrono::steady_clock::now();
+			const char* paths[] = { "nobody", "continue", "chunked", "" };
+			for (const char* path : paths)
+			{
+				mixer_internal::http_response response;
+				ASSERT_NOERR(framingClient.make_request(server.uri() + path, "GET", nullptr, "", response, 1000));
+				Assert::IsTrue((0 == strcmp(path, "nobody") ? 204 : 200) == response.statusCode);
+				Assert::IsTrue(0 == response.body.compare(0 == strcmp(path, "nobody") ? "" : "{\"ok\":true}"));
+			}
 
-		Logger::WriteMessage("Disconnecting...");
-		interactive_close_session(session);
+			mixer_internal::http_response response;
+			ASSERT_NOERR(framingClient.make_request(server.uri(), "HEAD", nullptr, "", response, 1000));
+			Assert::IsTrue(200 == response.statusCode && response.body.empty());
+			ASSERT_NOERR(framingClient.make_request(server.uri(), "GET", nullptr, "", response, 1000));
+			Assert::IsTrue(0 == response.body.compare("{\"ok\":true}"));
+			Assert::IsTrue(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(1000));
+			Assert::IsTrue(baseAccepted + 1 == server.accepted);
+		}
+
+		// Connections the server has closed while idle are replaced without failing the request.
+		server.closeAfterResponse = true;
+		size_t baseRequests = server.requests;
+		for (size_t i = 0; i < 20; ++i)
+		{
+			mixer_internal::http_response response;
+			ASSERT_NOERR(client.make_request(server.uri(), "GET", nullptr, "", response));
+			Assert::IsTrue(200 == response.statusCode);
+		}
+		Assert::IsTrue(20 == server.requests - baseRequests);
+
+		Logger::WriteMessage(s.str().c_str());
 	}
+#endif
 };
 }
\ No newline at end of file
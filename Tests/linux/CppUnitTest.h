@@ -0,0 +1,44 @@
+#pragma once
+// The subset of the MSTest C++ framework used by Tests.cpp, so the offline tests can run on Linux. A failed assertion
+// throws, ending the test method.
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+namespace Microsoft { namespace VisualStudio { namespace CppUnitTestFramework {
+
+struct Logger
+{
+	static void WriteMessage(const char* message)
+	{
+		printf("%s\n", message);
+		fflush(stdout);
+	}
+};
+
+struct Assert
+{
+	static void IsTrue(bool condition, const wchar_t* message = nullptr, int line = __builtin_LINE())
+	{
+		if (!condition)
+		{
+			throw std::runtime_error("Assert::IsTrue failed on line " + std::to_string(line));
+		}
+	}
+
+	static void IsFalse(bool condition, const wchar_t* message = nullptr, int line = __builtin_LINE())
+	{
+		IsTrue(!condition, message, line);
+	}
+
+	static void Fail(const wchar_t* message = nullptr, int line = __builtin_LINE())
+	{
+		throw std::runtime_error("Assert::Fail on line " + std::to_string(line));
+	}
+};
+
+}}}
+
+#define TEST_CLASS(name) class name
+#define TEST_METHOD(name) void name()
@@ -0,0 +1,2 @@
+#pragma once
+// Stands in for the Windows SDK header included by targetver.h.
@@ -0,0 +1,72 @@
+// Runs the tests in Tests.cpp that need no connection to the interactive service. Pass test names to run those tests,
+// or no arguments to run them all.
+#include "../Tests.cpp"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+using namespace MixerTests;
+
+static const std::vector<std::pair<const char*, void (Tests::*)()>> g_offlineTests =
+{
+	{ "InputThroughputBenchmark", &Tests::InputThroughputBenchmark },
+	{ "InputJsonTest", &Tests::InputJsonTest },
+	{ "MethodSerializationTest", &Tests::MethodSerializationTest },
+	{ "ControlUpdateBatchingTest", &Tests::ControlUpdateBatchingTest },
+	{ "PropertyHandleTest", &Tests::PropertyHandleTest },
+	{ "ControlStoreTest", &Tests::ControlStoreTest },
+	{ "ControlIndexStressTest", &Tests::ControlIndexStressTest },
+	{ "ParticipantTableBenchmark", &Tests::ParticipantTableBenchmark },
+	{ "ParticipantReadersTest", &Tests::ParticipantReadersTest },
+	{ "ParticipantSyncTest", &Tests::ParticipantSyncTest },
+	{ "ActiveParticipantsTest", &Tests::ActiveParticipantsTest },
+	{ "GroupMembershipTest", &Tests::GroupMembershipTest },
+	{ "ParticipantsSetGroupBenchmark", &Tests::ParticipantsSetGroupBenchmark },
+	{ "EventQueueBenchmark", &Tests::EventQueueBenchmark },
+	{ "IncomingBackpressureTest", &Tests::IncomingBackpressureTest },
+	{ "PooledEventsTest", &Tests::PooledEventsTest },
+	{ "PollEventsTest", &Tests::PollEventsTest },
+	{ "RunForBudgetTest", &Tests::RunForBudgetTest },
+	{ "CooperativeModeTest", &Tests::CooperativeModeTest },
+	{ "WebsocketLoopbackTest", &Tests::WebsocketLoopbackTest },
+	{ "WebsocketLimitsTest", &Tests::WebsocketLimitsTest },
+	{ "HostLookupTest", &Tests::HostLookupTest },
+	{ "SessionGroupScalingBenchmark", &Tests::SessionGroupScalingBenchmark },
+	{ "GroupedHostsLookupTest", &Tests::GroupedHostsLookupTest },
+	{ "WakeFdTest", &Tests::WakeFdTest },
+	{ "OutgoingLanesTest", &Tests::OutgoingLanesTest },
+	{ "HttpKeepAliveBenchmark", &Tests::HttpKeepAliveBenchmark },
+};
+
+int main(int argc, char** argv)
+{
+	int failed = 0;
+	for (const auto& test : g_offlineTests)
+	{
+		bool selected = 1 == argc;
+		for (int i = 1; i < argc && !selected; ++i)
+		{
+			selected = 0 == strcmp(argv[i], test.first);
+		}
+
+		if (!selected)
+		{
+			continue;
+		}
+
+		Tests tests;
+		try
+		{
+			(tests.*test.second)();
+			printf("PASS %s\n", test.first);
+		}
+		catch (const std::exception& e)
+		{
+			printf("FAIL %s: %s\n", test.first, e.what());
+			++failed;
+		}
+	}
+
+	return failed;
+}
@@ -23,6 +23,25 @@ std::map<std::string, std::string> controlsByTransaction;
 // Display an OAuth consent page to the user.
 int authorize(std::string& authorization);
 
+// Copy the json for an input, it is only serialized on request.
+int get_input_json(interactive_session session, const interactive_input* input, std::string& inputJson)
+{
+	size_t inputJsonLength = 0;
+
+	// First call with a nullptr to get the required size, MIXER_ERROR_BUFFER_SIZE is the expected return value.
+	int err = interactive_input_get_json(session, input, nullptr, &inputJsonLength);
+	if (MIXER_ERROR_BUFFER_SIZE != err)
+	{
+		return err;
+	}
+
+	inputJson.resize(inputJsonLength);
+	err = interactive_input_get_json(session, input, (char*)inputJson.data(), &inputJsonLength);
+	inputJson = inputJson.erase(inputJsonLength - 1);
+
+	return err;
+}
+
 // Handle any errors from the interactive service.
 void handle_error(void* context, interactive_session session, int errorCode, const char* errorMessage, size_t errorMessageLength);
 
@@ -260,8 +279,16 @@ void handle_interactive_input(void* context, interactive_session session, const
 	else if (input_type_custom == input->type && (0 == strcmp(input->control.id, "TextInput")))
 	{
 		// Handle text input.
+		std::string inputJsonData;
+		err = get_input_json(session, input, inputJsonData);
+		if (err)
+		{
+			std::cerr << "Failed to get input JSON data (" << std::to_string(err) << ")" << std::endl;
+			return;
+		}
+
 		rapidjson::Document inputJson;
-		if (inputJson.Parse(input->jsonData).HasParseError())
+		if (inputJson.Parse(inputJsonData.c_str()).HasParseError())
 		{
 			std::cerr << "Failed to parse input JSON data." << std::endl;
 			return;
@@ -2,9 +2,14 @@
 #include "internal/http_client.cpp"
 #include "internal/interactive_auth.cpp"
 #include "internal/interactive_control.cpp"
+#include "internal/interactive_control_store.cpp"
 #include "internal/interactive_event.cpp"
 #include "internal/interactive_group.cpp"
+#include "internal/interactive_input.cpp"
 #include "internal/interactive_participant.cpp"
+#include "internal/interactive_participant_store.cpp"
+#include "internal/interactive_poll.cpp"
+#include "internal/interactive_reactor.cpp"
 #include "internal/interactive_scene.cpp"
 #include "internal/interactive_session.cpp"
 #include "internal/interactive_session_internal.cpp"
@@ -16,4 +21,9 @@
 #include "internal/win_http_api.cpp"
 #include "internal/win_http_client.cpp"
 #include "internal/win_websocket.cpp"
+#elif __linux__
+#include "internal/posix_socket.cpp"
+#include "internal/posix_http_client.cpp"
+#include "internal/posix_reactor.cpp"
+#include "internal/posix_websocket.cpp"
 #endif
\ No newline at end of file
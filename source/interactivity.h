@@ -98,6 +98,42 @@ extern "C" {
 	/// <param name="setReady">Specifies if the session should set the interactive ready state during connection. If false, this can be manually toggled later with <c>interactive_set_ready</c></param>
 	int interactive_connect(interactive_session session, const char* auth, const char* versionId, const char* shareCode, bool setReady);
 
+	/// <summary>
+	/// When enabled, the session never starts a thread. <c>interactive_connect</c> returns at once and each call to <c>interactive_run</c> advances the connection, the host lookup,
+	/// the websocket and the sending of queued methods and requests without waiting on the network. Must be set before <c>interactive_connect</c>. Disabled by default.
+	/// </summary>
+	/// <remarks>
+	/// A cooperative session must only be used from one thread. Events arriving faster than they are processed are queued without limit. Returns <c>MIXER_ERROR_INVALID_OPERATION</c>
+	/// on platforms where the network can not be polled. Functions documented as blocking still block. Host names are looked up on a short-lived thread that ends with the lookup.
+	/// </remarks>
+	int interactive_set_cooperative_mode(interactive_session session, bool enabled);
+
+	/// <summary>
+	/// An opaque handle to a group of sessions that share a pool of network threads.
+	/// </summary>
+	typedef void* interactive_session_group;
+
+	/// <summary>
+	/// Open an <c>interactive_session_group</c> served by <c>threadCount</c> network threads. Each connected session otherwise runs two threads of its own, a group lets
+	/// a host with many sessions connect them all over a small fixed pool of threads.
+	/// </summary>
+	/// <remarks>
+	/// Returns <c>MIXER_ERROR_INVALID_OPERATION</c> on platforms where sessions can not share threads. Every session in the group must be closed with
+	/// <c>interactive_close_session</c> before the group is closed with <c>interactive_close_session_group</c>.
+	/// </remarks>
+	int interactive_open_session_group(size_t threadCount, interactive_session_group* group);
+
+	/// <summary>
+	/// Add a session to a group. The session must not have been connected yet, <c>interactive_connect</c> then connects it on the group's threads.
+	/// Events are still processed by <c>interactive_run</c> on your own thread.
+	/// </summary>
+	int interactive_session_group_add(interactive_session_group group, interactive_session session);
+
+	/// <summary>
+	/// Close a group opened with <c>interactive_open_session_group</c>, stopping its threads.
+	/// </summary>
+	void interactive_close_session_group(interactive_session_group group);
+
 	/// <summary>
 	/// Set the ready state for specified session. No participants will be able to see interactive scenes or give input
 	/// until the interactive session is ready.
@@ -115,6 +151,60 @@ extern "C" {
 	/// </remarks>
 	int interactive_run(interactive_session session, unsigned int maxEventsToProcess);
 
+	/// <summary>
+	/// This function processes events from the interactive service until <c>microsecondsBudget</c> has been used, calling back on registered event handlers. At least one queued event is
+	/// processed and an event that has started is always finished, so the budget may be exceeded by the cost of a single event. Events that do not fit in the budget are left for the next call.
+	/// </summary>
+	/// <remarks>
+	/// <c>pendingEvents</c>, when not null, is set to the number of events still waiting.
+	/// </remarks>
+	int interactive_run_for(interactive_session session, unsigned int microsecondsBudget, size_t* pendingEvents);
+
+	/// <summary>
+	/// Get a file descriptor that is readable whenever events are waiting for <c>interactive_run</c>, so the session can be waited on with <c>poll</c>, <c>epoll</c> or <c>select</c>
+	/// alongside the title's own descriptors. The descriptor is reset by the next call that runs events and is signalled again if that call leaves events behind. It is owned by the
+	/// session and closed by <c>interactive_close_session</c>.
+	/// </summary>
+	/// <remarks>
+	/// Only read the descriptor for readiness, never from it. Returns <c>MIXER_ERROR_INVALID_OPERATION</c> on platforms without file descriptors and for cooperative sessions, which have
+	/// no thread to signal it.
+	/// </remarks>
+	int interactive_get_wake_fd(interactive_session session, int* fd);
+
+	#define INTERACTIVE_QUEUE_LATENCY_BUCKETS 24
+
+	/// <summary>
+	/// A histogram of how long outgoing methods or requests waited in their queue before being sent. <c>buckets[0]</c> counts waits under one microsecond and <c>buckets[i]</c> counts waits
+	/// of at least 2^(i-1) and under 2^i microseconds, the last bucket counts every longer wait.
+	/// </summary>
+	struct interactive_queue_latency
+	{
+		unsigned long long count;
+		unsigned long long totalMicroseconds;
+		unsigned long long maxMicroseconds;
+		unsigned long long buckets[INTERACTIVE_QUEUE_LATENCY_BUCKETS];
+	};
+
+	/// <summary>
+	/// Queue wait latency for each outgoing lane. Websocket methods and http requests are sent independently, so a slow http request never holds up the methods queued behind it.
+	/// </summary>
+	struct interactive_outgoing_stats
+	{
+		interactive_queue_latency websocket;
+		interactive_queue_latency http;
+	};
+
+	/// <summary>
+	/// Get the queue wait latency of methods and requests sent since the session was opened.
+	/// </summary>
+	int interactive_get_outgoing_stats(interactive_session session, interactive_outgoing_stats* stats);
+
+	/// <summary>
+	/// When enabled, the scene and group caches are refreshed on a background thread as changes arrive, rather than by <c>interactive_run</c>. Refreshing the caches
+	/// for a large project can take milliseconds. Disabled by default. Caches are always filled by <c>interactive_run</c> while the session connects.
+	/// </summary>
+	int interactive_set_background_caching(interactive_session session, bool enabled);
+
 	enum interactive_state
 	{
 		interactive_disconnected,
@@ -327,6 +417,88 @@ extern "C" {
 	/// </summary>
 	int interactive_control_set_property_string(interactive_session session, const char* controlId, const char* key, const char* property);
 
+	/// <summary>
+	/// A control property resolved by <c>interactive_control_get_property_handle</c>. Handles remain valid for the lifetime of the session.
+	/// </summary>
+	typedef unsigned int interactive_property_handle;
+
+	/// <summary>
+	/// Resolve a control property once so that it can be read and written without looking up the control and property by name on every call.
+	/// The handle follows the control as the cached scenes are refreshed. Reads return <c>MIXER_ERROR_PROPERTY_NOT_FOUND</c> while the control does not have the property.
+	/// </summary>
+	int interactive_control_get_property_handle(interactive_session session, const char* controlId, const char* key, interactive_property_handle* handle);
+
+	/// <summary>
+	/// Get an <c>int</c> property value by handle.
+	/// </summary>
+	int interactive_property_get_int(interactive_session session, interactive_property_handle handle, int* property);
+
+	/// <summary>
+	/// Get a <c>long long</c> property value by handle.
+	/// </summary>
+	int interactive_property_get_int64(interactive_session session, interactive_property_handle handle, long long* property);
+
+	/// <summary>
+	/// Get a <c>bool</c> property value by handle.
+	/// </summary>
+	int interactive_property_get_bool(interactive_session session, interactive_property_handle handle, bool* property);
+
+	/// <summary>
+	/// Get a <c>float</c> property value by handle.
+	/// </summary>
+	int interactive_property_get_float(interactive_session session, interactive_property_handle handle, float* property);
+
+	/// <summary>
+	/// Get a <c>char*</c> property value by handle.
+	/// </summary>
+	int interactive_property_get_string(interactive_session session, interactive_property_handle handle, char* property, size_t* propertyLength);
+
+	/// <summary>
+	/// Set an <c>int</c> property value by handle.
+	/// </summary>
+	int interactive_property_set_int(interactive_session session, interactive_property_handle handle, int property);
+
+	/// <summary>
+	/// Set a <c>long long</c> property value by handle.
+	/// </summary>
+	int interactive_property_set_int64(interactive_session session, interactive_property_handle handle, long long property);
+
+	/// <summary>
+	/// Set a <c>bool</c> property value by handle.
+	/// </summary>
+	int interactive_property_set_bool(interactive_session session, interactive_property_handle handle, bool property);
+
+	/// <summary>
+	/// Set a <c>float</c> property value by handle.
+	/// </summary>
+	int interactive_property_set_float(interactive_session session, interactive_property_handle handle, float property);
+
+	/// <summary>
+	/// Set a <c>char*</c> property value by handle.
+	/// </summary>
+	int interactive_property_set_string(interactive_session session, interactive_property_handle handle, const char* property);
+
+	/// <summary>
+	/// Counters for batched control property updates.
+	/// </summary>
+	struct interactive_control_update_stats
+	{
+		unsigned long long propertyWrites;
+		unsigned long long methodsSent;
+		unsigned long long framesSaved;
+	};
+
+	/// <summary>
+	/// Send all pending control property updates. Property writes are batched per scene and merged per control, keeping only the last value for each property.
+	/// Pending updates are also sent on every call to <c>interactive_run</c>.
+	/// </summary>
+	int interactive_control_flush_updates(interactive_session session);
+
+	/// <summary>
+	/// Get the counters for batched control property updates, including the number of websocket frames saved by batching.
+	/// </summary>
+	int interactive_control_get_update_stats(interactive_session session, interactive_control_update_stats* stats);
+
 	/// <summary>
 	/// Get an <c>int</c> meta property value by name.
 	/// </summary>
@@ -450,6 +622,7 @@ extern "C" {
 		interactive_input_type type;
 		const char* participantId;
 		size_t participantIdLength;
+		// Raw json for the input's params, only set when it can be referenced without serialization. Use interactive_input_get_json to read it reliably.
 		const char* jsonData;
 		size_t jsonDataLength;
 		const char* transactionId;
@@ -470,6 +643,11 @@ extern "C" {
 	/// </summary>
 	typedef void(*on_input)(void* context, interactive_session session, const interactive_input* input);
 
+	/// <summary>
+	/// Get the raw json data for an input. This may only be called from within the <c>on_input</c> callback for that input.
+	/// </summary>
+	int interactive_input_get_json(interactive_session session, const interactive_input* input, char* json, size_t* jsonLength);
+
 	struct interactive_participant : public interactive_object
 	{
 		unsigned int userId;
@@ -544,6 +722,70 @@ extern "C" {
 	/// Set the handler function for unhandled methods. This may be useful for more advanced scenarios or future protocol changes that may not have existed in this version of the library. This function is called by your own thread during <c>interactive_run</c>
 	/// </summary>
 	int interactive_set_unhandled_method_handler(interactive_session session, on_unhandled_method onUnhandledMethod);
+
+	enum interactive_event_kind
+	{
+		interactive_event_error,
+		interactive_event_state_changed,
+		interactive_event_input,
+		interactive_event_participants_changed,
+		interactive_event_transaction_complete,
+		interactive_event_control_changed,
+		interactive_event_unhandled_method
+	};
+
+	/// <summary>
+	/// An event returned by <c>interactive_poll_events</c>. <c>kind</c> selects the member that is set, each member carries the arguments of the matching handler.
+	/// </summary>
+	struct interactive_event
+	{
+		interactive_event_kind kind;
+		union
+		{
+			struct
+			{
+				int errorCode;
+				const char* errorMessage;
+				size_t errorMessageLength;
+			} error;
+			struct
+			{
+				interactive_state previousState;
+				interactive_state newState;
+			} stateChanged;
+			interactive_input input;
+			struct
+			{
+				interactive_participant_action action;
+				interactive_participant participant;
+			} participantsChanged;
+			struct
+			{
+				const char* transactionId;
+				size_t transactionIdLength;
+				unsigned int error;
+				const char* errorMessage;
+				size_t errorMessageLength;
+			} transactionComplete;
+			struct
+			{
+				interactive_control_event eventType;
+				interactive_control control;
+			} controlChanged;
+			struct
+			{
+				const char* methodJson;
+				size_t methodJsonLength;
+			} unhandledMethod;
+		};
+	};
+
+	/// <summary>
+	/// Process events as <c>interactive_run</c> does, but return them in <c>events</c> rather than calling the registered handlers. Up to <c>capacity</c> events are returned
+	/// and <c>count</c> is set to the number returned, events that do not fit are returned by the next call. Strings in the events remain valid until the next call.
+	/// Input events always carry their json. Errors raised by background threads still go to the error handler. The handlers remain registered and are called as usual by <c>interactive_run</c>.
+	/// </summary>
+	int interactive_poll_events(interactive_session session, interactive_event* events, size_t capacity, size_t* count);
 	/** @} */
 
 	/** @name Participants
@@ -557,11 +799,47 @@ extern "C" {
 	/// </summary>
 	int interactive_get_participants(interactive_session session, on_participant_enumerate onParticipant);
 
+	/// <summary>
+	/// Get the participants who have given input at or after <c>sinceMs</c>, a unix millisecond timestamp, most recent first. Only the active participants are visited, so this is cheap to call every frame.
+	/// </summary>
+	int interactive_get_active_participants(interactive_session session, unsigned long long sinceMs, on_participant_enumerate onParticipant);
+
+	/// <summary>
+	/// Ask the service for the participants who have given input at or after <c>sinceMs</c> and update their last input times. Input is otherwise tracked as it arrives, use this to catch up after reconnecting.
+	/// </summary>
+	int interactive_refresh_active_participants(interactive_session session, unsigned long long sinceMs);
+
+	/// <summary>
+	/// Get the number of participants in a group.
+	/// </summary>
+	int interactive_group_get_participant_count(interactive_session session, const char* groupId, size_t* count);
+
+	/// <summary>
+	/// Get the participants in a group. Participants in other groups are not visited.
+	/// </summary>
+	int interactive_group_get_participants(interactive_session session, const char* groupId, on_participant_enumerate onParticipant);
+
 	/// <summary>
 	/// Change the participant's group Use this along with <c>interactive_group_set_scene</c> to configure which scene a participant sees. All participants join the 'default' (case sensitive) group when joining a session.
 	/// </summary>
 	int interactive_participant_set_group(interactive_session session, const char* participantId, const char* groupId);
 
+	/// <summary>
+	/// Callback when <c>interactive_participants_set_group</c> completes, listing the participants the service did not move.
+	/// </summary>
+	typedef void(*on_participants_group_set)(void* context, interactive_session session, const char* groupId, const char** failedParticipantIds, size_t failedCount);
+
+	/// <summary>
+	/// Change the group of many participants at once. The changes are packed into as few messages as the batch size allows. <c>onComplete</c> is optional and is called once
+	/// after the service has replied to every message. This function is called by your own thread during <c>interactive_run</c>
+	/// </summary>
+	int interactive_participants_set_group(interactive_session session, const char** participantIds, size_t participantCount, const char* groupId, on_participants_group_set onComplete);
+
+	/// <summary>
+	/// Set the largest message in bytes that <c>interactive_participants_set_group</c> will send, 32 KB by default.
+	/// </summary>
+	int interactive_set_participants_batch_size(interactive_session session, size_t maxMessageBytes);
+
 	/// <summary>
 	/// Get the participant's user id.
 	/// </summary>
@@ -2,10 +2,11 @@
 #include "json.h"
 #include "debugging.h"
 
-#include "rapidjson\stringbuffer.h"
-#include "rapidjson\writer.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
 
 #include <codecvt>
+#include <locale>
 
 namespace mixer_internal
 {
@@ -25,7 +26,7 @@ std::string wstring_to_utf8(const std::wstring& wstr)
 
 // JSON
 
-std::string jsonStringify(rapidjson::Value& value)
+std::string jsonStringify(const rapidjson::Value& value)
 {
 	rapidjson::StringBuffer buffer;
 	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
@@ -33,4 +34,39 @@ std::string jsonStringify(rapidjson::Value& value)
 	return std::string(buffer.GetString(), buffer.GetSize());
 }
 
+// Forwards SAX events to a document, asking it to copy every string and key.
+struct json_copy_handler
+{
+	rapidjson::Document& target;
+	json_copy_handler(rapidjson::Document& target) : target(target) {}
+
+	bool Null() { return target.Null(); }
+	bool Bool(bool b) { return target.Bool(b); }
+	bool Int(int i) { return target.Int(i); }
+	bool Uint(unsigned u) { return target.Uint(u); }
+	bool Int64(int64_t i) { return target.Int64(i); }
+	bool Uint64(uint64_t u) { return target.Uint64(u); }
+	bool Double(double d) { return target.Double(d); }
+	bool RawNumber(const char* str, rapidjson::SizeType length, bool) { return target.RawNumber(str, length, true); }
+	bool String(const char* str, rapidjson::SizeType length, bool) { return target.String(str, length, true); }
+	bool StartObject() { return target.StartObject(); }
+	bool Key(const char* str, rapidjson::SizeType length, bool) { return target.Key(str, length, true); }
+	bool EndObject(rapidjson::SizeType memberCount) { return target.EndObject(memberCount); }
+	bool StartArray() { return target.StartArray(); }
+	bool EndArray(rapidjson::SizeType elementCount) { return target.EndArray(elementCount); }
+};
+
+void jsonCopy(const rapidjson::Value& source, rapidjson::Value& target, rapidjson::Document::AllocatorType& allocator)
+{
+	rapidjson::Document copy(&allocator);
+	auto generator = [&source](rapidjson::Document& document)
+	{
+		json_copy_handler handler(document);
+		return source.Accept(handler);
+	};
+
+	copy.Populate(generator);
+	target.Swap(copy);
+}
+
 }
\ No newline at end of file
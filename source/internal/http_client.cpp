@@ -4,6 +4,8 @@
 #include "winapp_http_client.h"
 #elif _WIN32
 #include "win_http_client.h"
+#elif __linux__
+#include "posix_http_client.h"
 #endif
 namespace mixer_internal
 {
@@ -14,6 +16,8 @@ http_factory::make_http_client()
 	return std::make_unique<winapp_http_client>();
 #elif _WIN32
 	return std::make_unique<win_http_client>();
+#elif __linux__
+	return std::make_unique<posix_http_client>();
 #else
 #error "Missing http implementation for this platform."
 #endif
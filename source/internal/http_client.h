@@ -1,9 +1,14 @@
 #pragma once
 
 #include <string>
+#include <functional>
 #include <memory>
 #include <map>
 
+#ifndef _Out_
+#define _Out_
+#endif
+
 namespace mixer_internal
 {
 
@@ -15,13 +20,37 @@ struct http_response
 	std::string body;
 };
 
+// Called once an asynchronous request has finished, err is 0 when a response was received.
+typedef std::function<void(int err, http_response& response)> on_http_complete;
+
+class polled_http_client;
+
 class http_client
 {
 public:
-	virtual ~http_client() = 0 {};
+	virtual ~http_client() {};
 
 	// Make an http request with optional headers
 	virtual int make_request(const std::string& uri, const std::string& requestType, const http_headers* headers, const std::string& body, _Out_ http_response& response, unsigned long timeoutMs = 5000) const = 0;
+
+	// Returns nullptr if requests can only be made by blocking in make_request().
+	virtual polled_http_client* polled() { return nullptr; }
+};
+
+// An http client whose requests are advanced by its owner. Starting a request returns at once, poll() makes all the
+// progress possible without blocking and calls the completion handlers of the requests that finish.
+class polled_http_client
+{
+public:
+	virtual ~polled_http_client() {};
+	virtual int make_request_async(const std::string& uri, const std::string& requestType, const http_headers* headers, const std::string& body, const on_http_complete onComplete, unsigned long timeoutMs = 5000) = 0;
+
+	// Returns the number of requests still in flight.
+	virtual size_t poll() = 0;
+
+	// A descriptor that is readable whenever a request in flight can make progress, or -1 if there is none to wait on,
+	// and the longest wait in milliseconds before the next poll(), or -1 for no limit.
+	virtual int poll_fd(int& timeoutMs) const = 0;
 };
 
 class http_factory
@@ -1,7 +1,7 @@
 #include "interactivity.h"
 #include "common.h"
 #include "http_client.h"
-#include "rapidjson\document.h"
+#include "rapidjson/document.h"
 
 #include <ctime>
 #include <string>
@@ -8,116 +8,108 @@ namespace mixer_internal
 
 interactive_control_internal::interactive_control_internal(std::string id, std::string kind) : interactive_object_internal(std::move(id)), kind(std::move(kind)) {}
 
-interactive_control_pointer::interactive_control_pointer(std::string sceneId, std::string cachePointer) : sceneId(std::move(sceneId)), cachePointer(std::move(cachePointer)) {}
+interactive_property_handle_internal::interactive_property_handle_internal(std::string controlId, std::string key) : controlId(std::move(controlId)), key(std::move(key)), field(find_control_field(this->key.c_str())), control(CONTROL_STORE_NPOS), value(nullptr) {}
 
-// Assumes caller holds read lock on scenes mutex.
-int get_control_scene_id(interactive_session_internal& session, const char* controlId, std::string& sceneId)
+// Assumes caller holds write lock on scenes mutex.
+void resolve_property_handle(interactive_session_internal& session, interactive_property_handle_internal& handle)
 {
-	auto itr = session.controls.find(controlId);
-	if (itr == session.controls.end())
+	handle.control = session.controls.find(handle.controlId);
+	handle.value = nullptr;
+	if (CONTROL_STORE_NPOS != handle.control)
 	{
-		return MIXER_ERROR_OBJECT_NOT_FOUND;
+		// Typed properties are read from their column unless the control stored a value of another type.
+		const control_value& properties = session.controls.properties[handle.control];
+		auto propertyItr = properties.FindMember(handle.key.c_str());
+		handle.value = propertyItr == properties.MemberEnd() ? nullptr : &propertyItr->value;
 	}
-
-	std::string controlPtr = itr->second.cachePointer;
-
-	// The controlPtr is prefixed with a scene pointer, parse it to find the scene this control belongs to.
-	size_t controlOffset = controlPtr.find("controls", 0);
-	std::string scenePtr = controlPtr.substr(0, controlOffset - 1);
-
-	// Get the scene id.
-	rapidjson::Value* scene = rapidjson::Pointer(rapidjson::StringRef(scenePtr.c_str(), scenePtr.length())).Get(session.scenesRoot);
-	sceneId = (*scene)[RPC_SCENE_ID].GetString();
-
-	return MIXER_OK;
 }
 
-// Assumes caller holds read lock on scenes mutex.
-int get_scene_object_prop_count(interactive_session_internal& session, const char* pointer, size_t* count)
+// Assumes caller holds write lock on scenes mutex.
+void refresh_property_handles(interactive_session_internal& session, const char* controlId)
 {
-	if (nullptr == pointer || nullptr == count)
+	for (auto& handle : session.propertyHandles)
 	{
-		return MIXER_ERROR_INVALID_POINTER;
-	}
-
-	*count = 0;
-	rapidjson::Value* value = nullptr;
-	value = rapidjson::Pointer(rapidjson::StringRef(pointer)).Get(session.scenesRoot);
-	if (nullptr == value)
-	{
-		return MIXER_ERROR_OBJECT_NOT_FOUND;
+		if (nullptr == controlId || 0 == handle.controlId.compare(controlId))
+		{
+			resolve_property_handle(session, handle);
+		}
 	}
-
-	*count = value->MemberCount();
-	return MIXER_OK;
 }
 
 // Assumes caller holds read lock on scenes mutex.
-int get_scene_object_prop_data(interactive_session_internal& session, const char* pointer, size_t index, char* propName, size_t* propNameLength, interactive_property_type* propType)
+const control_value* get_property_handle_value(interactive_session_internal& session, const interactive_property_handle_internal& handle, control_value& scratch)
 {
-	if (nullptr == pointer || nullptr == propNameLength || nullptr == propType)
+	if (nullptr != handle.value)
 	{
-		return MIXER_ERROR_INVALID_POINTER;
+		return handle.value;
 	}
 
-	if (*propNameLength > 0 && nullptr == propName)
+	if (control_field_none != handle.field)
 	{
-		return MIXER_ERROR_INVALID_POINTER;
+		return session.controls.get(handle.control, handle.field, scratch);
 	}
 
-	*propType = interactive_property_type::interactive_unknown_t;
+	return session.controls.get(handle.control, handle.key.c_str(), scratch);
+}
 
-	rapidjson::Value* value = rapidjson::Pointer(rapidjson::StringRef(pointer)).Get(session.scenesRoot);
-	if (nullptr == value)
+// Assumes caller holds read lock on scenes mutex.
+int get_control_scene_id(interactive_session_internal& session, const char* controlId, std::string& sceneId)
+{
+	size_t slot = session.controls.find(controlId);
+	if (CONTROL_STORE_NPOS == slot)
 	{
 		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	// Verify that this index is valid for this object.
-	if (value->MemberCount() <= index)
+	sceneId = session.controls.sceneIds[session.controls.sceneIndices[slot]];
+	return MIXER_OK;
+}
+
+int get_control_prop_data(const char* name, const control_value* value, char* propName, size_t* propNameLength, interactive_property_type* propType)
+{
+	if (nullptr == name || nullptr == value)
 	{
 		return MIXER_ERROR_PROPERTY_NOT_FOUND;
 	}
 
-	// Move iterator to property index.
-	auto itr = value->MemberBegin();
-	for (size_t i = 0; i < index; ++i)
+	if (*propNameLength > 0 && nullptr == propName)
 	{
-		++itr;
+		return MIXER_ERROR_INVALID_POINTER;
 	}
 
 	// Verify the caller's buffer is large enough to hold the contents.
-	if (*propNameLength < itr->name.GetStringLength())
+	size_t nameLength = strlen(name);
+	if (*propNameLength < nameLength + 1)
 	{
-		*propNameLength = itr->name.GetStringLength() + 1;
+		*propNameLength = nameLength + 1;
 		return MIXER_ERROR_BUFFER_SIZE;
 	}
 
-	memcpy(propName, itr->name.GetString(), *propNameLength - 1);
-	propName[*propNameLength - 1] = '\0';
+	memcpy(propName, name, nameLength);
+	propName[nameLength] = '\0';
 
 	// Determine the type of this property.
-	if (itr->value.IsString())
+	if (value->IsString())
 	{
 		*propType = interactive_property_type::interactive_string_t;
 	}
-	else if (itr->value.IsInt())
+	else if (value->IsInt())
 	{
 		*propType = interactive_property_type::interactive_int_t;
 	}
-	else if (itr->value.IsBool())
+	else if (value->IsBool())
 	{
 		*propType = interactive_property_type::interactive_bool_t;
 	}
-	else if (itr->value.IsFloat())
+	else if (value->IsFloat())
 	{
 		*propType = interactive_property_type::interactive_float_t;
 	}
-	else if (itr->value.IsArray())
+	else if (value->IsArray())
 	{
 		*propType = interactive_property_type::interactive_array_t;
 	}
-	else if (itr->value.IsObject())
+	else if (value->IsObject())
 	{
 		*propType = interactive_property_type::interactive_object_t;
 	}
@@ -125,6 +117,18 @@ int get_scene_object_prop_data(interactive_session_internal& session, const char
 	return MIXER_OK;
 }
 
+// Assumes caller holds read lock on scenes mutex. Returns the control's meta object, if it has one.
+const control_value* get_control_meta(interactive_session_internal& session, size_t slot)
+{
+	auto metaItr = session.controls.properties[slot].FindMember(RPC_METADATA);
+	if (metaItr == session.controls.properties[slot].MemberEnd() || !metaItr->value.IsObject())
+	{
+		return nullptr;
+	}
+
+	return &metaItr->value;
+}
+
 void parse_control(rapidjson::Value& controlJson, interactive_control& control)
 {
 	control.id = controlJson[RPC_CONTROL_ID].GetString();
@@ -139,40 +143,15 @@ void parse_control(rapidjson::Value& controlJson, interactive_control& control)
 int cache_new_control(interactive_session_internal& session, const char* sceneId, interactive_control& control, rapidjson::Value& controlJson)
 {
 	// Critical Section: Add a control to the scenes cache.
+	std::unique_lock<std::shared_mutex> scenesLock(session.scenesMutex);
+	size_t sceneIndex = session.controls.find_scene(sceneId);
+	if (CONTROL_STORE_NPOS == sceneIndex)
 	{
-		std::unique_lock<std::shared_mutex> scenesLock(session.scenesMutex);
-		if (session.controls.find(control.id) != session.controls.end())
-		{
-			return MIXER_ERROR_OBJECT_EXISTS;
-		}
-
-		auto sceneItr = session.scenes.find(sceneId);
-		if (sceneItr == session.scenes.end())
-		{
-			return MIXER_ERROR_OBJECT_NOT_FOUND;
-		}
-
-		std::string scenePtr = sceneItr->second;
-		rapidjson::Value* scene = rapidjson::Pointer(rapidjson::StringRef(scenePtr.c_str(), scenePtr.length())).Get(session.scenesRoot);
-
-		rapidjson::Document::AllocatorType& allocator = session.scenesRoot.GetAllocator();
-		auto controlsItr = scene->FindMember(RPC_PARAM_CONTROLS);
-		rapidjson::Value* controls;
-		if (controlsItr == scene->MemberEnd() || !controlsItr->value.IsArray())
-		{
-			controls = &scene->AddMember(RPC_PARAM_CONTROLS, rapidjson::Value(rapidjson::kArrayType), allocator);
-		}
-		else
-		{
-			controls = &controlsItr->value;
-		}
-
-		rapidjson::Value myControlJson(rapidjson::kObjectType);
-		myControlJson.CopyFrom(controlJson, session.scenesRoot.GetAllocator());
-		controls->PushBack(myControlJson, allocator);
+		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	RETURN_IF_FAILED(update_control_pointers(session, sceneId));
+	RETURN_IF_FAILED(session.controls.insert(sceneIndex, controlJson));
+	refresh_property_handles(session, control.id);
 
 	return MIXER_OK;
 }
@@ -180,69 +159,43 @@ int cache_new_control(interactive_session_internal& session, const char* sceneId
 int update_cached_control(interactive_session_internal& session, interactive_control& control, rapidjson::Value& controlJson)
 {
 	// Critical Section: Replace a control in the scenes cache.
+	std::unique_lock<std::shared_mutex> scenesLock(session.scenesMutex);
+	size_t slot = session.controls.find(control.id);
+	if (CONTROL_STORE_NPOS == slot)
 	{
-		std::unique_lock<std::shared_mutex> scenesLock(session.scenesMutex);
-		auto itr = session.controls.find(control.id);
-		if (itr == session.controls.end())
-		{
-			return MIXER_ERROR_OBJECT_NOT_FOUND;
-		}
-
-		std::string controlPtr = itr->second.cachePointer;
-		rapidjson::Value myControlJson(rapidjson::kObjectType);
-		myControlJson.CopyFrom(controlJson, session.scenesRoot.GetAllocator());
-		rapidjson::Pointer(rapidjson::StringRef(controlPtr.c_str(), controlPtr.length()))
-			.Swap(session.scenesRoot, myControlJson);
+		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
+	RETURN_IF_FAILED(session.controls.update(slot, controlJson));
+	refresh_property_handles(session, control.id);
+
 	return MIXER_OK;
 }
 
 int delete_cached_control(interactive_session_internal& session, const char* sceneId, interactive_control& control)
 {
 	// Critical Section: Erase the control if it exists on the scene.
+	std::unique_lock<std::shared_mutex> scenesLock(session.scenesMutex);
+	size_t slot = session.controls.find(control.id);
+	if (CONTROL_STORE_NPOS == slot || 0 != session.controls.sceneIds[session.controls.sceneIndices[slot]].compare(sceneId))
 	{
-		std::unique_lock<std::shared_mutex> scenesLock(session.scenesMutex);
-		if (session.controls.find(control.id) == session.controls.end())
-		{
-			// This control doesn't exist, ignore this deletion.
-			return MIXER_OK;
-		}
-
-		auto sceneItr = session.scenes.find(sceneId);
-		if (sceneItr == session.scenes.end())
-		{
-			return MIXER_ERROR_OBJECT_NOT_FOUND;
-		}
-
-		// Find the controls array on the scene.
-		std::string scenePtr = sceneItr->second;
-		rapidjson::Value* scene = rapidjson::Pointer(rapidjson::StringRef(scenePtr.c_str(), scenePtr.length())).Get(session.scenesRoot);
-		auto controlsItr = scene->FindMember(RPC_PARAM_CONTROLS);
-		if (controlsItr == scene->MemberEnd() || !controlsItr->value.IsArray())
-		{
-			// If the scene has no controls on it, ignore this deletion.
-			return MIXER_OK;
-		}
-
-		// Erase the value from the array.
-		rapidjson::Value* controls = &controlsItr->value;
-		for (rapidjson::Value* controlItr = controls->Begin(); controlItr != controls->End(); ++controlItr)
-		{
-			if (0 == strcmp(controlItr->GetObject()[RPC_CONTROL_ID].GetString(), control.id))
-			{
-				controls->Erase(controlItr);
-				break;
-			}
-		}
+		// This control doesn't exist on the scene, ignore this deletion.
+		return MIXER_OK;
 	}
 
-	RETURN_IF_FAILED(update_control_pointers(session, sceneId));
+	// Erasing moves the last control into this slot, refresh the handles of both controls.
+	std::string controlId = session.controls.ids[slot];
+	session.controls.erase(slot);
+	refresh_property_handles(session, controlId.c_str());
+	if (slot < session.controls.size())
+	{
+		refresh_property_handles(session, session.controls.ids[slot].c_str());
+	}
 
 	return MIXER_OK;
 }
 
-int safe_get_value(rapidjson::Value* jsonValue, int* value)
+int safe_get_value(const control_value* jsonValue, int* value)
 {
 	if (!jsonValue->IsInt())
 	{
@@ -253,7 +206,7 @@ int safe_get_value(rapidjson::Value* jsonValue, int* value)
 	return MIXER_OK;
 }
 
-int safe_get_value(rapidjson::Value* jsonValue, long long* value)
+int safe_get_value(const control_value* jsonValue, long long* value)
 {
 	if (!jsonValue->IsInt64())
 	{
@@ -264,7 +217,7 @@ int safe_get_value(rapidjson::Value* jsonValue, long long* value)
 	return MIXER_OK;
 }
 
-int safe_get_value(rapidjson::Value* jsonValue, bool* value)
+int safe_get_value(const control_value* jsonValue, bool* value)
 {
 	if (!jsonValue->IsBool())
 	{
@@ -275,7 +228,7 @@ int safe_get_value(rapidjson::Value* jsonValue, bool* value)
 	return MIXER_OK;
 }
 
-int safe_get_value(rapidjson::Value* jsonValue, float* value)
+int safe_get_value(const control_value* jsonValue, float* value)
 {
 	if (!jsonValue->IsFloat())
 	{
@@ -286,7 +239,7 @@ int safe_get_value(rapidjson::Value* jsonValue, float* value)
 	return MIXER_OK;
 }
 
-int safe_get_value(rapidjson::Value* jsonValue, std::string* value)
+int safe_get_value(const control_value* jsonValue, std::string* value)
 {
 	if (!jsonValue->IsString())
 	{
@@ -318,14 +271,14 @@ int interactive_control_get_property(interactive_session session, const char* co
 	}
 
 	std::shared_lock<std::shared_mutex> scenesReadLock(sessionInternal->scenesMutex);
-	auto controlItr = sessionInternal->controls.find(std::string(controlId));
-	if (controlItr == sessionInternal->controls.end())
+	size_t slot = sessionInternal->controls.find(controlId);
+	if (CONTROL_STORE_NPOS == slot)
 	{
 		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	std::string controlPointer = controlItr->second.cachePointer + "/" + std::string(key);
-	rapidjson::Value* controlValue = rapidjson::Pointer(controlPointer.c_str()).Get(sessionInternal->scenesRoot);
+	control_value scratch;
+	const control_value* controlValue = sessionInternal->controls.get(slot, key, scratch);
 	if (nullptr == controlValue)
 	{
 		return MIXER_ERROR_PROPERTY_NOT_FOUND;
@@ -334,6 +287,150 @@ int interactive_control_get_property(interactive_session session, const char* co
 	return safe_get_value(controlValue, prop);
 }
 
+rapidjson::Value property_value(const rapidjson::Value& prop, rapidjson::Document::AllocatorType& allocator)
+{
+	return rapidjson::Value(prop, allocator);
+}
+
+rapidjson::Value property_value(int prop, rapidjson::Document::AllocatorType&)
+{
+	return rapidjson::Value(prop);
+}
+
+rapidjson::Value property_value(int64_t prop, rapidjson::Document::AllocatorType&)
+{
+	return rapidjson::Value(prop);
+}
+
+rapidjson::Value property_value(bool prop, rapidjson::Document::AllocatorType&)
+{
+	return rapidjson::Value(prop);
+}
+
+rapidjson::Value property_value(float prop, rapidjson::Document::AllocatorType&)
+{
+	return rapidjson::Value((double)prop);
+}
+
+rapidjson::Value property_value(const std::string& prop, rapidjson::Document::AllocatorType& allocator)
+{
+	return rapidjson::Value(prop, allocator);
+}
+
+// Find the named object member, adding an empty object if it does not exist yet.
+rapidjson::Value& get_or_add_object(rapidjson::Value& parent, const std::string& name, rapidjson::Document::AllocatorType& allocator)
+{
+	auto memberItr = parent.FindMember(rapidjson::StringRef(name.c_str(), name.length()));
+	if (parent.MemberEnd() != memberItr)
+	{
+		return memberItr->value;
+	}
+
+	parent.AddMember(rapidjson::Value(name, allocator), rapidjson::Value(rapidjson::kObjectType), allocator);
+	return (parent.MemberEnd() - 1)->value;
+}
+
+int flush_control_updates(interactive_session_internal& session)
+{
+	// Critical Section: Send the pending batch and start a new one.
+	std::unique_lock<std::mutex> updatesLock(session.controlUpdatesMutex);
+	if (0 == session.controlUpdatesPending)
+	{
+		return MIXER_OK;
+	}
+
+	// Send a single updateControls per scene.
+	int err = MIXER_OK;
+	size_t methodsSent = 0;
+	for (auto sceneItr = session.controlUpdates.MemberBegin(); sceneItr != session.controlUpdates.MemberEnd(); ++sceneItr)
+	{
+		err = queue_method(session, RPC_METHOD_UPDATE_CONTROLS, [&](method_writer& writer)
+		{
+			writer.StartObject();
+			writer.Key(RPC_SCENE_ID);
+			writer.String(sceneItr->name.GetString(), sceneItr->name.GetStringLength());
+			writer.Key(RPC_PARAM_CONTROLS);
+			writer.StartArray();
+			for (auto controlItr = sceneItr->value.MemberBegin(); controlItr != sceneItr->value.MemberEnd(); ++controlItr)
+			{
+				writer.StartObject();
+				writer.Key(RPC_CONTROL_ID);
+				writer.String(controlItr->name.GetString(), controlItr->name.GetStringLength());
+				for (auto propertyItr = controlItr->value.MemberBegin(); propertyItr != controlItr->value.MemberEnd(); ++propertyItr)
+				{
+					writer.Key(propertyItr->name.GetString(), propertyItr->name.GetStringLength());
+					propertyItr->value.Accept(writer);
+				}
+				writer.EndObject();
+			}
+			writer.EndArray();
+			writer.EndObject();
+		}, nullptr);
+
+		if (err)
+		{
+			break;
+		}
+
+		++methodsSent;
+	}
+
+	// Only the scenes that were queued count as saved frames, the rest stay pending for the next flush.
+	size_t writesSent = 0;
+	for (size_t i = 0; i < methodsSent; ++i)
+	{
+		writesSent += session.controlUpdatesPerScene[i];
+	}
+
+	session.controlUpdateStats.methodsSent += methodsSent;
+	session.controlUpdateStats.framesSaved += writesSent - methodsSent;
+	session.controlUpdatesPending -= writesSent;
+	if (0 == session.controlUpdatesPending)
+	{
+		session.controlUpdatesPerScene.clear();
+		session.controlUpdates.SetObject();
+		session.controlUpdates.GetAllocator().Clear();
+	}
+	else
+	{
+		session.controlUpdatesPerScene.erase(session.controlUpdatesPerScene.begin(), session.controlUpdatesPerScene.begin() + methodsSent);
+		session.controlUpdates.EraseMember(session.controlUpdates.MemberBegin(), session.controlUpdates.MemberBegin() + methodsSent);
+	}
+
+	return err;
+}
+
+// Merge a property write into the pending batch for the control's scene, replacing any pending value for the same key.
+template <typename T>
+void queue_control_update(interactive_session_internal& session, const std::string& sceneId, const std::string& controlId, const char* key, T prop)
+{
+	// Critical Section: The pending batch is shared with the thread flushing it.
+	std::unique_lock<std::mutex> updatesLock(session.controlUpdatesMutex);
+	rapidjson::Document::AllocatorType& allocator = session.controlUpdates.GetAllocator();
+	auto sceneItr = session.controlUpdates.FindMember(rapidjson::StringRef(sceneId.c_str(), sceneId.length()));
+	if (session.controlUpdates.MemberEnd() == sceneItr)
+	{
+		session.controlUpdates.AddMember(rapidjson::Value(sceneId, allocator), rapidjson::Value(rapidjson::kObjectType), allocator);
+		session.controlUpdatesPerScene.push_back(0);
+		sceneItr = session.controlUpdates.MemberEnd() - 1;
+	}
+
+	++session.controlUpdatesPerScene[sceneItr - session.controlUpdates.MemberBegin()];
+	rapidjson::Value& control = get_or_add_object(sceneItr->value, controlId, allocator);
+	auto propertyItr = control.FindMember(key);
+	if (control.MemberEnd() != propertyItr)
+	{
+		propertyItr->value = property_value(prop, allocator);
+	}
+	else
+	{
+		control.AddMember(rapidjson::Value(key, allocator), property_value(prop, allocator), allocator);
+	}
+
+	++session.controlUpdatesPending;
+	++session.controlUpdateStats.propertyWrites;
+}
+
 template <typename T>
 int interactive_control_set_property(interactive_session session, const char* controlId, const char* key, T prop)
 {
@@ -350,28 +447,72 @@ int interactive_control_set_property(interactive_session session, const char* co
 
 	// Find the control
 	std::shared_lock<std::shared_mutex> l(sessionInternal->scenesMutex);
-	auto controlItr = sessionInternal->controls.find(controlId);
-	if (sessionInternal->controls.end() == controlItr)
+	size_t slot = sessionInternal->controls.find(controlId);
+	if (CONTROL_STORE_NPOS == slot)
 	{
 		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	RETURN_IF_FAILED(queue_method(*sessionInternal, RPC_METHOD_UPDATE_CONTROLS, [&](rapidjson::Document::AllocatorType& allocator, rapidjson::Value& params)
+	const interactive_control_store& controls = sessionInternal->controls;
+	queue_control_update<T>(*sessionInternal, controls.sceneIds[controls.sceneIndices[slot]], controls.ids[slot], key, prop);
+
+	return MIXER_OK;
+}
+
+template <typename T>
+int interactive_property_get(interactive_session session, interactive_property_handle handle, T* property)
+{
+	if (nullptr == session || nullptr == property)
 	{
-		params.AddMember(RPC_SCENE_ID, controlItr->second.sceneId, allocator);
-		rapidjson::Value controlsArray(rapidjson::kArrayType);
-		// Create a control object with an id.
-		rapidjson::Value controlObj(rapidjson::kObjectType);
-		controlObj.AddMember(RPC_CONTROL_ID, std::string(controlId), allocator);
+		return MIXER_ERROR_INVALID_POINTER;
+	}
 
-		// Add a null value to the object with the given key.
-		rapidjson::Value keyVal(rapidjson::kStringType);
-		keyVal.SetString(std::string(key), allocator);
-		controlObj.AddMember(keyVal, prop, allocator);
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	if (interactive_connected > sessionInternal->state)
+	{
+		return MIXER_ERROR_NOT_CONNECTED;
+	}
 
-		controlsArray.PushBack(controlObj, allocator);
-		params.AddMember(RPC_PARAM_CONTROLS, controlsArray, allocator);
-	}, nullptr));
+	std::shared_lock<std::shared_mutex> scenesReadLock(sessionInternal->scenesMutex);
+	if (handle >= sessionInternal->propertyHandles.size() || CONTROL_STORE_NPOS == sessionInternal->propertyHandles[handle].control)
+	{
+		return MIXER_ERROR_OBJECT_NOT_FOUND;
+	}
+
+	const interactive_property_handle_internal& handleInternal = sessionInternal->propertyHandles[handle];
+	control_value scratch;
+	const control_value* value = get_property_handle_value(*sessionInternal, handleInternal, scratch);
+	if (nullptr == value)
+	{
+		return MIXER_ERROR_PROPERTY_NOT_FOUND;
+	}
+
+	return safe_get_value(value, property);
+}
+
+template <typename T>
+int interactive_property_set(interactive_session session, interactive_property_handle handle, T property)
+{
+	if (nullptr == session)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	if (interactive_connected > sessionInternal->state)
+	{
+		return MIXER_ERROR_NOT_CONNECTED;
+	}
+
+	std::shared_lock<std::shared_mutex> scenesReadLock(sessionInternal->scenesMutex);
+	if (handle >= sessionInternal->propertyHandles.size() || CONTROL_STORE_NPOS == sessionInternal->propertyHandles[handle].control)
+	{
+		return MIXER_ERROR_OBJECT_NOT_FOUND;
+	}
+
+	const interactive_property_handle_internal& handleInternal = sessionInternal->propertyHandles[handle];
+	const interactive_control_store& controls = sessionInternal->controls;
+	queue_control_update<T>(*sessionInternal, controls.sceneIds[controls.sceneIndices[handleInternal.control]], handleInternal.controlId, handleInternal.key.c_str(), property);
 
 	return MIXER_OK;
 }
@@ -379,8 +520,38 @@ int interactive_control_set_property(interactive_session session, const char* co
 template <typename T>
 int interactive_control_get_meta_property(interactive_session session, const char* controlId, const char* key, T* property)
 {
-	std::string metaKey = std::string(RPC_METADATA) + "/" + std::string(key) + "/value";
-	return interactive_control_get_property<T>(session, controlId, metaKey.c_str(), property);
+	if (nullptr == session || nullptr == controlId || nullptr == key || nullptr == property)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	if (interactive_connected > sessionInternal->state)
+	{
+		return MIXER_ERROR_NOT_CONNECTED;
+	}
+
+	std::shared_lock<std::shared_mutex> scenesReadLock(sessionInternal->scenesMutex);
+	size_t slot = sessionInternal->controls.find(controlId);
+	if (CONTROL_STORE_NPOS == slot)
+	{
+		return MIXER_ERROR_OBJECT_NOT_FOUND;
+	}
+
+	// Metadata properties are stored in a sub-"value".
+	const control_value* meta = get_control_meta(*sessionInternal, slot);
+	if (nullptr == meta)
+	{
+		return MIXER_ERROR_PROPERTY_NOT_FOUND;
+	}
+
+	auto metaItr = meta->FindMember(key);
+	if (metaItr == meta->MemberEnd() || !metaItr->value.IsObject() || !metaItr->value.HasMember(RPC_VALUE))
+	{
+		return MIXER_ERROR_PROPERTY_NOT_FOUND;
+	}
+
+	return safe_get_value(&metaItr->value[RPC_VALUE], property);
 }
 
 }
@@ -407,18 +578,27 @@ int interactive_control_trigger_cooldown(interactive_session session, const char
 		RETURN_IF_FAILED(get_control_scene_id(*sessionInternal, controlId, controlSceneId));
 	}
 
-	long long cooldownTimestamp = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()).time_since_epoch().count() - sessionInternal->serverTimeOffsetMs + cooldownMs;
-	RETURN_IF_FAILED(queue_method(*sessionInternal, RPC_METHOD_UPDATE_CONTROLS, [&](rapidjson::Document::AllocatorType& allocator, rapidjson::Value& params)
-	{
-		params.AddMember(RPC_SCENE_ID, controlSceneId, allocator);
-		params.AddMember("priority", 1, allocator);
-
-		rapidjson::Value controls(rapidjson::kArrayType);
-		rapidjson::Value control(rapidjson::kObjectType);
-		control.AddMember(RPC_CONTROL_ID, std::string(controlId), allocator);
-		control.AddMember(RPC_CONTROL_BUTTON_COOLDOWN, cooldownTimestamp, allocator);
-		controls.PushBack(std::move(control), allocator);
-		params.AddMember(RPC_PARAM_CONTROLS, std::move(controls), allocator);
+	// Send any batched updates first so the cooldown is not overwritten by an older update.
+	RETURN_IF_FAILED(flush_control_updates(*sessionInternal));
+
+	int64_t cooldownTimestamp = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()).time_since_epoch().count() - sessionInternal->serverTimeOffsetMs + cooldownMs;
+	RETURN_IF_FAILED(queue_method(*sessionInternal, RPC_METHOD_UPDATE_CONTROLS, [&](method_writer& writer)
+	{
+		writer.StartObject();
+		writer.Key(RPC_SCENE_ID);
+		writer.String(controlSceneId);
+		writer.Key("priority");
+		writer.Int(1);
+		writer.Key(RPC_PARAM_CONTROLS);
+		writer.StartArray();
+		writer.StartObject();
+		writer.Key(RPC_CONTROL_ID);
+		writer.String(controlId);
+		writer.Key(RPC_CONTROL_BUTTON_COOLDOWN);
+		writer.Int64(cooldownTimestamp);
+		writer.EndObject();
+		writer.EndArray();
+		writer.EndObject();
 	}, nullptr));
 
 	return MIXER_OK;
@@ -440,13 +620,14 @@ int interactive_control_get_property_count(interactive_session session, const ch
 	}
 
 	std::shared_lock<std::shared_mutex> scenesReadLock(sessionInternal->scenesMutex);
-	auto controlItr = sessionInternal->controls.find(controlId);
-	if (controlItr == sessionInternal->controls.end())
+	size_t slot = sessionInternal->controls.find(controlId);
+	if (CONTROL_STORE_NPOS == slot)
 	{
 		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	return get_scene_object_prop_count(*sessionInternal, controlItr->second.cachePointer.c_str(), count);
+	*count = sessionInternal->controls.property_count(slot);
+	return MIXER_OK;
 }
 
 int interactive_control_get_meta_property_count(interactive_session session, const char* controlId, size_t* count)
@@ -465,14 +646,20 @@ int interactive_control_get_meta_property_count(interactive_session session, con
 	}
 
 	std::shared_lock<std::shared_mutex> scenesReadLock(sessionInternal->scenesMutex);
-	auto controlItr = sessionInternal->controls.find(std::string(controlId));
-	if (controlItr == sessionInternal->controls.end())
+	size_t slot = sessionInternal->controls.find(controlId);
+	if (CONTROL_STORE_NPOS == slot)
+	{
+		return MIXER_ERROR_OBJECT_NOT_FOUND;
+	}
+
+	const control_value* meta = get_control_meta(*sessionInternal, slot);
+	if (nullptr == meta)
 	{
 		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	std::string metaPropPointer = controlItr->second.cachePointer + "/" + RPC_METADATA;
-	return get_scene_object_prop_count(*sessionInternal, metaPropPointer.c_str(), count);
+	*count = meta->MemberCount();
+	return MIXER_OK;
 }
 
 int interactive_control_get_property_data(interactive_session session, const char* controlId, size_t index, char* propName, size_t* propNameLength, interactive_property_type* propType)
@@ -491,14 +678,16 @@ int interactive_control_get_property_data(interactive_session session, const cha
 	}
 
 	std::shared_lock<std::shared_mutex> scenesReadLock(sessionInternal->scenesMutex);
-	auto controlItr = sessionInternal->controls.find(controlId);
-	if (controlItr == sessionInternal->controls.end())
+	size_t slot = sessionInternal->controls.find(controlId);
+	if (CONTROL_STORE_NPOS == slot)
 	{
 		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	const std::string& controlPointer = controlItr->second.cachePointer;
-	return get_scene_object_prop_data(*sessionInternal, controlPointer.c_str(), index, propName, propNameLength, propType);
+	const char* name = nullptr;
+	control_value scratch;
+	const control_value* value = sessionInternal->controls.property_at(slot, index, &name, scratch);
+	return get_control_prop_data(name, value, propName, propNameLength, propType);
 }
 
 int interactive_control_get_meta_property_data(interactive_session session, const char* controlId, size_t index, char* propName, size_t* propNameLength, interactive_property_type* propType)
@@ -517,25 +706,35 @@ int interactive_control_get_meta_property_data(interactive_session session, cons
 	}
 
 	std::shared_lock<std::shared_mutex> scenesReadLock(sessionInternal->scenesMutex);
-	auto controlItr = sessionInternal->controls.find(std::string(controlId));
-	if (controlItr == sessionInternal->controls.end())
+	size_t slot = sessionInternal->controls.find(controlId);
+	if (CONTROL_STORE_NPOS == slot)
+	{
+		return MIXER_ERROR_OBJECT_NOT_FOUND;
+	}
+
+	const control_value* meta = get_control_meta(*sessionInternal, slot);
+	if (nullptr == meta)
 	{
 		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	std::string controlPointer = controlItr->second.cachePointer + "/" + RPC_METADATA;
+	if (meta->MemberCount() <= index)
+	{
+		return MIXER_ERROR_PROPERTY_NOT_FOUND;
+	}
+
+	// Metadata properties are stored in a sub-"value", report the type of that value.
+	auto metaItr = meta->MemberBegin() + index;
 	interactive_property_type valueType = interactive_property_type::interactive_unknown_t;
-	int err = get_scene_object_prop_data(*sessionInternal, controlPointer.c_str(), index, propName, propNameLength, &valueType);
-	if (MIXER_OK == err)
+	RETURN_IF_FAILED(get_control_prop_data(metaItr->name.GetString(), &metaItr->value, propName, propNameLength, &valueType));
+	if (!metaItr->value.IsObject() || !metaItr->value.HasMember(RPC_VALUE))
 	{
-		// Metadata properties are stored in a sub-"value" for some reason.
-		controlPointer = controlPointer + "/" + propName;
-		char value[6]; // To store "value"
-		size_t valueLength = sizeof(value);
-		return get_scene_object_prop_data(*sessionInternal, controlPointer.c_str(), 0, value, &valueLength, propType);
+		return MIXER_ERROR_PROPERTY_NOT_FOUND;
 	}
 
-	return err;
+	char value[6]; // To store "value"
+	size_t valueLength = sizeof(value);
+	return get_control_prop_data(RPC_VALUE, &metaItr->value[RPC_VALUE], value, &valueLength, propType);
 }
 
 int interactive_control_get_property_int(interactive_session session, const char* controlId, const char* key, int* property)
@@ -584,6 +783,161 @@ int interactive_control_get_property_string(interactive_session session, const c
 	return MIXER_OK;
 }
 
+int interactive_control_flush_updates(interactive_session session)
+{
+	if (nullptr == session)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	return flush_control_updates(*sessionInternal);
+}
+
+int interactive_control_get_update_stats(interactive_session session, interactive_control_update_stats* stats)
+{
+	if (nullptr == session || nullptr == stats)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	std::unique_lock<std::mutex> updatesLock(sessionInternal->controlUpdatesMutex);
+	*stats = sessionInternal->controlUpdateStats;
+
+	return MIXER_OK;
+}
+
+int interactive_control_get_property_handle(interactive_session session, const char* controlId, const char* key, interactive_property_handle* handle)
+{
+	if (nullptr == session || nullptr == controlId || nullptr == key || nullptr == handle)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	if (interactive_connected > sessionInternal->state)
+	{
+		return MIXER_ERROR_NOT_CONNECTED;
+	}
+
+	// Critical Section: Resolve the property and add it to the session's handles.
+	std::unique_lock<std::shared_mutex> scenesLock(sessionInternal->scenesMutex);
+	if (CONTROL_STORE_NPOS == sessionInternal->controls.find(controlId))
+	{
+		return MIXER_ERROR_OBJECT_NOT_FOUND;
+	}
+
+	auto name = std::make_pair(std::string(controlId), std::string(key));
+	auto handleItr = sessionInternal->propertyHandlesByName.find(name);
+	if (handleItr == sessionInternal->propertyHandlesByName.end())
+	{
+		sessionInternal->propertyHandles.emplace_back(name.first, name.second);
+		resolve_property_handle(*sessionInternal, sessionInternal->propertyHandles.back());
+		handleItr = sessionInternal->propertyHandlesByName.emplace(std::move(name), sessionInternal->propertyHandles.size() - 1).first;
+	}
+
+	*handle = (interactive_property_handle)handleItr->second;
+
+	return MIXER_OK;
+}
+
+int interactive_property_get_int(interactive_session session, interactive_property_handle handle, int* property)
+{
+	return interactive_property_get<int>(session, handle, property);
+}
+
+int interactive_property_get_int64(interactive_session session, interactive_property_handle handle, long long* property)
+{
+	return interactive_property_get<long long>(session, handle, property);
+}
+
+int interactive_property_get_bool(interactive_session session, interactive_property_handle handle, bool* property)
+{
+	return interactive_property_get<bool>(session, handle, property);
+}
+
+int interactive_property_get_float(interactive_session session, interactive_property_handle handle, float* property)
+{
+	return interactive_property_get<float>(session, handle, property);
+}
+
+int interactive_property_get_string(interactive_session session, interactive_property_handle handle, char* property, size_t* propertyLength)
+{
+	if (nullptr == session || nullptr == propertyLength)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	if (interactive_connected > sessionInternal->state)
+	{
+		return MIXER_ERROR_NOT_CONNECTED;
+	}
+
+	std::shared_lock<std::shared_mutex> scenesReadLock(sessionInternal->scenesMutex);
+	if (handle >= sessionInternal->propertyHandles.size() || CONTROL_STORE_NPOS == sessionInternal->propertyHandles[handle].control)
+	{
+		return MIXER_ERROR_OBJECT_NOT_FOUND;
+	}
+
+	const interactive_property_handle_internal& handleInternal = sessionInternal->propertyHandles[handle];
+	control_value scratch;
+	const control_value* value = get_property_handle_value(*sessionInternal, handleInternal, scratch);
+	if (nullptr == value)
+	{
+		return MIXER_ERROR_PROPERTY_NOT_FOUND;
+	}
+
+	if (!value->IsString())
+	{
+		return MIXER_ERROR_INVALID_PROPERTY_TYPE;
+	}
+
+	size_t actualLength = value->GetStringLength();
+	if (nullptr == property || *propertyLength < actualLength + 1)
+	{
+		*propertyLength = actualLength + 1;
+		return MIXER_ERROR_BUFFER_SIZE;
+	}
+
+	memcpy(property, value->GetString(), actualLength);
+	property[actualLength] = 0;
+	*propertyLength = actualLength + 1;
+
+	return MIXER_OK;
+}
+
+int interactive_property_set_int(interactive_session session, interactive_property_handle handle, int property)
+{
+	return interactive_property_set<int>(session, handle, property);
+}
+
+int interactive_property_set_int64(interactive_session session, interactive_property_handle handle, long long property)
+{
+	return interactive_property_set<int64_t>(session, handle, property);
+}
+
+int interactive_property_set_bool(interactive_session session, interactive_property_handle handle, bool property)
+{
+	return interactive_property_set<bool>(session, handle, property);
+}
+
+int interactive_property_set_float(interactive_session session, interactive_property_handle handle, float property)
+{
+	return interactive_property_set<float>(session, handle, property);
+}
+
+int interactive_property_set_string(interactive_session session, interactive_property_handle handle, const char* property)
+{
+	if (nullptr == property)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	return interactive_property_set<std::string>(session, handle, property);
+}
+
 int interactive_control_set_property_null(interactive_session session, const char* controlId, const char* key)
 {
 	rapidjson::Value val(rapidjson::kNullType);
@@ -597,7 +951,7 @@ int interactive_control_set_property_int(interactive_session session, const char
 
 int interactive_control_set_property_int64(interactive_session session, const char* controlId, const char* key, long long property)
 {
-	return interactive_control_set_property<long long>(session, controlId, key, property);
+	return interactive_control_set_property<int64_t>(session, controlId, key, property);
 }
 
 int interactive_control_set_property_bool(interactive_session session, const char* controlId, const char* key, bool property)
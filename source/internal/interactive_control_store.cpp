@@ -0,0 +1,461 @@
+#include "interactive_control_store.h"
+#include "interactive_session.h"
+
+namespace mixer_internal
+{
+
+static const control_field s_controlFields[] =
+{
+	control_field_kind,
+	control_field_disabled,
+	control_field_cost,
+	control_field_cooldown,
+	control_field_progress,
+	control_field_text,
+	control_field_position
+};
+
+static const char* control_field_name(control_field field)
+{
+	switch (field)
+	{
+	case control_field_kind:
+		return RPC_CONTROL_KIND;
+	case control_field_disabled:
+		return RPC_DISABLED;
+	case control_field_cost:
+		return RPC_SPARK_COST;
+	case control_field_cooldown:
+		return RPC_CONTROL_BUTTON_COOLDOWN;
+	case control_field_progress:
+		return RPC_CONTROL_BUTTON_PROGRESS;
+	case control_field_text:
+		return RPC_CONTROL_BUTTON_TEXT;
+	case control_field_position:
+		return RPC_CONTROL_POSITION;
+	default:
+		return nullptr;
+	}
+}
+
+control_field find_control_field(const char* key)
+{
+	for (control_field field : s_controlFields)
+	{
+		if (0 == strcmp(key, control_field_name(field)))
+		{
+			return field;
+		}
+	}
+
+	return control_field_none;
+}
+
+// Deep copy a message value, copying every string so the result does not reference the message buffer.
+static void copy_value(const rapidjson::Value& source, control_value& target, rapidjson::CrtAllocator& allocator)
+{
+	switch (source.GetType())
+	{
+	case rapidjson::kObjectType:
+		target.SetObject();
+		for (auto itr = source.MemberBegin(); itr != source.MemberEnd(); ++itr)
+		{
+			control_value name(itr->name.GetString(), itr->name.GetStringLength(), allocator);
+			control_value value;
+			copy_value(itr->value, value, allocator);
+			target.AddMember(name, value, allocator);
+		}
+		break;
+	case rapidjson::kArrayType:
+		target.SetArray();
+		target.Reserve(source.Size(), allocator);
+		for (auto itr = source.Begin(); itr != source.End(); ++itr)
+		{
+			control_value value;
+			copy_value(*itr, value, allocator);
+			target.PushBack(value, allocator);
+		}
+		break;
+	case rapidjson::kStringType:
+		target.SetString(source.GetString(), source.GetStringLength(), allocator);
+		break;
+	case rapidjson::kNumberType:
+		if (source.IsInt())
+		{
+			target.SetInt(source.GetInt());
+		}
+		else if (source.IsUint())
+		{
+			target.SetUint(source.GetUint());
+		}
+		else if (source.IsInt64())
+		{
+			target.SetInt64(source.GetInt64());
+		}
+		else if (source.IsUint64())
+		{
+			target.SetUint64(source.GetUint64());
+		}
+		else
+		{
+			target.SetDouble(source.GetDouble());
+		}
+		break;
+	case rapidjson::kTrueType:
+	case rapidjson::kFalseType:
+		target.SetBool(source.GetBool());
+		break;
+	default:
+		target.SetNull();
+		break;
+	}
+}
+
+void interactive_control_store::clear()
+{
+	sceneIds.clear();
+	sceneIndexById.clear();
+	sceneSlots.clear();
+	ids.clear();
+	sceneIndices.clear();
+	sceneOffsets.clear();
+	fields.clear();
+	kinds.clear();
+	disabled.clear();
+	costs.clear();
+	cooldowns.clear();
+	progress.clear();
+	texts.clear();
+	positions.clear();
+	properties.clear();
+	indexById.clear();
+}
+
+size_t interactive_control_store::add_scene(const std::string& sceneId)
+{
+	auto sceneItr = sceneIndexById.find(sceneId);
+	if (sceneItr != sceneIndexById.end())
+	{
+		return sceneItr->second;
+	}
+
+	sceneIds.push_back(sceneId);
+	sceneIndexById.emplace(sceneId, sceneIds.size() - 1);
+	sceneSlots.emplace_back();
+	return sceneIds.size() - 1;
+}
+
+size_t interactive_control_store::find_scene(const std::string& sceneId) const
+{
+	auto sceneItr = sceneIndexById.find(sceneId);
+	return sceneItr == sceneIndexById.end() ? CONTROL_STORE_NPOS : sceneItr->second;
+}
+
+size_t interactive_control_store::find(const std::string& controlId) const
+{
+	auto controlItr = indexById.find(controlId);
+	return controlItr == indexById.end() ? CONTROL_STORE_NPOS : controlItr->second;
+}
+
+size_t interactive_control_store::size() const
+{
+	return ids.size();
+}
+
+int interactive_control_store::insert(size_t sceneIndex, const rapidjson::Value& controlJson, size_t* slot)
+{
+	if (sceneIndex >= sceneIds.size())
+	{
+		return MIXER_ERROR_OBJECT_NOT_FOUND;
+	}
+
+	if (!controlJson.IsObject() || !controlJson.HasMember(RPC_CONTROL_ID) || !controlJson[RPC_CONTROL_ID].IsString())
+	{
+		return MIXER_ERROR_UNRECOGNIZED_DATA_FORMAT;
+	}
+
+	std::string controlId(controlJson[RPC_CONTROL_ID].GetString(), controlJson[RPC_CONTROL_ID].GetStringLength());
+	if (indexById.end() != indexById.find(controlId))
+	{
+		return MIXER_ERROR_OBJECT_EXISTS;
+	}
+
+	size_t newSlot = ids.size();
+	ids.emplace_back(std::move(controlId));
+	sceneIndices.push_back(sceneIndex);
+	sceneOffsets.push_back(sceneSlots[sceneIndex].size());
+	sceneSlots[sceneIndex].push_back(newSlot);
+	fields.push_back(control_field_none);
+	kinds.emplace_back();
+	disabled.push_back(false);
+	costs.push_back(0);
+	cooldowns.push_back(0);
+	progress.push_back(0);
+	texts.emplace_back();
+	positions.emplace_back();
+	properties.emplace_back();
+	indexById.emplace(ids.back(), newSlot);
+	assign(newSlot, controlJson);
+
+	if (nullptr != slot)
+	{
+		*slot = newSlot;
+	}
+
+	return MIXER_OK;
+}
+
+int interactive_control_store::update(size_t slot, const rapidjson::Value& controlJson)
+{
+	if (slot >= ids.size() || !controlJson.IsObject())
+	{
+		return MIXER_ERROR_OBJECT_NOT_FOUND;
+	}
+
+	assign(slot, controlJson);
+	return MIXER_OK;
+}
+
+void interactive_control_store::erase(size_t slot)
+{
+	if (slot >= ids.size())
+	{
+		return;
+	}
+
+	// Remove the control from its scene's list, moving the scene's last control into its place.
+	std::vector<size_t>& controlSlots = sceneSlots[sceneIndices[slot]];
+	size_t movedSlot = controlSlots.back();
+	controlSlots[sceneOffsets[slot]] = movedSlot;
+	sceneOffsets[movedSlot] = sceneOffsets[slot];
+	controlSlots.pop_back();
+
+	indexById.erase(ids[slot]);
+	size_t last = ids.size() - 1;
+	if (slot != last)
+	{
+		// Move the last control into the vacated slot.
+		ids[slot] = std::move(ids[last]);
+		sceneIndices[slot] = sceneIndices[last];
+		sceneOffsets[slot] = sceneOffsets[last];
+		sceneSlots[sceneIndices[slot]][sceneOffsets[slot]] = slot;
+		fields[slot] = fields[last];
+		kinds[slot] = std::move(kinds[last]);
+		disabled[slot] = disabled[last];
+		costs[slot] = costs[last];
+		cooldowns[slot] = cooldowns[last];
+		progress[slot] = progress[last];
+		texts[slot] = std::move(texts[last]);
+		positions[slot] = std::move(positions[last]);
+		properties[slot] = std::move(properties[last]);
+		indexById[ids[slot]] = slot;
+	}
+
+	ids.pop_back();
+	sceneIndices.pop_back();
+	sceneOffsets.pop_back();
+	fields.pop_back();
+	kinds.pop_back();
+	disabled.pop_back();
+	costs.pop_back();
+	cooldowns.pop_back();
+	progress.pop_back();
+	texts.pop_back();
+	positions.pop_back();
+	properties.pop_back();
+}
+
+void interactive_control_store::assign(size_t slot, const rapidjson::Value& controlJson)
+{
+	rapidjson::CrtAllocator allocator;
+	unsigned int controlFields = control_field_none;
+	kinds[slot].clear();
+	texts[slot].clear();
+	positions[slot].SetNull();
+	properties[slot].SetObject();
+
+	for (auto itr = controlJson.MemberBegin(); itr != controlJson.MemberEnd(); ++itr)
+	{
+		const char* name = itr->name.GetString();
+		const rapidjson::Value& value = itr->value;
+		if (0 == strcmp(name, RPC_CONTROL_ID))
+		{
+			continue;
+		}
+
+		// Values that do not have the expected type for their column are kept with the other properties.
+		control_field field = find_control_field(name);
+		bool typed = true;
+		switch (field)
+		{
+		case control_field_kind:
+			typed = value.IsString();
+			if (typed)
+			{
+				kinds[slot].assign(value.GetString(), value.GetStringLength());
+			}
+			break;
+		case control_field_disabled:
+			typed = value.IsBool();
+			if (typed)
+			{
+				disabled[slot] = value.GetBool();
+			}
+			break;
+		case control_field_cost:
+			typed = value.IsInt();
+			if (typed)
+			{
+				costs[slot] = value.GetInt();
+			}
+			break;
+		case control_field_cooldown:
+			typed = value.IsInt64();
+			if (typed)
+			{
+				cooldowns[slot] = value.GetInt64();
+			}
+			break;
+		case control_field_progress:
+			// Whole number progress values are kept with the other properties so they still read back as integers.
+			typed = value.IsDouble();
+			if (typed)
+			{
+				progress[slot] = value.GetDouble();
+			}
+			break;
+		case control_field_text:
+			typed = value.IsString();
+			if (typed)
+			{
+				texts[slot].assign(value.GetString(), value.GetStringLength());
+			}
+			break;
+		case control_field_position:
+			typed = value.IsArray();
+			if (typed)
+			{
+				copy_value(value, positions[slot], allocator);
+			}
+			break;
+		default:
+			typed = false;
+			break;
+		}
+
+		if (typed)
+		{
+			controlFields |= field;
+		}
+		else
+		{
+			control_value propertyName(name, itr->name.GetStringLength(), allocator);
+			control_value propertyValue;
+			copy_value(value, propertyValue, allocator);
+			properties[slot].AddMember(propertyName, propertyValue, allocator);
+		}
+	}
+
+	fields[slot] = controlFields;
+}
+
+const control_value* interactive_control_store::get(size_t slot, const char* key, control_value& scratch) const
+{
+	if (0 == strcmp(key, RPC_CONTROL_ID))
+	{
+		scratch.SetString(ids[slot].c_str(), (rapidjson::SizeType)ids[slot].length());
+		return &scratch;
+	}
+
+	control_field field = find_control_field(key);
+	if (control_field_none != field && 0 != (fields[slot] & field))
+	{
+		return get(slot, field, scratch);
+	}
+
+	auto propertyItr = properties[slot].FindMember(key);
+	return propertyItr == properties[slot].MemberEnd() ? nullptr : &propertyItr->value;
+}
+
+const control_value* interactive_control_store::get(size_t slot, control_field field, control_value& scratch) const
+{
+	if (0 == (fields[slot] & field))
+	{
+		return nullptr;
+	}
+
+	switch (field)
+	{
+	case control_field_kind:
+		scratch.SetString(kinds[slot].c_str(), (rapidjson::SizeType)kinds[slot].length());
+		return &scratch;
+	case control_field_disabled:
+		scratch.SetBool(disabled[slot]);
+		return &scratch;
+	case control_field_cost:
+		scratch.SetInt(costs[slot]);
+		return &scratch;
+	case control_field_cooldown:
+		scratch.SetInt64(cooldowns[slot]);
+		return &scratch;
+	case control_field_progress:
+		scratch.SetDouble(progress[slot]);
+		return &scratch;
+	case control_field_text:
+		scratch.SetString(texts[slot].c_str(), (rapidjson::SizeType)texts[slot].length());
+		return &scratch;
+	case control_field_position:
+		return &positions[slot];
+	default:
+		return nullptr;
+	}
+}
+
+size_t interactive_control_store::property_count(size_t slot) const
+{
+	size_t count = 1 + properties[slot].MemberCount();
+	for (control_field field : s_controlFields)
+	{
+		if (0 != (fields[slot] & field))
+		{
+			++count;
+		}
+	}
+
+	return count;
+}
+
+const control_value* interactive_control_store::property_at(size_t slot, size_t index, const char** name, control_value& scratch) const
+{
+	if (0 == index)
+	{
+		*name = RPC_CONTROL_ID;
+		return get(slot, RPC_CONTROL_ID, scratch);
+	}
+
+	--index;
+	for (control_field field : s_controlFields)
+	{
+		if (0 != (fields[slot] & field))
+		{
+			if (0 == index)
+			{
+				*name = control_field_name(field);
+				return get(slot, field, scratch);
+			}
+
+			--index;
+		}
+	}
+
+	if (index >= properties[slot].MemberCount())
+	{
+		return nullptr;
+	}
+
+	auto propertyItr = properties[slot].MemberBegin() + index;
+	*name = propertyItr->name.GetString();
+	return &propertyItr->value;
+}
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "rapidjson/document.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace mixer_internal
+{
+
+// Control properties are copied out of the message documents into values that own and free their own memory.
+typedef rapidjson::GenericValue<rapidjson::UTF8<>, rapidjson::CrtAllocator> control_value;
+
+// Properties with a typed column in the control store.
+enum control_field
+{
+	control_field_none = 0,
+	control_field_kind = 1 << 0,
+	control_field_disabled = 1 << 1,
+	control_field_cost = 1 << 2,
+	control_field_cooldown = 1 << 3,
+	control_field_progress = 1 << 4,
+	control_field_text = 1 << 5,
+	control_field_position = 1 << 6
+};
+
+control_field find_control_field(const char* key);
+
+#define CONTROL_STORE_NPOS ((size_t)-1)
+
+// Cached controls for every scene, stored as parallel arrays indexed by slot. Controls are found by id through a hash
+// index, and deleting a control moves the last control into its slot. Each scene lists the slots of its controls, the
+// same way. The fields mask records which typed columns hold a value for the control, any property without a typed
+// column is kept in properties.
+struct interactive_control_store
+{
+	// Scenes, by index.
+	std::vector<std::string> sceneIds;
+	std::unordered_map<std::string, size_t> sceneIndexById;
+	std::vector<std::vector<size_t>> sceneSlots;
+
+	// Controls, by slot.
+	std::vector<std::string> ids;
+	std::vector<size_t> sceneIndices;
+	std::vector<size_t> sceneOffsets;
+	std::vector<unsigned int> fields;
+	std::vector<std::string> kinds;
+	std::vector<bool> disabled;
+	std::vector<int> costs;
+	std::vector<long long> cooldowns;
+	std::vector<double> progress;
+	std::vector<std::string> texts;
+	std::vector<control_value> positions;
+	std::vector<control_value> properties;
+	std::unordered_map<std::string, size_t> indexById;
+
+	void clear();
+	size_t add_scene(const std::string& sceneId);
+	size_t find_scene(const std::string& sceneId) const;
+	size_t find(const std::string& controlId) const;
+	size_t size() const;
+
+	// Add a control to a scene, or replace all of an existing control's properties.
+	int insert(size_t sceneIndex, const rapidjson::Value& controlJson, size_t* slot = nullptr);
+	int update(size_t slot, const rapidjson::Value& controlJson);
+
+	// Remove a control. Any control moved into the vacated slot is left at that slot.
+	void erase(size_t slot);
+
+	// Look up a property of a control. Typed properties are materialized into scratch, which must outlive the result.
+	const control_value* get(size_t slot, const char* key, control_value& scratch) const;
+	const control_value* get(size_t slot, control_field field, control_value& scratch) const;
+
+	// Enumerate a control's properties in a stable order: the id, the typed properties, then everything else.
+	size_t property_count(size_t slot) const;
+	const control_value* property_at(size_t slot, size_t index, const char** name, control_value& scratch) const;
+
+private:
+	void assign(size_t slot, const rapidjson::Value& controlJson);
+};
+
+}
@@ -3,19 +3,83 @@
 namespace mixer_internal
 {
 
-bool compare_event_priority::operator()(const std::shared_ptr<interactive_event_internal> left, const std::shared_ptr<interactive_event_internal> right)
+// Ring sizes by event type. Input makes up nearly all inbound traffic, the other rings only need to cover bursts.
+static const size_t s_eventRingCapacities[interactive_event_type_count] =
 {
-	return left->type > right->type;
+	256,  // interactive_event_type_error
+	64,   // interactive_event_type_state_change
+	256,  // interactive_event_type_http_response
+	2,    // interactive_event_type_http_request, outgoing only
+	1024, // interactive_event_type_rpc_reply
+	8192  // interactive_event_type_rpc_method
+};
+
+interactive_event_queue::interactive_event_queue() : overflow(interactive_event_type_count)
+{
+	for (size_t capacity : s_eventRingCapacities)
+	{
+		rings.emplace_back(new mpsc_ring<std::shared_ptr<interactive_event_internal>>(capacity));
+	}
+}
+
+bool interactive_event_queue::try_push(std::shared_ptr<interactive_event_internal>&& ev)
+{
+	return rings[ev->type]->try_push(std::move(ev));
+}
+
+void interactive_event_queue::push_local(std::shared_ptr<interactive_event_internal>&& ev)
+{
+	// Once an event has overflowed the rest of its type follow it, so the type stays in order.
+	auto& typeOverflow = overflow[ev->type];
+	if (!typeOverflow.empty() || !rings[ev->type]->try_push(std::move(ev)))
+	{
+		typeOverflow.emplace_back(std::move(ev));
+	}
+}
+
+bool interactive_event_queue::try_pop(std::shared_ptr<interactive_event_internal>& ev)
+{
+	for (size_t type = 0; type < rings.size(); ++type)
+	{
+		if (rings[type]->try_pop(ev))
+		{
+			return true;
+		}
+
+		if (!overflow[type].empty())
+		{
+			ev = std::move(overflow[type].front());
+			overflow[type].pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+size_t interactive_event_queue::size() const
+{
+	size_t count = 0;
+	for (size_t type = 0; type < rings.size(); ++type)
+	{
+		count += rings[type]->size() + overflow[type].size();
+	}
+
+	return count;
 }
 
 interactive_event_internal::interactive_event_internal(interactive_event_type type) : type(type) {}
 
-rpc_method_event::rpc_method_event(std::shared_ptr<rapidjson::Document>&& methodJson) : interactive_event_internal(interactive_event_type_rpc_method), methodJson(methodJson) {}
+rpc_message::rpc_message() : interactive_event_internal(interactive_event_type_rpc_method), isInput(false), allocator(allocatorBuffer, sizeof(allocatorBuffer), RPC_MESSAGE_ALLOCATOR_CHUNK_SIZE), document(&allocator), replyId(0)
+{
+	input.reset();
+}
 
-rpc_reply_event::rpc_reply_event(const unsigned int id, std::shared_ptr<rapidjson::Document>&& replyJson, const method_handler replyHandler) : interactive_event_internal(interactive_event_type_rpc_reply), id(id), replyJson(replyJson), replyHandler(replyHandler) {}
+rpc_method_event::rpc_method_event(std::string&& packet) : interactive_event_internal(interactive_event_type_rpc_method), packet(std::move(packet)), queuedAt(std::chrono::steady_clock::now()) {}
 
 http_request_event::http_request_event(const uint32_t packetId, const std::string& uri, const std::string& verb, const http_headers* headers, const std::string* body) :
-	interactive_event_internal(interactive_event_type_http_request), packetId(packetId), uri(uri), verb(verb), headers(nullptr == headers ? http_headers() : *headers), body(nullptr == body ? std::string() : *body)
+	interactive_event_internal(interactive_event_type_http_request), packetId(packetId), uri(uri), verb(verb), headers(nullptr == headers ? http_headers() : *headers), body(nullptr == body ? std::string() : *body),
+	queuedAt(std::chrono::steady_clock::now())
 {
 }
 
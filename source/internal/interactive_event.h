@@ -1,8 +1,13 @@
 #pragma once
+#include "interactivity.h"
 #include "common.h"
-#include "rapidjson\document.h"
+#include "rapidjson/document.h"
 #include "http_client.h"
 #include "interactive_types.h"
+#include "interactive_event_ring.h"
+#include <chrono>
+#include <deque>
+#include <vector>
 
 namespace mixer_internal
 {
@@ -16,31 +21,101 @@ enum interactive_event_type
 	interactive_event_type_http_request,
 	interactive_event_type_rpc_reply,
 	interactive_event_type_rpc_method,
+	interactive_event_type_count
 };
 
 struct interactive_event_internal
 {
-	const interactive_event_type type;
+	// Pooled events are reused for more than one type.
+	interactive_event_type type;
 	interactive_event_internal(const interactive_event_type type);
 };
 
-struct compare_event_priority
+// Inbound events, with a ring for each event type. The rings are drained in priority order so errors and state changes
+// are handled ahead of RPC traffic, while events of one type are handled in the order they arrived.
+struct interactive_event_queue
 {
-	bool operator()(const std::shared_ptr<interactive_event_internal> left, const std::shared_ptr<interactive_event_internal> right);
+	interactive_event_queue();
+
+	// Any thread, returns false without taking the event if its ring is full.
+	bool try_push(std::shared_ptr<interactive_event_internal>&& ev);
+
+	// The thread calling interactive_run, when no other thread pushes. Never waits, events that do not fit in their ring
+	// are kept in an overflow list until the ring has been drained.
+	void push_local(std::shared_ptr<interactive_event_internal>&& ev);
+
+	// The thread calling interactive_run.
+	bool try_pop(std::shared_ptr<interactive_event_internal>& ev);
+
+	// The thread calling interactive_run, the number of events waiting.
+	size_t size() const;
+
+private:
+	std::vector<std::unique_ptr<mpsc_ring<std::shared_ptr<interactive_event_internal>>>> rings;
+	std::vector<std::deque<std::shared_ptr<interactive_event_internal>>> overflow;
 };
 
-struct rpc_method_event : interactive_event_internal
-{	
-	const std::shared_ptr<rapidjson::Document> methodJson;
-	rpc_method_event(std::shared_ptr<rapidjson::Document>&& methodJson);
+struct rpc_input_string
+{
+	size_t offset;
+	size_t length;
+};
+
+// A giveInput method decoded without building a DOM. Strings are stored null terminated in strings, params locates the
+// raw params object inside the message buffer.
+struct rpc_input
+{
+	rpc_input_string controlId;
+	rpc_input_string participantId;
+	rpc_input_string transactionId;
+	interactive_input_type type;
+	interactive_button_action action;
+	bool hasX;
+	bool hasY;
+	float x;
+	float y;
+	bool hasSequence;
+	int sequence;
+	size_t paramsOffset;
+	size_t paramsLength;
+	std::vector<char> strings;
+
+	void reset();
+	bool has(const rpc_input_string& value) const;
+	const char* get(const rpc_input_string& value) const;
 };
 
-struct rpc_reply_event : interactive_event_internal
+#define RPC_MESSAGE_ALLOCATOR_BUFFER_SIZE 4096
+#define RPC_MESSAGE_ALLOCATOR_CHUNK_SIZE  16384
+
+// An inbound websocket message, recycled through the session's message pool. Input methods are decoded straight into
+// input, everything else is parsed in-situ into document so its strings point into buffer. Document values are
+// allocated from allocatorBuffer before falling back to the heap. The message is queued as an rpc_method or rpc_reply
+// event itself, so handling a message allocates nothing once the pool is warm.
+struct rpc_message : interactive_event_internal
 {
-	const unsigned int id;
-	const std::shared_ptr<rapidjson::Document> replyJson;
-	const method_handler replyHandler;
-	rpc_reply_event(const unsigned int id, std::shared_ptr<rapidjson::Document>&& replyJson, const method_handler handler);
+	std::vector<char> buffer;
+	rapidjson::Reader reader;
+	bool isInput;
+	rpc_input input;
+	char allocatorBuffer[RPC_MESSAGE_ALLOCATOR_BUFFER_SIZE];
+	rapidjson::MemoryPoolAllocator<> allocator;
+	rapidjson::Document document;
+	unsigned int replyId;
+	method_handler replyHandler;
+	rpc_message();
+
+private:
+	rpc_message(const rpc_message&) = delete;
+	rpc_message& operator=(const rpc_message&) = delete;
+};
+
+// An outgoing method and its serialized packet. Incoming methods and replies are queued as their rpc_message.
+struct rpc_method_event : interactive_event_internal
+{	
+	const std::string packet;
+	const std::chrono::steady_clock::time_point queuedAt;
+	rpc_method_event(std::string&& packet);
 };
 
 struct http_request_event : interactive_event_internal
@@ -50,6 +125,7 @@ struct http_request_event : interactive_event_internal
 	const std::string verb;
 	const std::map<std::string, std::string> headers;
 	const std::string body;
+	const std::chrono::steady_clock::time_point queuedAt;
 	http_request_event(const uint32_t packetId, const std::string& uri, const std::string& verb, const http_headers* headers, const std::string* body);
 };
 
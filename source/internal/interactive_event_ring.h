@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace mixer_internal
+{
+
+// A bounded queue with any number of producers and a single consumer, neither of which ever takes a lock. Each cell
+// carries a sequence number that tells a producer when the cell is free for its position and tells the consumer when
+// the cell has been filled, so producers only contend on the enqueue position. Items are consumed in the order their
+// positions were claimed.
+template <typename T>
+struct mpsc_ring
+{
+	// Capacity must be a power of two.
+	explicit mpsc_ring(size_t capacity) : cells(new cell[capacity]), mask(capacity - 1), enqueuePosition(0), dequeuePosition(0)
+	{
+		for (size_t i = 0; i < capacity; ++i)
+		{
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	// Any thread. The item is only moved from if there is room for it.
+	bool try_push(T&& item)
+	{
+		size_t position = enqueuePosition.load(std::memory_order_relaxed);
+		cell* target;
+		for (;;)
+		{
+			target = &cells[position & mask];
+			size_t sequence = target->sequence.load(std::memory_order_acquire);
+			intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+			if (0 == difference)
+			{
+				if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				// The consumer has not yet freed this cell, the ring is full.
+				return false;
+			}
+			else
+			{
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		target->item = std::move(item);
+		target->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer thread only.
+	bool try_pop(T& item)
+	{
+		cell& source = cells[dequeuePosition & mask];
+		if (source.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+		{
+			return false;
+		}
+
+		item = std::move(source.item);
+		source.sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+		++dequeuePosition;
+		return true;
+	}
+
+	// Consumer thread only.
+	bool empty() const
+	{
+		return cells[dequeuePosition & mask].sequence.load(std::memory_order_acquire) != dequeuePosition + 1;
+	}
+
+	// Consumer thread only. Counts items a producer has claimed a cell for but not finished writing.
+	size_t size() const
+	{
+		return enqueuePosition.load(std::memory_order_acquire) - dequeuePosition;
+	}
+
+	size_t capacity() const
+	{
+		return mask + 1;
+	}
+
+private:
+	struct cell
+	{
+		std::atomic<size_t> sequence;
+		T item;
+	};
+
+	std::unique_ptr<cell[]> cells;
+	const size_t mask;
+
+	// Producers and the consumer update their positions on separate cache lines.
+	char producerPadding[64];
+	std::atomic<size_t> enqueuePosition;
+	char consumerPadding[64];
+	size_t dequeuePosition;
+
+	mpsc_ring(const mpsc_ring&) = delete;
+	mpsc_ring& operator=(const mpsc_ring&) = delete;
+};
+
+}
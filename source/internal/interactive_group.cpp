@@ -9,6 +9,9 @@ interactive_group_internal::interactive_group_internal(std::string id, std::stri
 int cache_groups(interactive_session_internal& session)
 {
 	DEBUG_INFO("Caching groups.");
+
+	// Note: Once bootstrapped, this reply handler may be executed immediately by the background websocket thread.
+	bool inBackground = session.backgroundCaching && session.groupsCached;
 	RETURN_IF_FAILED(queue_method(session, RPC_METHOD_GET_GROUPS, nullptr, [](interactive_session_internal& session, rapidjson::Document& reply) -> int
 	{
 		scenes_by_group scenesByGroup;
@@ -38,7 +41,7 @@ int cache_groups(interactive_session_internal& session)
 		}
 
 		return MIXER_OK;
-	}));
+	}, inBackground));
 	
 	return MIXER_OK;
 }
@@ -99,14 +102,19 @@ int interactive_create_group(interactive_session session, const char* groupId, c
 
 	std::string groupIdStr(groupId);
 	std::string sceneIdStr = nullptr == sceneId ? RPC_SCENE_DEFAULT : sceneId;
-	RETURN_IF_FAILED(queue_method(*sessionInternal, RPC_METHOD_CREATE_GROUPS, [&](rapidjson::Document::AllocatorType& allocator, rapidjson::Value& params)
+	RETURN_IF_FAILED(queue_method(*sessionInternal, RPC_METHOD_CREATE_GROUPS, [&](method_writer& writer)
 	{
-		rapidjson::Value groups(rapidjson::kArrayType);
-		rapidjson::Value group(rapidjson::kObjectType);
-		group.AddMember(RPC_GROUP_ID, std::move(groupIdStr), allocator);
-		group.AddMember(RPC_SCENE_ID, std::move(sceneIdStr), allocator);
-		groups.PushBack(std::move(group), allocator);
-		params.AddMember(RPC_PARAM_GROUPS, std::move(groups), allocator);
+		writer.StartObject();
+		writer.Key(RPC_PARAM_GROUPS);
+		writer.StartArray();
+		writer.StartObject();
+		writer.Key(RPC_GROUP_ID);
+		writer.String(groupIdStr);
+		writer.Key(RPC_SCENE_ID);
+		writer.String(sceneIdStr);
+		writer.EndObject();
+		writer.EndArray();
+		writer.EndObject();
 	}, nullptr));
 
 	return MIXER_OK;
@@ -127,14 +135,19 @@ int interactive_group_set_scene(interactive_session session, const char* groupId
 
 	std::string groupIdStr(groupId);
 	std::string sceneIdStr(sceneId);
-	RETURN_IF_FAILED(queue_method(*sessionInternal, RPC_METHOD_UPDATE_GROUPS, [&](rapidjson::Document::AllocatorType& allocator, rapidjson::Value& params)
+	RETURN_IF_FAILED(queue_method(*sessionInternal, RPC_METHOD_UPDATE_GROUPS, [&](method_writer& writer)
 	{
-		rapidjson::Value groups(rapidjson::kArrayType);
-		rapidjson::Value group(rapidjson::kObjectType);
-		group.AddMember(RPC_GROUP_ID, std::move(groupIdStr), allocator);
-		group.AddMember(RPC_SCENE_ID, std::move(sceneIdStr), allocator);
-		groups.PushBack(std::move(group), allocator);
-		params.AddMember(RPC_PARAM_GROUPS, std::move(groups), allocator);
+		writer.StartObject();
+		writer.Key(RPC_PARAM_GROUPS);
+		writer.StartArray();
+		writer.StartObject();
+		writer.Key(RPC_GROUP_ID);
+		writer.String(groupIdStr);
+		writer.Key(RPC_SCENE_ID);
+		writer.String(sceneIdStr);
+		writer.EndObject();
+		writer.EndArray();
+		writer.EndObject();
 	}, nullptr));
 
 	return MIXER_OK;
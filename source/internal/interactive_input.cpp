@@ -0,0 +1,476 @@
+#include "interactive_session.h"
+#include "common.h"
+#include "json.h"
+
+namespace mixer_internal
+{
+
+#define RPC_INPUT_STRING_NONE ((size_t)-1)
+
+void rpc_input::reset()
+{
+	controlId.offset = participantId.offset = transactionId.offset = RPC_INPUT_STRING_NONE;
+	controlId.length = participantId.length = transactionId.length = 0;
+	type = input_type_custom;
+	action = interactive_button_action_up;
+	hasX = hasY = false;
+	x = y = 0;
+	hasSequence = false;
+	sequence = 0;
+	paramsOffset = paramsLength = 0;
+	strings.clear();
+}
+
+bool rpc_input::has(const rpc_input_string& value) const
+{
+	return RPC_INPUT_STRING_NONE != value.offset;
+}
+
+const char* rpc_input::get(const rpc_input_string& value) const
+{
+	return has(value) ? strings.data() + value.offset : nullptr;
+}
+
+static bool string_equals(const char* str, size_t length, const char* literal)
+{
+	return length == strlen(literal) && 0 == memcmp(str, literal, length);
+}
+
+static void parse_input_event(const char* inputEvent, size_t length, interactive_input_type& type, interactive_button_action& action)
+{
+	action = interactive_button_action_up;
+	if (string_equals(inputEvent, length, RPC_INPUT_EVENT_MOVE))
+	{
+		type = input_type_move;
+	}
+	else if (string_equals(inputEvent, length, RPC_INPUT_EVENT_KEY_DOWN))
+	{
+		type = input_type_key;
+		action = interactive_button_action_down;
+	}
+	else if (string_equals(inputEvent, length, RPC_INPUT_EVENT_KEY_UP))
+	{
+		type = input_type_key;
+	}
+	else if (string_equals(inputEvent, length, RPC_INPUT_EVENT_MOUSE_DOWN))
+	{
+		type = input_type_click;
+		action = interactive_button_action_down;
+	}
+	else if (string_equals(inputEvent, length, RPC_INPUT_EVENT_MOUSE_UP))
+	{
+		type = input_type_click;
+	}
+	else
+	{
+		type = input_type_custom;
+	}
+}
+
+// SAX handler that decodes a giveInput method in a single pass. It stops as soon as the message turns out to be anything
+// else so the caller can fall back to a DOM parse.
+class input_decoder
+{
+public:
+	input_decoder(rpc_input& input, rapidjson::StringStream& stream) : m_input(input), m_stream(stream), m_depth(0), m_key(key_none),
+		m_inParams(false), m_inInput(false), m_isInput(false), m_hasEvent(false)
+	{
+	}
+
+	// True when every field needed to raise the input was found.
+	bool complete() const
+	{
+		return m_isInput && m_hasEvent && m_input.has(m_input.controlId) && 0 != m_input.paramsLength &&
+			(input_type_move != m_input.type || (m_input.hasX && m_input.hasY));
+	}
+
+	bool Null() { m_key = key_none; return true; }
+	bool Bool(bool) { m_key = key_none; return true; }
+	bool Int(int i) { return number(i); }
+	bool Uint(unsigned u) { return number(u); }
+	bool Int64(int64_t i) { return number((double)i); }
+	bool Uint64(uint64_t u) { return number((double)u); }
+	bool Double(double d) { return number(d); }
+	bool RawNumber(const char*, rapidjson::SizeType, bool) { m_key = key_none; return true; }
+
+	bool String(const char* str, rapidjson::SizeType length, bool)
+	{
+		input_key key = m_key;
+		m_key = key_none;
+		switch (key)
+		{
+		case key_type:
+			return string_equals(str, length, RPC_METHOD);
+		case key_method:
+			m_isInput = string_equals(str, length, RPC_METHOD_ON_INPUT);
+			return m_isInput;
+		case key_participant_id:
+			store(m_input.participantId, str, length);
+			break;
+		case key_transaction_id:
+			store(m_input.transactionId, str, length);
+			break;
+		case key_control_id:
+			store(m_input.controlId, str, length);
+			break;
+		case key_event:
+			parse_input_event(str, length, m_input.type, m_input.action);
+			m_hasEvent = true;
+			break;
+		default:
+			break;
+		}
+
+		return true;
+	}
+
+	bool Key(const char* str, rapidjson::SizeType length, bool)
+	{
+		m_key = key_none;
+		if (1 == m_depth)
+		{
+			if (string_equals(str, length, RPC_TYPE))
+			{
+				m_key = key_type;
+			}
+			else if (string_equals(str, length, RPC_METHOD))
+			{
+				m_key = key_method;
+			}
+			else if (string_equals(str, length, RPC_SEQUENCE))
+			{
+				m_key = key_sequence;
+			}
+			else if (string_equals(str, length, RPC_PARAMS))
+			{
+				m_key = key_params;
+			}
+		}
+		else if (2 == m_depth && m_inParams)
+		{
+			if (string_equals(str, length, RPC_PARTICIPANT_ID))
+			{
+				m_key = key_participant_id;
+			}
+			else if (string_equals(str, length, RPC_PARAM_TRANSACTION_ID))
+			{
+				m_key = key_transaction_id;
+			}
+			else if (string_equals(str, length, RPC_PARAM_INPUT))
+			{
+				m_key = key_input;
+			}
+		}
+		else if (3 == m_depth && m_inInput)
+		{
+			if (string_equals(str, length, RPC_CONTROL_ID))
+			{
+				m_key = key_control_id;
+			}
+			else if (string_equals(str, length, RPC_PARAM_INPUT_EVENT))
+			{
+				m_key = key_event;
+			}
+			else if (string_equals(str, length, RPC_INPUT_EVENT_MOVE_X))
+			{
+				m_key = key_x;
+			}
+			else if (string_equals(str, length, RPC_INPUT_EVENT_MOVE_Y))
+			{
+				m_key = key_y;
+			}
+		}
+
+		return true;
+	}
+
+	bool StartObject()
+	{
+		++m_depth;
+		if (2 == m_depth && key_params == m_key)
+		{
+			// The opening brace has already been consumed.
+			m_input.paramsOffset = m_stream.Tell() - 1;
+			m_inParams = true;
+		}
+		else if (3 == m_depth && key_input == m_key)
+		{
+			m_inInput = true;
+		}
+
+		m_key = key_none;
+		return true;
+	}
+
+	bool EndObject(rapidjson::SizeType)
+	{
+		if (3 == m_depth && m_inInput)
+		{
+			m_inInput = false;
+		}
+		else if (2 == m_depth && m_inParams)
+		{
+			m_input.paramsLength = m_stream.Tell() - m_input.paramsOffset;
+			m_inParams = false;
+		}
+
+		--m_depth;
+		m_key = key_none;
+		return true;
+	}
+
+	bool StartArray()
+	{
+		++m_depth;
+		m_key = key_none;
+		return true;
+	}
+
+	bool EndArray(rapidjson::SizeType)
+	{
+		--m_depth;
+		return true;
+	}
+
+private:
+	enum input_key
+	{
+		key_none,
+		key_type,
+		key_method,
+		key_sequence,
+		key_params,
+		key_participant_id,
+		key_transaction_id,
+		key_input,
+		key_control_id,
+		key_event,
+		key_x,
+		key_y
+	};
+
+	bool number(double value)
+	{
+		switch (m_key)
+		{
+		case key_sequence:
+			m_input.hasSequence = true;
+			m_input.sequence = (int)value;
+			break;
+		case key_x:
+			m_input.hasX = true;
+			m_input.x = (float)value;
+			break;
+		case key_y:
+			m_input.hasY = true;
+			m_input.y = (float)value;
+			break;
+		default:
+			break;
+		}
+
+		m_key = key_none;
+		return true;
+	}
+
+	void store(rpc_input_string& target, const char* str, size_t length)
+	{
+		target.offset = m_input.strings.size();
+		target.length = length;
+		m_input.strings.insert(m_input.strings.end(), str, str + length);
+		m_input.strings.push_back('\0');
+	}
+
+	rpc_input& m_input;
+	rapidjson::StringStream& m_stream;
+	int m_depth;
+	input_key m_key;
+	bool m_inParams;
+	bool m_inInput;
+	bool m_isInput;
+	bool m_hasEvent;
+};
+
+bool decode_input(rpc_message& message)
+{
+	message.input.reset();
+	rapidjson::StringStream stream(message.buffer.data());
+	input_decoder decoder(message.input, stream);
+	message.isInput = !message.reader.Parse(stream, decoder).IsError() && decoder.complete();
+	return message.isInput;
+}
+
+// Resolve the input's control from the cache and raise it to the title. The params are only serialized if the title asks for them.
+static int dispatch_input(interactive_session_internal& session, interactive_input& inputData, const rapidjson::Value* params)
+{
+	// Critical Section: Locate the cached control data, scenes may be re-cached by the background websocket thread.
+	std::string kind;
+	size_t slot;
+	{
+		std::shared_lock<std::shared_mutex> scenesReadLock(session.scenesMutex);
+		slot = session.controls.find(inputData.control.id);
+		if (CONTROL_STORE_NPOS != slot)
+		{
+			kind = session.controls.kinds[slot];
+		}
+	}
+
+	if (CONTROL_STORE_NPOS == slot)
+	{
+		int errCode = MIXER_ERROR_OBJECT_NOT_FOUND;
+		if (error_handler(session))
+		{
+			std::string errMessage = "Input received for unknown control.";
+			error_handler(session)(session.callerContext, &session, errCode, errMessage.c_str(), errMessage.length());
+		}
+
+		return errCode;
+	}
+
+	inputData.control.kind = kind.c_str();
+	inputData.control.kindLength = kind.length();
+
+	session.activeInput = &inputData;
+	session.activeInputParams = params;
+	input_handler(session)(session.callerContext, &session, &inputData);
+	session.activeInput = nullptr;
+	session.activeInputParams = nullptr;
+
+	return MIXER_OK;
+}
+
+int handle_decoded_input(interactive_session_internal& session, rpc_message& message)
+{
+	const rpc_input& input = message.input;
+	record_participant_input(session, input.get(input.participantId), input.participantId.length);
+	if (!input_handler(session))
+	{
+		// No input handler, return.
+		return MIXER_OK;
+	}
+
+	interactive_input inputData;
+	memset(&inputData, 0, sizeof(inputData));
+	inputData.control.id = input.get(input.controlId);
+	inputData.control.idLength = input.controlId.length;
+	inputData.participantId = input.get(input.participantId);
+	inputData.participantIdLength = input.participantId.length;
+	inputData.transactionId = input.get(input.transactionId);
+	inputData.transactionIdLength = input.transactionId.length;
+	inputData.type = input.type;
+	inputData.buttonData.action = input.action;
+	if (input_type_move == input.type || input_type_click == input.type)
+	{
+		inputData.coordinateData.x = input.x;
+		inputData.coordinateData.y = input.y;
+	}
+
+	// The params object is handed out straight from the message, null terminated in place for the duration of the callback.
+	char* params = message.buffer.data() + input.paramsOffset;
+	char next = params[input.paramsLength];
+	params[input.paramsLength] = 0;
+	inputData.jsonData = params;
+	inputData.jsonDataLength = input.paramsLength;
+
+	int err = dispatch_input(session, inputData, nullptr);
+	params[input.paramsLength] = next;
+	return err;
+}
+
+int handle_input(interactive_session_internal& session, rapidjson::Document& doc)
+{
+	if (doc[RPC_PARAMS].HasMember(RPC_PARTICIPANT_ID) && doc[RPC_PARAMS][RPC_PARTICIPANT_ID].IsString())
+	{
+		record_participant_input(session, doc[RPC_PARAMS][RPC_PARTICIPANT_ID].GetString(), doc[RPC_PARAMS][RPC_PARTICIPANT_ID].GetStringLength());
+	}
+
+	if (!input_handler(session))
+	{
+		// No input handler, return.
+		return MIXER_OK;
+	}
+
+	interactive_input inputData;
+	memset(&inputData, 0, sizeof(inputData));
+	rapidjson::Value& input = doc[RPC_PARAMS][RPC_PARAM_INPUT];
+	inputData.control.id = input[RPC_CONTROL_ID].GetString();
+	inputData.control.idLength = input[RPC_CONTROL_ID].GetStringLength();
+
+	if (doc[RPC_PARAMS].HasMember(RPC_PARTICIPANT_ID))
+	{
+		inputData.participantId = doc[RPC_PARAMS][RPC_PARTICIPANT_ID].GetString();
+		inputData.participantIdLength = doc[RPC_PARAMS][RPC_PARTICIPANT_ID].GetStringLength();
+	}
+
+	if (doc[RPC_PARAMS].HasMember(RPC_PARAM_TRANSACTION_ID))
+	{
+		inputData.transactionId = doc[RPC_PARAMS][RPC_PARAM_TRANSACTION_ID].GetString();
+		inputData.transactionIdLength = doc[RPC_PARAMS][RPC_PARAM_TRANSACTION_ID].GetStringLength();
+	}
+
+	rapidjson::Value& inputEvent = input[RPC_PARAM_INPUT_EVENT];
+	parse_input_event(inputEvent.GetString(), inputEvent.GetStringLength(), inputData.type, inputData.buttonData.action);
+	if (input_type_move == inputData.type)
+	{
+		inputData.coordinateData.x = input[RPC_INPUT_EVENT_MOVE_X].GetFloat();
+		inputData.coordinateData.y = input[RPC_INPUT_EVENT_MOVE_Y].GetFloat();
+	}
+	else if (input_type_click == inputData.type)
+	{
+		if (input.HasMember(RPC_INPUT_EVENT_MOVE_X))
+		{
+			inputData.coordinateData.x = input[RPC_INPUT_EVENT_MOVE_X].GetFloat();
+		}
+		if (input.HasMember(RPC_INPUT_EVENT_MOVE_Y))
+		{
+			inputData.coordinateData.y = input[RPC_INPUT_EVENT_MOVE_Y].GetFloat();
+		}
+	}
+
+	return dispatch_input(session, inputData, &doc[RPC_PARAMS]);
+}
+
+}
+
+using namespace mixer_internal;
+
+int interactive_input_get_json(interactive_session session, const interactive_input* input, char* json, size_t* jsonLength)
+{
+	if (nullptr == session || nullptr == input || nullptr == jsonLength)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	if (input != sessionInternal->activeInput)
+	{
+		return MIXER_ERROR_INVALID_OPERATION;
+	}
+
+	std::string inputJson;
+	const char* data = input->jsonData;
+	size_t actualLength = input->jsonDataLength;
+	if (nullptr == data)
+	{
+		if (nullptr == sessionInternal->activeInputParams)
+		{
+			return MIXER_ERROR_OBJECT_NOT_FOUND;
+		}
+
+		inputJson = jsonStringify(*sessionInternal->activeInputParams);
+		data = inputJson.c_str();
+		actualLength = inputJson.length();
+	}
+
+	if (nullptr == json || *jsonLength < actualLength + 1)
+	{
+		*jsonLength = actualLength + 1;
+		return MIXER_ERROR_BUFFER_SIZE;
+	}
+
+	memcpy(json, data, actualLength);
+	json[actualLength] = 0;
+	*jsonLength = actualLength + 1;
+
+	return MIXER_OK;
+}
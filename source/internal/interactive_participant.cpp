@@ -19,6 +19,300 @@ void parse_participant(rapidjson::Value& participantJson, interactive_participan
 	participant.groupIdLength = participantJson[RPC_GROUP_ID].GetStringLength();
 }
 
+/*
+Syncing participants
+
+getAllParticipants returns up to RPC_GET_PARTICIPANTS_BLOCK_SIZE participants connected from a timestamp onward,
+ordered by connection time, so each page depends on the last. The service can only be paged by timestamp, so each page
+starts at the last timestamp seen and participants that were already merged are skipped. A page whose participants all
+share one timestamp is requested again while it brings new participants, only then does the walker step past it. Once the first page reports the total, the remaining
+time range up to now is split into windows that are walked in parallel, each stopping where the next begins.
+Replies are merged on the websocket thread as they arrive, interactive_run is never involved.
+*/
+
+static int request_participants(interactive_session_internal& session, unsigned int syncId, unsigned long long from, unsigned long long to, bool firstPage);
+
+// Assumes caller holds the participants write lock.
+static void finish_participants_walker(interactive_session_internal& session)
+{
+	if (0 == --session.participantSyncWalkers)
+	{
+		session.participants.end_sync();
+		DEBUG_INFO("Participant sync complete, " + std::to_string(session.participants.read()->size()) + " participants.");
+	}
+}
+
+// Give up on windows that could not be requested so the sync can still finish.
+static void abandon_participants_windows(interactive_session_internal& session, unsigned int syncId, size_t count)
+{
+	std::unique_lock<std::mutex> participantsLock(session.participants.writeMutex);
+	if (syncId != session.participantSyncId)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		finish_participants_walker(session);
+	}
+}
+
+static int handle_participants_page(interactive_session_internal& session, rapidjson::Document& reply, unsigned int syncId, unsigned long long from, unsigned long long to, bool firstPage)
+{
+	// Note: This reply handler is executed immediately by the background websocket thread.
+	std::vector<std::pair<unsigned long long, unsigned long long>> windows;
+	{
+		std::unique_lock<std::mutex> participantsLock(session.participants.writeMutex);
+		if (syncId != session.participantSyncId)
+		{
+			// A newer sync has started.
+			return MIXER_OK;
+		}
+
+		if (!reply.HasMember(RPC_RESULT) || !reply[RPC_RESULT].HasMember(RPC_PARAM_PARTICIPANTS) || !reply[RPC_RESULT][RPC_PARAM_PARTICIPANTS].IsArray())
+		{
+			DEBUG_ERROR("Unexpected reply format for " RPC_GET_PARTICIPANTS);
+			finish_participants_walker(session);
+			return MIXER_ERROR_UNRECOGNIZED_DATA_FORMAT;
+		}
+
+		rapidjson::Value& result = reply[RPC_RESULT];
+		unsigned long long last = from;
+		bool mergedAtFrom = false;
+		bool windowComplete = false;
+		for (auto& participant : result[RPC_PARAM_PARTICIPANTS].GetArray())
+		{
+			unsigned long long connectedAt = participant.HasMember(RPC_PART_CONNECTED) && participant[RPC_PART_CONNECTED].IsUint64() ? participant[RPC_PART_CONNECTED].GetUint64() : from;
+			if (0 != to && connectedAt >= to)
+			{
+				// The next window starts here.
+				windowComplete = true;
+				break;
+			}
+
+			bool merged = false;
+			session.participants.merge_synced(participant, merged);
+			mergedAtFrom = mergedAtFrom || (merged && connectedAt == from);
+			last = (std::max)(last, connectedAt);
+		}
+
+		session.participants.publish();
+
+		bool hasMore = result.HasMember(RPC_PARAM_HAS_MORE) && result[RPC_PARAM_HAS_MORE].IsBool() && result[RPC_PARAM_HAS_MORE].GetBool();
+		if (windowComplete || !hasMore)
+		{
+			finish_participants_walker(session);
+			return MIXER_OK;
+		}
+
+		// A whole page shared the starting timestamp, ask for it again until it brings nobody new.
+		unsigned long long next = last == from && !mergedAtFrom ? from + 1 : last;
+		windows.emplace_back(next, to);
+		if (firstPage && result.HasMember(RPC_PARAM_TOTAL) && result[RPC_PARAM_TOTAL].IsUint())
+		{
+			unsigned long long serverNow = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() - session.serverTimeOffsetMs;
+			unsigned int remainingPages = result[RPC_PARAM_TOTAL].GetUint() / RPC_GET_PARTICIPANTS_BLOCK_SIZE;
+			unsigned int walkers = (std::min)(remainingPages, (unsigned int)RPC_GET_PARTICIPANTS_PIPELINE);
+			if (walkers > 1 && serverNow > next + walkers)
+			{
+				// Walkers start just before their window so participants on a boundary are not missed, duplicates are skipped.
+				windows.clear();
+				unsigned long long span = (serverNow - next) / walkers;
+				for (unsigned int i = 0; i < walkers; ++i)
+				{
+					unsigned long long start = next + i * span;
+					windows.emplace_back(0 == i ? start : start - 1, i + 1 == walkers ? 0 : start + span);
+				}
+
+				session.participantSyncWalkers += walkers - 1;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < windows.size(); ++i)
+	{
+		int err = request_participants(session, syncId, windows[i].first, windows[i].second, false);
+		if (err)
+		{
+			abandon_participants_windows(session, syncId, windows.size() - i);
+			return err;
+		}
+	}
+
+	return MIXER_OK;
+}
+
+static int request_participants(interactive_session_internal& session, unsigned int syncId, unsigned long long from, unsigned long long to, bool firstPage)
+{
+	return queue_method(session, RPC_GET_PARTICIPANTS, [&](method_writer& writer)
+	{
+		writer.StartObject();
+		writer.Key(RPC_PARAM_FROM);
+		writer.Uint64(from);
+		writer.EndObject();
+	}, [syncId, from, to, firstPage](interactive_session_internal& session, rapidjson::Document& reply) -> int
+	{
+		return handle_participants_page(session, reply, syncId, from, to, firstPage);
+	}, true);
+}
+
+int sync_participants(interactive_session_internal& session)
+{
+	DEBUG_INFO("Syncing participants.");
+	unsigned int syncId = 0;
+	{
+		std::unique_lock<std::mutex> participantsLock(session.participants.writeMutex);
+		syncId = ++session.participantSyncId;
+		session.participantSyncWalkers = 1;
+		session.participants.begin_sync();
+	}
+
+	int err = request_participants(session, syncId, 0, 0, true);
+	if (err)
+	{
+		abandon_participants_windows(session, syncId, 1);
+	}
+
+	return err;
+}
+
+void record_participant_input(interactive_session_internal& session, const char* participantId, size_t participantIdLength)
+{
+	if (nullptr == participantId)
+	{
+		return;
+	}
+
+	// A participant with earlier input is still present, leaving removes it from the activity.
+	unsigned long long serverNow = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() - session.serverTimeOffsetMs;
+	if (session.participants.activity.advance(participantId, participantIdLength, serverNow))
+	{
+		return;
+	}
+
+	// Input from a participant that has already left would never be removed again.
+	size_t row = 0;
+	if (nullptr == session.participants.read()->find(participantId, &row))
+	{
+		return;
+	}
+
+	session.participants.activity.touch(participantId, participantIdLength, serverNow);
+}
+
+static int handle_active_participants(interactive_session_internal& session, rapidjson::Document& reply)
+{
+	// Note: This reply handler is executed immediately by the background websocket thread.
+	if (!reply.HasMember(RPC_RESULT) || !reply[RPC_RESULT].HasMember(RPC_PARAM_PARTICIPANTS) || !reply[RPC_RESULT][RPC_PARAM_PARTICIPANTS].IsArray())
+	{
+		DEBUG_ERROR("Unexpected reply format for " RPC_METHOD_PARTICIPANTS_ACTIVE);
+		return MIXER_ERROR_UNRECOGNIZED_DATA_FORMAT;
+	}
+
+	// Critical Section: The service's copy of each participant is current.
+	std::unique_lock<std::mutex> participantsLock(session.participants.writeMutex);
+	for (auto& participant : reply[RPC_RESULT][RPC_PARAM_PARTICIPANTS].GetArray())
+	{
+		session.participants.upsert(participant);
+	}
+
+	session.participants.publish();
+	return MIXER_OK;
+}
+
+// A group change split across several updateParticipants messages, completed once every message has a reply.
+struct participants_group_change
+{
+	std::string groupId;
+	size_t messagesPending;
+	std::vector<std::string> failedIds;
+	on_participants_group_set onComplete;
+};
+
+static void complete_participants_group_change(interactive_session_internal& session, participants_group_change& change)
+{
+	if (nullptr == change.onComplete)
+	{
+		return;
+	}
+
+	std::vector<const char*> failedIds;
+	failedIds.reserve(change.failedIds.size());
+	for (const std::string& participantId : change.failedIds)
+	{
+		failedIds.push_back(participantId.c_str());
+	}
+
+	change.onComplete(session.callerContext, &session, change.groupId.c_str(), failedIds.data(), failedIds.size());
+}
+
+static int handle_participants_group_set(interactive_session_internal& session, rapidjson::Document& reply, participants_group_change& change, const std::vector<std::string>& participantIds)
+{
+	if (reply.HasMember(RPC_ERROR) && !reply[RPC_ERROR].IsNull())
+	{
+		check_reply_errors(session, reply);
+		change.failedIds.insert(change.failedIds.end(), participantIds.begin(), participantIds.end());
+	}
+	else
+	{
+		// The service replies with the participants it updated, any others were not moved.
+		std::unordered_set<std::string> updatedIds;
+		bool hasUpdated = reply.HasMember(RPC_RESULT) && reply[RPC_RESULT].IsObject() && reply[RPC_RESULT].HasMember(RPC_PARAM_PARTICIPANTS) && reply[RPC_RESULT][RPC_PARAM_PARTICIPANTS].IsArray();
+		if (hasUpdated)
+		{
+			for (auto& participant : reply[RPC_RESULT][RPC_PARAM_PARTICIPANTS].GetArray())
+			{
+				if (participant.HasMember(RPC_SESSION_ID) && participant[RPC_SESSION_ID].IsString())
+				{
+					updatedIds.emplace(participant[RPC_SESSION_ID].GetString(), participant[RPC_SESSION_ID].GetStringLength());
+				}
+			}
+		}
+
+		// Critical Section: Move the participants the service has moved.
+		std::unique_lock<std::mutex> participantsLock(session.participants.writeMutex);
+		for (const std::string& participantId : participantIds)
+		{
+			if (hasUpdated && updatedIds.end() == updatedIds.find(participantId))
+			{
+				change.failedIds.push_back(participantId);
+				continue;
+			}
+
+			session.participants.set_group(participantId.c_str(), change.groupId.c_str());
+		}
+
+		session.participants.publish();
+	}
+
+	if (0 == --change.messagesPending)
+	{
+		complete_participants_group_change(session, change);
+	}
+
+	return MIXER_OK;
+}
+
+// Length of a string as the method writer writes it, without its quotes.
+static size_t json_escaped_length(const char* value, size_t length)
+{
+	size_t escapedLength = length;
+	for (size_t i = 0; i < length; ++i)
+	{
+		unsigned char c = (unsigned char)value[i];
+		if ('"' == c || '\\' == c || '\b' == c || '\f' == c || '\n' == c || '\r' == c || '\t' == c)
+		{
+			escapedLength += 1;
+		}
+		else if (c < 0x20)
+		{
+			escapedLength += 5;
+		}
+	}
+
+	return escapedLength;
+}
+
 }
 
 using namespace mixer_internal;
@@ -37,16 +331,131 @@ int interactive_get_participants(interactive_session session, on_participant_enu
 		return MIXER_ERROR_NOT_CONNECTED;
 	}
 
-	for (auto& participantById : sessionInternal->participants)
+	// The version is held for the whole enumeration, changes made meanwhile are not seen.
+	std::shared_ptr<const participant_version> participants = sessionInternal->participants.read();
+	for (auto& page : participants->pages)
+	{
+		for (size_t row = 0; row < page->size(); ++row)
+		{
+			interactive_participant participant;
+			page->get(row, participant);
+			onParticipant(sessionInternal->callerContext, sessionInternal, &participant);
+		}
+	}
+
+	return MIXER_OK;
+}
+
+int interactive_get_active_participants(interactive_session session, unsigned long long sinceMs, on_participant_enumerate onParticipant)
+{
+	if (nullptr == session || nullptr == onParticipant)
 	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	// Validate connection state.
+	if (interactive_connected > sessionInternal->state)
+	{
+		return MIXER_ERROR_NOT_CONNECTED;
+	}
+
+	// Only the active participants are visited, in order of their last input.
+	std::vector<std::pair<std::string, unsigned long long>> active;
+	sessionInternal->participants.activity.since(sinceMs, active);
+	std::shared_ptr<const participant_version> participants = sessionInternal->participants.read();
+	for (auto& activeParticipant : active)
+	{
+		size_t row = 0;
+		const participant_page* page = participants->find(activeParticipant.first.c_str(), &row);
+		if (nullptr == page)
+		{
+			continue;
+		}
+
+		interactive_participant participant;
+		page->get(row, participant);
+		participant.lastInputAtMs = (std::max)(participant.lastInputAtMs, activeParticipant.second);
+		onParticipant(sessionInternal->callerContext, sessionInternal, &participant);
+	}
+
+	return MIXER_OK;
+}
+
+int interactive_group_get_participant_count(interactive_session session, const char* groupId, size_t* count)
+{
+	if (nullptr == session || nullptr == groupId || nullptr == count)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	// Validate connection state.
+	if (interactive_connected > sessionInternal->state)
+	{
+		return MIXER_ERROR_NOT_CONNECTED;
+	}
+
+	*count = sessionInternal->participants.groups.count(groupId);
+	return MIXER_OK;
+}
+
+int interactive_group_get_participants(interactive_session session, const char* groupId, on_participant_enumerate onParticipant)
+{
+	if (nullptr == session || nullptr == groupId || nullptr == onParticipant)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	// Validate connection state.
+	if (interactive_connected > sessionInternal->state)
+	{
+		return MIXER_ERROR_NOT_CONNECTED;
+	}
+
+	std::vector<std::string> members;
+	sessionInternal->participants.groups.members(groupId, members);
+	std::shared_ptr<const participant_version> participants = sessionInternal->participants.read();
+	for (auto& member : members)
+	{
+		size_t row = 0;
+		const participant_page* page = participants->find(member.c_str(), &row);
+		if (nullptr == page)
+		{
+			continue;
+		}
+
 		interactive_participant participant;
-		parse_participant(*participantById.second, participant);
+		page->get(row, participant);
 		onParticipant(sessionInternal->callerContext, sessionInternal, &participant);
 	}
 
 	return MIXER_OK;
 }
 
+int interactive_refresh_active_participants(interactive_session session, unsigned long long sinceMs)
+{
+	if (nullptr == session)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	if (interactive_connected > sessionInternal->state)
+	{
+		return MIXER_ERROR_NOT_CONNECTED;
+	}
+
+	return queue_method(*sessionInternal, RPC_METHOD_PARTICIPANTS_ACTIVE, [&](method_writer& writer)
+	{
+		writer.StartObject();
+		writer.Key(RPC_PARAM_PARTICIPANTS_ACTIVE_THRESHOLD);
+		writer.Uint64(sinceMs);
+		writer.EndObject();
+	}, handle_active_participants, true);
+}
+
 int interactive_participant_set_group(interactive_session session, const char* participantId, const char* groupId)
 {
 	if (nullptr == session || nullptr == participantId || nullptr == groupId)
@@ -60,20 +469,159 @@ int interactive_participant_set_group(interactive_session session, const char* p
 		return MIXER_ERROR_NOT_CONNECTED;
 	}
 
-	RETURN_IF_FAILED(queue_method(*sessionInternal, RPC_METHOD_UPDATE_PARTICIPANTS, [&](rapidjson::Document::AllocatorType& allocator, rapidjson::Value& params)
+	std::string participantIdStr(participantId);
+	std::string groupIdStr(groupId);
+	RETURN_IF_FAILED(queue_method(*sessionInternal, RPC_METHOD_UPDATE_PARTICIPANTS, [&](method_writer& writer)
+	{
+		writer.StartObject();
+		writer.Key(RPC_PARAM_PARTICIPANTS);
+		writer.StartArray();
+		writer.StartObject();
+		writer.Key(RPC_SESSION_ID);
+		writer.String(participantId);
+		writer.Key(RPC_GROUP_ID);
+		writer.String(groupId);
+		writer.EndObject();
+		writer.EndArray();
+		writer.Key(RPC_PARAM_PRIORITY);
+		writer.Int(0);
+		writer.EndObject();
+	}, [participantIdStr, groupIdStr](interactive_session_internal& session, rapidjson::Document& reply) -> int
 	{
-		rapidjson::Value participants(rapidjson::kArrayType);
-		rapidjson::Value participant(rapidjson::kObjectType);
-		participant.AddMember(RPC_SESSION_ID, std::string(participantId), allocator);
-		participant.AddMember(RPC_GROUP_ID, std::string(groupId), allocator);
-		participants.PushBack(participant, allocator);
-		params.AddMember(RPC_PARAM_PARTICIPANTS, participants, allocator);
-		params.AddMember("priority", 0, allocator);
-	}, nullptr));
+		// Note: This reply handler is executed immediately by the background websocket thread.
+		if (reply.HasMember(RPC_ERROR) && !reply[RPC_ERROR].IsNull())
+		{
+			return check_reply_errors(session, reply);
+		}
+
+		// Critical Section: Move the participant once the service has.
+		std::unique_lock<std::mutex> participantsLock(session.participants.writeMutex);
+		session.participants.set_group(participantIdStr.c_str(), groupIdStr.c_str());
+		session.participants.publish();
+		return MIXER_OK;
+	}, true));
 
 	return MIXER_OK;
 }
 
+int interactive_participants_set_group(interactive_session session, const char** participantIds, size_t participantCount, const char* groupId, on_participants_group_set onComplete)
+{
+	if (nullptr == session || (nullptr == participantIds && 0 != participantCount) || nullptr == groupId)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	if (interactive_connected > sessionInternal->state)
+	{
+		return MIXER_ERROR_NOT_CONNECTED;
+	}
+
+	for (size_t i = 0; i < participantCount; ++i)
+	{
+		if (nullptr == participantIds[i])
+		{
+			return MIXER_ERROR_INVALID_POINTER;
+		}
+	}
+
+	// Size each message from the escaped length of its entries, every message holds at least one participant. The
+	// envelope is sized with the widest id and sequence number.
+	static const size_t messageBytes = sizeof(RPC_METHOD_ENVELOPE_ID "4294967295" RPC_METHOD_ENVELOPE_METHOD "\"" RPC_METHOD_UPDATE_PARTICIPANTS "\""
+		RPC_METHOD_ENVELOPE_DISCARD "false" RPC_METHOD_ENVELOPE_SEQUENCE "-2147483648" RPC_METHOD_ENVELOPE_PARAMS
+		"{\"" RPC_PARAM_PARTICIPANTS "\":[],\"" RPC_PARAM_PRIORITY "\":0}" RPC_METHOD_ENVELOPE_END) - 1;
+	static const size_t entryBytes = sizeof("{\"" RPC_SESSION_ID "\":\"\",\"" RPC_GROUP_ID "\":\"\"},") - 1;
+	size_t groupIdLength = strlen(groupId);
+	size_t escapedGroupIdLength = json_escaped_length(groupId, groupIdLength);
+	std::vector<std::vector<std::string>> messages;
+	size_t bytes = 0;
+	for (size_t i = 0; i < participantCount; ++i)
+	{
+		size_t participantBytes = entryBytes + json_escaped_length(participantIds[i], strlen(participantIds[i])) + escapedGroupIdLength;
+		if (messages.empty() || (!messages.back().empty() && bytes + participantBytes > sessionInternal->participantsBatchBytes))
+		{
+			messages.emplace_back();
+			bytes = messageBytes;
+		}
+
+		messages.back().emplace_back(participantIds[i]);
+		bytes += participantBytes;
+	}
+
+	if (messages.empty())
+	{
+		if (nullptr != onComplete)
+		{
+			onComplete(sessionInternal->callerContext, session, groupId, nullptr, 0);
+		}
+
+		return MIXER_OK;
+	}
+
+	std::shared_ptr<participants_group_change> change = std::make_shared<participants_group_change>();
+	change->groupId = groupId;
+	change->messagesPending = messages.size();
+	change->onComplete = onComplete;
+	for (size_t i = 0; i < messages.size(); ++i)
+	{
+		std::shared_ptr<std::vector<std::string>> ids = std::make_shared<std::vector<std::string>>(std::move(messages[i]));
+		int err = queue_method(*sessionInternal, RPC_METHOD_UPDATE_PARTICIPANTS, [&](method_writer& writer)
+		{
+			writer.StartObject();
+			writer.Key(RPC_PARAM_PARTICIPANTS);
+			writer.StartArray();
+			for (const std::string& participantId : *ids)
+			{
+				writer.StartObject();
+				writer.Key(RPC_SESSION_ID);
+				writer.String(participantId.c_str(), (rapidjson::SizeType)participantId.length());
+				writer.Key(RPC_GROUP_ID);
+				writer.String(groupId, (rapidjson::SizeType)groupIdLength);
+				writer.EndObject();
+			}
+			writer.EndArray();
+			writer.Key(RPC_PARAM_PRIORITY);
+			writer.Int(0);
+			writer.EndObject();
+		}, [change, ids](interactive_session_internal& session, rapidjson::Document& reply) -> int
+		{
+			return handle_participants_group_set(session, reply, *change, *ids);
+		});
+
+		if (err)
+		{
+			// None of the remaining participants are moved, complete once the messages already sent are answered.
+			change->failedIds.insert(change->failedIds.end(), ids->begin(), ids->end());
+			for (size_t j = i + 1; j < messages.size(); ++j)
+			{
+				change->failedIds.insert(change->failedIds.end(), messages[j].begin(), messages[j].end());
+			}
+
+			change->messagesPending -= messages.size() - i;
+			if (0 == change->messagesPending)
+			{
+				complete_participants_group_change(*sessionInternal, *change);
+			}
+
+			return err;
+		}
+	}
+
+	return MIXER_OK;
+}
+
+int interactive_set_participants_batch_size(interactive_session session, size_t maxMessageBytes)
+{
+	if (nullptr == session)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	sessionInternal->participantsBatchBytes = maxMessageBytes;
+	return MIXER_OK;
+}
+
 int interactive_participant_get_user_id(interactive_session session, const char* participantId, unsigned int* userId)
 {
 	if (nullptr == session || nullptr == participantId || nullptr == userId)
@@ -88,14 +636,16 @@ int interactive_participant_get_user_id(interactive_session session, const char*
 		return MIXER_ERROR_NOT_CONNECTED;
 	}
 
-	auto participantItr = sessionInternal->participants.find(std::string(participantId));
-	if (sessionInternal->participants.end() == participantItr)
+	// Hold the current version of the participants while reading from it.
+	std::shared_ptr<const participant_version> participants = sessionInternal->participants.read();
+	size_t row = 0;
+	const participant_page* page = participants->find(participantId, &row);
+	if (nullptr == page)
 	{
 		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	std::shared_ptr<rapidjson::Document> participantDoc = participantItr->second;
-	*userId = (*participantDoc)[RPC_USER_ID].GetUint();
+	*userId = page->userIds[row];
 	return MIXER_OK;
 }
 
@@ -113,22 +663,23 @@ int interactive_participant_get_user_name(interactive_session session, const cha
 		return MIXER_ERROR_NOT_CONNECTED;
 	}
 
-	auto participantItr = sessionInternal->participants.find(std::string(participantId));
-	if (sessionInternal->participants.end() == participantItr)
+	// Hold the current version of the participants while reading from it.
+	std::shared_ptr<const participant_version> participants = sessionInternal->participants.read();
+	size_t row = 0;
+	const participant_page* page = participants->find(participantId, &row);
+	if (nullptr == page)
 	{
 		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	std::shared_ptr<rapidjson::Document> participantDoc = participantItr->second;
-
-	size_t actualLength = (*participantDoc)[RPC_USERNAME].GetStringLength();
+	size_t actualLength = page->strings.length(page->userNames[row]);
 	if (nullptr == userName || *userNameLength < actualLength + 1)
 	{
 		*userNameLength = actualLength + 1;
 		return MIXER_ERROR_BUFFER_SIZE;
 	}
 
-	memcpy(userName, (*participantDoc)[RPC_USERNAME].GetString(), actualLength);
+	memcpy(userName, page->strings.get(page->userNames[row]), actualLength);
 	userName[actualLength] = 0;
 	*userNameLength = actualLength + 1;
 	return MIXER_OK;
@@ -148,14 +699,16 @@ int interactive_participant_get_level(interactive_session session, const char* p
 		return MIXER_ERROR_NOT_CONNECTED;
 	}
 
-	auto participantItr = sessionInternal->participants.find(std::string(participantId));
-	if (sessionInternal->participants.end() == participantItr)
+	// Hold the current version of the participants while reading from it.
+	std::shared_ptr<const participant_version> participants = sessionInternal->participants.read();
+	size_t row = 0;
+	const participant_page* page = participants->find(participantId, &row);
+	if (nullptr == page)
 	{
 		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	std::shared_ptr<rapidjson::Document> participantDoc = participantItr->second;
-	*level = (*participantDoc)[RPC_LEVEL].GetUint();
+	*level = page->levels[row];
 	return MIXER_OK;
 }
 
@@ -173,14 +726,17 @@ int interactive_participant_get_last_input_at(interactive_session session, const
 		return MIXER_ERROR_NOT_CONNECTED;
 	}
 
-	auto participantItr = sessionInternal->participants.find(std::string(participantId));
-	if (sessionInternal->participants.end() == participantItr)
+	// Hold the current version of the participants while reading from it.
+	std::shared_ptr<const participant_version> participants = sessionInternal->participants.read();
+	size_t row = 0;
+	const participant_page* page = participants->find(participantId, &row);
+	if (nullptr == page)
 	{
 		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	std::shared_ptr<rapidjson::Document> participantDoc = participantItr->second;
-	*lastInputAt = (*participantDoc)[RPC_PART_LAST_INPUT].GetUint64();
+	// Input since the participant was last updated is only in the activity index.
+	*lastInputAt = (std::max)(page->lastInputAt[row], sessionInternal->participants.activity.last_input_at(participantId));
 	return MIXER_OK;
 }
 
@@ -198,14 +754,16 @@ int interactive_participant_get_connected_at(interactive_session session, const
 		return MIXER_ERROR_NOT_CONNECTED;
 	}
 
-	auto participantItr = sessionInternal->participants.find(std::string(participantId));
-	if (sessionInternal->participants.end() == participantItr)
+	// Hold the current version of the participants while reading from it.
+	std::shared_ptr<const participant_version> participants = sessionInternal->participants.read();
+	size_t row = 0;
+	const participant_page* page = participants->find(participantId, &row);
+	if (nullptr == page)
 	{
 		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	std::shared_ptr<rapidjson::Document> participantDoc = participantItr->second;
-	*connectedAt = (*participantDoc)[RPC_PART_CONNECTED].GetUint64();
+	*connectedAt = page->connectedAt[row];
 	return MIXER_OK;
 }
 
@@ -223,14 +781,16 @@ int interactive_participant_is_disabled(interactive_session session, const char*
 		return MIXER_ERROR_NOT_CONNECTED;
 	}
 
-	auto participantItr = sessionInternal->participants.find(std::string(participantId));
-	if (sessionInternal->participants.end() == participantItr)
+	// Hold the current version of the participants while reading from it.
+	std::shared_ptr<const participant_version> participants = sessionInternal->participants.read();
+	size_t row = 0;
+	const participant_page* page = participants->find(participantId, &row);
+	if (nullptr == page)
 	{
 		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	std::shared_ptr<rapidjson::Document> participantDoc = participantItr->second;
-	*isDisabled = (*participantDoc)[RPC_DISABLED].GetBool();
+	*isDisabled = page->disabled[row];
 	return MIXER_OK;
 }
 
@@ -248,21 +808,23 @@ int interactive_participant_get_group(interactive_session session, const char* p
 		return MIXER_ERROR_NOT_CONNECTED;
 	}
 
-	auto participantItr = sessionInternal->participants.find(std::string(participantId));
-	if (sessionInternal->participants.end() == participantItr)
+	// Hold the current version of the participants while reading from it.
+	std::shared_ptr<const participant_version> participants = sessionInternal->participants.read();
+	size_t row = 0;
+	const participant_page* page = participants->find(participantId, &row);
+	if (nullptr == page)
 	{
 		return MIXER_ERROR_OBJECT_NOT_FOUND;
 	}
 
-	std::shared_ptr<rapidjson::Document> participantDoc = participantItr->second;
-	size_t actualLength = (*participantDoc)[RPC_GROUP_ID].GetStringLength();
+	size_t actualLength = page->strings.length(page->groupIds[row]);
 	if (nullptr == group || *groupLength < actualLength + 1)
 	{
 		*groupLength = actualLength + 1;
 		return MIXER_ERROR_BUFFER_SIZE;
 	}
 
-	memcpy(group, (*participantDoc)[RPC_GROUP_ID].GetString(), actualLength);
+	memcpy(group, page->strings.get(page->groupIds[row]), actualLength);
 	group[actualLength] = 0;
 	*groupLength = actualLength + 1;
 	return MIXER_OK;
@@ -0,0 +1,844 @@
+#include "interactive_participant_store.h"
+#include "interactive_session.h"
+#include <algorithm>
+
+namespace mixer_internal
+{
+
+// FNV-1a
+static unsigned int hash_string(const char* value, size_t length)
+{
+	unsigned int hash = 2166136261u;
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash ^= (unsigned char)value[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+string_table::string_table() : indexCount(0), unusedChars(0)
+{
+	index.assign(16, INTERNED_STRING_NONE);
+}
+
+void string_table::clear()
+{
+	chars.clear();
+	entries.clear();
+	freeEntries.clear();
+	index.assign(16, INTERNED_STRING_NONE);
+	indexCount = 0;
+	unusedChars = 0;
+}
+
+size_t string_table::find_index(const char* value, size_t length, unsigned int hash) const
+{
+	size_t mask = index.size() - 1;
+	for (size_t i = hash & mask; INTERNED_STRING_NONE != index[i]; i = (i + 1) & mask)
+	{
+		const entry& e = entries[index[i]];
+		if (e.hash == hash && e.length == length && 0 == memcmp(&chars[e.offset], value, length))
+		{
+			return i;
+		}
+	}
+
+	return PARTICIPANT_STORE_NPOS;
+}
+
+void string_table::grow_index()
+{
+	std::vector<interned_string> oldIndex(index.size() * 2, INTERNED_STRING_NONE);
+	oldIndex.swap(index);
+	size_t mask = index.size() - 1;
+	for (interned_string id : oldIndex)
+	{
+		if (INTERNED_STRING_NONE == id)
+		{
+			continue;
+		}
+
+		size_t i = entries[id].hash & mask;
+		while (INTERNED_STRING_NONE != index[i])
+		{
+			i = (i + 1) & mask;
+		}
+
+		index[i] = id;
+	}
+}
+
+void string_table::compact()
+{
+	std::vector<char> liveChars;
+	liveChars.reserve(chars.size() - unusedChars);
+	for (entry& e : entries)
+	{
+		if (0 == e.refs)
+		{
+			continue;
+		}
+
+		unsigned int offset = (unsigned int)liveChars.size();
+		liveChars.insert(liveChars.end(), chars.begin() + e.offset, chars.begin() + e.offset + e.length + 1);
+		e.offset = offset;
+	}
+
+	chars.swap(liveChars);
+	unusedChars = 0;
+}
+
+interned_string string_table::intern(const char* value, size_t length)
+{
+	unsigned int hash = hash_string(value, length);
+	size_t position = find_index(value, length, hash);
+	if (PARTICIPANT_STORE_NPOS != position)
+	{
+		++entries[index[position]].refs;
+		return index[position];
+	}
+
+	// Keep the index at most three quarters full.
+	if (4 * (indexCount + 1) > 3 * index.size())
+	{
+		grow_index();
+	}
+
+	interned_string id;
+	if (freeEntries.empty())
+	{
+		id = (interned_string)entries.size();
+		entries.emplace_back();
+	}
+	else
+	{
+		id = freeEntries.back();
+		freeEntries.pop_back();
+	}
+
+	entry& e = entries[id];
+	e.offset = (unsigned int)chars.size();
+	e.length = (unsigned int)length;
+	e.hash = hash;
+	e.refs = 1;
+	chars.insert(chars.end(), value, value + length);
+	chars.push_back('\0');
+
+	size_t mask = index.size() - 1;
+	size_t i = hash & mask;
+	while (INTERNED_STRING_NONE != index[i])
+	{
+		i = (i + 1) & mask;
+	}
+
+	index[i] = id;
+	++indexCount;
+	return id;
+}
+
+interned_string string_table::find(const char* value, size_t length) const
+{
+	size_t position = find_index(value, length, hash_string(value, length));
+	return PARTICIPANT_STORE_NPOS == position ? INTERNED_STRING_NONE : index[position];
+}
+
+void string_table::release(interned_string id)
+{
+	if (id >= entries.size() || 0 == entries[id].refs || 0 != --entries[id].refs)
+	{
+		return;
+	}
+
+	// Remove the string from the index, shifting back any entries that probed past it.
+	entry& e = entries[id];
+	size_t mask = index.size() - 1;
+	size_t i = find_index(&chars[e.offset], e.length, e.hash);
+	for (size_t j = (i + 1) & mask; INTERNED_STRING_NONE != index[j]; j = (j + 1) & mask)
+	{
+		size_t home = entries[index[j]].hash & mask;
+		bool between = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+		if (!between)
+		{
+			index[i] = index[j];
+			i = j;
+		}
+	}
+
+	index[i] = INTERNED_STRING_NONE;
+	--indexCount;
+	freeEntries.push_back(id);
+	unusedChars += e.length + 1;
+	if (unusedChars > 1024 && 2 * unusedChars > chars.size())
+	{
+		compact();
+	}
+}
+
+const char* string_table::get(interned_string id) const
+{
+	return &chars[entries[id].offset];
+}
+
+size_t string_table::length(interned_string id) const
+{
+	return entries[id].length;
+}
+
+size_t string_table::capacity() const
+{
+	return entries.size();
+}
+
+size_t string_table::memory_usage() const
+{
+	return chars.capacity() + entries.capacity() * sizeof(entry) + (freeEntries.capacity() + index.capacity()) * sizeof(interned_string);
+}
+
+size_t participant_page::find(const char* sessionId) const
+{
+	interned_string id = strings.find(sessionId, strlen(sessionId));
+	if (INTERNED_STRING_NONE == id || id >= rowBySessionId.size())
+	{
+		return PARTICIPANT_STORE_NPOS;
+	}
+
+	size_t row = rowBySessionId[id];
+	return row < sessionIds.size() && sessionIds[row] == id ? row : PARTICIPANT_STORE_NPOS;
+}
+
+size_t participant_page::size() const
+{
+	return sessionIds.size();
+}
+
+void participant_page::set_string(interned_string& field, const rapidjson::Value& participantJson, const char* key)
+{
+	interned_string previous = field;
+	auto itr = participantJson.FindMember(key);
+	if (itr != participantJson.MemberEnd() && itr->value.IsString())
+	{
+		field = strings.intern(itr->value.GetString(), itr->value.GetStringLength());
+	}
+	else
+	{
+		field = strings.intern("", 0);
+	}
+
+	// Release after interning so an unchanged value keeps its entry.
+	if (INTERNED_STRING_NONE != previous)
+	{
+		strings.release(previous);
+	}
+}
+
+int participant_page::upsert(const rapidjson::Value& participantJson, size_t* row)
+{
+	if (!participantJson.IsObject() || !participantJson.HasMember(RPC_SESSION_ID) || !participantJson[RPC_SESSION_ID].IsString())
+	{
+		return MIXER_ERROR_UNRECOGNIZED_DATA_FORMAT;
+	}
+
+	size_t participantRow = find(participantJson[RPC_SESSION_ID].GetString());
+	if (PARTICIPANT_STORE_NPOS == participantRow)
+	{
+		const rapidjson::Value& sessionId = participantJson[RPC_SESSION_ID];
+		participantRow = sessionIds.size();
+		sessionIds.push_back(strings.intern(sessionId.GetString(), sessionId.GetStringLength()));
+		userNames.push_back(INTERNED_STRING_NONE);
+		groupIds.push_back(INTERNED_STRING_NONE);
+		userIds.push_back(0);
+		levels.push_back(0);
+		lastInputAt.push_back(0);
+		connectedAt.push_back(0);
+		disabled.push_back(false);
+		if (rowBySessionId.size() < strings.capacity())
+		{
+			rowBySessionId.resize(strings.capacity(), (unsigned int)PARTICIPANT_STORE_NPOS);
+		}
+
+		rowBySessionId[sessionIds.back()] = (unsigned int)participantRow;
+	}
+
+	set_string(userNames[participantRow], participantJson, RPC_USERNAME);
+	set_string(groupIds[participantRow], participantJson, RPC_GROUP_ID);
+
+	auto itr = participantJson.FindMember(RPC_USER_ID);
+	userIds[participantRow] = itr != participantJson.MemberEnd() && itr->value.IsUint() ? itr->value.GetUint() : 0;
+	itr = participantJson.FindMember(RPC_LEVEL);
+	levels[participantRow] = itr != participantJson.MemberEnd() && itr->value.IsUint() ? itr->value.GetUint() : 0;
+	itr = participantJson.FindMember(RPC_PART_LAST_INPUT);
+	lastInputAt[participantRow] = itr != participantJson.MemberEnd() && itr->value.IsUint64() ? itr->value.GetUint64() : 0;
+	itr = participantJson.FindMember(RPC_PART_CONNECTED);
+	connectedAt[participantRow] = itr != participantJson.MemberEnd() && itr->value.IsUint64() ? itr->value.GetUint64() : 0;
+	itr = participantJson.FindMember(RPC_DISABLED);
+	disabled[participantRow] = itr != participantJson.MemberEnd() && itr->value.IsBool() && itr->value.GetBool();
+
+	if (nullptr != row)
+	{
+		*row = participantRow;
+	}
+
+	return MIXER_OK;
+}
+
+void participant_page::erase(size_t row)
+{
+	if (row >= sessionIds.size())
+	{
+		return;
+	}
+
+	rowBySessionId[sessionIds[row]] = (unsigned int)PARTICIPANT_STORE_NPOS;
+	strings.release(sessionIds[row]);
+	strings.release(userNames[row]);
+	strings.release(groupIds[row]);
+
+	size_t last = sessionIds.size() - 1;
+	if (row != last)
+	{
+		// Move the last participant into the vacated row.
+		sessionIds[row] = sessionIds[last];
+		userNames[row] = userNames[last];
+		groupIds[row] = groupIds[last];
+		userIds[row] = userIds[last];
+		levels[row] = levels[last];
+		lastInputAt[row] = lastInputAt[last];
+		connectedAt[row] = connectedAt[last];
+		disabled[row] = disabled[last];
+		rowBySessionId[sessionIds[row]] = (unsigned int)row;
+	}
+
+	sessionIds.pop_back();
+	userNames.pop_back();
+	groupIds.pop_back();
+	userIds.pop_back();
+	levels.pop_back();
+	lastInputAt.pop_back();
+	connectedAt.pop_back();
+	disabled.pop_back();
+}
+
+void participant_page::set_group(size_t row, const char* groupId, size_t length)
+{
+	interned_string previous = groupIds[row];
+	groupIds[row] = strings.intern(groupId, length);
+	strings.release(previous);
+}
+
+void participant_page::get(size_t row, interactive_participant& participant) const
+{
+	participant.id = strings.get(sessionIds[row]);
+	participant.idLength = strings.length(sessionIds[row]);
+	participant.userId = userIds[row];
+	participant.userName = strings.get(userNames[row]);
+	participant.usernameLength = strings.length(userNames[row]);
+	participant.level = levels[row];
+	participant.lastInputAtMs = lastInputAt[row];
+	participant.connectedAtMs = connectedAt[row];
+	participant.disabled = disabled[row];
+	participant.groupId = strings.get(groupIds[row]);
+	participant.groupIdLength = strings.length(groupIds[row]);
+}
+
+size_t participant_page::memory_usage() const
+{
+	return sizeof(*this) + strings.memory_usage()
+		+ (sessionIds.capacity() + userNames.capacity() + groupIds.capacity()) * sizeof(interned_string)
+		+ (userIds.capacity() + levels.capacity()) * sizeof(unsigned int)
+		+ (lastInputAt.capacity() + connectedAt.capacity()) * sizeof(unsigned long long)
+		+ disabled.capacity() / 8
+		+ rowBySessionId.capacity() * sizeof(unsigned int);
+}
+
+participant_version::participant_version() : shards(PARTICIPANT_SHARD_COUNT), count(0)
+{
+}
+
+size_t participant_version::size() const
+{
+	return count;
+}
+
+const participant_page* participant_version::find(const char* sessionId, size_t* row) const
+{
+	unsigned int hash = hash_string(sessionId, strlen(sessionId));
+	const std::shared_ptr<const participant_shard>& shard = shards[hash % PARTICIPANT_SHARD_COUNT];
+	if (nullptr == shard)
+	{
+		return nullptr;
+	}
+
+	for (auto itr = std::lower_bound(shard->begin(), shard->end(), std::make_pair(hash, 0u)); itr != shard->end() && itr->first == hash; ++itr)
+	{
+		const participant_page* page = pages[itr->second].get();
+		*row = page->find(sessionId);
+		if (PARTICIPANT_STORE_NPOS != *row)
+		{
+			return page;
+		}
+	}
+
+	return nullptr;
+}
+
+size_t participant_version::memory_usage() const
+{
+	size_t bytes = sizeof(*this) + pages.capacity() * sizeof(pages[0]) + shards.capacity() * sizeof(shards[0]);
+	for (auto& page : pages)
+	{
+		bytes += page->memory_usage();
+	}
+
+	for (auto& shard : shards)
+	{
+		if (nullptr != shard)
+		{
+			bytes += sizeof(*shard) + shard->capacity() * sizeof((*shard)[0]);
+		}
+	}
+
+	return bytes;
+}
+
+void participant_activity::touch(const char* sessionId, size_t length, unsigned long long lastInputAt)
+{
+	if (0 == lastInputAt)
+	{
+		return;
+	}
+
+	// Critical Section: Move the participant within the ordering.
+	std::unique_lock<std::mutex> activityLock(mutex);
+	key.assign(sessionId, length);
+	auto participant = lastInputById.find(key);
+	if (participant == lastInputById.end())
+	{
+		participant = lastInputById.emplace(key, 0).first;
+	}
+
+	move(participant, lastInputAt);
+}
+
+bool participant_activity::advance(const char* sessionId, size_t length, unsigned long long lastInputAt)
+{
+	// Critical Section: Move the participant within the ordering.
+	std::unique_lock<std::mutex> activityLock(mutex);
+	key.assign(sessionId, length);
+	auto participant = lastInputById.find(key);
+	if (participant == lastInputById.end())
+	{
+		return false;
+	}
+
+	move(participant, lastInputAt);
+	return true;
+}
+
+// Assumes caller holds the lock.
+void participant_activity::move(std::unordered_map<std::string, unsigned long long>::iterator participant, unsigned long long lastInputAt)
+{
+	if (participant->second >= lastInputAt)
+	{
+		return;
+	}
+
+	if (0 != participant->second)
+	{
+		byLastInput.erase(std::make_pair(participant->second, &participant->first));
+	}
+
+	participant->second = lastInputAt;
+	byLastInput.emplace(lastInputAt, &participant->first);
+}
+
+void participant_activity::erase(const char* sessionId)
+{
+	std::unique_lock<std::mutex> activityLock(mutex);
+	auto participant = lastInputById.find(sessionId);
+	if (participant == lastInputById.end())
+	{
+		return;
+	}
+
+	byLastInput.erase(std::make_pair(participant->second, &participant->first));
+	lastInputById.erase(participant);
+}
+
+void participant_activity::rebuild(const participant_version& version)
+{
+	std::unordered_map<std::string, unsigned long long> rebuiltById;
+	std::set<std::pair<unsigned long long, const std::string*>> rebuiltByLastInput;
+
+	// Critical Section: Swap in the rebuilt ordering, input recorded meanwhile is kept.
+	std::unique_lock<std::mutex> activityLock(mutex);
+	for (const auto& page : version.pages)
+	{
+		for (size_t row = 0; row < page->size(); ++row)
+		{
+			const char* sessionId = page->strings.get(page->sessionIds[row]);
+			auto participant = lastInputById.find(sessionId);
+			unsigned long long lastInputAt = (std::max)(page->lastInputAt[row], participant == lastInputById.end() ? 0 : participant->second);
+			if (0 != lastInputAt)
+			{
+				auto rebuilt = rebuiltById.emplace(std::string(sessionId, page->strings.length(page->sessionIds[row])), lastInputAt).first;
+				rebuiltByLastInput.emplace(lastInputAt, &rebuilt->first);
+			}
+		}
+	}
+
+	lastInputById.swap(rebuiltById);
+	byLastInput.swap(rebuiltByLastInput);
+}
+
+unsigned long long participant_activity::last_input_at(const char* sessionId) const
+{
+	std::unique_lock<std::mutex> activityLock(mutex);
+	auto participant = lastInputById.find(sessionId);
+	return participant == lastInputById.end() ? 0 : participant->second;
+}
+
+void participant_activity::since(unsigned long long sinceMs, std::vector<std::pair<std::string, unsigned long long>>& participants) const
+{
+	// Critical Section: Copy out the participants so callers do not hold the lock.
+	std::unique_lock<std::mutex> activityLock(mutex);
+	for (auto itr = byLastInput.rbegin(); itr != byLastInput.rend() && itr->first >= sinceMs; ++itr)
+	{
+		participants.emplace_back(*itr->second, itr->first);
+	}
+}
+
+size_t participant_activity::size() const
+{
+	std::unique_lock<std::mutex> activityLock(mutex);
+	return lastInputById.size();
+}
+
+void participant_groups::set(const char* sessionId, size_t sessionIdLength, const char* groupId, size_t groupIdLength)
+{
+	// Critical Section: Move the participant to the end of its new group's list.
+	std::unique_lock<std::mutex> groupsLock(mutex);
+	std::string groupName(groupId, groupIdLength);
+	auto membershipItr = memberships.find(std::string(sessionId, sessionIdLength));
+	if (membershipItr != memberships.end())
+	{
+		if (membershipItr->second.memberGroup->first == groupName)
+		{
+			return;
+		}
+
+		remove(membershipItr);
+	}
+	else
+	{
+		membershipItr = memberships.emplace(std::string(sessionId, sessionIdLength), member()).first;
+	}
+
+	named_group& newGroup = *groups.emplace(std::move(groupName), group()).first;
+	membershipItr->second.memberGroup = &newGroup;
+	membershipItr->second.position = newGroup.second.members.size();
+	newGroup.second.members.push_back(&*membershipItr);
+}
+
+// Assumes caller holds the lock, leaves the membership without a group.
+void participant_groups::remove(std::unordered_map<std::string, member>::iterator membershipItr)
+{
+	named_group* currentGroup = membershipItr->second.memberGroup;
+	std::vector<membership*>& members = currentGroup->second.members;
+	membership* moved = members.back();
+	members[membershipItr->second.position] = moved;
+	moved->second.position = membershipItr->second.position;
+	members.pop_back();
+	membershipItr->second.memberGroup = nullptr;
+	if (members.empty())
+	{
+		// Copy the name, it is destroyed along with the group.
+		groups.erase(std::string(currentGroup->first));
+	}
+}
+
+void participant_groups::erase(const char* sessionId)
+{
+	std::unique_lock<std::mutex> groupsLock(mutex);
+	auto membershipItr = memberships.find(sessionId);
+	if (membershipItr == memberships.end())
+	{
+		return;
+	}
+
+	remove(membershipItr);
+	memberships.erase(membershipItr);
+}
+
+void participant_groups::rebuild(const participant_version& version)
+{
+	// Build the memberships aside, readers see the old groups until they are swapped in.
+	participant_groups rebuilt;
+	for (const auto& page : version.pages)
+	{
+		for (size_t row = 0; row < page->size(); ++row)
+		{
+			interned_string sessionId = page->sessionIds[row];
+			interned_string groupId = page->groupIds[row];
+			rebuilt.set(page->strings.get(sessionId), page->strings.length(sessionId), page->strings.get(groupId), page->strings.length(groupId));
+		}
+	}
+
+	// Critical Section: Swapping the maps keeps every node, and so every member pointer, where it is.
+	std::unique_lock<std::mutex> groupsLock(mutex);
+	groups.swap(rebuilt.groups);
+	memberships.swap(rebuilt.memberships);
+}
+
+size_t participant_groups::count(const char* groupId) const
+{
+	std::unique_lock<std::mutex> groupsLock(mutex);
+	auto groupItr = groups.find(groupId);
+	return groupItr == groups.end() ? 0 : groupItr->second.members.size();
+}
+
+void participant_groups::members(const char* groupId, std::vector<std::string>& sessionIds) const
+{
+	// Critical Section: Copy out the members so callers do not hold the lock.
+	std::unique_lock<std::mutex> groupsLock(mutex);
+	auto groupItr = groups.find(groupId);
+	if (groupItr == groups.end())
+	{
+		return;
+	}
+
+	sessionIds.reserve(groupItr->second.members.size());
+	for (const membership* groupMember : groupItr->second.members)
+	{
+		sessionIds.push_back(groupMember->first);
+	}
+}
+
+interactive_participant_store::interactive_participant_store() : syncing(false), current(std::make_shared<participant_version>())
+{
+}
+
+std::shared_ptr<const participant_version> interactive_participant_store::read() const
+{
+	return std::atomic_load(&current);
+}
+
+participant_version& interactive_participant_store::edit()
+{
+	// Start a new version sharing every page and shard with the current one.
+	if (nullptr == pending)
+	{
+		pending = std::make_shared<participant_version>(*current);
+		pendingPages.assign(pending->pages.size(), false);
+		pendingShards.assign(PARTICIPANT_SHARD_COUNT, false);
+	}
+
+	return *pending;
+}
+
+participant_page& interactive_participant_store::edit_page(size_t page)
+{
+	participant_version& version = edit();
+	if (page == version.pages.size())
+	{
+		version.pages.push_back(std::make_shared<participant_page>());
+		pendingPages.push_back(true);
+		pageOpen.push_back(true);
+		openPages.push_back(page);
+	}
+	else if (!pendingPages[page])
+	{
+		version.pages[page] = std::make_shared<participant_page>(*version.pages[page]);
+		pendingPages[page] = true;
+	}
+
+	return const_cast<participant_page&>(*version.pages[page]);
+}
+
+participant_shard& interactive_participant_store::edit_shard(size_t shard)
+{
+	participant_version& version = edit();
+	if (!pendingShards[shard])
+	{
+		version.shards[shard] = nullptr == version.shards[shard] ? std::make_shared<participant_shard>() : std::make_shared<participant_shard>(*version.shards[shard]);
+		pendingShards[shard] = true;
+	}
+
+	return const_cast<participant_shard&>(*version.shards[shard]);
+}
+
+size_t interactive_participant_store::find_page(const char* sessionId, unsigned int hash)
+{
+	const participant_version& version = nullptr == pending ? *current : *pending;
+	const std::shared_ptr<const participant_shard>& shard = version.shards[hash % PARTICIPANT_SHARD_COUNT];
+	if (nullptr == shard)
+	{
+		return PARTICIPANT_STORE_NPOS;
+	}
+
+	for (auto itr = std::lower_bound(shard->begin(), shard->end(), std::make_pair(hash, 0u)); itr != shard->end() && itr->first == hash; ++itr)
+	{
+		if (PARTICIPANT_STORE_NPOS != version.pages[itr->second]->find(sessionId))
+		{
+			return itr->second;
+		}
+	}
+
+	return PARTICIPANT_STORE_NPOS;
+}
+
+int interactive_participant_store::upsert(const rapidjson::Value& participantJson)
+{
+	if (!participantJson.IsObject() || !participantJson.HasMember(RPC_SESSION_ID) || !participantJson[RPC_SESSION_ID].IsString())
+	{
+		return MIXER_ERROR_UNRECOGNIZED_DATA_FORMAT;
+	}
+
+	// While syncing the activity and groups are rebuilt from the synced set once it is complete.
+	const rapidjson::Value& sessionId = participantJson[RPC_SESSION_ID];
+	unsigned int hash = hash_string(sessionId.GetString(), sessionId.GetStringLength());
+	auto lastInputAt = participantJson.FindMember(RPC_PART_LAST_INPUT);
+	if (!syncing && lastInputAt != participantJson.MemberEnd() && lastInputAt->value.IsUint64())
+	{
+		activity.touch(sessionId.GetString(), sessionId.GetStringLength(), lastInputAt->value.GetUint64());
+	}
+
+	auto groupId = participantJson.FindMember(RPC_GROUP_ID);
+	bool hasGroup = groupId != participantJson.MemberEnd() && groupId->value.IsString();
+	if (!syncing)
+	{
+		groups.set(sessionId.GetString(), sessionId.GetStringLength(), hasGroup ? groupId->value.GetString() : "", hasGroup ? groupId->value.GetStringLength() : 0);
+	}
+
+	size_t page = find_page(sessionId.GetString(), hash);
+	if (PARTICIPANT_STORE_NPOS != page)
+	{
+		return edit_page(page).upsert(participantJson);
+	}
+
+	// New participants fill the most recently opened page with room.
+	page = openPages.empty() ? edit().pages.size() : openPages.back();
+	participant_page& pageToEdit = edit_page(page);
+	RETURN_IF_FAILED(pageToEdit.upsert(participantJson));
+	if (PARTICIPANT_PAGE_SIZE <= pageToEdit.size())
+	{
+		pageOpen[page] = false;
+		openPages.pop_back();
+	}
+
+	participant_shard& shard = edit_shard(hash % PARTICIPANT_SHARD_COUNT);
+	auto entry = std::make_pair(hash, (unsigned int)page);
+	shard.insert(std::upper_bound(shard.begin(), shard.end(), entry), entry);
+	++pending->count;
+
+	return MIXER_OK;
+}
+
+void interactive_participant_store::erase(const char* sessionId)
+{
+	if (syncing)
+	{
+		leftDuringSync.emplace(sessionId);
+	}
+
+	activity.erase(sessionId);
+	groups.erase(sessionId);
+
+	unsigned int hash = hash_string(sessionId, strlen(sessionId));
+	size_t page = find_page(sessionId, hash);
+	if (PARTICIPANT_STORE_NPOS == page)
+	{
+		return;
+	}
+
+	participant_page& pageToEdit = edit_page(page);
+	pageToEdit.erase(pageToEdit.find(sessionId));
+	if (!pageOpen[page])
+	{
+		pageOpen[page] = true;
+		openPages.push_back(page);
+	}
+
+	participant_shard& shard = edit_shard(hash % PARTICIPANT_SHARD_COUNT);
+	auto entry = std::find(shard.begin(), shard.end(), std::make_pair(hash, (unsigned int)page));
+	if (entry != shard.end())
+	{
+		shard.erase(entry);
+	}
+
+	--pending->count;
+}
+
+int interactive_participant_store::set_group(const char* sessionId, const char* groupId)
+{
+	size_t page = find_page(sessionId, hash_string(sessionId, strlen(sessionId)));
+	if (PARTICIPANT_STORE_NPOS == page)
+	{
+		return MIXER_ERROR_OBJECT_NOT_FOUND;
+	}
+
+	participant_page& pageToEdit = edit_page(page);
+	pageToEdit.set_group(pageToEdit.find(sessionId), groupId, strlen(groupId));
+	if (!syncing)
+	{
+		groups.set(sessionId, strlen(sessionId), groupId, strlen(groupId));
+	}
+
+	return MIXER_OK;
+}
+
+void interactive_participant_store::publish()
+{
+	// A version being synced is only published once it is complete.
+	if (nullptr == pending || syncing)
+	{
+		return;
+	}
+
+	std::atomic_store(&current, std::shared_ptr<const participant_version>(std::move(pending)));
+	pending = nullptr;
+}
+
+void interactive_participant_store::begin_sync()
+{
+	pending = std::make_shared<participant_version>();
+	pendingPages.clear();
+	pendingShards.assign(PARTICIPANT_SHARD_COUNT, false);
+	openPages.clear();
+	pageOpen.clear();
+	syncing = true;
+	leftDuringSync.clear();
+}
+
+int interactive_participant_store::merge_synced(const rapidjson::Value& participantJson, bool& merged)
+{
+	merged = false;
+	if (!participantJson.IsObject() || !participantJson.HasMember(RPC_SESSION_ID) || !participantJson[RPC_SESSION_ID].IsString())
+	{
+		return MIXER_ERROR_UNRECOGNIZED_DATA_FORMAT;
+	}
+
+	const rapidjson::Value& sessionId = participantJson[RPC_SESSION_ID];
+	if (leftDuringSync.end() != leftDuringSync.find(std::string(sessionId.GetString(), sessionId.GetStringLength()))
+		|| PARTICIPANT_STORE_NPOS != find_page(sessionId.GetString(), hash_string(sessionId.GetString(), sessionId.GetStringLength())))
+	{
+		return MIXER_OK;
+	}
+
+	RETURN_IF_FAILED(upsert(participantJson));
+	merged = true;
+	return MIXER_OK;
+}
+
+void interactive_participant_store::end_sync()
+{
+	syncing = false;
+	leftDuringSync.clear();
+	const participant_version& synced = edit();
+	activity.rebuild(synced);
+	groups.rebuild(synced);
+	publish();
+}
+
+}
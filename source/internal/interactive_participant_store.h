@@ -0,0 +1,232 @@
+#pragma once
+
+#include "interactivity.h"
+#include "rapidjson/document.h"
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace mixer_internal
+{
+
+typedef unsigned int interned_string;
+
+#define INTERNED_STRING_NONE ((interned_string)-1)
+#define PARTICIPANT_STORE_NPOS ((size_t)-1)
+
+// Reference counted strings stored back to back in a single null terminated buffer. Each distinct string is kept once
+// and found through an open addressing hash index. Released strings are reclaimed by compacting the buffer once enough
+// of it is unused.
+struct string_table
+{
+	string_table();
+
+	void clear();
+	interned_string intern(const char* value, size_t length);
+	interned_string find(const char* value, size_t length) const;
+	void release(interned_string id);
+	const char* get(interned_string id) const;
+	size_t length(interned_string id) const;
+
+	// Number of entries, including released ones, ids are always less than this.
+	size_t capacity() const;
+	size_t memory_usage() const;
+
+private:
+	struct entry
+	{
+		unsigned int offset;
+		unsigned int length;
+		unsigned int hash;
+		unsigned int refs;
+	};
+
+	std::vector<char> chars;
+	std::vector<entry> entries;
+	std::vector<interned_string> freeEntries;
+	std::vector<interned_string> index;
+	size_t indexCount;
+	size_t unusedChars;
+
+	size_t find_index(const char* value, size_t length, unsigned int hash) const;
+	void grow_index();
+	void compact();
+};
+
+// A page of participants stored as parallel arrays indexed by row. Strings are interned in the page's table and
+// participants are found by their interned session id. Removing a participant moves the page's last participant into
+// its row. Published pages are never modified, a change is made to a copy of the page.
+struct participant_page
+{
+	string_table strings;
+
+	// Participants, by row.
+	std::vector<interned_string> sessionIds;
+	std::vector<interned_string> userNames;
+	std::vector<interned_string> groupIds;
+	std::vector<unsigned int> userIds;
+	std::vector<unsigned int> levels;
+	std::vector<unsigned long long> lastInputAt;
+	std::vector<unsigned long long> connectedAt;
+	std::vector<bool> disabled;
+
+	// Rows, by interned session id.
+	std::vector<unsigned int> rowBySessionId;
+
+	size_t find(const char* sessionId) const;
+	size_t size() const;
+
+	// Add a participant, or replace all fields of an existing participant with the same session id.
+	int upsert(const rapidjson::Value& participantJson, size_t* row = nullptr);
+	void erase(size_t row);
+
+	void set_group(size_t row, const char* groupId, size_t length);
+
+	// Fill in a participant, the strings remain valid as long as the page.
+	void get(size_t row, interactive_participant& participant) const;
+
+	// Approximate heap bytes held by the page.
+	size_t memory_usage() const;
+
+private:
+	void set_string(interned_string& field, const rapidjson::Value& participantJson, const char* key);
+};
+
+#define PARTICIPANT_PAGE_SIZE 64
+#define PARTICIPANT_SHARD_COUNT 1024
+
+// Pages holding a session id hash, sorted by hash.
+typedef std::vector<std::pair<unsigned int, unsigned int>> participant_shard;
+
+// An immutable set of participants. The pages and shards are shared with the versions before and after it.
+struct participant_version
+{
+	std::vector<std::shared_ptr<const participant_page>> pages;
+	std::vector<std::shared_ptr<const participant_shard>> shards;
+	size_t count;
+
+	participant_version();
+	size_t size() const;
+
+	// Find a participant's page and row, returns nullptr if the participant does not exist.
+	const participant_page* find(const char* sessionId, size_t* row) const;
+	size_t memory_usage() const;
+};
+
+// Participants ordered by their last input. Input is far more frequent than participant changes so it is tracked here,
+// under a lock of its own, rather than by copying pages. Times only move forward.
+struct participant_activity
+{
+	void touch(const char* sessionId, size_t length, unsigned long long lastInputAt);
+
+	// Touch a participant that is already tracked, returns false without adding it otherwise.
+	bool advance(const char* sessionId, size_t length, unsigned long long lastInputAt);
+	void erase(const char* sessionId);
+
+	// Keep only the participants in a version, taking the later of the tracked and stored input times.
+	void rebuild(const participant_version& version);
+
+	// Returns 0 for a participant that has not given input.
+	unsigned long long last_input_at(const char* sessionId) const;
+
+	// Participants with input at or after a time, most recent first.
+	void since(unsigned long long sinceMs, std::vector<std::pair<std::string, unsigned long long>>& participants) const;
+	size_t size() const;
+
+private:
+	mutable std::mutex mutex;
+	std::unordered_map<std::string, unsigned long long> lastInputById;
+	std::set<std::pair<unsigned long long, const std::string*>> byLastInput;
+
+	// Lookup key reused under the lock so finding a tracked participant does not allocate.
+	std::string key;
+
+	void move(std::unordered_map<std::string, unsigned long long>::iterator participant, unsigned long long lastInputAt);
+};
+
+// Participants by group. Each group lists its members so one group is counted and enumerated without visiting the
+// others. Members are moved between lists as their group changes.
+struct participant_groups
+{
+	void set(const char* sessionId, size_t sessionIdLength, const char* groupId, size_t groupIdLength);
+	void erase(const char* sessionId);
+
+	// Replace every membership with the groups of the participants in a version.
+	void rebuild(const participant_version& version);
+
+	size_t count(const char* groupId) const;
+
+	// Session ids of a group's members.
+	void members(const char* groupId, std::vector<std::string>& sessionIds) const;
+
+private:
+	struct group;
+	typedef std::pair<const std::string, group> named_group;
+	struct member
+	{
+		named_group* memberGroup;
+		size_t position;
+	};
+
+	typedef std::pair<const std::string, member> membership;
+	struct group
+	{
+		std::vector<membership*> members;
+	};
+
+	mutable std::mutex mutex;
+	std::unordered_map<std::string, group> groups;
+	std::unordered_map<std::string, member> memberships;
+
+	void remove(std::unordered_map<std::string, member>::iterator membershipItr);
+};
+
+// Participants published as immutable versions. Readers take the current version without waiting on the writer and
+// keep it alive while they use it. The dispatch thread applies a batch of changes to a copy of the version, copying
+// only the pages and shards it touches, then publishes the copy.
+struct interactive_participant_store
+{
+	interactive_participant_store();
+
+	// Any thread.
+	std::shared_ptr<const participant_version> read() const;
+
+	// Held by the writer for a batch of changes, readers never take it. Changes are visible to readers once published.
+	std::mutex writeMutex;
+	int upsert(const rapidjson::Value& participantJson);
+	void erase(const char* sessionId);
+	int set_group(const char* sessionId, const char* groupId);
+	void publish();
+
+	// A bulk sync starts from an empty set of participants. Participants that are already present or that leave while
+	// the sync runs are newer than the synced copy and are left as they are. Readers keep the participants from before the
+	// sync until it ends, when the synced set is published whole and the activity and groups are rebuilt from it.
+	void begin_sync();
+	int merge_synced(const rapidjson::Value& participantJson, bool& merged);
+	void end_sync();
+
+	// Any thread.
+	participant_activity activity;
+	participant_groups groups;
+
+private:
+	bool syncing;
+	std::unordered_set<std::string> leftDuringSync;
+	std::shared_ptr<const participant_version> current;
+	std::shared_ptr<participant_version> pending;
+	std::vector<bool> pendingPages;
+	std::vector<bool> pendingShards;
+	std::vector<size_t> openPages;
+	std::vector<bool> pageOpen;
+
+	participant_version& edit();
+	participant_page& edit_page(size_t page);
+	participant_shard& edit_shard(size_t shard);
+	size_t find_page(const char* sessionId, unsigned int hash);
+};
+
+}
@@ -0,0 +1,239 @@
+#include "interactive_session.h"
+#include "common.h"
+#include <climits>
+
+namespace mixer_internal
+{
+
+#define POLL_STRING_CHUNK_SIZE 16384
+
+interactive_poll_state::interactive_poll_state() : thread(std::thread::id()), delivered(0), chunk(0), chunkOffset(0)
+{
+}
+
+// Copy a string the event refers to, it remains valid until the strings are reset.
+static const char* poll_string(interactive_poll_state& poll, const char* value, size_t length)
+{
+	if (nullptr == value)
+	{
+		return nullptr;
+	}
+
+	while (poll.chunk < poll.chunks.size() && poll.chunks[poll.chunk].size() - poll.chunkOffset < length + 1)
+	{
+		++poll.chunk;
+		poll.chunkOffset = 0;
+	}
+
+	if (poll.chunk == poll.chunks.size())
+	{
+		poll.chunks.emplace_back((std::max)((size_t)POLL_STRING_CHUNK_SIZE, length + 1));
+	}
+
+	char* copy = poll.chunks[poll.chunk].data() + poll.chunkOffset;
+	memcpy(copy, value, length);
+	copy[length] = 0;
+	poll.chunkOffset += length + 1;
+	return copy;
+}
+
+static interactive_event& add_poll_event(interactive_poll_state& poll, interactive_event_kind kind)
+{
+	poll.events.emplace_back();
+	interactive_event& ev = poll.events.back();
+	memset(&ev, 0, sizeof(ev));
+	ev.kind = kind;
+	return ev;
+}
+
+static interactive_poll_state& get_poll_state(interactive_session session)
+{
+	return reinterpret_cast<interactive_session_internal*>(session)->poll;
+}
+
+static void poll_error(void* context, interactive_session session, int errorCode, const char* errorMessage, size_t errorMessageLength)
+{
+	(void)context;
+	interactive_poll_state& poll = get_poll_state(session);
+	interactive_event& ev = add_poll_event(poll, interactive_event_error);
+	ev.error.errorCode = errorCode;
+	ev.error.errorMessage = poll_string(poll, errorMessage, errorMessageLength);
+	ev.error.errorMessageLength = errorMessageLength;
+}
+
+static void poll_state_changed(void* context, interactive_session session, interactive_state previousState, interactive_state newState)
+{
+	(void)context;
+	interactive_event& ev = add_poll_event(get_poll_state(session), interactive_event_state_changed);
+	ev.stateChanged.previousState = previousState;
+	ev.stateChanged.newState = newState;
+}
+
+static void poll_input(void* context, interactive_session session, const interactive_input* input)
+{
+	(void)context;
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	interactive_poll_state& poll = sessionInternal->poll;
+	interactive_event& ev = add_poll_event(poll, interactive_event_input);
+	ev.input = *input;
+	ev.input.control.id = poll_string(poll, input->control.id, input->control.idLength);
+	ev.input.control.kind = poll_string(poll, input->control.kind, input->control.kindLength);
+	ev.input.participantId = poll_string(poll, input->participantId, input->participantIdLength);
+	ev.input.transactionId = poll_string(poll, input->transactionId, input->transactionIdLength);
+
+	// The json is only readable during the input, serialize it now if it is not already at hand.
+	if (nullptr != input->jsonData)
+	{
+		ev.input.jsonData = poll_string(poll, input->jsonData, input->jsonDataLength);
+	}
+	else if (nullptr != sessionInternal->activeInputParams)
+	{
+		std::string inputJson = jsonStringify(*sessionInternal->activeInputParams);
+		ev.input.jsonData = poll_string(poll, inputJson.c_str(), inputJson.length());
+		ev.input.jsonDataLength = inputJson.length();
+	}
+}
+
+static void poll_participants_changed(void* context, interactive_session session, interactive_participant_action action, const interactive_participant* participant)
+{
+	(void)context;
+	interactive_poll_state& poll = get_poll_state(session);
+	interactive_event& ev = add_poll_event(poll, interactive_event_participants_changed);
+	ev.participantsChanged.action = action;
+	ev.participantsChanged.participant = *participant;
+	ev.participantsChanged.participant.id = poll_string(poll, participant->id, participant->idLength);
+	ev.participantsChanged.participant.userName = poll_string(poll, participant->userName, participant->usernameLength);
+	ev.participantsChanged.participant.groupId = poll_string(poll, participant->groupId, participant->groupIdLength);
+}
+
+static void poll_transaction_complete(void* context, interactive_session session, const char* transactionId, size_t transactionIdLength, unsigned int error, const char* errorMessage, size_t errorMessageLength)
+{
+	(void)context;
+	interactive_poll_state& poll = get_poll_state(session);
+	interactive_event& ev = add_poll_event(poll, interactive_event_transaction_complete);
+	ev.transactionComplete.transactionId = poll_string(poll, transactionId, transactionIdLength);
+	ev.transactionComplete.transactionIdLength = transactionIdLength;
+	ev.transactionComplete.error = error;
+	ev.transactionComplete.errorMessage = poll_string(poll, errorMessage, errorMessageLength);
+	ev.transactionComplete.errorMessageLength = errorMessageLength;
+}
+
+static void poll_control_changed(void* context, interactive_session session, interactive_control_event eventType, const interactive_control* control)
+{
+	(void)context;
+	interactive_poll_state& poll = get_poll_state(session);
+	interactive_event& ev = add_poll_event(poll, interactive_event_control_changed);
+	ev.controlChanged.eventType = eventType;
+	ev.controlChanged.control = *control;
+	ev.controlChanged.control.id = poll_string(poll, control->id, control->idLength);
+	ev.controlChanged.control.kind = poll_string(poll, control->kind, control->kindLength);
+}
+
+static void poll_unhandled_method(void* context, interactive_session session, const char* methodJson, size_t methodJsonLength)
+{
+	(void)context;
+	interactive_poll_state& poll = get_poll_state(session);
+	interactive_event& ev = add_poll_event(poll, interactive_event_unhandled_method);
+	ev.unhandledMethod.methodJson = poll_string(poll, methodJson, methodJsonLength);
+	ev.unhandledMethod.methodJsonLength = methodJsonLength;
+}
+
+// Only the title's own thread raises events into the poll state, the handlers themselves are never swapped.
+static bool polling(interactive_session_internal& session)
+{
+	return std::this_thread::get_id() == session.poll.thread.load();
+}
+
+on_input input_handler(interactive_session_internal& session)
+{
+	return polling(session) ? poll_input : session.onInput;
+}
+
+on_error error_handler(interactive_session_internal& session)
+{
+	return polling(session) ? poll_error : session.onError;
+}
+
+on_state_changed state_changed_handler(interactive_session_internal& session)
+{
+	return polling(session) ? poll_state_changed : session.onStateChanged;
+}
+
+on_participants_changed participants_changed_handler(interactive_session_internal& session)
+{
+	return polling(session) ? poll_participants_changed : session.onParticipantsChanged;
+}
+
+on_control_changed control_changed_handler(interactive_session_internal& session)
+{
+	return polling(session) ? poll_control_changed : session.onControlChanged;
+}
+
+on_transaction_complete transaction_complete_handler(interactive_session_internal& session)
+{
+	return polling(session) ? poll_transaction_complete : session.onTransactionComplete;
+}
+
+on_unhandled_method unhandled_method_handler(interactive_session_internal& session)
+{
+	return polling(session) ? poll_unhandled_method : session.onUnhandledMethod;
+}
+
+}
+
+using namespace mixer_internal;
+
+int interactive_poll_events(interactive_session session, interactive_event* events, size_t capacity, size_t* count)
+{
+	if (nullptr == session || (nullptr == events && 0 != capacity) || nullptr == count)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	*count = 0;
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	interactive_poll_state& poll = sessionInternal->poll;
+	if (poll.delivered == poll.events.size())
+	{
+		// Every event has been returned, the strings they refer to can be reused.
+		poll.events.clear();
+		poll.delivered = 0;
+		poll.chunk = 0;
+		poll.chunkOffset = 0;
+	}
+
+	// Events raised on this thread are collected in place of the title's handlers.
+	poll.thread = std::this_thread::get_id();
+
+	// A single event may raise several, stop once the caller's array is full.
+	int err = MIXER_OK;
+	while (poll.events.size() - poll.delivered < capacity)
+	{
+		unsigned int eventsProcessed = 0;
+		size_t space = capacity - (poll.events.size() - poll.delivered);
+		err = run_events(*sessionInternal, (unsigned int)(std::min)(space, (size_t)UINT_MAX), &eventsProcessed);
+		if (MIXER_OK != err || 0 == eventsProcessed || sessionInternal->shutdownRequested)
+		{
+			break;
+		}
+	}
+
+	poll.thread = std::thread::id();
+
+	size_t returned = (std::min)(capacity, poll.events.size() - poll.delivered);
+	if (0 < returned)
+	{
+		memcpy(events, &poll.events[poll.delivered], returned * sizeof(interactive_event));
+	}
+
+	poll.delivered += returned;
+	*count = returned;
+
+	// Events raised but not yet returned are still waiting for the title.
+	if (poll.delivered < poll.events.size())
+	{
+		sessionInternal->wake.signal();
+	}
+
+	return err;
+}
@@ -0,0 +1,25 @@
+#include "interactive_reactor.h"
+
+#if __linux__
+#include "posix_reactor.h"
+#endif
+namespace mixer_internal
+{
+std::unique_ptr<interactive_reactor>
+reactor_factory::make_reactor(size_t threadCount)
+{
+#if __linux__
+	std::unique_ptr<posix_reactor> reactor = std::make_unique<posix_reactor>();
+	if (0 != reactor->start(threadCount))
+	{
+		return nullptr;
+	}
+
+	return reactor;
+#else
+	// The Windows websockets are only serviced by the thread that opens them.
+	(threadCount);
+	return nullptr;
+#endif
+}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <memory>
+
+namespace mixer_internal
+{
+
+struct interactive_session_internal;
+
+// Services the connections of many sessions from a small pool of threads, in place of the incoming and outgoing threads
+// each session would otherwise run. A session is stepped by one thread at a time whenever the descriptor it waits on is
+// ready, the time it asked to wait until has passed, or it has been woken.
+class interactive_reactor
+{
+public:
+	virtual ~interactive_reactor() {};
+
+	// Start stepping a session.
+	virtual int add(interactive_session_internal& session) = 0;
+
+	// Any thread. Step the session again as soon as possible.
+	virtual void wake(interactive_session_internal& session) = 0;
+
+	// Stop stepping a session, waiting for a step that is in progress to finish.
+	virtual void remove(interactive_session_internal& session) = 0;
+
+	virtual size_t thread_count() const = 0;
+};
+
+class reactor_factory
+{
+public:
+	// Returns nullptr if the platform's connections can not be serviced by a shared pool of threads.
+	static std::unique_ptr<interactive_reactor> make_reactor(size_t threadCount);
+};
+
+}
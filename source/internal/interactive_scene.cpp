@@ -4,37 +4,40 @@
 namespace mixer_internal
 {
 
-int update_control_pointers(interactive_session_internal& session, const char* sceneId)
+// The caller must hold the scenes lock exclusively.
+static void index_controls(interactive_session_internal& session)
 {
-	std::unique_lock<std::shared_mutex> scenesLock(session.scenesMutex);
-	// Iterate through each scene and set up a pointer to each control.
-	int sceneIndex = 0;
+	session.controls.clear();
+
+	// Move each scene's controls into the control store, scene indices match the cached scenes array.
 	for (auto& scene : session.scenesRoot[RPC_PARAM_SCENES].GetArray())
 	{
-		std::string scenePointer = "/" + std::string(RPC_PARAM_SCENES) + "/" + std::to_string(sceneIndex++);
-		auto thisSceneId = scene[RPC_SCENE_ID].GetString();
-		if (nullptr != sceneId)
+		size_t sceneIndex = session.controls.add_scene(scene[RPC_SCENE_ID].GetString());
+		auto controlsArray = scene.FindMember(RPC_PARAM_CONTROLS);
+		if (controlsArray == scene.MemberEnd())
 		{
-			if (0 != strcmp(sceneId, thisSceneId))
-			{
-				continue;
-			}
+			continue;
 		}
 
-		auto controlsArray = scene.FindMember(RPC_PARAM_CONTROLS);
-		if (controlsArray != scene.MemberEnd() && controlsArray->value.IsArray())
+		if (controlsArray->value.IsArray())
 		{
-			int controlIndex = 0;
 			for (auto& control : controlsArray->value.GetArray())
 			{
-				interactive_control_pointer ctrl(thisSceneId, scenePointer + "/" + std::string(RPC_PARAM_CONTROLS) + "/" + std::to_string(controlIndex++));
-				session.controls.emplace(control[RPC_CONTROL_ID].GetString(), std::move(ctrl));
+				session.controls.insert(sceneIndex, control);
 			}
 		}
 
-		session.scenes.emplace(thisSceneId, scenePointer);
+		scene.RemoveMember(controlsArray);
 	}
 
+	refresh_property_handles(session);
+}
+
+int cache_controls(interactive_session_internal& session)
+{
+	std::unique_lock<std::shared_mutex> scenesLock(session.scenesMutex);
+	index_controls(session);
+
 	return MIXER_OK;
 }
 
@@ -42,6 +45,8 @@ int cache_scenes(interactive_session_internal& session)
 {
 	DEBUG_INFO("Caching scenes.");
 
+	// Note: Once bootstrapped, this reply handler may be executed immediately by the background websocket thread.
+	bool inBackground = session.backgroundCaching && session.scenesCached;
 	RETURN_IF_FAILED(queue_method(session, RPC_METHOD_GET_SCENES, nullptr, [](interactive_session_internal& session, rapidjson::Document& doc) -> int
 	{
 		if (session.shutdownRequested)
@@ -49,21 +54,19 @@ int cache_scenes(interactive_session_internal& session)
 			return MIXER_OK;
 		}
 
-		// Critical Section: Get the scenes array from the result and set up pointers to scenes and controls.
+		// Critical Section: Replace the scenes and rebuild the control store together so readers never see one without the other.
 		{
 			std::unique_lock<std::shared_mutex> l(session.scenesMutex);
-			session.controls.clear();
-			session.scenes.clear();
 			session.scenesRoot.RemoveAllMembers();
 
 			// Copy just the scenes array portion of the reply into the cached scenes root.
 			rapidjson::Value scenesArray(rapidjson::kArrayType);
 			rapidjson::Value replyScenesArray = doc[RPC_RESULT][RPC_PARAM_SCENES].GetArray();
-			scenesArray.CopyFrom(replyScenesArray, session.scenesRoot.GetAllocator());
+			jsonCopy(replyScenesArray, scenesArray, session.scenesRoot.GetAllocator());
 			session.scenesRoot.AddMember(RPC_PARAM_SCENES, scenesArray, session.scenesRoot.GetAllocator());
+			index_controls(session);
 		}
 
-		RETURN_IF_FAILED(update_control_pointers(session));
 		if (!session.scenesCached)
 		{
 			session.scenesCached = true;
@@ -71,7 +74,7 @@ int cache_scenes(interactive_session_internal& session)
 		}
 
 		return MIXER_OK;
-	}));
+	}, inBackground));
 
 	return MIXER_OK;
 }
@@ -96,10 +99,10 @@ int interactive_get_scenes(interactive_session session, on_scene_enumerate onSce
 	// Critical Section: Enumerate the scenes and create interactive_scene objects for each.
 	{
 		std::shared_lock<std::shared_mutex> l(sessionInternal->scenesMutex);
-		for (auto sceneItr = sessionInternal->scenes.begin(); sessionInternal->scenes.end() != sceneItr; ++sceneItr)
+		for (const std::string& sceneId : sessionInternal->controls.sceneIds)
 		{
 			// Construct an interactive_scene object to pass to the caller.
-			scenes.push_back({ sceneItr->first });
+			scenes.push_back({ sceneId });
 		}
 	}
 
@@ -131,14 +134,14 @@ int interactive_scene_get_groups(interactive_session session, const char* sceneI
 	// Critical Section: Enumerate all groups for the specified scene.
 	{
 		std::shared_lock<std::shared_mutex> l(sessionInternal->scenesMutex);
-		auto sceneItr = sessionInternal->scenes.find(sceneId);
-		if (sessionInternal->scenes.end() == sceneItr)
+		size_t sceneIndex = sessionInternal->controls.find_scene(sceneId);
+		if (CONTROL_STORE_NPOS == sceneIndex)
 		{
 			return MIXER_ERROR_OBJECT_NOT_FOUND;
 		}
 
 		// Find the cached scene and enumerate all groups.
-		rapidjson::Value* sceneVal = rapidjson::Pointer(sceneItr->second.c_str()).Get(sessionInternal->scenesRoot);
+		rapidjson::Value* sceneVal = &sessionInternal->scenesRoot[RPC_PARAM_SCENES][(rapidjson::SizeType)sceneIndex];
 		if (sceneVal->HasMember(RPC_PARAM_GROUPS) && (*sceneVal)[RPC_PARAM_GROUPS].IsArray() && !(*sceneVal)[RPC_PARAM_GROUPS].Empty())
 		{
 			for (auto& groupObj : (*sceneVal)[RPC_PARAM_GROUPS].GetArray())
@@ -178,30 +181,17 @@ int interactive_scene_get_controls(interactive_session session, const char* scen
 	// Critical Section: Enumerate all controls on the scene.
 	{
 		std::shared_lock<std::shared_mutex> l(sessionInternal->scenesMutex);
-		auto sceneItr = sessionInternal->scenes.find(sceneId);
-		if (sessionInternal->scenes.end() == sceneItr)
+		const interactive_control_store& store = sessionInternal->controls;
+		size_t sceneIndex = store.find_scene(sceneId);
+		if (CONTROL_STORE_NPOS == sceneIndex)
 		{
 			return MIXER_ERROR_OBJECT_NOT_FOUND;
 		}
 
-		// Find the cached scene and enumerate all controls.
-		rapidjson::Value* sceneVal = rapidjson::Pointer(sceneItr->second.c_str()).Get(sessionInternal->scenesRoot);
-		if (sceneVal->HasMember(RPC_PARAM_CONTROLS) && (*sceneVal)[RPC_PARAM_CONTROLS].IsArray() && !(*sceneVal)[RPC_PARAM_CONTROLS].Empty())
+		// Enumerate all controls stored on the scene.
+		for (size_t slot : store.sceneSlots[sceneIndex])
 		{
-			for (auto& controlObj : (*sceneVal)[RPC_PARAM_CONTROLS].GetArray())
-			{
-				if (!controlObj.IsObject())
-				{
-					continue;
-				}
-
-				if (!controlObj.HasMember(RPC_CONTROL_ID) || !controlObj[RPC_CONTROL_ID].IsString())
-				{
-					continue;
-				}
-
-				controls.push_back({ controlObj[RPC_CONTROL_ID].GetString(), controlObj[RPC_CONTROL_KIND].GetString() });
-			}
+			controls.push_back({ store.ids[slot], store.kinds[slot] });
 		}
 	}
 
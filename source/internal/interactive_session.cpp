@@ -1,59 +1,95 @@
 #include "interactive_session.h"
 #include "common.h"
 #include "interactive_event.h"
+#include <climits>
 #include <functional>
 
 namespace mixer_internal
 {
 
-typedef std::function<void(rapidjson::Document::AllocatorType& allocator, rapidjson::Value& value)> on_get_params;
+// Methods larger than this do not keep their memory in the session's method buffer.
+#define METHOD_BUFFER_MAX_SIZE 65536
 
-int create_method_json(interactive_session_internal& session, const std::string& method, on_get_params getParams, bool discard, unsigned int* id, std::shared_ptr<rapidjson::Document>& methodDoc)
+template <size_t length>
+void write_literal(rapidjson::StringBuffer& buffer, const char(&literal)[length])
 {
-	std::shared_ptr<rapidjson::Document> doc(std::make_shared<rapidjson::Document>());
-	doc->SetObject();
-	rapidjson::Document::AllocatorType& allocator = doc->GetAllocator();
+	memcpy(buffer.Push(length - 1), literal, length - 1);
+}
+
+int create_method_packet(interactive_session_internal& session, const std::string& method, on_get_params getParams, bool discard, unsigned int* id, std::string& packet)
+{
+	// Critical Section: The method buffer is shared by every thread that queues methods.
+	std::unique_lock<std::mutex> bufferLock(session.methodBufferMutex);
+	rapidjson::StringBuffer& buffer = session.methodBuffer;
+	method_writer& writer = session.methodWriter;
+	buffer.Clear();
 
+	// Each variable field is written as its own root value between the literal fragments of the envelope.
 	unsigned int packetID = session.packetId++;
-	doc->AddMember(RPC_ID, packetID, allocator);
-	doc->AddMember(RPC_METHOD, method, allocator);
-	doc->AddMember(RPC_DISCARD, discard, allocator);
-	doc->AddMember(RPC_SEQUENCE, session.sequenceId, allocator);
+	write_literal(buffer, RPC_METHOD_ENVELOPE_ID);
+	writer.Reset(buffer);
+	writer.Uint(packetID);
+	write_literal(buffer, RPC_METHOD_ENVELOPE_METHOD);
+	writer.Reset(buffer);
+	writer.String(method.c_str(), (rapidjson::SizeType)method.length());
+	write_literal(buffer, RPC_METHOD_ENVELOPE_DISCARD);
+	if (discard)
+	{
+		write_literal(buffer, "true");
+	}
+	else
+	{
+		write_literal(buffer, "false");
+	}
+	write_literal(buffer, RPC_METHOD_ENVELOPE_SEQUENCE);
+	writer.Reset(buffer);
+	writer.Int(session.sequenceId);
+	write_literal(buffer, RPC_METHOD_ENVELOPE_PARAMS);
 
 	// Get the parameters from the caller.
-	rapidjson::Value params(rapidjson::kObjectType);
 	if (getParams)
 	{
-		getParams(allocator, params);
+		writer.Reset(buffer);
+		getParams(writer);
+		if (!writer.IsComplete())
+		{
+			return MIXER_ERROR_METHOD_CREATE;
+		}
+	}
+	else
+	{
+		write_literal(buffer, RPC_METHOD_EMPTY_PARAMS);
+	}
+	write_literal(buffer, RPC_METHOD_ENVELOPE_END);
+
+	packet.assign(buffer.GetString(), buffer.GetSize());
+	if (buffer.GetSize() > METHOD_BUFFER_MAX_SIZE)
+	{
+		buffer.Clear();
+		buffer.ShrinkToFit();
 	}
-	doc->AddMember(RPC_PARAMS, params, allocator);
 
 	if (nullptr != id)
 	{
 		*id = packetID;
 	}
-	methodDoc = doc;
 	return MIXER_OK;
 }
 
 // Queue a method to be sent out on the websocket. If handleImmediately is set to true, the handler will be called by the websocket receive thread rather than put on the reply queue.
 int queue_method(interactive_session_internal& session, const std::string& method, on_get_params getParams, method_handler onReply, const bool handleImmediately)
 {
-	std::shared_ptr<rapidjson::Document> methodDoc;
+	std::string packet;
 	unsigned int packetId = 0;
-	RETURN_IF_FAILED(create_method_json(session, method, getParams, nullptr == onReply, &packetId, methodDoc));
-	DEBUG_TRACE(std::string("Queueing method: ") + jsonStringify(*methodDoc));
+	RETURN_IF_FAILED(create_method_packet(session, method, getParams, nullptr == onReply, &packetId, packet));
+	DEBUG_TRACE(std::string("Queueing method: ") + packet);
 	if (onReply)
 	{
 		std::unique_lock<std::mutex> incomingLock(session.incomingMutex);
 		session.replyHandlersById[packetId] = std::pair<bool, method_handler>(handleImmediately, onReply);
 	}
 
-	// Synchronize write access to the queue.
-	std::shared_ptr<rpc_method_event> methodEvent = std::make_shared<rpc_method_event>(std::move(methodDoc));
-	std::unique_lock<std::mutex> queueLock(session.outgoingMutex);
-	session.outgoingEvents.emplace(methodEvent);
-	session.outgoingCV.notify_one();
+	session.enqueue_outgoing_event(std::make_shared<rpc_method_event>(std::move(packet)));
 
 	return MIXER_OK;
 }
@@ -64,15 +100,11 @@ int queue_request(interactive_session_internal& session, const std::string uri,
 
 	if (nullptr != onResponse)
 	{
+		std::unique_lock<std::mutex> incomingLock(session.incomingMutex);
 		session.httpResponseHandlers[requestEvent->packetId] = onResponse;
 	}
 
-	// Queue the request, synchronizing access.
-	{
-		std::unique_lock<std::mutex> outgoingLock(session.outgoingMutex);
-		session.outgoingEvents.emplace(requestEvent);
-		session.outgoingCV.notify_one();
-	}
+	session.enqueue_outgoing_event(std::move(requestEvent));
 
 	return MIXER_OK;
 }
@@ -87,10 +119,10 @@ int check_reply_errors(interactive_session_internal& session, rapidjson::Documen
 	if (reply.HasMember(RPC_ERROR) && !reply[RPC_ERROR].IsNull())
 	{
 		int errCode = reply[RPC_ERROR][RPC_ERROR_CODE].GetInt();
-		if (session.onError)
+		if (error_handler(session))
 		{
 			std::string errMessage = reply[RPC_ERROR][RPC_ERROR_MESSAGE].GetString();
-			session.onError(session.callerContext, &session, errCode, errMessage.c_str(), errMessage.length());
+			error_handler(session)(session.callerContext, &session, errCode, errMessage.c_str(), errMessage.length());
 		}
 
 		return errCode;
@@ -101,9 +133,12 @@ int check_reply_errors(interactive_session_internal& session, rapidjson::Documen
 
 int send_ready_message(interactive_session_internal& session, bool ready = true)
 {
-	return queue_method(session, RPC_METHOD_READY, [&](rapidjson::Document::AllocatorType& allocator, rapidjson::Value& params)
+	return queue_method(session, RPC_METHOD_READY, [&](method_writer& writer)
 	{
-		params.AddMember(RPC_PARAM_IS_READY, ready, allocator);
+		writer.StartObject();
+		writer.Key(RPC_PARAM_IS_READY);
+		writer.Bool(ready);
+		writer.EndObject();
 	}, nullptr);
 }
 
@@ -176,12 +211,15 @@ int bootstrap(interactive_session_internal& session)
 	else
 	{
 		DEBUG_TRACE("Bootstrapping complete.");
+		// Participants are synced in the background, they fill in after the session is connected.
+		RETURN_IF_FAILED(sync_participants(session));
+
 		interactive_state prevState = session.state;
 		session.state = interactive_connected;
 
-		if (session.onStateChanged)
+		if (state_changed_handler(session))
 		{
-			session.onStateChanged(session.callerContext, &session, prevState, session.state);
+			state_changed_handler(session)(session.callerContext, &session, prevState, session.state);
 		}
 
 		if (session.isReady)
@@ -204,114 +242,6 @@ int handle_hello(interactive_session_internal& session, rapidjson::Document& doc
 	return bootstrap(session);
 }
 
-int handle_input(interactive_session_internal& session, rapidjson::Document& doc)
-{
-	if (!session.onInput)
-	{
-		// No input handler, return.
-		return MIXER_OK;
-	}
-
-	interactive_input inputData;
-	memset(&inputData, 0, sizeof(inputData));
-	std::string inputJson = jsonStringify(doc[RPC_PARAMS]);
-	inputData.jsonData = inputJson.c_str();
-	inputData.jsonDataLength = inputJson.length();
-	rapidjson::Value& input = doc[RPC_PARAMS][RPC_PARAM_INPUT];
-	inputData.control.id = input[RPC_CONTROL_ID].GetString();
-	inputData.control.idLength = input[RPC_CONTROL_ID].GetStringLength();
-
-	if (doc[RPC_PARAMS].HasMember(RPC_PARTICIPANT_ID))
-	{
-		inputData.participantId = doc[RPC_PARAMS][RPC_PARTICIPANT_ID].GetString();
-		inputData.participantIdLength = doc[RPC_PARAMS][RPC_PARTICIPANT_ID].GetStringLength();
-	}
-
-	// Locate the cached control data.
-	auto itr = session.controls.find(inputData.control.id);
-	if (itr == session.controls.end())
-	{
-		int errCode = MIXER_ERROR_OBJECT_NOT_FOUND;
-		if (session.onError)
-		{
-			std::string errMessage = "Input received for unknown control.";
-			session.onError(session.callerContext, &session, errCode, errMessage.c_str(), errMessage.length());
-		}
-
-		return errCode;
-	}
-
-	rapidjson::Value* control = rapidjson::Pointer(itr->second.cachePointer.c_str()).Get(session.scenesRoot);
-	if (nullptr == control)
-	{
-		int errCode = MIXER_ERROR_OBJECT_NOT_FOUND;
-		if (session.onError)
-		{
-			std::string errMessage = "Internal failure: Failed to find control in cached json data.";
-			session.onError(session.callerContext, &session, errCode, errMessage.c_str(), errMessage.length());
-		}
-
-		return errCode;
-	}
-
-	inputData.control.kind = control->GetObject()[RPC_CONTROL_KIND].GetString();
-	inputData.control.kindLength = control->GetObject()[RPC_CONTROL_KIND].GetStringLength();
-	if (doc[RPC_PARAMS].HasMember(RPC_PARAM_TRANSACTION_ID))
-	{
-		inputData.transactionId = doc[RPC_PARAMS][RPC_PARAM_TRANSACTION_ID].GetString();
-		inputData.transactionIdLength = doc[RPC_PARAMS][RPC_PARAM_TRANSACTION_ID].GetStringLength();
-	}
-
-	std::string inputEvent = input[RPC_PARAM_INPUT_EVENT].GetString();
-	if (0 == inputEvent.compare(RPC_INPUT_EVENT_MOVE))
-	{
-		inputData.type = input_type_move;
-		inputData.coordinateData.x = input[RPC_INPUT_EVENT_MOVE_X].GetFloat();
-		inputData.coordinateData.y = input[RPC_INPUT_EVENT_MOVE_Y].GetFloat();
-	}
-	else if (0 == inputEvent.compare(RPC_INPUT_EVENT_KEY_DOWN) ||
-		0 == inputEvent.compare(RPC_INPUT_EVENT_KEY_UP))
-	{
-		inputData.type = input_type_key;
-		interactive_button_action action = interactive_button_action_up;
-		if (0 == inputEvent.compare(RPC_INPUT_EVENT_KEY_DOWN))
-		{
-			action = interactive_button_action_down;
-		}
-
-		inputData.buttonData.action = action;
-	}
-	else if (0 == inputEvent.compare(RPC_INPUT_EVENT_MOUSE_DOWN) ||
-		0 == inputEvent.compare(RPC_INPUT_EVENT_MOUSE_UP))
-	{
-		inputData.type = input_type_click;
-		interactive_button_action action = interactive_button_action_up;
-		if (0 == inputEvent.compare(RPC_INPUT_EVENT_MOUSE_DOWN))
-		{
-			action = interactive_button_action_down;
-		}
-
-		inputData.buttonData.action = action;
-
-		if (input.HasMember(RPC_INPUT_EVENT_MOVE_X))
-		{
-			inputData.coordinateData.x = input[RPC_INPUT_EVENT_MOVE_X].GetFloat();
-		}
-		if (input.HasMember(RPC_INPUT_EVENT_MOVE_Y))
-		{
-			inputData.coordinateData.y = input[RPC_INPUT_EVENT_MOVE_Y].GetFloat();
-		}
-	}
-	else
-	{
-		inputData.type = input_type_custom;
-	}
-
-	session.onInput(session.callerContext, &session, &inputData);
-
-	return MIXER_OK;
-}
-
 int handle_participants_change(interactive_session_internal& session, rapidjson::Document& doc, interactive_participant_action action)
 {
 	if (!doc.HasMember(RPC_PARAMS) || !doc[RPC_PARAMS].HasMember(RPC_PARAM_PARTICIPANTS))
@@ -319,33 +249,43 @@ int handle_participants_change(interactive_session_internal& session, rapidjson:
 		return MIXER_ERROR_UNRECOGNIZED_DATA_FORMAT;
 	}
 
+	// Critical Section: Apply the whole batch, then publish it to readers as one version.
+	int err = MIXER_OK;
 	rapidjson::Value& participants = doc[RPC_PARAMS][RPC_PARAM_PARTICIPANTS];
-	for (auto itr = participants.Begin(); itr != participants.End(); ++itr)
+	std::unique_lock<std::mutex> participantsLock(session.participants.writeMutex);
+	for (auto itr = participants.Begin(); itr != participants.End() && MIXER_OK == err; ++itr)
 	{
-		interactive_participant participant;
-		parse_participant(*itr, participant);
-
 		switch (action)
 		{
 		case participant_join:
 		case participant_update:
 		{
-			std::shared_ptr<rapidjson::Document> participantDoc(std::make_shared<rapidjson::Document>());
-			participantDoc->CopyFrom(*itr, participantDoc->GetAllocator());
-			session.participants[participant.id] = participantDoc;
+			err = session.participants.upsert(*itr);
 			break;
 		}
 		case participant_leave:
 		default:
 		{
-			session.participants.erase(participant.id);
+			if (itr->HasMember(RPC_SESSION_ID) && (*itr)[RPC_SESSION_ID].IsString())
+			{
+				session.participants.erase((*itr)[RPC_SESSION_ID].GetString());
+			}
 			break;
 		}
 		}
+	}
 
-		if (session.onParticipantsChanged)
+	session.participants.publish();
+	participantsLock.unlock();
+	RETURN_IF_FAILED(err);
+
+	if (participants_changed_handler(session))
+	{
+		for (auto itr = participants.Begin(); itr != participants.End(); ++itr)
 		{
-			session.onParticipantsChanged(session.callerContext, &session, action, &participant);
+			interactive_participant participant;
+			parse_participant(*itr, participant);
+			participants_changed_handler(session)(session.callerContext, &session, action, &participant);
 		}
 	}
 
@@ -380,9 +320,9 @@ int handle_ready(interactive_session_internal& session, rapidjson::Document& doc
 	{
 		interactive_state previousState = session.state;
 		session.state = isReady ? interactive_ready : interactive_connected;
-		if (session.onStateChanged)
+		if (state_changed_handler(session))
 		{
-			session.onStateChanged(session.callerContext, &session, previousState, session.state);
+			state_changed_handler(session)(session.callerContext, &session, previousState, session.state);
 		}
 	}
 
@@ -438,9 +378,9 @@ int handle_control_changed(interactive_session_internal& session, rapidjson::Doc
 			return MIXER_ERROR_UNKNOWN_METHOD;
 		}
 
-		if (session.onControlChanged)
+		if (control_changed_handler(session))
 		{
-			session.onControlChanged(session.callerContext, &session, eventType, &control);
+			control_changed_handler(session)(session.callerContext, &session, eventType, &control);
 		}
 	}
 
@@ -458,10 +398,10 @@ int route_method(interactive_session_internal& session, rapidjson::Document& doc
 	else
 	{
 		DEBUG_WARNING("Unhandled method type: " + method);
-		if (session.onUnhandledMethod)
+		if (unhandled_method_handler(session))
 		{
 			std::string methodJson = jsonStringify(doc);
-			session.onUnhandledMethod(session.callerContext, &session, methodJson.c_str(), methodJson.length());
+			unhandled_method_handler(session)(session.callerContext, &session, methodJson.c_str(), methodJson.length());
 		}
 	}
 
@@ -478,10 +418,151 @@ void register_method_handlers(interactive_session_internal& session)
 	session.methodHandlers.emplace(RPC_METHOD_ON_PARTICIPANT_UPDATE, handle_participants_update);
 	session.methodHandlers.emplace(RPC_METHOD_ON_GROUP_UPDATE, handle_group_changed);
 	session.methodHandlers.emplace(RPC_METHOD_ON_GROUP_CREATE, handle_group_changed);
+	session.methodHandlers.emplace(RPC_METHOD_ON_CONTROL_CREATE, handle_control_changed);
 	session.methodHandlers.emplace(RPC_METHOD_ON_CONTROL_UPDATE, handle_control_changed);
+	session.methodHandlers.emplace(RPC_METHOD_ON_CONTROL_DELETE, handle_control_changed);
 	session.methodHandlers.emplace(RPC_METHOD_UPDATE_SCENES, handle_scene_changed);
 }
 
+// A cooperative session's connection is advanced by the title's thread, taking what has arrived and sending what has been
+// queued without waiting on either.
+void step_cooperative(interactive_session_internal& session)
+{
+	if (session.cooperative && interactive_disconnected != session.state)
+	{
+		int fd = -1;
+		bool wantWrite = false;
+		int httpFd = -1;
+		std::chrono::steady_clock::time_point wakeAt;
+		session.step_connection(fd, wantWrite, httpFd, wakeAt);
+	}
+}
+
+// Process up to maxEventsToProcess queued events on the caller's thread, raising them to the handlers. Once the deadline
+// has passed no further events are started.
+static int run_queued_events(interactive_session_internal& session, unsigned int maxEventsToProcess, unsigned int* eventsProcessed, std::chrono::steady_clock::time_point deadline)
+{
+	bool timed = std::chrono::steady_clock::time_point::max() != deadline;
+	if (session.shutdownRequested)
+	{
+		return MIXER_ERROR_CANCELLED;
+	}
+
+	// Send property updates made since the last call.
+	RETURN_IF_FAILED(flush_control_updates(session));
+	step_cooperative(session);
+
+	// Process up to the requested number of events, highest priority first.
+	std::shared_ptr<interactive_event_internal> ev;
+	for (unsigned int i = 0; i < maxEventsToProcess && session.incomingEvents.try_pop(ev); ++i)
+	{
+		if (nullptr != eventsProcessed)
+		{
+			++*eventsProcessed;
+		}
+
+		switch (ev->type)
+		{
+		case interactive_event_type_error:
+		{
+			auto errorEvent = reinterpret_cast<std::shared_ptr<error_event>&>(ev);
+			if (error_handler(session))
+			{
+				error_handler(session)(session.callerContext, &session, errorEvent->error.first, errorEvent->error.second.c_str(), errorEvent->error.second.length());
+				if (session.shutdownRequested)
+				{
+					return MIXER_OK;
+				}
+			}
+			break;
+		}
+		case interactive_event_type_state_change:
+		{
+			auto stateChangeEvent = reinterpret_cast<std::shared_ptr<state_change_event>&>(ev);
+			interactive_state previousState = session.state;
+			session.state = stateChangeEvent->currentState;
+			if (state_changed_handler(session))
+			{
+				state_changed_handler(session)(session.callerContext, &session, previousState, session.state);
+			}
+			break;
+		}
+		case interactive_event_type_rpc_reply:
+		{
+			rpc_message& reply = static_cast<rpc_message&>(*ev);
+			reply.replyHandler(session, reply.document);
+			session.release_message(std::move(reinterpret_cast<std::shared_ptr<rpc_message>&>(ev)));
+			break;
+		}
+		case interactive_event_type_http_response:
+		{
+			auto httpResponseEvent = reinterpret_cast<std::shared_ptr<http_response_event>&>(ev);
+			httpResponseEvent->responseHandler(httpResponseEvent->response);
+			break;
+		}
+		case interactive_event_type_rpc_method:
+		{
+			rpc_message& method = static_cast<rpc_message&>(*ev);
+			int err = MIXER_OK;
+			if (method.isInput)
+			{
+				if (method.input.hasSequence)
+				{
+					session.sequenceId = method.input.sequence;
+				}
+
+				err = handle_decoded_input(session, method);
+			}
+			else
+			{
+				if (method.document.HasMember(RPC_SEQUENCE))
+				{
+					session.sequenceId = method.document[RPC_SEQUENCE].GetInt();
+				}
+
+				err = route_method(session, method.document);
+			}
+
+			session.release_message(std::move(reinterpret_cast<std::shared_ptr<rpc_message>&>(ev)));
+			RETURN_IF_FAILED(err);
+			break;
+		}
+		default:
+			break;
+		}
+
+		ev.reset();
+		if (session.shutdownRequested)
+		{
+			return MIXER_OK;
+		}
+
+		if (timed && std::chrono::steady_clock::now() >= deadline)
+		{
+			break;
+		}
+	}
+
+	// Send property updates made by the event handlers.
+	RETURN_IF_FAILED(flush_control_updates(session));
+	step_cooperative(session);
+	return MIXER_OK;
+}
+
+int run_events(interactive_session_internal& session, unsigned int maxEventsToProcess, unsigned int* eventsProcessed, std::chrono::steady_clock::time_point deadline)
+{
+	// Events queued from here on signal the title again, as do any left behind.
+	session.wake.reset();
+	int err = run_queued_events(session, maxEventsToProcess, eventsProcessed, deadline);
+	session.notify_incoming_space();
+	if (0 < session.incomingEvents.size())
+	{
+		session.wake.signal();
+	}
+
+	return err;
+}
+
 }
 
 using namespace mixer_internal;
@@ -532,15 +613,27 @@ int interactive_connect(interactive_session session, const char* auth, const cha
 	sessionInternal->shareCode = shareCode;
 	
 	sessionInternal->state = interactive_connecting;
-	if (sessionInternal->onStateChanged)
+	if (state_changed_handler(*sessionInternal))
 	{
-		sessionInternal->onStateChanged(sessionInternal->callerContext, sessionInternal, interactive_disconnected, sessionInternal->state);
+		state_changed_handler(*sessionInternal)(sessionInternal->callerContext, sessionInternal, interactive_disconnected, sessionInternal->state);
 		if (sessionInternal->shutdownRequested)
 		{
 			return MIXER_ERROR_CANCELLED;
 		}
 	}
 
+	// A cooperative session is connected by interactive_run.
+	if (sessionInternal->cooperative)
+	{
+		return MIXER_OK;
+	}
+
+	// A session in a group is connected by the group's threads.
+	if (nullptr != sessionInternal->reactor)
+	{
+		return sessionInternal->reactor->add(*sessionInternal) ? MIXER_ERROR : MIXER_OK;
+	}
+
 	// Create thread to open websocket and receive messages.
 	sessionInternal->incomingThread = std::thread(std::bind(&interactive_session_internal::run_incoming_thread, sessionInternal));
 
@@ -550,6 +643,118 @@ int interactive_connect(interactive_session session, const char* auth, const cha
 	return MIXER_OK;
 }
 
+int interactive_open_session_group(size_t threadCount, interactive_session_group* groupPtr)
+{
+	if (nullptr == groupPtr)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	if (0 == threadCount)
+	{
+		return MIXER_ERROR_INVALID_OPERATION;
+	}
+
+	std::unique_ptr<interactive_reactor> reactor = reactor_factory::make_reactor(threadCount);
+	if (nullptr == reactor)
+	{
+		return MIXER_ERROR_INVALID_OPERATION;
+	}
+
+	*groupPtr = reactor.release();
+	return MIXER_OK;
+}
+
+int interactive_session_group_add(interactive_session_group group, interactive_session session)
+{
+	if (nullptr == group || nullptr == session)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	if (interactive_disconnected != sessionInternal->state || nullptr != sessionInternal->reactor || sessionInternal->cooperative)
+	{
+		return MIXER_ERROR_INVALID_STATE;
+	}
+
+	// The group's threads step the session's websocket and http requests without blocking on either.
+	polled_websocket* socket = sessionInternal->ws->polled();
+	if (nullptr == socket || nullptr == sessionInternal->http->polled())
+	{
+		return MIXER_ERROR_INVALID_OPERATION;
+	}
+
+	interactive_reactor* reactor = reinterpret_cast<interactive_reactor*>(group);
+	socket->set_wake_handler([reactor, sessionInternal]()
+	{
+		reactor->wake(*sessionInternal);
+	});
+
+	sessionInternal->reactor = reactor;
+	return MIXER_OK;
+}
+
+void interactive_close_session_group(interactive_session_group group)
+{
+	if (nullptr != group)
+	{
+		// Stops and joins the group's threads.
+		delete reinterpret_cast<interactive_reactor*>(group);
+	}
+}
+
+int interactive_set_cooperative_mode(interactive_session session, bool enabled)
+{
+	if (nullptr == session)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	if (interactive_disconnected != sessionInternal->state || nullptr != sessionInternal->reactor)
+	{
+		return MIXER_ERROR_INVALID_STATE;
+	}
+
+	if (enabled && (nullptr == sessionInternal->ws->polled() || nullptr == sessionInternal->http->polled()))
+	{
+		return MIXER_ERROR_INVALID_OPERATION;
+	}
+
+	sessionInternal->cooperative = enabled;
+	return MIXER_OK;
+}
+
+int interactive_get_wake_fd(interactive_session session, int* fd)
+{
+	if (nullptr == session || nullptr == fd)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	if (sessionInternal->cooperative)
+	{
+		return MIXER_ERROR_INVALID_OPERATION;
+	}
+
+	return sessionInternal->wake.open(*fd);
+}
+
+int interactive_get_outgoing_stats(interactive_session session, interactive_outgoing_stats* stats)
+{
+	if (nullptr == session || nullptr == stats)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	sessionInternal->websocketLatency.get(stats->websocket);
+	sessionInternal->httpLatency.get(stats->http);
+	return MIXER_OK;
+}
+
 int interactive_set_session_context(interactive_session session, void* context)
 {
 	if (nullptr == session)
@@ -607,15 +812,17 @@ int interactive_set_bandwidth_throttle(interactive_session session, interactive_
 		break;
 	}
 
-	RETURN_IF_FAILED(queue_method(*sessionInternal, RPC_METHOD_SET_THROTTLE, [&](rapidjson::Document::AllocatorType& allocator, rapidjson::Value& params)
+	RETURN_IF_FAILED(queue_method(*sessionInternal, RPC_METHOD_SET_THROTTLE, [&](method_writer& writer)
 	{
-		rapidjson::Value method(rapidjson::kObjectType);
-		method.SetObject();
-		method.AddMember(RPC_PARAM_CAPACITY, maxBytes, allocator);
-		method.AddMember(RPC_PARAM_DRAIN_RATE, bytesPerSecond, allocator);
-		rapidjson::Value throttleVal(rapidjson::kStringType);
-		throttleVal.SetString(throttleMethod, allocator);
-		params.AddMember(throttleVal, method, allocator);
+		writer.StartObject();
+		writer.Key(throttleMethod.c_str(), (rapidjson::SizeType)throttleMethod.length());
+		writer.StartObject();
+		writer.Key(RPC_PARAM_CAPACITY);
+		writer.Uint(maxBytes);
+		writer.Key(RPC_PARAM_DRAIN_RATE);
+		writer.Uint(bytesPerSecond);
+		writer.EndObject();
+		writer.EndObject();
 	}, check_reply_errors));
 
 	return MIXER_OK;
@@ -634,88 +841,25 @@ int interactive_run(interactive_session session, unsigned int maxEventsToProcess
 	}
 
 	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	return run_events(*sessionInternal, maxEventsToProcess, nullptr);
+}
 
-	if (sessionInternal->shutdownRequested)
+int interactive_run_for(interactive_session session, unsigned int microsecondsBudget, size_t* pendingEvents)
+{
+	if (nullptr == session)
 	{
-		return MIXER_ERROR_CANCELLED;
+		return MIXER_ERROR_INVALID_POINTER;
 	}
 
-	// Create a local queue and populate it with the top elements from the incoming event queue to minimize locking time.
-	interactive_event_queue processingQueue;
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(microsecondsBudget);
+	int err = run_events(*sessionInternal, UINT_MAX, nullptr, deadline);
+	if (nullptr != pendingEvents)
 	{
-		std::lock_guard<std::mutex> incomingLock(sessionInternal->incomingMutex);
-		for (unsigned int i = 0; i < maxEventsToProcess && i < sessionInternal->incomingEvents.size(); ++i)
-		{
-			processingQueue.emplace(std::move(sessionInternal->incomingEvents.top()));
-			sessionInternal->incomingEvents.pop();
-		}
+		*pendingEvents = sessionInternal->incomingEvents.size();
 	}
 
-	// Process all the events in the local queue.
-	while (!processingQueue.empty())
-	{
-		auto ev = processingQueue.top();
-		switch (ev->type)
-		{
-		case interactive_event_type_error:
-		{
-			auto errorEvent = reinterpret_cast<std::shared_ptr<error_event>&>(ev);
-			if (sessionInternal->onError)
-			{
-				sessionInternal->onError(sessionInternal->callerContext, sessionInternal, errorEvent->error.first, errorEvent->error.second.c_str(), errorEvent->error.second.length());
-				if (sessionInternal->shutdownRequested)
-				{
-					return MIXER_OK;
-				}
-			}
-			break;
-		}
-		case interactive_event_type_state_change:
-		{
-			auto stateChangeEvent = reinterpret_cast<std::shared_ptr<state_change_event>&>(ev);
-			interactive_state previousState = sessionInternal->state;
-			sessionInternal->state = stateChangeEvent->currentState;
-			if (sessionInternal->onStateChanged)
-			{
-				sessionInternal->onStateChanged(sessionInternal->callerContext, sessionInternal, previousState, sessionInternal->state);
-			}
-			break;
-		}
-		case interactive_event_type_rpc_reply:
-		{
-			auto replyEvent = reinterpret_cast<std::shared_ptr<rpc_reply_event>&>(ev);
-			replyEvent->replyHandler(*sessionInternal, *replyEvent->replyJson);
-			break;
-		}
-		case interactive_event_type_http_response:
-		{
-			auto httpResponseEvent = reinterpret_cast<std::shared_ptr<http_response_event>&>(ev);
-			httpResponseEvent->responseHandler(httpResponseEvent->response);
-			break;
-		}
-		case interactive_event_type_rpc_method:
-		{
-			auto rpcMethodEvent = reinterpret_cast<std::shared_ptr<rpc_method_event>&>(ev);
-			if (rpcMethodEvent->methodJson->HasMember(RPC_SEQUENCE))
-			{
-				sessionInternal->sequenceId = (*rpcMethodEvent->methodJson)[RPC_SEQUENCE].GetInt();
-			}
-
-			RETURN_IF_FAILED(route_method(*sessionInternal, *rpcMethodEvent->methodJson));
-			break;
-		}
-		default:
-			break;
-		}
-
-		processingQueue.pop();
-		if (sessionInternal->shutdownRequested)
-		{
-			return MIXER_OK;
-		}
-	}
-
-	return MIXER_OK;
+	return err;
 }
 
 int interactive_get_state(interactive_session session, interactive_state* state)
@@ -827,6 +971,18 @@ int interactive_set_ready(interactive_session session, bool isReady)
 	return send_ready_message(*sessionInternal, isReady);
 }
 
+int interactive_set_background_caching(interactive_session session, bool enabled)
+{
+	if (nullptr == session)
+	{
+		return MIXER_ERROR_INVALID_POINTER;
+	}
+
+	interactive_session_internal* sessionInternal = reinterpret_cast<interactive_session_internal*>(session);
+	sessionInternal->backgroundCaching = enabled;
+	return MIXER_OK;
+}
+
 int interactive_capture_transaction(interactive_session session, const char* transactionId)
 {
 	if (nullptr == session || nullptr == transactionId)
@@ -846,12 +1002,15 @@ int interactive_capture_transaction(interactive_session session, const char* tra
 		return MIXER_ERROR_NOT_CONNECTED;
 	}
 	
-	RETURN_IF_FAILED(queue_method(*sessionInternal, RPC_METHOD_CAPTURE, [&](rapidjson::Document::AllocatorType& allocator, rapidjson::Value& params)
+	RETURN_IF_FAILED(queue_method(*sessionInternal, RPC_METHOD_CAPTURE, [&](method_writer& writer)
 	{
-		params.AddMember(RPC_PARAM_TRANSACTION_ID, transactionIdStr, allocator);
+		writer.StartObject();
+		writer.Key(RPC_PARAM_TRANSACTION_ID);
+		writer.String(transactionIdStr.c_str(), (rapidjson::SizeType)transactionIdStr.length());
+		writer.EndObject();
 	}, [transactionIdStr](interactive_session_internal& session, rapidjson::Document& replyDoc)
 	{
-		if (session.onTransactionComplete)
+		if (transaction_complete_handler(session))
 		{
 			unsigned int err = 0;
 			std::string errMessage;
@@ -867,7 +1026,7 @@ int interactive_capture_transaction(interactive_session session, const char* tra
 				}
 			}
 
-			session.onTransactionComplete(session.callerContext, &session, transactionIdStr.c_str(), transactionIdStr.length(), err, errMessage.c_str(), errMessage.length());
+			transaction_complete_handler(session)(session.callerContext, &session, transactionIdStr.c_str(), transactionIdStr.length(), err, errMessage.c_str(), errMessage.length());
 		}
 
 		return MIXER_OK;
@@ -906,9 +1065,9 @@ int interactive_queue_method(interactive_session session, const char* method, co
 		};
 	}
 
-	RETURN_IF_FAILED(queue_method(*sessionInternal, method, [&](rapidjson::Document::AllocatorType& allocator, rapidjson::Value& params)
+	RETURN_IF_FAILED(queue_method(*sessionInternal, method, [&](method_writer& writer)
 	{
-		params.CopyFrom(paramsDoc, allocator);
+		paramsDoc.Accept(writer);
 	}, replyHandler));
 
 	return MIXER_OK;
@@ -927,13 +1086,29 @@ void interactive_close_session(interactive_session session)
 			sessionInternal->ws->close();
 		}
 
-		// Notify the outgoing websocket thread to shutdown.
+		// Release any thread waiting for room on the incoming queue.
+		{
+			std::lock_guard<std::mutex> spaceLock(sessionInternal->incomingSpaceMutex);
+			sessionInternal->incomingSpaceCV.notify_all();
+		}
+
+		// Notify the outgoing websocket thread and the http lane to shutdown.
 		{
 			std::unique_lock<std::mutex> outgoingLock(sessionInternal->outgoingMutex);
 			sessionInternal->outgoingCV.notify_all();
 		}
+		{
+			std::unique_lock<std::mutex> httpRequestsLock(sessionInternal->httpRequestsMutex);
+			sessionInternal->httpRequestsCV.notify_all();
+		}
 
-		// Wait for both threads to terminate.
+		// Wait for the group to finish stepping the session.
+		if (nullptr != sessionInternal->reactor)
+		{
+			sessionInternal->reactor->remove(*sessionInternal);
+		}
+
+		// Wait for the threads to terminate.
 		if (sessionInternal->incomingThread.joinable())
 		{
 			sessionInternal->incomingThread.join();
@@ -942,6 +1117,10 @@ void interactive_close_session(interactive_session session)
 		{
 			sessionInternal->outgoingThread.join();
 		}
+		if (sessionInternal->httpThread.joinable())
+		{
+			sessionInternal->httpThread.join();
+		}
 
 		// Clean up the session memory.
 		delete sessionInternal;
@@ -2,10 +2,12 @@
 #include "interactivity.h"
 #include "http_client.h"
 #include "websocket.h"
-#include "rapidjson\document.h"
-#include "rapidjson\pointer.h"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
 #include "interactive_types.h"
 #include "interactive_event.h"
+#include "interactive_reactor.h"
 #include <map>
 #include <vector>
 #include <queue>
@@ -13,16 +15,72 @@
 #include <mutex>
 #include <shared_mutex>
 #include <atomic>
+#include <condition_variable>
 
 namespace mixer_internal
 {
 
+typedef rapidjson::Writer<rapidjson::StringBuffer> method_writer;
+typedef std::function<void(method_writer& writer)> on_get_params;
+
+// Events raised while the title polls, in place of its handlers. Strings are copied into chunks that are reused once
+// every event has been returned. Only the polling thread touches the events, other threads raise events with the
+// title's handlers as usual.
+struct interactive_poll_state
+{
+	interactive_poll_state();
+
+	std::atomic<std::thread::id> thread;
+	std::vector<interactive_event> events;
+	size_t delivered;
+	std::vector<std::vector<char>> chunks;
+	size_t chunk;
+	size_t chunkOffset;
+};
+
+// A descriptor the title can wait on alongside its own, readable whenever incoming events are waiting to be run. It is
+// only created once the title asks for it, and is only signalled when it is not already, so a busy session makes at
+// most one system call per call to interactive_run.
+struct interactive_wake_signal
+{
+	interactive_wake_signal();
+	~interactive_wake_signal();
+
+	int open(int& fd);
+
+	// Any thread.
+	void signal();
+
+	// Title thread only, before the events it is waking for are taken.
+	void reset();
+
+private:
+	std::atomic<int> fd;
+	std::atomic<bool> signalled;
+};
+
+// How long outgoing events waited to be sent. Recorded by the thread sending them and read by any thread.
+struct queue_latency_histogram
+{
+	queue_latency_histogram();
+	void record(std::chrono::steady_clock::time_point queuedAt);
+	void get(interactive_queue_latency& latency) const;
+
+private:
+	std::atomic<unsigned long long> count;
+	std::atomic<unsigned long long> totalMicroseconds;
+	std::atomic<unsigned long long> maxMicroseconds;
+	std::atomic<unsigned long long> buckets[INTERACTIVE_QUEUE_LATENCY_BUCKETS];
+};
+
 struct interactive_session_internal
 {
 	interactive_session_internal();
 
 	// Configuration
 	bool isReady;
+	size_t participantsBatchBytes;
+	std::atomic<bool> backgroundCaching;
 
 	// State
 	interactive_state state;
@@ -44,11 +102,14 @@ struct interactive_session_internal
 	std::shared_mutex scenesMutex;
 	rapidjson::Document scenesRoot;
 	bool scenesCached;
-	scenes_by_id scenes;
 	scenes_by_group scenesByGroup;
 	bool groupsCached;
-	controls_by_id controls;
-	participants_by_id participants;
+	interactive_control_store controls;
+	property_handles propertyHandles;
+	property_handles_by_name propertyHandlesByName;
+	interactive_participant_store participants;
+	std::atomic<unsigned int> participantSyncId;
+	unsigned int participantSyncWalkers;
 
 	// Event handlers
 	on_input onInput;
@@ -58,6 +119,19 @@ struct interactive_session_internal
 	on_control_changed onControlChanged;
 	on_transaction_complete onTransactionComplete;
 	on_unhandled_method onUnhandledMethod;
+	interactive_poll_state poll;
+
+	// Control property writes waiting to be sent, batched as { sceneId: { controlId: { key: value } } }. The writes merged
+	// into each scene's batch are counted in the order of the scenes.
+	std::mutex controlUpdatesMutex;
+	rapidjson::Document controlUpdates;
+	std::vector<size_t> controlUpdatesPerScene;
+	size_t controlUpdatesPending;
+	interactive_control_update_stats controlUpdateStats;
+
+	// The input currently being raised to the title, so its json can be serialized on request.
+	const interactive_input* activeInput;
+	const rapidjson::Value* activeInputParams;
 
 	// Transactions that have been completed.
 	std::map<std::string, interactive_error> completedTransactions;
@@ -65,50 +139,124 @@ struct interactive_session_internal
 	// Http
 	std::unique_ptr<http_client> http;
 	std::mutex httpMutex;
+	// Requests are sent from a lane of their own, started by the first request, so websocket methods never wait behind
+	// them. The lane of a grouped or cooperative session is run by each step of its connection, which sends the requests
+	// without blocking.
+	void run_http_thread();
+	std::thread httpThread;
+	std::mutex httpRequestsMutex;
+	std::condition_variable httpRequestsCV;
+	std::queue<std::shared_ptr<http_request_event>> httpRequests;
+	int send_http_request(const std::shared_ptr<http_request_event>& request);
+	queue_latency_histogram httpLatency;
 
 	// Websocket
 	std::mutex websocketMutex;
 	std::unique_ptr<websocket> ws;
 	bool wsOpen;
+	// Counts the times the websocket has opened, guarded by outgoingMutex.
+	unsigned int wsOpenCount;
 	// Websocket handlers
 	void handle_ws_open(const websocket& socket, const std::string& message);
-	void handle_ws_message(const websocket& socket, const std::string& message);
+	void handle_ws_message(const websocket& socket, char* message, const size_t messageSize);
 	void handle_ws_close(const websocket& socket, unsigned short code, const std::string& message);
 
 	// Outgoing data
+	// Methods are serialized into a reusable buffer, only the finished bytes are queued.
+	std::mutex methodBufferMutex;
+	rapidjson::StringBuffer methodBuffer;
+	method_writer methodWriter;
 	void run_outgoing_thread();
 	std::thread outgoingThread;
 	std::mutex outgoingMutex;
 	std::condition_variable outgoingCV;
 	std::queue<std::shared_ptr<interactive_event_internal>> outgoingEvents;
 	void enqueue_outgoing_event(std::shared_ptr<interactive_event_internal>&& ev);
+	queue_latency_histogram websocketLatency;
+
+	// Connection retries
+	unsigned int connectionRetryFrequency;
+	void handle_ws_ended(const std::string& host, int err);
+
+	// A session in a group is stepped by the group's reactor rather than by its own incoming and outgoing threads.
+	interactive_reactor* reactor;
+	unsigned long long reactorId;
+	std::vector<std::string> hosts;
+	size_t hostIndex;
+	std::chrono::steady_clock::time_point retryAt;
+	bool wsStarted;
+	std::queue<std::shared_ptr<interactive_event_internal>> processingEvents;
+	// Step the connection without blocking, then give the websocket's descriptor, the http client's descriptor and the
+	// time to step again.
+	void step_connection(int& fd, bool& wantWrite, int& httpFd, std::chrono::steady_clock::time_point& wakeAt);
+	void watch_http(polled_http_client* httpPoller, int& httpFd, std::chrono::steady_clock::time_point& wakeAt);
+	int send_outgoing_event(const std::shared_ptr<interactive_event_internal>& ev);
+	void complete_http_request(const http_request_event& request, int err, http_response& response);
+
+	// A cooperative session is stepped by interactive_run and never starts a thread of its own, only the sockets start one
+	// to look up a host name. Its http requests, including the hosts lookup, are made without blocking.
+	bool cooperative;
+	bool hostsRequested;
 
 	// Incoming data
 	void run_incoming_thread();
 	std::thread incomingThread;
+	// The event queue takes no lock, incomingMutex guards the reply handlers.
 	std::mutex incomingMutex;
 	interactive_event_queue incomingEvents;
+	interactive_wake_signal wake;
 	reply_handlers_by_id replyHandlersById;
 	std::map<unsigned int, http_response_handler> httpResponseHandlers;
 	void enqueue_incoming_event(std::shared_ptr<interactive_event_internal>&& ev);
+	// Threads that find their ring full wait here until interactive_run has drained events.
+	std::mutex incomingSpaceMutex;
+	std::condition_variable incomingSpaceCV;
+	std::atomic<unsigned int> incomingSpaceWaiters;
+	void notify_incoming_space();
+
+	// Inbound messages are parsed into pooled documents which are recycled once they have been handled. Every inbound
+	// event that could not be taken from the pool is counted. Messages are returned to the pool by any thread but only
+	// taken by the thread receiving websocket messages, so the pool is a ring rather than a locked list.
+	std::atomic<unsigned long long> incomingAllocations;
+	mpsc_ring<std::shared_ptr<rpc_message>> messagePool;
+	std::shared_ptr<rpc_message> acquire_message();
+	void release_message(std::shared_ptr<rpc_message>&& message);
 
 	// Method handlers
 	method_handlers_by_method methodHandlers;
 };
 
-typedef std::function<void(rapidjson::Document::AllocatorType& allocator, rapidjson::Value& value)> on_get_params;
-
 // Common helper functions
 int queue_method(interactive_session_internal& session, const std::string& method, on_get_params getParams, method_handler onReply, const bool handleImmediately = false);
+int queue_request(interactive_session_internal& session, const std::string uri, const std::string& verb, const http_headers* headers, const std::string* body, http_response_handler onResponse);
 int bootstrap(interactive_session_internal& session);
+int run_events(interactive_session_internal& session, unsigned int maxEventsToProcess, unsigned int* eventsProcessed, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
 
 int cache_groups(interactive_session_internal& session);
+// The handlers events are raised with, these are the poll state's while the title polls on the calling thread.
+on_input input_handler(interactive_session_internal& session);
+on_error error_handler(interactive_session_internal& session);
+on_state_changed state_changed_handler(interactive_session_internal& session);
+on_participants_changed participants_changed_handler(interactive_session_internal& session);
+on_control_changed control_changed_handler(interactive_session_internal& session);
+on_transaction_complete transaction_complete_handler(interactive_session_internal& session);
+on_unhandled_method unhandled_method_handler(interactive_session_internal& session);
+
 int cache_scenes(interactive_session_internal& session);
 int update_cached_control(interactive_session_internal& session, interactive_control& control, rapidjson::Value& controlJson);
-int update_control_pointers(interactive_session_internal& session, const char* sceneId = nullptr);
+int cache_controls(interactive_session_internal& session);
+int flush_control_updates(interactive_session_internal& session);
+void refresh_property_handles(interactive_session_internal& session, const char* controlId = nullptr);
 void parse_participant(rapidjson::Value& participantJson, interactive_participant& participant);
+int sync_participants(interactive_session_internal& session);
+void record_participant_input(interactive_session_internal& session, const char* participantId, size_t participantIdLength);
 void parse_control(rapidjson::Value& controlJson, interactive_control& control);
 
+// Input handling. Input methods are decoded without a DOM when possible, falling back to the document otherwise.
+bool decode_input(rpc_message& message);
+int handle_decoded_input(interactive_session_internal& session, rpc_message& message);
+int handle_input(interactive_session_internal& session, rapidjson::Document& doc);
+
 // Common reply handler that checks a reply for errors and calls the session's error handler if it exists.
 int check_reply_errors(interactive_session_internal& session, rapidjson::Document& reply);
 
@@ -131,6 +279,15 @@ int check_reply_errors(interactive_session_internal& session, rapidjson::Documen
 #define RPC_DISABLED                   "disabled"
 #define RPC_SEQUENCE				   "seq"
 
+// Fixed fragments of the outgoing method envelope: {"id":<id>,"method":<method>,"discard":<discard>,"seq":<seq>,"params":<params>}
+#define RPC_METHOD_ENVELOPE_ID         "{\"" RPC_ID "\":"
+#define RPC_METHOD_ENVELOPE_METHOD     ",\"" RPC_METHOD "\":"
+#define RPC_METHOD_ENVELOPE_DISCARD    ",\"" RPC_DISCARD "\":"
+#define RPC_METHOD_ENVELOPE_SEQUENCE   ",\"" RPC_SEQUENCE "\":"
+#define RPC_METHOD_ENVELOPE_PARAMS     ",\"" RPC_PARAMS "\":"
+#define RPC_METHOD_ENVELOPE_END        "}"
+#define RPC_METHOD_EMPTY_PARAMS        "{}"
+
 // RPC methods and replies
 #define RPC_METHOD_HELLO               "hello"
 #define RPC_METHOD_READY               "ready"   // equivalent to "start_interactive" or "goInteractive"
@@ -150,6 +307,7 @@ int check_reply_errors(interactive_session_internal& session, rapidjson::Documen
 
 #define RPC_GET_PARTICIPANTS           "getAllParticipants"
 #define RPC_GET_PARTICIPANTS_BLOCK_SIZE 100 // returns up to 100 participants
+#define RPC_GET_PARTICIPANTS_PIPELINE  8 // page requests in flight while syncing participants
 #define RPC_METHOD_ON_PARTICIPANT_JOIN "onParticipantJoin"
 #define RPC_METHOD_ON_PARTICIPANT_LEAVE "onParticipantLeave"
 #define RPC_METHOD_ON_PARTICIPANT_UPDATE "onParticipantUpdate"
@@ -157,7 +315,12 @@ int check_reply_errors(interactive_session_internal& session, rapidjson::Documen
 #define RPC_METHOD_PARTICIPANTS_UPDATE "updateParticipants"
 #define RPC_PARAM_PARTICIPANTS         "participants"
 #define RPC_PARAM_PARTICIPANT          "participant"
+#define RPC_PARAM_FROM                 "from"
+#define RPC_PARAM_TOTAL                "total"
+#define RPC_PARAM_HAS_MORE             "hasMore"
 #define RPC_PARAM_PARTICIPANTS_ACTIVE_THRESHOLD "threshold" // unix milliseconds timestamp
+#define RPC_PARAM_PRIORITY             "priority"
+#define RPC_PARTICIPANTS_BATCH_BYTES   32768 // default largest updateParticipants message sent by a batch
 
 #define RPC_METHOD_GET_SCENES          "getScenes"
 #define RPC_METHOD_UPDATE_SCENES       "updateScenes"
@@ -1,16 +1,139 @@
 #include "interactive_session.h"
 #include "common.h"
 
+#if __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
 namespace mixer_internal
 {
 
+#define DEFAULT_CONNECTION_RETRY_FREQUENCY_S 1
+#define MAX_CONNECTION_RETRY_FREQUENCY_S 8
+
+#define MESSAGE_POOL_MAX_SIZE 256 // Must be a power of two.
+#define MESSAGE_POOL_MAX_BUFFER_SIZE 65536
+
 interactive_session_internal::interactive_session_internal()
-	: callerContext(nullptr), isReady(false), state(interactive_disconnected), shutdownRequested(false),packetId(0), 
-	sequenceId(0), wsOpen(false), onInput(nullptr), onError(nullptr), onStateChanged(nullptr), onParticipantsChanged(nullptr), 
-	onUnhandledMethod(nullptr), onControlChanged(nullptr), onTransactionComplete(nullptr), serverTimeOffsetMs(0), serverTimeOffsetCalculated(false), scenesCached(false), groupsCached(false),
-	getTimeRequestId(0xffffffff)
+	: isReady(false), participantsBatchBytes(RPC_PARTICIPANTS_BATCH_BYTES), backgroundCaching(false), state(interactive_disconnected),
+	shutdownRequested(false), callerContext(nullptr), packetId(0), sequenceId(0), serverTimeOffsetMs(0), serverTimeOffsetCalculated(false),
+	getTimeRequestId(0xffffffff), scenesCached(false), groupsCached(false), participantSyncId(0), participantSyncWalkers(0), onInput(nullptr),
+	onError(nullptr), onStateChanged(nullptr), onParticipantsChanged(nullptr), onControlChanged(nullptr), onTransactionComplete(nullptr),
+	onUnhandledMethod(nullptr), controlUpdatesPending(0), activeInput(nullptr), activeInputParams(nullptr), wsOpen(false), wsOpenCount(0),
+	connectionRetryFrequency(DEFAULT_CONNECTION_RETRY_FREQUENCY_S), reactor(nullptr), reactorId(0), hostIndex(0), wsStarted(false),
+	cooperative(false), hostsRequested(false), incomingSpaceWaiters(0), incomingAllocations(0), messagePool(MESSAGE_POOL_MAX_SIZE)
 {
 	scenesRoot.SetObject();
+	controlUpdates.SetObject();
+	memset(&controlUpdateStats, 0, sizeof(controlUpdateStats));
+}
+
+queue_latency_histogram::queue_latency_histogram() : count(0), totalMicroseconds(0), maxMicroseconds(0)
+{
+	for (auto& bucket : buckets)
+	{
+		bucket = 0;
+	}
+}
+
+void
+queue_latency_histogram::record(std::chrono::steady_clock::time_point queuedAt)
+{
+	unsigned long long waitUs = (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queuedAt).count();
+	size_t bucket = 0;
+	while (bucket + 1 < INTERACTIVE_QUEUE_LATENCY_BUCKETS && waitUs >= (1ull << bucket))
+	{
+		++bucket;
+	}
+
+	++this->buckets[bucket];
+	++this->count;
+	this->totalMicroseconds += waitUs;
+	unsigned long long maxUs = this->maxMicroseconds;
+	while (waitUs > maxUs && !this->maxMicroseconds.compare_exchange_weak(maxUs, waitUs))
+	{
+	}
+}
+
+void
+queue_latency_histogram::get(interactive_queue_latency& latency) const
+{
+	latency.count = this->count;
+	latency.totalMicroseconds = this->totalMicroseconds;
+	latency.maxMicroseconds = this->maxMicroseconds;
+	for (size_t i = 0; i < INTERACTIVE_QUEUE_LATENCY_BUCKETS; ++i)
+	{
+		latency.buckets[i] = this->buckets[i];
+	}
+}
+
+interactive_wake_signal::interactive_wake_signal() : fd(-1), signalled(false)
+{
+}
+
+interactive_wake_signal::~interactive_wake_signal()
+{
+#if __linux__
+	if (0 <= this->fd)
+	{
+		::close(this->fd);
+	}
+#endif
+}
+
+int
+interactive_wake_signal::open(int& wakeFd)
+{
+#if __linux__
+	if (0 > this->fd)
+	{
+		int newFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (0 > newFd)
+		{
+			return errno;
+		}
+
+		this->fd = newFd;
+
+		// Events queued before there was anything to signal still need to be run.
+		this->signalled = true;
+		uint64_t one = 1;
+		(void)::write(newFd, &one, sizeof(one));
+	}
+
+	wakeFd = this->fd;
+	return MIXER_OK;
+#else
+	// Titles on Windows wait for events with their own timers.
+	(wakeFd);
+	return MIXER_ERROR_INVALID_OPERATION;
+#endif
+}
+
+void
+interactive_wake_signal::signal()
+{
+#if __linux__
+	int wakeFd = this->fd.load(std::memory_order_acquire);
+	if (0 <= wakeFd && !this->signalled.exchange(true))
+	{
+		uint64_t one = 1;
+		(void)::write(wakeFd, &one, sizeof(one));
+	}
+#endif
+}
+
+void
+interactive_wake_signal::reset()
+{
+#if __linux__
+	if (this->signalled.exchange(false))
+	{
+		uint64_t count;
+		(void)::read(this->fd, &count, sizeof(count));
+	}
+#endif
 }
 
 interactive_object_internal::interactive_object_internal(std::string id) : id(std::move(id)) {}
@@ -18,53 +141,173 @@ interactive_object_internal::interactive_object_internal(std::string id) : id(st
 void
 interactive_session_internal::enqueue_outgoing_event(std::shared_ptr<interactive_event_internal>&& ev)
 {
-	std::unique_lock<std::mutex> outgoingLock(this->outgoingMutex);
-	this->outgoingEvents.emplace(ev);
+	if (interactive_event_type_http_request == ev->type)
+	{
+		// Critical Section: Queue the request for the http lane. A grouped session's lane runs on the group's reactor and
+		// a cooperative session's on the title's thread, any other session starts a thread for it with the first request.
+		{
+			std::unique_lock<std::mutex> httpRequestsLock(this->httpRequestsMutex);
+			this->httpRequests.emplace(std::move(reinterpret_cast<std::shared_ptr<http_request_event>&>(ev)));
+			if (nullptr == this->reactor && !this->cooperative && !this->httpThread.joinable())
+			{
+				this->httpThread = std::thread(std::bind(&interactive_session_internal::run_http_thread, this));
+			}
+
+			this->httpRequestsCV.notify_one();
+		}
+
+		if (nullptr != this->reactor)
+		{
+			this->reactor->wake(*this);
+		}
+
+		return;
+	}
+
+	// Critical Section: Queue the event and wake whichever thread sends it.
+	{
+		std::unique_lock<std::mutex> outgoingLock(this->outgoingMutex);
+		this->outgoingEvents.emplace(std::move(ev));
+		this->outgoingCV.notify_one();
+	}
+
+	if (nullptr != this->reactor)
+	{
+		this->reactor->wake(*this);
+	}
 }
 
 void
 interactive_session_internal::enqueue_incoming_event(std::shared_ptr<interactive_event_internal>&& ev)
 {
-	std::unique_lock<std::mutex> incomingLock(this->incomingMutex);
-	this->incomingEvents.emplace(ev);
+	// Methods and replies are pooled messages, every other inbound event is allocated for the occasion.
+	if (interactive_event_type_rpc_method != ev->type && interactive_event_type_rpc_reply != ev->type)
+	{
+		++this->incomingAllocations;
+	}
+
+	// Without threads of its own the session queues on the title's thread, which can not wait on itself.
+	if (this->cooperative)
+	{
+		this->incomingEvents.push_local(std::move(ev));
+		return;
+	}
+
+	// The rings are bounded, wait for the title to catch up rather than queue without limit.
+	if (!this->incomingEvents.try_push(std::move(ev)))
+	{
+		// Critical Section: Register as a waiter before trying again, so space freed in between is not missed.
+		std::unique_lock<std::mutex> spaceLock(this->incomingSpaceMutex);
+		++this->incomingSpaceWaiters;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		this->incomingSpaceCV.wait(spaceLock, [&]() { return this->shutdownRequested || this->incomingEvents.try_push(std::move(ev)); });
+		--this->incomingSpaceWaiters;
+		if (this->shutdownRequested)
+		{
+			return;
+		}
+	}
+
+	this->wake.signal();
+}
+
+void
+interactive_session_internal::notify_incoming_space()
+{
+	// Pairs with the fence in enqueue_incoming_event, either the waiter sees the freed space or it is seen here.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (0 < this->incomingSpaceWaiters)
+	{
+		std::lock_guard<std::mutex> spaceLock(this->incomingSpaceMutex);
+		this->incomingSpaceCV.notify_all();
+	}
+}
+
+std::shared_ptr<rpc_message>
+interactive_session_internal::acquire_message()
+{
+	std::shared_ptr<rpc_message> message;
+	if (this->messagePool.try_pop(message))
+	{
+		return message;
+	}
+
+	++this->incomingAllocations;
+	return std::make_shared<rpc_message>();
+}
+
+void
+interactive_session_internal::release_message(std::shared_ptr<rpc_message>&& message)
+{
+	// Messages that grew to hold an unusually large payload are not worth keeping around.
+	if (nullptr == message || message->buffer.capacity() > MESSAGE_POOL_MAX_BUFFER_SIZE)
+	{
+		message.reset();
+		return;
+	}
+
+	message->document.SetNull();
+	message->allocator.Clear();
+	message->isInput = false;
+	message->replyHandler = nullptr;
+
+	// A full pool leaves the message with the caller to be freed.
+	this->messagePool.try_push(std::move(message));
+	message.reset();
 }
 
 void interactive_session_internal::handle_ws_open(const websocket& socket, const std::string& message)
 {
 	(socket);
 	DEBUG_INFO("Websocket opened: " + message);
-	// Notify the outgoing thread.
-	this->wsOpen = true;
+	// Critical Section: Notify the outgoing thread.
+	{
+		std::unique_lock<std::mutex> outgoingLock(this->outgoingMutex);
+		this->wsOpen = true;
+		++this->wsOpenCount;
+		this->outgoingCV.notify_all();
+	}
 }
 
-void interactive_session_internal::handle_ws_message(const websocket& socket, const std::string& message)
+void interactive_session_internal::handle_ws_message(const websocket& socket, char* message, const size_t messageSize)
 {
 	(socket);
-	DEBUG_TRACE("Websocket message received: " + message);
+	DEBUG_TRACE("Websocket message received: " + std::string(message, messageSize));
 	if (this->shutdownRequested)
 	{
 		return;
 	}
 
-	// Parse the message to determine packet type.
-	std::shared_ptr<rapidjson::Document> messageJson = std::make_shared<rapidjson::Document>();
-	if (!messageJson->Parse(message.c_str(), message.length()).HasParseError())
+	// Copy the message into a pooled buffer. Input is by far the most frequent method, try to decode it without a DOM.
+	std::shared_ptr<rpc_message> rpcMessage = this->acquire_message();
+	rpcMessage->buffer.assign(message, message + messageSize + 1);
+	rpcMessage->type = interactive_event_type_rpc_method;
+	if (decode_input(*rpcMessage))
+	{
+		this->enqueue_incoming_event(std::move(rpcMessage));
+		return;
+	}
+
+	// Parse the message in place to determine packet type.
+	rapidjson::Document& messageJson = rpcMessage->document;
+	if (!messageJson.ParseInsitu(rpcMessage->buffer.data()).HasParseError())
 	{
-		if (!messageJson->HasMember(RPC_TYPE))
+		if (!messageJson.HasMember(RPC_TYPE))
 		{
 			// Message does not conform to protocol, ignore it.
 			DEBUG_WARNING("Incoming RPC packet missing type parameter.");
+			this->release_message(std::move(rpcMessage));
 			return;
 		}
 
-		std::string type = (*messageJson)[RPC_TYPE].GetString();
-		if (0 == type.compare(RPC_METHOD))
+		const char* type = messageJson[RPC_TYPE].GetString();
+		if (0 == strcmp(type, RPC_METHOD))
 		{	
-			this->enqueue_incoming_event(std::make_shared<rpc_method_event>(std::move(messageJson)));
+			this->enqueue_incoming_event(std::move(rpcMessage));
 		}
-		else if (0 == type.compare(RPC_REPLY))
+		else if (0 == strcmp(type, RPC_REPLY))
 		{
-			unsigned int id = (*messageJson)[RPC_ID].GetUint();
+			unsigned int id = messageJson[RPC_ID].GetUint();
 			method_handler handlerFunc = nullptr;
 			bool executeImmediately = false;
 			// Critical Section: Check if there is a registered reply handler and if it's marked for immediate execution.
@@ -83,19 +326,24 @@ void interactive_session_internal::handle_ws_message(const websocket& socket, co
 			{
 				if (executeImmediately)
 				{
-					handlerFunc(*this, *messageJson);
+					handlerFunc(*this, messageJson);
 				}
 				else
 				{
-					this->enqueue_incoming_event(std::make_shared<rpc_reply_event>(id, std::move(messageJson), handlerFunc));
+					rpcMessage->type = interactive_event_type_rpc_reply;
+					rpcMessage->replyId = id;
+					rpcMessage->replyHandler = std::move(handlerFunc);
+					this->enqueue_incoming_event(std::move(rpcMessage));
 				}
 			}
 		}
 	}
 	else
 	{
-		DEBUG_ERROR("Failed to parse websocket message: " + message);
+		DEBUG_ERROR("Failed to parse websocket message: " + std::string(message, messageSize));
 	}
+
+	this->release_message(std::move(rpcMessage));
 }
 
 void interactive_session_internal::handle_ws_close(const websocket& socket, const unsigned short code, const std::string& message)
@@ -104,17 +352,10 @@ void interactive_session_internal::handle_ws_close(const websocket& socket, cons
 	DEBUG_INFO("Websocket closed: " + message + " (" + std::to_string(code) + ")");
 }
 
-int get_interactive_hosts(interactive_session_internal& session, std::vector<std::string>& interactiveHosts)
-{	
-	DEBUG_INFO("Retrieving interactive hosts.");
-	http_response response;
-	static std::string hostsUri = "https://mixer.com/api/v1/interactive/hosts";
-	// Critical Section: Http request.
-	{
-		std::unique_lock<std::mutex> httpLock(session.httpMutex);
-		RETURN_IF_FAILED(session.http->make_request(hostsUri, "GET", nullptr, "", response));
-	}
+#define INTERACTIVE_HOSTS_URI "https://mixer.com/api/v1/interactive/hosts"
 
+int parse_interactive_hosts(interactive_session_internal& session, const http_response& response, std::vector<std::string>& interactiveHosts)
+{
 	if (200 != response.statusCode)
 	{
 		std::string errorMessage = "Failed to acquire interactive host servers.";
@@ -143,19 +384,107 @@ int get_interactive_hosts(interactive_session_internal& session, std::vector<std
 	return MIXER_OK;
 }
 
-#define DEFAULT_CONNECTION_RETRY_FREQUENCY_S 1
-#define MAX_CONNECTION_RETRY_FREQUENCY_S 8
+int get_interactive_hosts(interactive_session_internal& session, std::vector<std::string>& interactiveHosts)
+{	
+	DEBUG_INFO("Retrieving interactive hosts.");
+	http_response response;
+	// Critical Section: Http request.
+	{
+		std::unique_lock<std::mutex> httpLock(session.httpMutex);
+		RETURN_IF_FAILED(session.http->make_request(INTERACTIVE_HOSTS_URI, "GET", nullptr, "", response));
+	}
+
+	return parse_interactive_hosts(session, response, interactiveHosts);
+}
+
+// Start looking up the interactive hosts without waiting, the hosts are filled in by a later poll of the http client.
+int request_interactive_hosts(interactive_session_internal& session)
+{
+	DEBUG_INFO("Requesting interactive hosts.");
+	session.hostsRequested = true;
+	int err = session.http->polled()->make_request_async(INTERACTIVE_HOSTS_URI, "GET", nullptr, "", [&session](int err, http_response& response)
+	{
+		session.hostsRequested = false;
+		if (MIXER_OK == err)
+		{
+			err = parse_interactive_hosts(session, response, session.hosts);
+		}
+
+		if (err || session.hosts.empty())
+		{
+			session.hosts.clear();
+			session.retryAt = std::chrono::steady_clock::now() + std::chrono::seconds(session.connectionRetryFrequency);
+		}
+	});
+
+	if (err)
+	{
+		session.hostsRequested = false;
+	}
+
+	return err;
+}
+
+void interactive_session_internal::handle_ws_ended(const std::string& host, int err)
+{
+	if (!err)
+	{
+		return;
+	}
+
+	std::string errorMessage;
+	if (!this->wsOpen)
+	{
+		errorMessage = "Failed to open websocket: " + host;
+		DEBUG_ERROR(std::to_string(err) + " " + errorMessage);
+		enqueue_incoming_event(std::make_shared<error_event>(interactive_error(MIXER_ERROR_WS_CONNECT_FAILED, std::move(errorMessage))));
+		return;
+	}
+
+	this->wsOpen = false;
+	errorMessage = "Lost connection to websocket: " + host;
+	// Since there was a successful connection, reset the connection retry frequency and hosts.
+	this->connectionRetryFrequency = DEFAULT_CONNECTION_RETRY_FREQUENCY_S;
+	enqueue_incoming_event(std::make_shared<error_event>(interactive_error(MIXER_ERROR_WS_CLOSED, errorMessage)));
+
+	// When the websocket closes, interactive state is fully reset. Clear any pending methods.
+	// Critical Section: Clear websocket methods.
+	{
+		std::lock_guard<std::mutex> outgoingLock(this->outgoingMutex);
+		std::queue<std::shared_ptr<interactive_event_internal>> cleanOutgoingEvents;
+		while (!this->outgoingEvents.empty())
+		{
+			auto ev = this->outgoingEvents.front();
+			if (ev->type != interactive_event_type_rpc_method)
+			{
+				cleanOutgoingEvents.emplace(std::move(ev));
+			}
+			this->outgoingEvents.pop();
+		}
+
+		if (!cleanOutgoingEvents.empty())
+		{
+			this->outgoingEvents.swap(cleanOutgoingEvents);
+		}
+	}
+
+	// Reset bootstraps
+	this->serverTimeOffsetCalculated = false;
+	this->groupsCached = false;
+	this->scenesCached = false;
+
+	enqueue_incoming_event(std::make_shared<state_change_event>(interactive_connecting));
+}
 
 void interactive_session_internal::run_incoming_thread()
 {	
 	auto onWsOpen = std::bind(&interactive_session_internal::handle_ws_open, this, std::placeholders::_1, std::placeholders::_2);
-	auto onWsMessage = std::bind(&interactive_session_internal::handle_ws_message, this, std::placeholders::_1, std::placeholders::_2);
+	auto onWsMessage = std::bind(&interactive_session_internal::handle_ws_message, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
 	auto onWsClose = std::bind(&interactive_session_internal::handle_ws_close, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
 
 	// Interactive hosts in retry order.
 	std::vector<std::string> hosts;
 	std::vector<std::string>::iterator hostItr;
-	static unsigned int connectionRetryFrequency = DEFAULT_CONNECTION_RETRY_FREQUENCY_S;
 
 	while (!shutdownRequested)
 	{
@@ -188,53 +517,7 @@ void interactive_session_internal::run_incoming_thread()
 			break;
 		}
 
-		if (err)
-		{
-			std::string errorMessage;
-			if (!this->wsOpen)
-			{
-				errorMessage = "Failed to open websocket: " + *hostItr;
-				DEBUG_ERROR(std::to_string(err) + " " + errorMessage);
-				enqueue_incoming_event(std::make_shared<error_event>(interactive_error(MIXER_ERROR_WS_CONNECT_FAILED, std::move(errorMessage))));
-			}
-			else
-			{
-				this->wsOpen = false;
-				errorMessage = "Lost connection to websocket: " + *hostItr;
-				// Since there was a successful connection, reset the connection retry frequency and hosts.
-				connectionRetryFrequency = DEFAULT_CONNECTION_RETRY_FREQUENCY_S;
-				enqueue_incoming_event(std::make_shared<error_event>(interactive_error(MIXER_ERROR_WS_CLOSED, errorMessage)));
-
-				// When the websocket closes, interactive state is fully reset. Clear any pending methods.
-				// Critical Section: Clear websocket methods.
-				{
-					std::lock_guard<std::mutex> outgoingLock(this->outgoingMutex);
-					std::queue<std::shared_ptr<interactive_event_internal>> cleanOutgoingEvents;
-					while (!this->outgoingEvents.empty())
-					{
-						auto ev = this->outgoingEvents.front();
-						if (ev->type != interactive_event_type_rpc_method)
-						{
-							cleanOutgoingEvents.emplace(std::move(ev));
-						}
-						this->outgoingEvents.pop();
-					}
-
-					if (!cleanOutgoingEvents.empty())
-					{
-						this->outgoingEvents.swap(cleanOutgoingEvents);
-					}
-				}
-
-				// Reset bootstraps
-				this->serverTimeOffsetCalculated = false;
-				this->groupsCached = false;
-				this->scenesCached = false;
-
-				enqueue_incoming_event(std::make_shared<state_change_event>(interactive_connecting));
-			}
-		}
-		
+		handle_ws_ended(*hostItr, err);
 		++hostItr;
 
 		// Once all the hosts have been tried, clear it and get a new list of hosts.
@@ -247,121 +530,380 @@ void interactive_session_internal::run_incoming_thread()
 	}
 }
 
+void interactive_session_internal::complete_http_request(const http_request_event& request, int err, http_response& response)
+{
+	// Critical Section: Find the response handler for this request.
+	http_response_handler handler = nullptr;
+	{
+		std::unique_lock<std::mutex> incomingLock(this->incomingMutex);
+		auto responseHandlerItr = this->httpResponseHandlers.find(request.packetId);
+		if (responseHandlerItr != this->httpResponseHandlers.end())
+		{
+			handler = std::move(responseHandlerItr->second);
+			this->httpResponseHandlers.erase(responseHandlerItr);
+		}
+	}
+
+	if (err)
+	{
+		// A failed request is reported once rather than retried.
+		std::string errorMessage = "Failed to '" + request.verb + "' to " + request.uri;
+		DEBUG_ERROR(std::to_string(err) + " " + errorMessage);
+		enqueue_incoming_event(std::make_shared<error_event>(interactive_error(MIXER_ERROR_HTTP, std::move(errorMessage))));
+		return;
+	}
+
+	DEBUG_TRACE("HTTP response received: (" + std::to_string(response.statusCode) + ") " + response.body);
+	if (nullptr != handler)
+	{
+		enqueue_incoming_event(std::make_shared<http_response_event>(std::move(response), handler));
+	}
+}
+
+int interactive_session_internal::send_http_request(const std::shared_ptr<http_request_event>& request)
+{
+	this->httpLatency.record(request->queuedAt);
+	if (this->cooperative || nullptr != this->reactor)
+	{
+		// The request completes during a later step.
+		int err = this->http->polled()->make_request_async(request->uri, request->verb, request->headers.empty() ? nullptr : &request->headers, request->body, [this, request](int err, http_response& response)
+		{
+			complete_http_request(*request, err, response);
+		});
+
+		if (err)
+		{
+			http_response response;
+			complete_http_request(*request, err, response);
+		}
+
+		return err ? MIXER_ERROR_HTTP : MIXER_OK;
+	}
+
+	http_response response;
+	int err = 0;
+	// Critical Section: Http request.
+	{
+		std::unique_lock<std::mutex> httpLock(this->httpMutex);
+		err = http->make_request(request->uri, request->verb, request->headers.empty() ? nullptr : &request->headers, request->body, response);
+	}
+
+	if (this->shutdownRequested)
+	{
+		return MIXER_ERROR_CANCELLED;
+	}
+
+	complete_http_request(*request, err, response);
+	return err ? MIXER_ERROR_HTTP : MIXER_OK;
+}
+
+int interactive_session_internal::send_outgoing_event(const std::shared_ptr<interactive_event_internal>& ev)
+{
+	switch (ev->type)
+	{
+	case interactive_event_type_http_request:
+	{
+		// Failed requests have been reported, they never hold up the events behind them.
+		send_http_request(reinterpret_cast<const std::shared_ptr<http_request_event>&>(ev));
+		return MIXER_OK;
+	}
+	case interactive_event_type_rpc_method:
+	{	
+		if (!this->wsOpen)
+		{
+			// If the websocket is not open, leave this event for later.
+			return MIXER_ERROR_NOT_CONNECTED;
+		}
+
+		auto methodEvent = reinterpret_cast<const std::shared_ptr<rpc_method_event>&>(ev);
+		const std::string& packet = methodEvent->packet;
+		DEBUG_TRACE("Sending websocket message: " + packet);
+		this->websocketLatency.record(methodEvent->queuedAt);
+
+		// Critical Section: Only one thread may send a websocket message at a time.
+		int err = 0;
+		{
+			std::unique_lock<std::mutex> sendLock(this->websocketMutex);
+			err = this->ws->send(packet);
+		}
+
+		if (err)
+		{
+			std::string errorMessage = "Failed to send websocket message.";
+			DEBUG_ERROR(std::to_string(err) + " " + errorMessage);
+			enqueue_incoming_event(std::make_shared<error_event>(interactive_error(MIXER_ERROR_WS_SEND_FAILED, std::move(errorMessage))));
+			return MIXER_ERROR_WS_SEND_FAILED;
+		}
+
+		return MIXER_OK;
+	}
+	default:
+	{
+		assert(false);
+		return MIXER_ERROR;
+	}
+	}
+}
+
 void interactive_session_internal::run_outgoing_thread()
 {
 	std::queue<std::shared_ptr<interactive_event_internal>> processingEvents;
+	bool sendFailed = false;
+	unsigned int failedOpenCount = 0;
 	// Run this thread continuously until shutdown is requested.
 	while (!shutdownRequested)
 	{
-		if (!processingEvents.empty())
+		// Critical section: Wait for queued methods and an open websocket to send them on. After a failed send, wait
+		// for the websocket to be opened again rather than retrying on the connection that failed.
 		{
-			// If the processing queue still contains messages after a loop executes, there must have been an error. Throttle retries by sleeping this thread whenever this happens.
-			std::this_thread::sleep_for(std::chrono::seconds(DEFAULT_CONNECTION_RETRY_FREQUENCY_S));
-		}
-		else
-		{	
-			// Critical section: Check if there are any queued methods or requests that need to be sent.
 			std::unique_lock<std::mutex> lock(outgoingMutex);
-			if (this->outgoingEvents.empty())
+			if (sendFailed)
 			{
-				outgoingCV.wait(lock);
-				// Since this thread just woke up, check if it has been signalled to stop.
-				if (shutdownRequested)
-				{
-					break;
-				}
+				sendFailed = false;
+				failedOpenCount = this->wsOpenCount;
+			}
+
+			outgoingCV.wait(lock, [&]
+			{
+				return shutdownRequested || (this->wsOpen && this->wsOpenCount != failedOpenCount && !this->outgoingEvents.empty());
+			});
+
+			if (shutdownRequested)
+			{
+				break;
 			}
 
 			processingEvents.swap(this->outgoingEvents);
 		}
 
-		// Process all http requests.
+		// Send every method in order.
 		while (!processingEvents.empty() && !shutdownRequested)
 		{
-			auto ev = processingEvents.front();
-			switch (ev->type)
+			if (MIXER_OK != send_outgoing_event(processingEvents.front()))
 			{
-			case interactive_event_type_http_request:
+				// The connection was lost, the methods queued for it are dropped along with it.
+				std::queue<std::shared_ptr<interactive_event_internal>>().swap(processingEvents);
+				sendFailed = true;
+				break;
+			}
+
+			processingEvents.pop();
+		}
+	}
+}
+
+void interactive_session_internal::run_http_thread()
+{
+	while (!shutdownRequested)
+	{
+		// Critical section: Wait for a request.
+		std::shared_ptr<http_request_event> request;
+		{
+			std::unique_lock<std::mutex> httpRequestsLock(this->httpRequestsMutex);
+			this->httpRequestsCV.wait(httpRequestsLock, [&]
 			{
-				auto request = reinterpret_cast<std::shared_ptr<http_request_event>&>(ev);
-				http_response response;
-				int err = http->make_request(request->uri, request->verb, request->headers.empty() ? nullptr : &request->headers, request->body, response);
-				if (err)
-				{
-					std::string errorMessage = "Failed to '" + request->verb + "' to " + request->uri;
-					DEBUG_ERROR(std::to_string(err) + " " + errorMessage);
-					enqueue_incoming_event(std::make_shared<error_event>(interactive_error(MIXER_ERROR_HTTP, std::move(errorMessage))));
-				}
-				else
-				{
-					// This request was successfully sent, remove it from the queue.
-					processingEvents.pop();
-
-					DEBUG_TRACE("HTTP response received: (" + std::to_string(response.statusCode) + ") " + response.body);
-					// Critical Section: Find the response handler for this request.
-					http_response_handler handler = nullptr;
-					{
-						std::unique_lock<std::mutex> incomingLock(this->incomingMutex);
-						auto responseHandlerItr = this->httpResponseHandlers.find(request->packetId);
-						if (responseHandlerItr != this->httpResponseHandlers.end())
-						{
-							handler = std::move(responseHandlerItr->second);
-							this->httpResponseHandlers.erase(responseHandlerItr);
-						}
-					}
-
-					if (nullptr != handler)
-					{
-						enqueue_incoming_event(std::make_shared<http_response_event>(std::move(response), handler));
-					}
-				}
+				return shutdownRequested || !this->httpRequests.empty();
+			});
 
+			if (shutdownRequested)
+			{
 				break;
 			}
-			case interactive_event_type_rpc_method:
-			{	
-				if (!this->wsOpen)
-				{
-					// If the websocket is not open, skip processing this event.
-					break;
-				}
 
-				auto methodEvent = reinterpret_cast<std::shared_ptr<rpc_method_event>&>(ev);
-				std::string packet = jsonStringify(*(methodEvent->methodJson));
-				DEBUG_TRACE("Sending websocket message: " + packet);
+			request = std::move(this->httpRequests.front());
+			this->httpRequests.pop();
+		}
 
-				// Critical Section: Only one thread may send a websocket message at a time.
-				int err = 0;
-				{
-					std::unique_lock<std::mutex> sendLock(this->websocketMutex);
-					err = this->ws->send(packet);
-				}
+		send_http_request(request);
+	}
+}
 
-				if (err)
-				{
-					std::string errorMessage = "Failed to send websocket message.";
-					DEBUG_ERROR(std::to_string(err) + " " + errorMessage);
-					enqueue_incoming_event(std::make_shared<error_event>(interactive_error(MIXER_ERROR_WS_SEND_FAILED, std::move(errorMessage))));
+// Wait on the http requests in flight alongside the websocket.
+void interactive_session_internal::watch_http(polled_http_client* httpPoller, int& httpFd, std::chrono::steady_clock::time_point& wakeAt)
+{
+	if (nullptr == httpPoller)
+	{
+		return;
+	}
 
-					// An error here implies that the connection is broken.
-					// Break out of the websocket method loop so that http requests are not starved and retry.
-					break;
-				}
-				else
+	int timeoutMs = -1;
+	httpFd = httpPoller->poll_fd(timeoutMs);
+	if (timeoutMs >= 0)
+	{
+		wakeAt = (std::min)(wakeAt, std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs));
+	}
+}
+
+void interactive_session_internal::step_connection(int& fd, bool& wantWrite, int& httpFd, std::chrono::steady_clock::time_point& wakeAt)
+{
+	fd = -1;
+	wantWrite = false;
+	httpFd = -1;
+	wakeAt = std::chrono::steady_clock::time_point::max();
+	if (this->shutdownRequested)
+	{
+		return;
+	}
+
+	// Sessions stepped by the title or by a group's reactor must not block on http, they poll the http client instead.
+	polled_websocket* socket = this->ws->polled();
+	polled_http_client* httpPoller = this->cooperative || nullptr != this->reactor ? this->http->polled() : nullptr;
+	for (;;)
+	{
+		// Finish the http requests that are ready, the hosts lookup among them.
+		if (nullptr != httpPoller)
+		{
+			httpPoller->poll();
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		if (!this->wsStarted && now >= this->retryAt && this->hosts.empty() && !this->hostsRequested)
+		{
+			// Query interactive hosts if they have not been populated. Without an http poller this blocks the step.
+			this->hostIndex = 0;
+			int err = nullptr != httpPoller ? request_interactive_hosts(*this) : get_interactive_hosts(*this, this->hosts);
+			if (this->shutdownRequested)
+			{
+				return;
+			}
+
+			if (err || (this->hosts.empty() && !this->hostsRequested))
+			{
+				this->hosts.clear();
+				this->retryAt = now + std::chrono::seconds(this->connectionRetryFrequency);
+			}
+		}
+
+		if (!this->wsStarted && now >= this->retryAt && !this->hosts.empty())
+		{
+			// Start the long running websocket, it is advanced by each step from here on.
+			const std::string& host = this->hosts[this->hostIndex];
+			DEBUG_INFO("Connecting to websocket: " + host);
+			this->ws->add_header("X-Protocol-Version", "2.0");
+			this->ws->add_header("Authorization", this->authorization);
+			this->ws->add_header("X-Interactive-Version", this->versionId);
+			if (!this->shareCode.empty())
+			{
+				this->ws->add_header("X-Interactive-Sharecode", this->shareCode);
+			}
+
+			int err = socket->open_async(host,
+				std::bind(&interactive_session_internal::handle_ws_open, this, std::placeholders::_1, std::placeholders::_2),
+				std::bind(&interactive_session_internal::handle_ws_message, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3),
+				nullptr,
+				std::bind(&interactive_session_internal::handle_ws_close, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+			this->wsStarted = 0 == err;
+			if (err)
+			{
+				handle_ws_ended(host, err);
+				if (++this->hostIndex == this->hosts.size())
 				{
-					// Method sent successfully.
-					processingEvents.pop();
+					this->hosts.clear();
+					this->retryAt = now + std::chrono::seconds(this->connectionRetryFrequency);
+					this->connectionRetryFrequency = std::min<unsigned int>(MAX_CONNECTION_RETRY_FREQUENCY_S, this->connectionRetryFrequency * 2);
 				}
-				break;
+
+				continue;
 			}
-			default:
+		}
+
+		// Critical section: Take the queued methods and requests.
+		{
+			std::unique_lock<std::mutex> lock(outgoingMutex);
+			while (!this->outgoingEvents.empty())
+			{
+				this->processingEvents.emplace(std::move(this->outgoingEvents.front()));
+				this->outgoingEvents.pop();
+			}
+		}
+
+		// Run the http lane, requests complete during later steps.
+		if (nullptr != httpPoller)
+		{
+			std::queue<std::shared_ptr<http_request_event>> requests;
+			// Critical section: Take the queued requests.
+			{
+				std::unique_lock<std::mutex> httpRequestsLock(this->httpRequestsMutex);
+				requests.swap(this->httpRequests);
+			}
+
+			while (!requests.empty() && !this->shutdownRequested)
+			{
+				send_http_request(requests.front());
+				requests.pop();
+			}
+		}
+
+		// Send in order, methods wait at the head of the queue until the websocket has opened.
+		int sendErr = MIXER_OK;
+		while (!this->processingEvents.empty() && !this->shutdownRequested)
+		{
+			sendErr = send_outgoing_event(this->processingEvents.front());
+			if (sendErr)
 			{
-				assert(false);
 				break;
 			}
+
+			this->processingEvents.pop();
+		}
+
+		if (this->shutdownRequested)
+		{
+			return;
+		}
+
+		if (MIXER_OK != sendErr && MIXER_ERROR_NOT_CONNECTED != sendErr)
+		{
+			// The connection was lost, the methods queued for it are dropped along with it.
+			std::queue<std::shared_ptr<interactive_event_internal>>().swap(this->processingEvents);
+		}
+
+		if (!this->wsStarted)
+		{
+			if (!this->hostsRequested)
+			{
+				wakeAt = (std::min)(wakeAt, this->retryAt);
 			}
+
+			watch_http(httpPoller, httpFd, wakeAt);
+			return;
+		}
+
+		int err = socket->poll();
+		if (EAGAIN == err)
+		{
+			int timeoutMs = -1;
+			fd = socket->poll_fd(wantWrite, timeoutMs);
+			if (timeoutMs >= 0)
+			{
+				wakeAt = (std::min)(wakeAt, std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs));
+			}
+
+			// Methods held back while the websocket opened can go now.
+			if (MIXER_ERROR_NOT_CONNECTED == sendErr && this->wsOpen)
+			{
+				continue;
+			}
+
+			watch_http(httpPoller, httpFd, wakeAt);
+			return;
+		}
+
+		// The websocket has closed, move on to the next host.
+		this->wsStarted = false;
+		if (this->shutdownRequested)
+		{
+			return;
+		}
+
+		handle_ws_ended(this->hosts[this->hostIndex], err);
+		if (++this->hostIndex == this->hosts.size())
+		{
+			this->hosts.clear();
+			this->retryAt = std::chrono::steady_clock::now() + std::chrono::seconds(this->connectionRetryFrequency);
+			this->connectionRetryFrequency = std::min<unsigned int>(MAX_CONNECTION_RETRY_FREQUENCY_S, this->connectionRetryFrequency * 2);
 		}
 	}
 }
 
-}
\ No newline at end of file
+}
@@ -1,10 +1,13 @@
 #pragma once
 
-#include "rapidjson\document.h"
+#include "rapidjson/document.h"
+#include "interactive_control_store.h"
+#include "interactive_participant_store.h"
 #include <string>
 #include <map>
 #include <functional>
 #include <queue>
+#include <vector>
 
 namespace mixer_internal
 {
@@ -18,11 +21,17 @@ struct interactive_object_internal
 	interactive_object_internal(std::string id);
 };
 
-struct interactive_control_pointer
+// A control property resolved once by id and key. The control is a slot in the control store and is refreshed whenever
+// controls move, it is CONTROL_STORE_NPOS while the control does not exist. Properties with a typed column are read
+// from the column, any other property resolves value to the stored property.
+struct interactive_property_handle_internal
 {
-	const std::string sceneId;
-	const std::string cachePointer;
-	interactive_control_pointer(std::string sceneId, std::string cachePointer);
+	const std::string controlId;
+	const std::string key;
+	const control_field field;
+	size_t control;
+	const control_value* value;
+	interactive_property_handle_internal(std::string controlId, std::string key);
 };
 
 struct interactive_control_internal : public interactive_object_internal
@@ -37,13 +46,9 @@ struct interactive_group_internal : public interactive_object_internal
 	interactive_group_internal(std::string id, std::string scene);
 };
 
-struct compare_event_priority;
-typedef std::priority_queue<std::shared_ptr<interactive_event_internal>, std::vector<std::shared_ptr<interactive_event_internal>>, compare_event_priority> interactive_event_queue;
-
-typedef std::map<std::string, std::string> scenes_by_id;
 typedef std::map<std::string, std::string> scenes_by_group;
-typedef std::map<std::string, interactive_control_pointer> controls_by_id;
-typedef std::map<std::string, std::shared_ptr<rapidjson::Document>> participants_by_id;
+typedef std::vector<interactive_property_handle_internal> property_handles;
+typedef std::map<std::pair<std::string, std::string>, size_t> property_handles_by_name;
 typedef std::function<int(interactive_session_internal&, rapidjson::Document&)> method_handler;
 typedef std::map<std::string, method_handler> method_handlers_by_method;
 typedef std::map<unsigned int, std::pair<bool, method_handler>> reply_handlers_by_id;
@@ -5,11 +5,15 @@
 #elif RAPIDJSON_HAS_STDSTRING == 0
 #error "Mixer interactivity requires std::string for json parsing."
 #endif
-#include "rapidjson\document.h"
+#include "rapidjson/document.h"
 
 namespace mixer_internal
 {
 
-std::string jsonStringify(rapidjson::Value& doc);
+std::string jsonStringify(const rapidjson::Value& doc);
+
+// Deep copy source into target, copying every string into the allocator. Unlike CopyFrom this also copies strings that
+// reference an in-situ parsed message buffer, so the copy remains valid after the message is recycled.
+void jsonCopy(const rapidjson::Value& source, rapidjson::Value& target, rapidjson::Document::AllocatorType& allocator);
 
 }
\ No newline at end of file
@@ -0,0 +1,572 @@
+#include "posix_http_client.h"
+#include "posix_socket.h"
+#include "common.h"
+#include "debugging.h"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <strings.h>
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <map>
+#include <mutex>
+
+namespace mixer_internal
+{
+
+#define POSIX_HTTP_MAX_IDLE_CONNECTIONS_PER_HOST 4
+#define POSIX_HTTP_IDLE_TIMEOUT_S 30
+
+static unsigned long remaining_request_ms(const std::chrono::steady_clock::time_point& deadline)
+{
+	auto now = std::chrono::steady_clock::now();
+	return now >= deadline ? 0 : (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+}
+
+// Idle connections by scheme, host and port. Any thread may take or return a connection.
+class posix_connection_pool
+{
+public:
+	// Returns nullptr if there is no idle connection to the origin that is still open.
+	std::unique_ptr<posix_socket> take(const std::string& origin)
+	{
+		// Critical Section: Find the most recently used connection the server has not closed.
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto idleItr = m_idle.find(origin);
+		if (idleItr == m_idle.end())
+		{
+			return nullptr;
+		}
+
+		auto oldest = std::chrono::steady_clock::now() - std::chrono::seconds(POSIX_HTTP_IDLE_TIMEOUT_S);
+		std::vector<idle_connection>& connections = idleItr->second;
+		while (!connections.empty())
+		{
+			idle_connection connection = std::move(connections.back());
+			connections.pop_back();
+			if (connection.idleSince < oldest)
+			{
+				continue;
+			}
+
+			// An idle connection has nothing to read unless the server has closed it.
+			char byte;
+			size_t bytesRead = 0;
+			if (EAGAIN == connection.socket->read(&byte, 1, bytesRead))
+			{
+				return std::move(connection.socket);
+			}
+		}
+
+		return nullptr;
+	}
+
+	void give(const std::string& origin, std::unique_ptr<posix_socket>&& socket)
+	{
+		// Critical Section: Keep the connection, replacing the longest idle if the host has too many.
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::vector<idle_connection>& connections = m_idle[origin];
+		if (connections.size() == POSIX_HTTP_MAX_IDLE_CONNECTIONS_PER_HOST)
+		{
+			connections.erase(connections.begin());
+		}
+
+		connections.push_back({ std::move(socket), std::chrono::steady_clock::now() });
+	}
+
+private:
+	struct idle_connection
+	{
+		std::unique_ptr<posix_socket> socket;
+		std::chrono::steady_clock::time_point idleSince;
+	};
+
+	std::mutex m_mutex;
+	std::map<std::string, std::vector<idle_connection>> m_idle;
+};
+
+// A single request advanced without blocking, either by the thread in make_request() or by poll(). With a pool the
+// request starts on an idle connection to its host when there is one and returns the connection once the response has
+// been read, otherwise the connection is closed.
+class posix_http_request
+{
+public:
+	posix_http_request(const on_http_complete& onComplete, posix_connection_pool* pool) : m_onComplete(onComplete), m_pool(pool), m_reused(false), m_stage(stage_connecting), m_written(0),
+		m_head(false), m_keepAlive(false), m_chunked(false), m_contentLength(std::string::npos)
+	{
+		m_response.statusCode = 0;
+	}
+
+	int begin(const std::string& uri, const std::string& verb, const http_headers* headers, const std::string& body, unsigned long timeoutMs)
+	{
+		DEBUG_TRACE(verb + " " + uri + " " + body);
+		m_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+		RETURN_IF_FAILED(parse_uri(uri, "https", "http", m_target));
+		m_origin = m_target.protocol + "://" + m_target.host + ":" + m_target.port;
+		m_head = 0 == verb.compare("HEAD");
+
+		m_request = verb + " " + m_target.path + " HTTP/1.1\r\n";
+		m_request += "Host: " + m_target.host + "\r\n";
+		m_request += "Accept: */*\r\n";
+		if (nullptr == m_pool)
+		{
+			m_request += "Connection: close\r\n";
+		}
+		m_request += "Content-Length: " + std::to_string(body.length()) + "\r\n";
+		if (nullptr != headers)
+		{
+			for (const auto& header : *headers)
+			{
+				m_request += header.first + ": " + header.second + "\r\n";
+			}
+		}
+		m_request += "\r\n";
+		m_request += body;
+
+		if (nullptr != m_pool)
+		{
+			m_socket = m_pool->take(m_origin);
+			if (nullptr != m_socket)
+			{
+				m_reused = true;
+				m_stage = stage_writing;
+				return 0;
+			}
+		}
+
+		return connect();
+	}
+
+	// Returns EAGAIN until the response has been read or the request has failed.
+	int step()
+	{
+		int err = 0;
+		if (stage_connecting == m_stage)
+		{
+			err = m_socket->continue_connect();
+			if (err)
+			{
+				return check_deadline(err);
+			}
+
+			m_stage = stage_writing;
+		}
+
+		if (stage_writing == m_stage)
+		{
+			while (m_written < m_request.length())
+			{
+				size_t bytesWritten = 0;
+				err = m_socket->write(m_request.c_str() + m_written, m_request.length() - m_written, bytesWritten);
+				if (err)
+				{
+					return reconnect_if_stale(check_deadline(err));
+				}
+
+				m_written += bytesWritten;
+			}
+
+			m_stage = stage_reading_headers;
+		}
+
+		for (;;)
+		{
+			if (stage_reading_headers == m_stage)
+			{
+				err = parse_headers();
+				if (0 == err)
+				{
+					m_stage = stage_reading_body;
+				}
+				else if (EAGAIN != err)
+				{
+					return err;
+				}
+			}
+
+			if (stage_reading_body == m_stage)
+			{
+				err = parse_body();
+				if (EAGAIN != err)
+				{
+					return err;
+				}
+			}
+
+			char chunk[16384];
+			size_t bytesRead = 0;
+			err = m_socket->read(chunk, sizeof(chunk), bytesRead);
+			if (0 == err)
+			{
+				m_buffer.append(chunk, bytesRead);
+				continue;
+			}
+
+			if (ECONNRESET == err && stage_reading_body == m_stage && !m_chunked && std::string::npos == m_contentLength)
+			{
+				// No framing information, the body ran until the server closed the connection.
+				m_response.body.swap(m_buffer);
+				m_keepAlive = false;
+				return 0;
+			}
+
+			return reconnect_if_stale(check_deadline(err));
+		}
+	}
+
+	// The descriptor the request waits on next and whether it waits to write. The wait is no longer than waitMs, which is
+	// 0 when decrypted bytes are already buffered.
+	int poll_fd(bool& wantWrite, unsigned long& waitMs) const
+	{
+		wantWrite = stage_writing == m_stage || m_socket->wants_write();
+		waitMs = m_socket->has_pending() ? 0 : remaining_request_ms(m_deadline);
+		return m_socket->fd();
+	}
+
+	// Wait until the request can make progress, for at most timeoutMs.
+	int wait(unsigned long timeoutMs)
+	{
+		if (m_socket->has_pending())
+		{
+			return 0;
+		}
+
+		return m_socket->wait(stage_writing == m_stage || m_socket->wants_write(), (std::min)(timeoutMs, remaining_request_ms(m_deadline)));
+	}
+
+	void complete(int err)
+	{
+		// Only a connection whose response was fully framed and entirely read can carry another request.
+		if (0 == err && nullptr != m_pool && m_keepAlive && (m_chunked || std::string::npos != m_contentLength) && m_buffer.empty() && !m_socket->has_pending())
+		{
+			m_pool->give(m_origin, std::move(m_socket));
+		}
+		else if (nullptr != m_socket)
+		{
+			m_socket->close();
+		}
+
+		if (nullptr != m_onComplete)
+		{
+			m_onComplete(err, m_response);
+		}
+	}
+
+	http_response& response()
+	{
+		return m_response;
+	}
+
+private:
+	enum request_stage
+	{
+		stage_connecting,
+		stage_writing,
+		stage_reading_headers,
+		stage_reading_body
+	};
+
+	int connect()
+	{
+		m_socket = std::make_unique<posix_socket>();
+		m_stage = stage_connecting;
+		int err = m_socket->begin_connect(m_target.host, m_target.port, 0 == m_target.protocol.compare("https"));
+		return EAGAIN == err ? 0 : err;
+	}
+
+	// The server may close an idle connection just as it is reused. If nothing of the response has arrived, send the
+	// request again on a new connection.
+	int reconnect_if_stale(int err)
+	{
+		if (!m_reused || EAGAIN == err || ETIMEDOUT == err || stage_reading_body == m_stage || !m_buffer.empty())
+		{
+			return err;
+		}
+
+		DEBUG_TRACE("Reused connection closed, reconnecting to " + m_origin);
+		m_reused = false;
+		m_written = 0;
+		m_socket->close();
+		RETURN_IF_FAILED(connect());
+		return step();
+	}
+
+	int check_deadline(int err)
+	{
+		if (EAGAIN == err && std::chrono::steady_clock::now() >= m_deadline)
+		{
+			return ETIMEDOUT;
+		}
+
+		return err;
+	}
+
+	// Read the status line and headers.
+	int parse_headers()
+	{
+		size_t headerEnd = m_buffer.find("\r\n\r\n");
+		if (std::string::npos == headerEnd)
+		{
+			return EAGAIN;
+		}
+
+		size_t statusStart = m_buffer.find(' ');
+		if (std::string::npos == statusStart || statusStart > headerEnd)
+		{
+			return EPROTO;
+		}
+
+		m_response.statusCode = (unsigned int)strtoul(m_buffer.c_str() + statusStart + 1, nullptr, 10);
+		if (100 <= m_response.statusCode && m_response.statusCode < 200)
+		{
+			// An interim response, the final one follows it.
+			m_buffer.erase(0, headerEnd + 4);
+			return parse_headers();
+		}
+
+		m_keepAlive = 0 == m_buffer.compare(0, 9, "HTTP/1.1 ");
+
+		size_t lineStart = m_buffer.find("\r\n") + 2;
+		while (lineStart < headerEnd)
+		{
+			size_t lineEnd = m_buffer.find("\r\n", lineStart);
+			size_t colon = m_buffer.find(':', lineStart);
+			if (std::string::npos != colon && colon < lineEnd)
+			{
+				std::string name = m_buffer.substr(lineStart, colon - lineStart);
+				size_t valueStart = m_buffer.find_first_not_of(' ', colon + 1);
+				std::string value = m_buffer.substr(valueStart, lineEnd - valueStart);
+				if (0 == strcasecmp(name.c_str(), "Content-Length"))
+				{
+					m_contentLength = (size_t)strtoull(value.c_str(), nullptr, 10);
+				}
+				else if (0 == strcasecmp(name.c_str(), "Transfer-Encoding") && std::string::npos != value.find("chunked"))
+				{
+					m_chunked = true;
+				}
+				else if (0 == strcasecmp(name.c_str(), "Connection") && 0 == strcasecmp(value.c_str(), "close"))
+				{
+					m_keepAlive = false;
+				}
+			}
+
+			lineStart = lineEnd + 2;
+		}
+
+		// Responses to HEAD, 204 and 304 responses never have a body, whatever their headers say (RFC 7230 3.3.3).
+		if (m_head || 204 == m_response.statusCode || 304 == m_response.statusCode)
+		{
+			m_chunked = false;
+			m_contentLength = 0;
+		}
+
+		m_buffer.erase(0, headerEnd + 4);
+		m_response.body.clear();
+		return 0;
+	}
+
+	// Take as much of the body as has arrived, returns EAGAIN until all of it has.
+	int parse_body()
+	{
+		if (m_chunked)
+		{
+			for (;;)
+			{
+				size_t sizeEnd = m_buffer.find("\r\n");
+				if (std::string::npos == sizeEnd)
+				{
+					return EAGAIN;
+				}
+
+				size_t chunkSize = (size_t)strtoull(m_buffer.c_str(), nullptr, 16);
+				if (0 == chunkSize)
+				{
+					// The last chunk is followed by any trailer fields, which are skipped, and an empty line.
+					size_t trailerEnd = m_buffer.find("\r\n\r\n", sizeEnd);
+					if (std::string::npos == trailerEnd)
+					{
+						return EAGAIN;
+					}
+
+					m_buffer.erase(0, trailerEnd + 4);
+					return 0;
+				}
+
+				if (m_buffer.length() < sizeEnd + 2 + chunkSize + 2)
+				{
+					return EAGAIN;
+				}
+
+				m_response.body.append(m_buffer, sizeEnd + 2, chunkSize);
+				m_buffer.erase(0, sizeEnd + 2 + chunkSize + 2);
+			}
+		}
+		else if (std::string::npos != m_contentLength)
+		{
+			if (m_buffer.length() < m_contentLength)
+			{
+				return EAGAIN;
+			}
+
+			m_response.body.assign(m_buffer, 0, m_contentLength);
+			m_buffer.erase(0, m_contentLength);
+			return 0;
+		}
+
+		return EAGAIN;
+	}
+
+	on_http_complete m_onComplete;
+	posix_connection_pool* m_pool;
+	posix_uri m_target;
+	std::string m_origin;
+	std::unique_ptr<posix_socket> m_socket;
+	bool m_reused;
+	std::chrono::steady_clock::time_point m_deadline;
+	request_stage m_stage;
+	std::string m_request;
+	size_t m_written;
+	std::string m_buffer;
+	bool m_head;
+	bool m_keepAlive;
+	bool m_chunked;
+	size_t m_contentLength;
+	http_response m_response;
+};
+
+posix_http_client::posix_http_client(bool keepAlive) : m_pool(keepAlive ? std::make_unique<posix_connection_pool>() : nullptr), m_epoll(-1)
+{
+}
+
+posix_http_client::~posix_http_client()
+{
+	if (m_epoll >= 0)
+	{
+		::close(m_epoll);
+	}
+}
+
+int posix_http_client::make_request(const std::string& uri, const std::string& verb, const http_headers* headers, const std::string& body, _Out_ http_response& response, unsigned long timeoutMs) const
+{
+	posix_http_request request(nullptr, m_pool.get());
+	RETURN_IF_FAILED(request.begin(uri, verb, headers, body, timeoutMs));
+
+	int err;
+	while (EAGAIN == (err = request.step()) && 0 == (err = request.wait(timeoutMs)))
+	{
+	}
+
+	// Return the connection to the pool.
+	request.complete(err);
+	RETURN_IF_FAILED(err);
+	response = std::move(request.response());
+	return 0;
+}
+
+polled_http_client* posix_http_client::polled()
+{
+	return this;
+}
+
+int posix_http_client::make_request_async(const std::string& uri, const std::string& verb, const http_headers* headers, const std::string& body, const on_http_complete onComplete, unsigned long timeoutMs)
+{
+	std::unique_ptr<posix_http_request> request = std::make_unique<posix_http_request>(onComplete, m_pool.get());
+	RETURN_IF_FAILED(request->begin(uri, verb, headers, body, timeoutMs));
+	m_requests.emplace_back(std::move(request));
+	watch();
+	return 0;
+}
+
+size_t posix_http_client::poll()
+{
+	// Completion handlers may start new requests, those are stepped by the next poll.
+	std::vector<std::unique_ptr<posix_http_request>> requests;
+	requests.swap(m_requests);
+	for (auto& request : requests)
+	{
+		int err = request->step();
+		if (EAGAIN == err)
+		{
+			m_requests.emplace_back(std::move(request));
+		}
+		else
+		{
+			request->complete(err);
+		}
+	}
+
+	watch();
+	return m_requests.size();
+}
+
+int posix_http_client::poll_fd(int& timeoutMs) const
+{
+	// The descriptor stays the same once created, it is never ready while there are no requests.
+	timeoutMs = -1;
+	if (m_requests.empty())
+	{
+		return m_epoll;
+	}
+
+	// Wake for the first deadline, a request that has timed out only fails once it is stepped.
+	unsigned long waitMs = ULONG_MAX;
+	for (auto& request : m_requests)
+	{
+		bool wantWrite = false;
+		unsigned long requestWaitMs = 0;
+		request->poll_fd(wantWrite, requestWaitMs);
+		waitMs = (std::min)(waitMs, requestWaitMs);
+	}
+
+	timeoutMs = 0 == waitMs ? 0 : (int)(std::min)(waitMs + 1, (unsigned long)INT_MAX);
+	return m_epoll;
+}
+
+// Point the epoll instance at the descriptors of the requests in flight. Descriptors are modified even when they were
+// watched before, a closed socket leaves the epoll instance and a new one can reuse its number.
+void posix_http_client::watch()
+{
+	if (m_epoll < 0)
+	{
+		m_epoll = epoll_create1(EPOLL_CLOEXEC);
+	}
+
+	std::vector<int> watchedFds;
+	for (auto& request : m_requests)
+	{
+		bool wantWrite = false;
+		unsigned long waitMs = 0;
+		int fd = request->poll_fd(wantWrite, waitMs);
+		if (fd < 0)
+		{
+			continue;
+		}
+
+		epoll_event ev = {};
+		ev.events = EPOLLIN | (wantWrite ? EPOLLOUT : 0);
+		ev.data.fd = fd;
+		if (0 != epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &ev))
+		{
+			epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev);
+		}
+
+		watchedFds.push_back(fd);
+	}
+
+	// Connections returned to the pool stay open, they must not wake the owner.
+	for (int fd : m_watchedFds)
+	{
+		if (watchedFds.end() == std::find(watchedFds.begin(), watchedFds.end(), fd))
+		{
+			epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+		}
+	}
+
+	m_watchedFds.swap(watchedFds);
+}
+
+}
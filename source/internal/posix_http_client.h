@@ -0,0 +1,41 @@
+#pragma once
+
+#include "http_client.h"
+#include <vector>
+
+namespace mixer_internal
+{
+
+class posix_http_request;
+class posix_connection_pool;
+
+// Connections are kept alive once a response has been read and reused by later requests to the same host, so only the
+// first request pays for the TCP and TLS handshakes. Each client keeps its own pool, a session's connections are only
+// reused by that session and are closed with it. Polled requests are watched by an epoll instance of the client's own,
+// whose descriptor is what the owner waits on.
+class posix_http_client : public http_client, public polled_http_client
+{
+public:
+	posix_http_client(bool keepAlive = true);
+	~posix_http_client();
+
+	int make_request(const std::string& uri, const std::string& requestType, const http_headers* headers, const std::string& body, _Out_ http_response& response, unsigned long timeoutMs = 5000) const;
+	polled_http_client* polled();
+
+	int make_request_async(const std::string& uri, const std::string& requestType, const http_headers* headers, const std::string& body, const on_http_complete onComplete, unsigned long timeoutMs = 5000);
+	size_t poll();
+	int poll_fd(int& timeoutMs) const;
+
+private:
+	posix_http_client(const posix_http_client&) = delete;
+	posix_http_client& operator=(const posix_http_client&) = delete;
+
+	void watch();
+
+	std::unique_ptr<posix_connection_pool> m_pool;
+	std::vector<std::unique_ptr<posix_http_request>> m_requests;
+	int m_epoll;
+	std::vector<int> m_watchedFds;
+};
+
+}
@@ -0,0 +1,346 @@
+#include "posix_reactor.h"
+#include "interactive_session.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define REACTOR_MAX_EVENTS 64
+#define REACTOR_WAKE_ID    0
+
+namespace mixer_internal
+{
+
+posix_reactor::posix_reactor() : m_epollFd(-1), m_wakeFd(-1), m_stopping(false), m_nextId(REACTOR_WAKE_ID)
+{
+}
+
+posix_reactor::~posix_reactor()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+
+	signal();
+	for (auto& thread : m_threads)
+	{
+		thread.join();
+	}
+
+	if (m_wakeFd >= 0)
+	{
+		::close(m_wakeFd);
+	}
+
+	if (m_epollFd >= 0)
+	{
+		::close(m_epollFd);
+	}
+}
+
+int
+posix_reactor::start(size_t threadCount)
+{
+	if (0 == threadCount)
+	{
+		return EINVAL;
+	}
+
+	m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if (m_epollFd < 0)
+	{
+		return errno;
+	}
+
+	m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (m_wakeFd < 0)
+	{
+		return errno;
+	}
+
+	// Each signal wakes a single waiting thread, which re-arms the eventfd once it has read it.
+	epoll_event wakeEvent = {};
+	wakeEvent.events = EPOLLIN | EPOLLONESHOT;
+	wakeEvent.data.u64 = REACTOR_WAKE_ID;
+	if (0 != epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &wakeEvent))
+	{
+		return errno;
+	}
+
+	for (size_t i = 0; i < threadCount; ++i)
+	{
+		m_threads.emplace_back(std::bind(&posix_reactor::run, this));
+	}
+
+	return 0;
+}
+
+int
+posix_reactor::add(interactive_session_internal& session)
+{
+	// Critical Section: Register the session and queue its first step.
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		unsigned long long id = ++m_nextId;
+		session.reactorId = id;
+		entry& sessionEntry = m_entries[id];
+		sessionEntry.session = &session;
+		sessionEntry.fd = -1;
+		sessionEntry.httpFd = -1;
+		sessionEntry.wakeAt = time_point::max();
+		sessionEntry.queued = false;
+		sessionEntry.running = false;
+		sessionEntry.again = false;
+		schedule(id, sessionEntry);
+	}
+
+	signal();
+	return 0;
+}
+
+void
+posix_reactor::wake(interactive_session_internal& session)
+{
+	bool scheduled = false;
+	// Critical Section: Queue a step unless one is already queued or will follow the one in progress.
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto entryItr = m_entries.find(session.reactorId);
+		if (entryItr != m_entries.end())
+		{
+			scheduled = schedule(entryItr->first, entryItr->second);
+		}
+	}
+
+	if (scheduled)
+	{
+		signal();
+	}
+}
+
+void
+posix_reactor::remove(interactive_session_internal& session)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		auto entryItr = m_entries.find(session.reactorId);
+		if (entryItr == m_entries.end())
+		{
+			return;
+		}
+
+		entry& sessionEntry = entryItr->second;
+		if (sessionEntry.running)
+		{
+			m_stepDone.wait(lock);
+			continue;
+		}
+
+		// A queued step is skipped once its entry is gone.
+		if (time_point::max() != sessionEntry.wakeAt)
+		{
+			m_timers.erase(std::make_pair(sessionEntry.wakeAt, entryItr->first));
+		}
+
+		if (sessionEntry.fd >= 0)
+		{
+			epoll_ctl(m_epollFd, EPOLL_CTL_DEL, sessionEntry.fd, nullptr);
+		}
+
+		if (sessionEntry.httpFd >= 0)
+		{
+			epoll_ctl(m_epollFd, EPOLL_CTL_DEL, sessionEntry.httpFd, nullptr);
+		}
+
+		m_entries.erase(entryItr);
+		session.reactorId = 0;
+		return;
+	}
+}
+
+size_t
+posix_reactor::thread_count() const
+{
+	return m_threads.size();
+}
+
+void
+posix_reactor::run()
+{
+	epoll_event events[REACTOR_MAX_EVENTS];
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_stopping)
+	{
+		auto now = std::chrono::steady_clock::now();
+		while (!m_timers.empty() && m_timers.begin()->first <= now)
+		{
+			unsigned long long id = m_timers.begin()->second;
+			m_timers.erase(m_timers.begin());
+			entry& sessionEntry = m_entries[id];
+			sessionEntry.wakeAt = time_point::max();
+			schedule(id, sessionEntry);
+		}
+
+		if (!m_ready.empty())
+		{
+			unsigned long long id = m_ready.front();
+			m_ready.pop_front();
+			auto entryItr = m_entries.find(id);
+			if (entryItr == m_entries.end())
+			{
+				continue;
+			}
+
+			entryItr->second.queued = false;
+			entryItr->second.running = true;
+
+			// Hand the rest of the queue to another thread.
+			if (!m_ready.empty())
+			{
+				signal();
+			}
+
+			lock.unlock();
+			step(id);
+			lock.lock();
+			continue;
+		}
+
+		int timeoutMs = -1;
+		if (!m_timers.empty())
+		{
+			timeoutMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(m_timers.begin()->first - now).count() + 1;
+		}
+
+		lock.unlock();
+		int count = epoll_wait(m_epollFd, events, REACTOR_MAX_EVENTS, timeoutMs);
+		lock.lock();
+		for (int i = 0; i < count; ++i)
+		{
+			unsigned long long id = events[i].data.u64;
+			if (REACTOR_WAKE_ID == id)
+			{
+				uint64_t value;
+				ssize_t readBytes = ::read(m_wakeFd, &value, sizeof(value));
+				(void)readBytes;
+				epoll_event wakeEvent = {};
+				wakeEvent.events = EPOLLIN | EPOLLONESHOT;
+				wakeEvent.data.u64 = REACTOR_WAKE_ID;
+				epoll_ctl(m_epollFd, EPOLL_CTL_MOD, m_wakeFd, &wakeEvent);
+				continue;
+			}
+
+			auto entryItr = m_entries.find(id);
+			if (entryItr != m_entries.end())
+			{
+				schedule(id, entryItr->second);
+			}
+		}
+	}
+
+	// Pass the shutdown on to the next waiting thread.
+	lock.unlock();
+	signal();
+}
+
+void
+posix_reactor::step(unsigned long long id)
+{
+	// The entry can not be removed while it is running.
+	interactive_session_internal* session;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		session = m_entries[id].session;
+	}
+
+	int fd = -1;
+	bool wantWrite = false;
+	int httpFd = -1;
+	time_point wakeAt = time_point::max();
+	session->step_connection(fd, wantWrite, httpFd, wakeAt);
+
+	// Critical Section: Wait on what the session asked for and run it again if it was woken during the step.
+	std::lock_guard<std::mutex> lock(m_mutex);
+	entry& sessionEntry = m_entries[id];
+	sessionEntry.running = false;
+	watch(id, sessionEntry.fd, fd, wantWrite);
+	watch(id, sessionEntry.httpFd, httpFd, false);
+	if (wakeAt != sessionEntry.wakeAt)
+	{
+		if (time_point::max() != sessionEntry.wakeAt)
+		{
+			m_timers.erase(std::make_pair(sessionEntry.wakeAt, id));
+		}
+
+		sessionEntry.wakeAt = wakeAt;
+		if (time_point::max() != wakeAt)
+		{
+			m_timers.emplace(wakeAt, id);
+		}
+	}
+
+	if (sessionEntry.again)
+	{
+		sessionEntry.again = false;
+		schedule(id, sessionEntry);
+	}
+
+	m_stepDone.notify_all();
+}
+
+bool
+posix_reactor::schedule(unsigned long long id, entry& sessionEntry)
+{
+	if (sessionEntry.running)
+	{
+		sessionEntry.again = true;
+		return false;
+	}
+
+	if (sessionEntry.queued)
+	{
+		return false;
+	}
+
+	sessionEntry.queued = true;
+	m_ready.push_back(id);
+	return true;
+}
+
+void
+posix_reactor::signal()
+{
+	uint64_t one = 1;
+	ssize_t written = ::write(m_wakeFd, &one, sizeof(one));
+	(void)written;
+}
+
+void
+posix_reactor::watch(unsigned long long id, int& watchedFd, int fd, bool wantWrite)
+{
+	// Closing a socket takes it out of the epoll set, a socket that has gone is simply forgotten.
+	if (fd < 0)
+	{
+		watchedFd = -1;
+		return;
+	}
+
+	epoll_event socketEvent = {};
+	socketEvent.events = (uint32_t)EPOLLIN | (uint32_t)EPOLLONESHOT | (wantWrite ? (uint32_t)EPOLLOUT : 0u);
+	socketEvent.data.u64 = id;
+	if (fd != watchedFd || 0 != epoll_ctl(m_epollFd, EPOLL_CTL_MOD, fd, &socketEvent))
+	{
+		// A new socket, possibly reusing the number of the one it replaced.
+		if (0 != epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &socketEvent) && EEXIST == errno)
+		{
+			epoll_ctl(m_epollFd, EPOLL_CTL_MOD, fd, &socketEvent);
+		}
+	}
+
+	watchedFd = fd;
+}
+
+}
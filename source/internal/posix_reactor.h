@@ -0,0 +1,69 @@
+#pragma once
+
+#include "interactive_reactor.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mixer_internal
+{
+
+// A reactor that waits on a single epoll instance from every thread. Each session is watched through its websocket's
+// descriptor and its http client's. Descriptors are armed for one event at a time so a session is only picked up by one
+// thread, and an eventfd hands stepping work to a waiting thread.
+class posix_reactor : public interactive_reactor
+{
+public:
+	posix_reactor();
+	~posix_reactor();
+
+	int start(size_t threadCount);
+
+	int add(interactive_session_internal& session);
+	void wake(interactive_session_internal& session);
+	void remove(interactive_session_internal& session);
+	size_t thread_count() const;
+
+private:
+	posix_reactor(const posix_reactor&) = delete;
+	posix_reactor& operator=(const posix_reactor&) = delete;
+
+	typedef std::chrono::steady_clock::time_point time_point;
+
+	struct entry
+	{
+		interactive_session_internal* session;
+		int fd;
+		int httpFd;
+		time_point wakeAt;
+		bool queued;
+		bool running;
+		bool again;
+	};
+
+	void run();
+	void step(unsigned long long id);
+	bool schedule(unsigned long long id, entry& sessionEntry);
+	void signal();
+	void watch(unsigned long long id, int& watchedFd, int fd, bool wantWrite);
+
+	int m_epollFd;
+	int m_wakeFd;
+	std::vector<std::thread> m_threads;
+
+	// Guards everything below.
+	std::mutex m_mutex;
+	std::condition_variable m_stepDone;
+	bool m_stopping;
+	unsigned long long m_nextId;
+	std::unordered_map<unsigned long long, entry> m_entries;
+	std::deque<unsigned long long> m_ready;
+	std::set<std::pair<time_point, unsigned long long>> m_timers;
+};
+
+}
@@ -0,0 +1,556 @@
+#include "posix_socket.h"
+#include "common.h"
+
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/eventfd.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#include <chrono>
+#include <mutex>
+#include <regex>
+#include <thread>
+
+namespace mixer_internal
+{
+
+int parse_uri(const std::string& uri, const char* secureProtocol, const char* plainProtocol, posix_uri& result)
+{
+	// Parse the url with regex in accordance with RFC 3986.
+	static const std::regex url_regex(R"(^(([^:/?#]+):)?(//([^:/?#]*):?([0-9]*)?)?([^?#]*)(\?([^#]*))?(#(.*))?)", std::regex::ECMAScript);
+	std::smatch url_match_result;
+
+	if (!std::regex_match(uri, url_match_result, url_regex))
+	{
+		return EINVAL;
+	}
+
+	result.protocol = url_match_result[2];
+	result.host = url_match_result[4];
+	result.port = url_match_result[5];
+	result.path = url_match_result[6];
+	if (url_match_result[7].matched)
+	{
+		result.path += url_match_result[7];
+	}
+
+	if (result.path.empty())
+	{
+		result.path = "/";
+	}
+
+	if (result.port.empty())
+	{
+		if (0 == result.protocol.compare(secureProtocol))
+		{
+			result.port = "443";
+		}
+		else if (0 == result.protocol.compare(plainProtocol))
+		{
+			result.port = "80";
+		}
+		else
+		{
+			return EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+static SSL_CTX* get_ssl_context()
+{
+	static std::once_flag initFlag;
+	static SSL_CTX* context = nullptr;
+	std::call_once(initFlag, []()
+	{
+		context = SSL_CTX_new(TLS_client_method());
+		if (nullptr != context)
+		{
+			SSL_CTX_set_default_verify_paths(context);
+			SSL_CTX_set_verify(context, SSL_VERIFY_PEER, nullptr);
+			SSL_CTX_set_mode(context, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+		}
+	});
+
+	return context;
+}
+
+// A host name lookup running on a thread of its own. The eventfd becomes readable once it has finished.
+struct posix_resolution
+{
+	posix_resolution() : fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), done(false), err(0), addresses(nullptr)
+	{
+	}
+
+	~posix_resolution()
+	{
+		if (nullptr != addresses)
+		{
+			freeaddrinfo(addresses);
+		}
+
+		if (fd >= 0)
+		{
+			::close(fd);
+		}
+	}
+
+	int fd;
+	std::mutex mutex;
+	bool done;
+	int err;
+	addrinfo* addresses;
+};
+
+static unsigned long remaining_ms(const std::chrono::steady_clock::time_point& deadline)
+{
+	auto now = std::chrono::steady_clock::now();
+	if (now >= deadline)
+	{
+		return 0;
+	}
+
+	return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+}
+
+posix_socket::posix_socket() : m_fd(-1), m_ssl(nullptr), m_wantWrite(false), m_connectStage(connect_stage_none), m_secure(false), m_addresses(nullptr, &freeaddrinfo), m_address(nullptr)
+{
+}
+
+posix_socket::~posix_socket()
+{
+	close();
+}
+
+int posix_socket::connect(const std::string& host, const std::string& port, bool secure, unsigned long timeoutMs)
+{
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+	int err = begin_connect(host, port, secure);
+	while (EAGAIN == err)
+	{
+		err = wait(m_wantWrite, remaining_ms(deadline));
+		if (0 == err)
+		{
+			err = continue_connect();
+		}
+	}
+
+	if (err)
+	{
+		close();
+	}
+
+	return err;
+}
+
+int posix_socket::begin_connect(const std::string& host, const std::string& port, bool secure)
+{
+	close();
+	m_host = host;
+	m_secure = secure;
+
+	// An address needs no lookup.
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_NUMERICHOST;
+	addrinfo* addresses = nullptr;
+	if (0 == getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses))
+	{
+		return connect_addresses(addresses);
+	}
+
+	// getaddrinfo blocks for as long as the name servers take, look the name up on a thread of its own.
+	std::shared_ptr<posix_resolution> resolution = std::make_shared<posix_resolution>();
+	if (resolution->fd < 0)
+	{
+		return errno;
+	}
+
+	hints.ai_flags = 0;
+	std::thread([resolution, host, port, hints]()
+	{
+		addrinfo* addresses = nullptr;
+		int err = 0 == getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) ? 0 : EHOSTUNREACH;
+		{
+			std::lock_guard<std::mutex> resolutionLock(resolution->mutex);
+			resolution->addresses = addresses;
+			resolution->err = err;
+			resolution->done = true;
+		}
+
+		uint64_t one = 1;
+		ssize_t written = ::write(resolution->fd, &one, sizeof(one));
+		(void)written;
+	}).detach();
+
+	m_resolution = std::move(resolution);
+	m_connectStage = connect_stage_resolving;
+	return EAGAIN;
+}
+
+// Take ownership of the addresses for a host and start connecting to them in turn.
+int posix_socket::connect_addresses(addrinfo* addresses)
+{
+	m_addresses.reset(addresses);
+	m_address = addresses;
+	m_connectStage = connect_stage_tcp;
+	int err = connect_next_address();
+	if (EAGAIN != err)
+	{
+		close();
+		return err;
+	}
+
+	return continue_connect();
+}
+
+// Start connecting to the first remaining address that accepts a connection attempt.
+int posix_socket::connect_next_address()
+{
+	int err = EHOSTUNREACH;
+	for (; nullptr != m_address; m_address = m_address->ai_next)
+	{
+		m_fd = socket(m_address->ai_family, m_address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, m_address->ai_protocol);
+		if (m_fd < 0)
+		{
+			err = errno;
+			continue;
+		}
+
+		// Even a connection that completes at once is confirmed by continue_connect().
+		if (0 == ::connect(m_fd, m_address->ai_addr, m_address->ai_addrlen) || EINPROGRESS == errno)
+		{
+			m_wantWrite = true;
+			return EAGAIN;
+		}
+
+		err = errno;
+		::close(m_fd);
+		m_fd = -1;
+	}
+
+	return err;
+}
+
+int posix_socket::continue_connect()
+{
+	if (connect_stage_resolving == m_connectStage)
+	{
+		addrinfo* addresses = nullptr;
+		int err = 0;
+		{
+			std::lock_guard<std::mutex> resolutionLock(m_resolution->mutex);
+			if (!m_resolution->done)
+			{
+				return EAGAIN;
+			}
+
+			std::swap(addresses, m_resolution->addresses);
+			err = m_resolution->err;
+		}
+
+		if (err)
+		{
+			close();
+			return err;
+		}
+
+		// The socket is created before the eventfd is closed so that a poller sees a new descriptor.
+		err = connect_addresses(addresses);
+		m_resolution.reset();
+		return err;
+	}
+
+	if (connect_stage_tcp == m_connectStage)
+	{
+		// The socket becomes writable once the attempt on the current address has finished.
+		for (;;)
+		{
+			int err = wait(true, 0);
+			if (ETIMEDOUT == err)
+			{
+				return EAGAIN;
+			}
+
+			if (0 == err)
+			{
+				socklen_t errLength = sizeof(err);
+				if (0 != getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &err, &errLength))
+				{
+					err = errno;
+				}
+			}
+
+			if (0 == err)
+			{
+				break;
+			}
+
+			::close(m_fd);
+			m_fd = -1;
+			m_address = m_address->ai_next;
+			err = connect_next_address();
+			if (EAGAIN != err)
+			{
+				close();
+				return err;
+			}
+		}
+
+		m_addresses.reset();
+		m_address = nullptr;
+
+		int noDelay = 1;
+		setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+		if (!m_secure)
+		{
+			m_connectStage = connect_stage_none;
+			m_wantWrite = false;
+			return 0;
+		}
+
+		SSL_CTX* context = get_ssl_context();
+		if (nullptr == context)
+		{
+			close();
+			return EPROTO;
+		}
+
+		m_ssl = SSL_new(context);
+		SSL_set_fd(m_ssl, m_fd);
+		SSL_set_tlsext_host_name(m_ssl, m_host.c_str());
+		SSL_set1_host(m_ssl, m_host.c_str());
+		m_connectStage = connect_stage_tls;
+	}
+
+	if (connect_stage_tls == m_connectStage)
+	{
+		// Drive the handshake as far as the socket allows.
+		int err = tls_result(SSL_connect(m_ssl), m_wantWrite);
+		if (EAGAIN == err)
+		{
+			return EAGAIN;
+		}
+
+		m_connectStage = connect_stage_none;
+		m_wantWrite = false;
+		if (err)
+		{
+			close();
+		}
+
+		return err;
+	}
+
+	return m_fd < 0 ? ENOTCONN : 0;
+}
+
+int posix_socket::tls_result(int ret, bool& wantWrite)
+{
+	if (ret > 0)
+	{
+		return 0;
+	}
+
+	switch (SSL_get_error(m_ssl, ret))
+	{
+	case SSL_ERROR_WANT_READ:
+		wantWrite = false;
+		return EAGAIN;
+	case SSL_ERROR_WANT_WRITE:
+		wantWrite = true;
+		return EAGAIN;
+	case SSL_ERROR_ZERO_RETURN:
+		return ECONNRESET;
+	case SSL_ERROR_SYSCALL:
+		ERR_clear_error();
+		return 0 != errno ? errno : ECONNRESET;
+	default:
+		ERR_clear_error();
+		return EPROTO;
+	}
+}
+
+int posix_socket::read(char* buffer, size_t length, size_t& bytesRead)
+{
+	bytesRead = 0;
+	if (m_fd < 0)
+	{
+		return ENOTCONN;
+	}
+
+	if (nullptr != m_ssl)
+	{
+		m_wantWrite = false;
+		errno = 0;
+		int ret = SSL_read(m_ssl, buffer, (int)length);
+		int err = tls_result(ret, m_wantWrite);
+		if (0 == err)
+		{
+			bytesRead = (size_t)ret;
+		}
+
+		return err;
+	}
+
+	for (;;)
+	{
+		ssize_t ret = ::recv(m_fd, buffer, length, 0);
+		if (ret > 0)
+		{
+			bytesRead = (size_t)ret;
+			return 0;
+		}
+		else if (0 == ret)
+		{
+			return ECONNRESET;
+		}
+		else if (EINTR != errno)
+		{
+			return EWOULDBLOCK == errno ? EAGAIN : errno;
+		}
+	}
+}
+
+int posix_socket::write(const char* buffer, size_t length, size_t& bytesWritten)
+{
+	bytesWritten = 0;
+	if (m_fd < 0)
+	{
+		return ENOTCONN;
+	}
+
+	if (nullptr != m_ssl)
+	{
+		m_wantWrite = false;
+		errno = 0;
+		int ret = SSL_write(m_ssl, buffer, (int)length);
+		int err = tls_result(ret, m_wantWrite);
+		if (0 == err)
+		{
+			bytesWritten = (size_t)ret;
+		}
+
+		return err;
+	}
+
+	for (;;)
+	{
+		ssize_t ret = ::send(m_fd, buffer, length, MSG_NOSIGNAL);
+		if (ret >= 0)
+		{
+			bytesWritten = (size_t)ret;
+			return 0;
+		}
+		else if (EINTR != errno)
+		{
+			return EWOULDBLOCK == errno ? EAGAIN : errno;
+		}
+	}
+}
+
+int posix_socket::write_all(const char* buffer, size_t length, unsigned long timeoutMs)
+{
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+	while (length > 0)
+	{
+		size_t bytesWritten = 0;
+		int err = write(buffer, length, bytesWritten);
+		if (EAGAIN == err)
+		{
+			// A TLS write may need to read before it can continue.
+			RETURN_IF_FAILED(wait(nullptr == m_ssl || m_wantWrite, remaining_ms(deadline)));
+			continue;
+		}
+		else if (err)
+		{
+			return err;
+		}
+
+		buffer += bytesWritten;
+		length -= bytesWritten;
+	}
+
+	return 0;
+}
+
+int posix_socket::wait(bool forWrite, unsigned long timeoutMs)
+{
+	pollfd pfd;
+	pfd.fd = fd();
+	pfd.events = forWrite ? POLLOUT : POLLIN;
+	pfd.revents = 0;
+	for (;;)
+	{
+		int ret = poll(&pfd, 1, (int)timeoutMs);
+		if (ret > 0)
+		{
+			return 0;
+		}
+		else if (0 == ret)
+		{
+			return ETIMEDOUT;
+		}
+		else if (EINTR != errno)
+		{
+			return errno;
+		}
+	}
+}
+
+bool posix_socket::wants_write() const
+{
+	return m_wantWrite;
+}
+
+bool posix_socket::has_pending() const
+{
+	return nullptr != m_ssl && SSL_pending(m_ssl) > 0;
+}
+
+int posix_socket::fd() const
+{
+	return connect_stage_resolving == m_connectStage ? m_resolution->fd : m_fd;
+}
+
+bool posix_socket::is_open() const
+{
+	return m_fd >= 0;
+}
+
+void posix_socket::close()
+{
+	if (nullptr != m_ssl)
+	{
+		SSL_shutdown(m_ssl);
+		SSL_free(m_ssl);
+		m_ssl = nullptr;
+	}
+
+	if (m_fd >= 0)
+	{
+		::close(m_fd);
+		m_fd = -1;
+	}
+
+	m_wantWrite = false;
+	m_connectStage = connect_stage_none;
+	m_addresses.reset();
+	m_address = nullptr;
+	m_resolution.reset();
+}
+
+}
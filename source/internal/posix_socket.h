@@ -0,0 +1,95 @@
+#pragma once
+
+#include <string>
+#include <memory>
+
+typedef struct ssl_st SSL;
+struct addrinfo;
+
+namespace mixer_internal
+{
+
+struct posix_resolution;
+
+struct posix_uri
+{
+	std::string protocol;
+	std::string host;
+	std::string port;
+	std::string path;
+};
+
+// Crack a uri into its components, defaulting the port from the protocol.
+int parse_uri(const std::string& uri, const char* secureProtocol, const char* plainProtocol, posix_uri& result);
+
+// A non-blocking TCP stream with optional TLS. All reads and writes return EAGAIN rather than blocking,
+// use wait() or an external poller on fd() to wait for readiness.
+class posix_socket
+{
+public:
+	posix_socket();
+	~posix_socket();
+
+	// Connect and complete the TLS handshake, blocking for at most timeoutMs.
+	int connect(const std::string& host, const std::string& port, bool secure, unsigned long timeoutMs);
+
+	// Start connecting without waiting. A host name is looked up on a thread of its own, until it is found fd() is a
+	// descriptor that becomes readable once it is. Call continue_connect() whenever fd() is ready, it returns EAGAIN until
+	// the lookup, the connection and the TLS handshake are complete.
+	int begin_connect(const std::string& host, const std::string& port, bool secure);
+	int continue_connect();
+
+	// Read up to length bytes. Returns 0 on success, EAGAIN if no data is ready, or ECONNRESET once the peer has closed.
+	int read(char* buffer, size_t length, size_t& bytesRead);
+
+	// Write up to length bytes. Returns 0 on success, EAGAIN if the socket is not writable.
+	int write(const char* buffer, size_t length, size_t& bytesWritten);
+
+	// Write the entire buffer, blocking for at most timeoutMs.
+	int write_all(const char* buffer, size_t length, unsigned long timeoutMs);
+
+	// Wait until the socket is readable or writable. Returns ETIMEDOUT when timeoutMs elapses.
+	int wait(bool forWrite, unsigned long timeoutMs);
+
+	// True when the last read or write could not make progress until the socket becomes writable (TLS renegotiation).
+	bool wants_write() const;
+
+	// True when decrypted bytes are buffered and can be read without waiting on the file descriptor.
+	bool has_pending() const;
+
+	int fd() const;
+	bool is_open() const;
+	void close();
+
+private:
+	posix_socket(const posix_socket&) = delete;
+	posix_socket& operator=(const posix_socket&) = delete;
+
+	int tls_result(int ret, bool& wantWrite);
+	int connect_addresses(addrinfo* addresses);
+	int connect_next_address();
+
+	int m_fd;
+	SSL* m_ssl;
+	bool m_wantWrite;
+
+	// Connection in progress.
+	enum connect_stage
+	{
+		connect_stage_none,
+		connect_stage_resolving,
+		connect_stage_tcp,
+		connect_stage_tls
+	};
+
+	connect_stage m_connectStage;
+	std::string m_host;
+	bool m_secure;
+	std::unique_ptr<addrinfo, void(*)(addrinfo*)> m_addresses;
+	addrinfo* m_address;
+
+	// Shared with the thread looking up the host, which may outlive the socket.
+	std::shared_ptr<posix_resolution> m_resolution;
+};
+
+}
@@ -0,0 +1,959 @@
+#include "websocket.h"
+#include "posix_socket.h"
+#include "common.h"
+
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <strings.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#define WS_OPCODE_CONTINUATION 0x0
+#define WS_OPCODE_TEXT         0x1
+#define WS_OPCODE_BINARY       0x2
+#define WS_OPCODE_CLOSE        0x8
+#define WS_OPCODE_PING         0x9
+#define WS_OPCODE_PONG         0xA
+
+#define WS_CLOSE_NORMAL        1000
+#define WS_CLOSE_PROTOCOL      1002
+#define WS_CLOSE_ABNORMAL      1006
+#define WS_CLOSE_TOO_BIG       1009
+#define WS_HANDSHAKE_GUID      "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+#define WS_CONNECT_TIMEOUT_MS  5000
+#define WS_READ_CHUNK_SIZE     16384
+#define WS_MAX_MESSAGE_SIZE    (16 * 1024 * 1024)
+#define WS_MAX_CONTROL_SIZE    125
+
+namespace mixer_internal
+{
+
+static std::string base64_encode(const unsigned char* data, size_t length)
+{
+	std::string encoded(4 * ((length + 2) / 3), '\0');
+	int encodedLength = EVP_EncodeBlock(reinterpret_cast<unsigned char*>(&encoded[0]), data, (int)length);
+	encoded.resize(encodedLength);
+	return encoded;
+}
+
+// A websocket client that runs entirely on non-blocking sockets. It is a state machine advanced by poll(), either by
+// its owner or by the thread inside open(), which waits on a single epoll instance holding the socket and an eventfd
+// signalled by send() and close(). All socket IO, including sends queued from other threads, is performed by whichever
+// thread calls poll().
+class posix_websocket : public websocket, public polled_websocket
+{
+public:
+	posix_websocket() : m_epoll(-1), m_watchedFd(-1), m_wakeFd(-1), m_open(false), m_closed(false), m_stage(ws_stage_closed), m_closeSent(false), m_readStart(0), m_readEnd(0),
+		m_messageOpcode(WS_OPCODE_TEXT), m_maskGenerator(std::random_device()())
+	{
+	}
+
+	~posix_websocket()
+	{
+		if (m_epoll >= 0)
+		{
+			::close(m_epoll);
+		}
+
+		if (m_wakeFd >= 0)
+		{
+			::close(m_wakeFd);
+		}
+	}
+
+	int add_header(const std::string& key, const std::string& value)
+	{
+		m_headers[key] = value;
+		return 0;
+	}
+
+	int open(const std::string& uri, const on_ws_connect onConnect, const on_ws_message onMessage, const on_ws_error onError, const on_ws_close onClose)
+	{
+		if (m_epoll < 0)
+		{
+			m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			m_epoll = epoll_create1(EPOLL_CLOEXEC);
+			epoll_event ev;
+			memset(&ev, 0, sizeof(ev));
+			ev.events = EPOLLIN;
+			ev.data.fd = m_wakeFd;
+			epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeFd, &ev);
+		}
+
+		RETURN_IF_FAILED(open_async(uri, onConnect, onMessage, onError, onClose));
+
+		int err;
+		while (EAGAIN == (err = poll()))
+		{
+			bool wantWrite = false;
+			int timeoutMs = -1;
+			watch(poll_fd(wantWrite, timeoutMs), EPOLLIN | (wantWrite ? EPOLLOUT : 0));
+			epoll_event events[2];
+			int count = epoll_wait(m_epoll, events, 2, timeoutMs);
+			if (count < 0 && EINTR != errno)
+			{
+				err = errno;
+				break;
+			}
+
+			for (int i = 0; i < count; ++i)
+			{
+				if (events[i].data.fd == m_wakeFd)
+				{
+					uint64_t value;
+					ssize_t readBytes = ::read(m_wakeFd, &value, sizeof(value));
+					(void)readBytes;
+				}
+			}
+		}
+
+		watch(-1, 0);
+		return err;
+	}
+
+	int send(const std::string& message)
+	{
+		if (m_closed)
+		{
+			return ECANCELED;
+		}
+
+		if (!m_open)
+		{
+			return ENOTCONN;
+		}
+
+		// Critical Section: Frame the message onto the send queue and wake the socket thread to write it.
+		{
+			std::lock_guard<std::mutex> sendLock(m_sendMutex);
+			append_frame(m_sendQueue, WS_OPCODE_TEXT, message.c_str(), message.length());
+		}
+
+		wake();
+		return 0;
+	}
+
+	// Read a single message synchronously. This is only valid when the socket is not being serviced by poll().
+	int read(std::string& message)
+	{
+		if (m_closed)
+		{
+			return ECANCELED;
+		}
+
+		if (!m_socket.is_open())
+		{
+			return ENOTCONN;
+		}
+
+		bool received = false;
+		on_ws_message captureMessage = [&](const websocket&, char* frameMessage, const size_t frameMessageSize)
+		{
+			message.assign(frameMessage, frameMessageSize);
+			received = true;
+		};
+
+		while (!received)
+		{
+			// Later messages stay buffered for the next read.
+			bool closed = false;
+			RETURN_IF_FAILED(process_frames(captureMessage, nullptr, closed, true));
+			if (closed)
+			{
+				return ECONNRESET;
+			}
+
+			if (!received)
+			{
+				int err = fill_read_buffer();
+				if (EAGAIN == err)
+				{
+					RETURN_IF_FAILED(m_socket.wait(m_socket.wants_write(), WS_CONNECT_TIMEOUT_MS));
+				}
+				else if (err)
+				{
+					return err;
+				}
+			}
+		}
+
+		return 0;
+	}
+
+	void close()
+	{
+		if (!m_closed.exchange(true))
+		{
+			wake();
+		}
+	}
+
+	polled_websocket* polled()
+	{
+		return this;
+	}
+
+	void set_wake_handler(const on_ws_wake onWake)
+	{
+		m_onWake = onWake;
+	}
+
+	int open_async(const std::string& uri, const on_ws_connect onConnect, const on_ws_message onMessage, const on_ws_error onError, const on_ws_close onClose)
+	{
+		if (m_closed)
+		{
+			return ECANCELED;
+		}
+
+		RETURN_IF_FAILED(parse_uri(uri, "wss", "ws", m_target));
+
+		reset();
+		m_uri = uri;
+		m_onConnect = onConnect;
+		m_onMessage = onMessage;
+		m_onError = onError;
+		m_onClose = onClose;
+		m_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(WS_CONNECT_TIMEOUT_MS);
+		m_stage = ws_stage_connecting;
+		int err = m_socket.begin_connect(m_target.host, m_target.port, 0 == m_target.protocol.compare("wss"));
+		if (err && EAGAIN != err)
+		{
+			return fail_open(err);
+		}
+
+		return 0;
+	}
+
+	int poll()
+	{
+		if (ws_stage_connecting == m_stage || ws_stage_handshaking == m_stage)
+		{
+			if (m_closed)
+			{
+				return finish(0);
+			}
+
+			int err = EAGAIN;
+			if (ws_stage_connecting == m_stage)
+			{
+				err = m_socket.continue_connect();
+				if (0 == err)
+				{
+					start_handshake();
+					m_stage = ws_stage_handshaking;
+				}
+			}
+
+			if (ws_stage_handshaking == m_stage)
+			{
+				err = continue_handshake();
+				if (0 == err)
+				{
+					m_stage = ws_stage_open;
+					m_open = true;
+					if (nullptr != m_onConnect)
+					{
+						m_onConnect(*this, "Connected to " + m_uri);
+					}
+				}
+			}
+
+			if (EAGAIN == err && std::chrono::steady_clock::now() >= m_deadline)
+			{
+				err = ETIMEDOUT;
+			}
+
+			if (err && EAGAIN != err)
+			{
+				return fail_open(err);
+			}
+			else if (err)
+			{
+				return err;
+			}
+		}
+
+		if (ws_stage_open == m_stage)
+		{
+			return service();
+		}
+
+		return ENOTCONN;
+	}
+
+	int poll_fd(bool& wantWrite, int& timeoutMs) const
+	{
+		wantWrite = !m_writeBuffer.empty() || m_socket.wants_write();
+		timeoutMs = -1;
+		if (ws_stage_connecting == m_stage || ws_stage_handshaking == m_stage)
+		{
+			auto now = std::chrono::steady_clock::now();
+			timeoutMs = now >= m_deadline ? 0 : (int)std::chrono::duration_cast<std::chrono::milliseconds>(m_deadline - now).count() + 1;
+		}
+
+		return m_socket.fd();
+	}
+
+private:
+	// Point the epoll instance at the socket's current descriptor, or at none for a negative one. The descriptor is
+	// modified even when nothing seems to have changed, a socket reconnected while connecting can reuse its number.
+	void watch(int fd, uint32_t events)
+	{
+		epoll_event ev;
+		memset(&ev, 0, sizeof(ev));
+		ev.events = events;
+		ev.data.fd = fd;
+		if (fd != m_watchedFd && m_watchedFd >= 0)
+		{
+			// Fails harmlessly if the descriptor was closed, which already removed it.
+			epoll_ctl(m_epoll, EPOLL_CTL_DEL, m_watchedFd, nullptr);
+		}
+
+		// A closed and reopened socket can keep its number while having left the epoll instance.
+		if (fd >= 0 && (fd != m_watchedFd || 0 != epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &ev)))
+		{
+			epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev);
+		}
+
+		m_watchedFd = fd;
+	}
+
+	enum ws_stage
+	{
+		ws_stage_closed,
+		ws_stage_connecting,
+		ws_stage_handshaking,
+		ws_stage_open
+	};
+
+	void reset()
+	{
+		m_readBuffer.resize(WS_READ_CHUNK_SIZE);
+		m_readStart = m_readEnd = 0;
+		m_message.clear();
+		m_handshake.clear();
+		m_writeBuffer.clear();
+		m_closeSent = false;
+		std::lock_guard<std::mutex> sendLock(m_sendMutex);
+		m_sendQueue.clear();
+	}
+
+	void wake()
+	{
+		if (nullptr != m_onWake)
+		{
+			m_onWake();
+			return;
+		}
+
+		if (m_wakeFd >= 0)
+		{
+			uint64_t one = 1;
+			ssize_t written = ::write(m_wakeFd, &one, sizeof(one));
+			(void)written;
+		}
+	}
+
+	int fail_open(int err)
+	{
+		finish(err);
+		if (nullptr != m_onError)
+		{
+			m_onError(*this, WS_CLOSE_ABNORMAL, "Failed to connect to " + m_uri);
+		}
+
+		return err;
+	}
+
+	int finish(int err)
+	{
+		m_open = false;
+		m_stage = ws_stage_closed;
+		m_socket.close();
+		return err;
+	}
+
+	void start_handshake()
+	{
+		unsigned char nonce[16];
+		RAND_bytes(nonce, sizeof(nonce));
+		m_key = base64_encode(nonce, sizeof(nonce));
+
+		m_writeBuffer = "GET " + m_target.path + " HTTP/1.1\r\n";
+		m_writeBuffer += "Host: " + m_target.host + "\r\n";
+		m_writeBuffer += "Upgrade: websocket\r\n";
+		m_writeBuffer += "Connection: Upgrade\r\n";
+		m_writeBuffer += "Sec-WebSocket-Key: " + m_key + "\r\n";
+		m_writeBuffer += "Sec-WebSocket-Version: 13\r\n";
+		for (const auto& header : m_headers)
+		{
+			m_writeBuffer += header.first + ": " + header.second + "\r\n";
+		}
+		m_writeBuffer += "\r\n";
+	}
+
+	// Send the upgrade request, then read and check the response. Returns EAGAIN until the response is complete.
+	int continue_handshake()
+	{
+		RETURN_IF_FAILED(write_pending());
+		if (!m_writeBuffer.empty())
+		{
+			return EAGAIN;
+		}
+
+		size_t headerEnd = std::string::npos;
+		while (std::string::npos == headerEnd)
+		{
+			RETURN_IF_FAILED(fill_read_buffer());
+			m_handshake.append(m_readBuffer.data() + m_readStart, m_readEnd - m_readStart);
+			m_readStart = m_readEnd = 0;
+			headerEnd = m_handshake.find("\r\n\r\n");
+		}
+
+		const std::string& response = m_handshake;
+		size_t statusStart = response.find(' ');
+		if (std::string::npos == statusStart || 101 != strtoul(response.c_str() + statusStart + 1, nullptr, 10))
+		{
+			return EPROTO;
+		}
+
+		std::string accept = m_key + WS_HANDSHAKE_GUID;
+		unsigned char digest[SHA_DIGEST_LENGTH];
+		SHA1(reinterpret_cast<const unsigned char*>(accept.c_str()), accept.length(), digest);
+		std::string expectedAccept = base64_encode(digest, sizeof(digest));
+
+		bool accepted = false;
+		size_t lineStart = response.find("\r\n") + 2;
+		while (lineStart < headerEnd && !accepted)
+		{
+			size_t lineEnd = response.find("\r\n", lineStart);
+			size_t colon = response.find(':', lineStart);
+			if (std::string::npos != colon && colon < lineEnd && 0 == strncasecmp(response.c_str() + lineStart, "Sec-WebSocket-Accept", colon - lineStart))
+			{
+				size_t valueStart = response.find_first_not_of(' ', colon + 1);
+				accepted = 0 == response.compare(valueStart, lineEnd - valueStart, expectedAccept);
+			}
+
+			lineStart = lineEnd + 2;
+		}
+
+		if (!accepted)
+		{
+			return EPROTO;
+		}
+
+		// Keep any bytes that arrived with the handshake.
+		size_t extra = response.length() - (headerEnd + 4);
+		if (extra >= m_readBuffer.size())
+		{
+			m_readBuffer.resize(extra + WS_READ_CHUNK_SIZE);
+		}
+
+		memcpy(m_readBuffer.data(), response.data() + headerEnd + 4, extra);
+		m_readEnd = extra;
+		m_handshake.clear();
+		return 0;
+	}
+
+	// Dispatch received frames and write queued ones until the socket would block.
+	int service()
+	{
+		int err = 0;
+		for (;;)
+		{
+			bool closed = false;
+			err = process_frames(m_onMessage, m_onClose, closed);
+			if (0 == err && !closed)
+			{
+				err = flush();
+			}
+
+			if (closed)
+			{
+				return finish(m_closed ? 0 : ECONNRESET);
+			}
+
+			if (err)
+			{
+				break;
+			}
+
+			if (m_closed && m_closeSent && m_writeBuffer.empty())
+			{
+				// The close frame has been written, there is no need to wait for the server's acknowledgement.
+				if (nullptr != m_onClose)
+				{
+					m_onClose(*this, WS_CLOSE_NORMAL, "Close requested");
+				}
+
+				return finish(0);
+			}
+
+			// Decrypted bytes that are already buffered are read here, so EAGAIN means there is nothing left to read.
+			err = fill_read_buffer();
+			if (EAGAIN == err)
+			{
+				return EAGAIN;
+			}
+			else if (err)
+			{
+				// Dispatch anything that arrived before the connection dropped.
+				process_frames(m_onMessage, m_onClose, closed);
+				if (closed)
+				{
+					return finish(m_closed ? 0 : ECONNRESET);
+				}
+
+				break;
+			}
+		}
+
+		if (nullptr != m_onClose)
+		{
+			m_onClose(*this, WS_CLOSE_ABNORMAL, "Connection lost.");
+		}
+
+		return finish(m_closed ? 0 : err);
+	}
+
+	// Read the next chunk from the socket into the receive buffer. The buffer only grows when a single frame outgrows it.
+	int fill_read_buffer()
+	{
+		if (m_readStart == m_readEnd)
+		{
+			m_readStart = m_readEnd = 0;
+		}
+
+		if (m_readBuffer.size() - m_readEnd < WS_READ_CHUNK_SIZE)
+		{
+			if (m_readStart > 0)
+			{
+				memmove(m_readBuffer.data(), m_readBuffer.data() + m_readStart, m_readEnd - m_readStart);
+				m_readEnd -= m_readStart;
+				m_readStart = 0;
+			}
+
+			if (m_readBuffer.size() - m_readEnd < WS_READ_CHUNK_SIZE)
+			{
+				m_readBuffer.resize(m_readBuffer.size() * 2);
+			}
+		}
+
+		// Leave room to null terminate a message at the very end of the buffer.
+		size_t bytesRead = 0;
+		RETURN_IF_FAILED(m_socket.read(m_readBuffer.data() + m_readEnd, m_readBuffer.size() - m_readEnd - 1, bytesRead));
+		m_readEnd += bytesRead;
+		return 0;
+	}
+
+	// Parse and dispatch every complete frame in the receive buffer, or only up to the first message. A frame that breaks
+	// the protocol or a message over WS_MAX_MESSAGE_SIZE fails the connection before its payload is buffered.
+	int process_frames(const on_ws_message& onMessage, const on_ws_close& onClose, bool& closed, bool firstMessageOnly = false)
+	{
+		for (;;)
+		{
+			const unsigned char* frame = reinterpret_cast<const unsigned char*>(m_readBuffer.data() + m_readStart);
+			size_t available = m_readEnd - m_readStart;
+			if (available < 2)
+			{
+				return 0;
+			}
+
+			bool fin = 0 != (frame[0] & 0x80);
+			unsigned char opcode = frame[0] & 0x0F;
+			bool masked = 0 != (frame[1] & 0x80);
+			uint64_t payloadLength = frame[1] & 0x7F;
+			size_t headerLength = 2;
+			if (126 == payloadLength)
+			{
+				if (available < 4)
+				{
+					return 0;
+				}
+
+				payloadLength = ((uint64_t)frame[2] << 8) | frame[3];
+				headerLength = 4;
+			}
+			else if (127 == payloadLength)
+			{
+				if (available < 10)
+				{
+					return 0;
+				}
+
+				payloadLength = 0;
+				for (int i = 0; i < 8; ++i)
+				{
+					payloadLength = (payloadLength << 8) | frame[2 + i];
+				}
+				headerLength = 10;
+			}
+
+			if (masked)
+			{
+				headerLength += 4;
+			}
+
+			// Control frames are never fragmented and carry at most 125 bytes (RFC 6455 5.5).
+			if (0 != (opcode & 0x8) && (!fin || payloadLength > WS_MAX_CONTROL_SIZE))
+			{
+				return fail_connection(WS_CLOSE_PROTOCOL);
+			}
+
+			if (payloadLength > WS_MAX_MESSAGE_SIZE || (WS_OPCODE_CONTINUATION == opcode && m_message.length() + payloadLength > WS_MAX_MESSAGE_SIZE))
+			{
+				return fail_connection(WS_CLOSE_TOO_BIG);
+			}
+
+			if (available < headerLength || available - headerLength < payloadLength)
+			{
+				return 0;
+			}
+
+			char* payload = m_readBuffer.data() + m_readStart + headerLength;
+			if (masked)
+			{
+				const unsigned char* mask = frame + headerLength - 4;
+				for (uint64_t i = 0; i < payloadLength; ++i)
+				{
+					payload[i] ^= mask[i & 3];
+				}
+			}
+
+			m_readStart += headerLength + (size_t)payloadLength;
+
+			switch (opcode)
+			{
+			case WS_OPCODE_TEXT:
+			case WS_OPCODE_BINARY:
+				m_messageOpcode = opcode;
+				if (fin)
+				{
+					// Unfragmented messages are handed out as a view straight into the receive buffer. Binary messages are not supported.
+					if (WS_OPCODE_TEXT == opcode && nullptr != onMessage)
+					{
+						char next = payload[payloadLength];
+						payload[payloadLength] = 0;
+						onMessage(*this, payload, (size_t)payloadLength);
+						payload[payloadLength] = next;
+						if (firstMessageOnly)
+						{
+							return 0;
+						}
+					}
+
+					continue;
+				}
+
+				m_message.assign(payload, (size_t)payloadLength);
+				break;
+			case WS_OPCODE_CONTINUATION:
+				m_message.append(payload, (size_t)payloadLength);
+				break;
+			case WS_OPCODE_PING:
+				append_frame(m_writeBuffer, WS_OPCODE_PONG, payload, (size_t)payloadLength);
+				continue;
+			case WS_OPCODE_PONG:
+				continue;
+			case WS_OPCODE_CLOSE:
+			{
+				unsigned short code = WS_CLOSE_NORMAL;
+				std::string reason;
+				if (payloadLength >= 2)
+				{
+					code = (unsigned short)(((unsigned char)payload[0] << 8) | (unsigned char)payload[1]);
+					reason.assign(payload + 2, (size_t)payloadLength - 2);
+				}
+
+				// Echo the close frame back before closing the connection.
+				if (!m_closeSent)
+				{
+					append_frame(m_writeBuffer, WS_OPCODE_CLOSE, payload, payloadLength >= 2 ? 2 : 0);
+					m_closeSent = true;
+					flush();
+				}
+
+				closed = true;
+				if (nullptr != onClose)
+				{
+					onClose(*this, code, reason);
+				}
+
+				return 0;
+			}
+			default:
+				return EPROTO;
+			}
+
+			if (fin)
+			{
+				// Binary messages are not supported.
+				bool dispatched = WS_OPCODE_TEXT == m_messageOpcode && nullptr != onMessage;
+				if (dispatched)
+				{
+					onMessage(*this, &m_message[0], m_message.length());
+				}
+
+				m_message.clear();
+				if (dispatched && firstMessageOnly)
+				{
+					return 0;
+				}
+			}
+		}
+	}
+
+	// Tell the server why the connection is being dropped, then drop it.
+	int fail_connection(unsigned short code)
+	{
+		if (!m_closeSent)
+		{
+			const char closeReason[] = { (char)(code >> 8), (char)(code & 0xFF) };
+			append_frame(m_writeBuffer, WS_OPCODE_CLOSE, closeReason, sizeof(closeReason));
+			m_closeSent = true;
+			write_pending();
+		}
+
+		return EPROTO;
+	}
+
+	// Write queued frames until the socket would block.
+	int flush()
+	{
+		// Critical Section: Take ownership of frames queued by other threads.
+		{
+			std::lock_guard<std::mutex> sendLock(m_sendMutex);
+			if (!m_sendQueue.empty())
+			{
+				if (m_writeBuffer.empty())
+				{
+					m_writeBuffer.swap(m_sendQueue);
+				}
+				else
+				{
+					m_writeBuffer.append(m_sendQueue);
+					m_sendQueue.clear();
+				}
+			}
+
+			if (m_closed && !m_closeSent)
+			{
+				static const char closeReason[] = { (char)(WS_CLOSE_NORMAL >> 8), (char)(WS_CLOSE_NORMAL & 0xFF) };
+				append_frame(m_writeBuffer, WS_OPCODE_CLOSE, closeReason, sizeof(closeReason));
+				m_closeSent = true;
+			}
+		}
+
+		return write_pending();
+	}
+
+	// Write the write buffer until the socket would block, whatever remains is written by a later poll().
+	int write_pending()
+	{
+		size_t offset = 0;
+		int err = 0;
+		while (offset < m_writeBuffer.length())
+		{
+			size_t bytesWritten = 0;
+			err = m_socket.write(m_writeBuffer.data() + offset, m_writeBuffer.length() - offset, bytesWritten);
+			if (err)
+			{
+				break;
+			}
+
+			offset += bytesWritten;
+		}
+
+		m_writeBuffer.erase(0, offset);
+		return EAGAIN == err ? 0 : err;
+	}
+
+	// Append a masked client frame to the buffer. Client to server frames must always be masked.
+	void append_frame(std::string& buffer, unsigned char opcode, const char* payload, size_t length)
+	{
+		unsigned char header[14];
+		size_t headerLength = 2;
+		header[0] = 0x80 | opcode;
+		if (length < 126)
+		{
+			header[1] = 0x80 | (unsigned char)length;
+		}
+		else if (length <= 0xFFFF)
+		{
+			header[1] = 0x80 | 126;
+			header[2] = (unsigned char)(length >> 8);
+			header[3] = (unsigned char)length;
+			headerLength = 4;
+		}
+		else
+		{
+			header[1] = 0x80 | 127;
+			for (int i = 0; i < 8; ++i)
+			{
+				header[2 + i] = (unsigned char)((uint64_t)length >> (56 - 8 * i));
+			}
+			headerLength = 10;
+		}
+
+		uint32_t maskKey = m_maskGenerator();
+		unsigned char* mask = header + headerLength;
+		memcpy(mask, &maskKey, 4);
+		headerLength += 4;
+
+		size_t frameStart = buffer.length();
+		buffer.append(reinterpret_cast<const char*>(header), headerLength);
+		buffer.append(payload, length);
+		char* maskedPayload = &buffer[frameStart + headerLength];
+		for (size_t i = 0; i < length; ++i)
+		{
+			maskedPayload[i] ^= mask[i & 3];
+		}
+	}
+
+	std::map<std::string, std::string> m_headers;
+	posix_socket m_socket;
+
+	// Owned by the thread inside open(). The descriptor to wait on changes as the socket is reconnected.
+	int m_epoll;
+	int m_watchedFd;
+
+	std::atomic<int> m_wakeFd;
+	std::atomic<bool> m_open;
+	std::atomic<bool> m_closed;
+	on_ws_wake m_onWake;
+
+	// Owned by the thread calling poll().
+	ws_stage m_stage;
+	std::string m_uri;
+	posix_uri m_target;
+	std::string m_key;
+	std::string m_handshake;
+	std::chrono::steady_clock::time_point m_deadline;
+	on_ws_connect m_onConnect;
+	on_ws_message m_onMessage;
+	on_ws_error m_onError;
+	on_ws_close m_onClose;
+	bool m_closeSent;
+	std::vector<char> m_readBuffer;
+	size_t m_readStart;
+	size_t m_readEnd;
+	std::string m_message;
+	unsigned char m_messageOpcode;
+	std::string m_writeBuffer;
+
+	// Frames queued by send().
+	std::mutex m_sendMutex;
+	std::string m_sendQueue;
+	std::mt19937 m_maskGenerator;
+};
+
+std::unique_ptr<websocket>
+websocket_factory::make_websocket()
+{
+	return std::unique_ptr<websocket>(new posix_websocket());
+}
+
+extern "C" {
+
+	int create_websocket(websocket_handle* handlePtr)
+	{
+		if (nullptr == handlePtr)
+		{
+			return 1;
+		}
+
+		std::unique_ptr<websocket> handle = websocket_factory::make_websocket();
+		*handlePtr = handle.release();
+		return 0;
+	}
+
+	int add_header(websocket_handle handle, const char* key, const char* value)
+	{
+		websocket* client = reinterpret_cast<websocket*>(handle);
+		return client->add_header(key, value);
+	}
+
+	int open_websocket(websocket_handle handle, const char* uri, const c_on_ws_connect onConnect, const c_on_ws_message onMessage, const c_on_ws_error onError, const c_on_ws_close onClose)
+	{
+		websocket* client = reinterpret_cast<websocket*>(handle);
+
+		auto connectHandler = [&](const websocket& socket, const std::string& connectMessage)
+		{
+			if (onConnect)
+			{
+				onConnect((void*)&socket, connectMessage.c_str(), connectMessage.length());
+			}
+		};
+
+		auto messageHandler = [&](const websocket& socket, char* message, const size_t messageSize)
+		{
+			if (onMessage)
+			{
+				onMessage((void*)&socket, message, messageSize);
+			}
+		};
+
+		auto errorHandler = [&](const websocket& socket, unsigned short code, const std::string& error)
+		{
+			if (onError)
+			{
+				onError((void*)&socket, code, error.c_str(), error.length());
+			}
+		};
+
+		auto closeHandler = [&](const websocket& socket, unsigned short code, const std::string& reason)
+		{
+			if (onClose)
+			{
+				onClose((void*)&socket, code, reason.c_str(), reason.length());
+			}
+		};
+
+		return client->open(uri, connectHandler, messageHandler, errorHandler, closeHandler);
+	}
+
+	int write_websocket(websocket_handle handle, const char* message)
+	{
+		websocket* client = reinterpret_cast<websocket*>(handle);
+		return client->send(message);
+	}
+
+	int read_websocket(websocket_handle handle, c_on_ws_message onMessage)
+	{
+		if (nullptr == handle || nullptr == onMessage)
+		{
+			return 1;
+		}
+
+		websocket* client = reinterpret_cast<websocket*>(handle);
+		std::string message;
+		int error = client->read(message);
+		if (error)
+		{
+			return error;
+		}
+
+		return 0;
+	}
+
+	int close_websocket(websocket_handle handle)
+	{
+		websocket* client = reinterpret_cast<websocket*>(handle);
+		client->close();
+		delete client;
+		return 0;
+	}
+}
+
+}
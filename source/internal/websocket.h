@@ -8,19 +8,48 @@ namespace mixer_internal
 class websocket;
 
 typedef std::function<void(const websocket& socket, const std::string& connectMessage)> on_ws_connect;
-typedef std::function<void(const websocket& socket, const std::string& message)> on_ws_message;
+// Messages are a view into the websocket's receive buffer, which is reused for every message. The view is null terminated,
+// is only valid for the duration of the callback, and may be modified in place by the handler.
+typedef std::function<void(const websocket& socket, char* message, const size_t messageSize)> on_ws_message;
 typedef std::function<void(const websocket& socket, const unsigned short code, const std::string& error)> on_ws_error;
 typedef std::function<void(const websocket& socket, const unsigned short code, const std::string& reason)> on_ws_close;
 
+class polled_websocket;
+
 class websocket
 {
 public:
-	virtual ~websocket() = 0 {};
+	virtual ~websocket() {};
 	virtual int add_header(const std::string& key, const std::string& value) = 0;
 	virtual int open(const std::string& uri, const on_ws_connect onConnect, const on_ws_message onMessage, const on_ws_error onError, const on_ws_close onClose) = 0;
 	virtual int send(const std::string& message) = 0;
 	virtual int read(std::string& message) = 0;
 	virtual void close() = 0;
+
+	// Returns nullptr if the socket can only be serviced by the thread inside open().
+	virtual polled_websocket* polled() { return nullptr; }
+};
+
+typedef std::function<void()> on_ws_wake;
+
+// A websocket serviced by its owner instead of a thread of its own. Opening returns at once and the owner calls poll()
+// whenever the descriptor is ready, the wake handler runs or the wait time passes. Handlers are called from poll().
+class polled_websocket
+{
+public:
+	virtual ~polled_websocket() {};
+
+	// Called from any thread when send() or close() leaves work for poll(). Set before opening.
+	virtual void set_wake_handler(const on_ws_wake onWake) = 0;
+	virtual int open_async(const std::string& uri, const on_ws_connect onConnect, const on_ws_message onMessage, const on_ws_error onError, const on_ws_close onClose) = 0;
+
+	// Make all the progress possible without blocking. Returns EAGAIN while the socket is opening or open, otherwise it
+	// has closed and the result is what open() would have returned.
+	virtual int poll() = 0;
+
+	// The descriptor to wait on until the next poll(), whether to wait for it to be writable, and the longest wait in
+	// milliseconds, or -1 for no limit.
+	virtual int poll_fd(bool& wantWrite, int& timeoutMs) const = 0;
 };
 
 class websocket_factory
@@ -7,10 +7,13 @@
 
 #include <map>
 #include <sstream>
+#include <vector>
 #include <queue>
 #include <condition_variable>
 #include <regex>
 
+#define WS_RECEIVE_CHUNK_SIZE 4096
+
 namespace mixer_internal
 {
 
@@ -149,16 +152,14 @@ public:
 			}
 		}
 
-		BYTE buffer[1024];
-		memset(buffer, 0, sizeof(buffer));
 		DWORD bytesRead = 0;
 		WINHTTP_WEB_SOCKET_BUFFER_TYPE bufferType;
-
-		std::stringstream message;
+		size_t received = 0;
 
 		while (!m_closed)
 		{
-			int err = winHttpApi.win_http_websocket_receive(m_websocketHandle.get(), buffer, sizeof(buffer) - 1, &bytesRead, &bufferType);
+			reserve_receive_buffer(received);
+			int err = winHttpApi.win_http_websocket_receive(m_websocketHandle.get(), m_receiveBuffer.data() + received, (DWORD)(m_receiveBuffer.size() - received - 1), &bytesRead, &bufferType);
 			if (err)
 			{
 				if (ERROR_WINHTTP_OPERATION_CANCELLED == err && nullptr != onClose)
@@ -189,24 +190,19 @@ public:
 			if (WINHTTP_WEB_SOCKET_BINARY_MESSAGE_BUFFER_TYPE == bufferType ||
 				WINHTTP_WEB_SOCKET_BINARY_FRAGMENT_BUFFER_TYPE == bufferType)
 			{
-				// Binary messages are not supported.
-				memset(buffer, 0, bytesRead);
-				bytesRead = 0;
+				// Binary messages are not supported, leave the bytes uncommitted.
 				continue;
 			}
 
-			buffer[bytesRead] = 0;
-			message << buffer;
-			memset(buffer, 0, bytesRead);
-			bytesRead = 0;
-
+			received += bytesRead;
 			if (WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE != bufferType)
 			{
+				m_receiveBuffer[received] = 0;
 				if (nullptr != onMessage)
 				{
-					onMessage(*this, message.str());
+					onMessage(*this, m_receiveBuffer.data(), received);
 				}
-				message = std::stringstream();
+				received = 0;
 			}
 		}
 
@@ -245,15 +241,14 @@ public:
 			return E_ABORT;
 		}
 
-		BYTE buffer[1024];
-		memset(buffer, 0, sizeof(buffer));
 		DWORD bytesRead = 0;
 		WINHTTP_WEB_SOCKET_BUFFER_TYPE bufferType = WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE;
-		std::stringstream messageStream;
+		size_t received = 0;
 
 		while (WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE == bufferType)
 		{
-			int err = winHttpApi.win_http_websocket_receive(m_websocketHandle.get(), buffer, sizeof(buffer), &bytesRead, &bufferType);
+			reserve_receive_buffer(received);
+			int err = winHttpApi.win_http_websocket_receive(m_websocketHandle.get(), m_receiveBuffer.data() + received, (DWORD)(m_receiveBuffer.size() - received - 1), &bytesRead, &bufferType);
 			if (err)
 			{
 				return err;
@@ -271,11 +266,10 @@ public:
 				return E_INVALID_PROTOCOL_FORMAT;
 			}
 
-			messageStream << buffer;
-			memset(buffer, 0, bytesRead);
+			received += bytesRead;
 		}
 
-		message = messageStream.str();
+		message.assign(m_receiveBuffer.data(), received);
 		return 0;
 	}
 
@@ -290,7 +284,18 @@ public:
 	}
 
 private:
+	// Grow the receive buffer so another chunk and a null terminator fit after the bytes already received.
+	void reserve_receive_buffer(size_t received)
+	{
+		if (m_receiveBuffer.size() - received < WS_RECEIVE_CHUNK_SIZE + 1)
+		{
+			size_t grownSize = m_receiveBuffer.size() * 2;
+			m_receiveBuffer.resize(grownSize > received + WS_RECEIVE_CHUNK_SIZE ? grownSize : received + WS_RECEIVE_CHUNK_SIZE + 1);
+		}
+	}
+
 	hinternet_ptr m_websocketHandle;
+	std::vector<char> m_receiveBuffer;
 	std::map<std::string, std::string> m_headers;
 	bool m_open;
 	bool m_opening;
@@ -340,11 +345,11 @@ extern "C" {
 			}
 		};
 
-		auto messageHandler = [&](const websocket& socket, const std::string& message)
+		auto messageHandler = [&](const websocket& socket, char* message, const size_t messageSize)
 		{
 			if (onMessage)
 			{
-				onMessage((void*)&socket, message.c_str(), message.length());
+				onMessage((void*)&socket, message, messageSize);
 			}
 		};
 
@@ -199,14 +199,14 @@ public:
 				}
 			}
 
-			// Connected and a message is ready.
-			std::string message = m_messages.front();
+			// Connected and a message is ready, take it without copying.
+			m_receiveBuffer.swap(m_messages.front());
 			m_messages.pop();
 			socketLock.unlock();
 
 			if (onMessage)
 			{
-				onMessage(*this, message);
+				onMessage(*this, &m_receiveBuffer[0], m_receiveBuffer.length());
 			}
 		}
 
@@ -281,6 +281,9 @@ private:
 	std::condition_variable m_socketEventCV;
 	bool m_connected;
 	std::queue<std::string> m_messages;
+
+	// The message currently being handled by onMessage.
+	std::string m_receiveBuffer;
 };
 
 
@@ -323,11 +326,11 @@ extern "C" {
 			}
 		};
 
-		auto messageHandler = [&](const websocket& socket, const std::string& message)
+		auto messageHandler = [&](const websocket& socket, char* message, const size_t messageSize)
 		{
 			if (onMessage)
 			{
-				onMessage((void*)&socket, message.c_str(), (unsigned int)message.length());
+				onMessage((void*)&socket, message, messageSize);
 			}
 		};
 